@@ -5,10 +5,16 @@ add_library(minizinc_mip OBJECT
   lib/utils_savestream.cpp
 
   solvers/MIP/MIP_solverinstance.cpp
+  solvers/MIP/MIP_writer.cpp
+  solvers/MIP/MIP_writer_solverfactory.cpp
+  solvers/MIP/MIP_writer_wrap.cpp
 
   include/minizinc/plugin.hh
   include/minizinc/solvers/MIP/MIP_wrap.hh
   include/minizinc/solvers/MIP/MIP_solverinstance.hh
   include/minizinc/solvers/MIP/MIP_solverinstance.hpp
+  include/minizinc/solvers/MIP/MIP_writer.hh
+  include/minizinc/solvers/MIP/MIP_writer_solverfactory.hh
+  include/minizinc/solvers/MIP/MIP_writer_wrap.hh
 )
 add_dependencies(minizinc_mip minizinc_parser)
@@ -93,11 +93,6 @@ else()
   set(FLEX_RegExLexer_OUTPUTS ${PROJECT_SOURCE_DIR}/lib/cached/regex_lexer.yy.cpp)
 endif()
 
-if(NOT GECODE_FOUND)
-  set(FLEX_RegExLexer_OUTPUTS "")
-  set(BISON_RegExParser_OUTPUTS "")
-endif()
-
 add_library(minizinc_parser OBJECT
   ${BISON_MZNParser_OUTPUTS}
   ${FLEX_MZNLexer_OUTPUTS}
@@ -107,8 +102,3 @@ add_library(minizinc_parser OBJECT
 set_target_properties(minizinc_parser PROPERTIES
   CXX_CLANG_TIDY ""
 )
-
-if(GECODE_FOUND)
-  target_include_directories(minizinc_parser PRIVATE "${GECODE_INCLUDE_DIRS}")
-  target_compile_definitions(minizinc_parser PRIVATE HAS_GECODE)
-endif()
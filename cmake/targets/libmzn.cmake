@@ -47,12 +47,14 @@ add_library(mzn
   lib/optimize.cpp
   lib/optimize_constraints.cpp
   lib/output.cpp
+  lib/parallel_comp.cpp
   lib/param_config.cpp
   lib/parser.cpp
   lib/parser.yxx
   lib/passes/compile_pass.cpp
   lib/pathfileprinter.cpp
   lib/prettyprinter.cpp
+  lib/shared_bounds.cpp
   lib/solns2out.cpp
   lib/solver.cpp
   lib/solver_config.cpp
@@ -64,6 +66,7 @@ add_library(mzn
   lib/type_specialise.cpp
   lib/values.cpp
   lib/warning.cpp
+  lib/support/regex/dfa.cpp
   lib/support/regex/parser.yxx
   lib/support/regex/lexer.lxx
   lib/utils.cpp
@@ -96,12 +99,14 @@ add_library(mzn
   include/minizinc/optimize.hh
   include/minizinc/optimize_constraints.hh
   include/minizinc/output.hh
+  include/minizinc/parallel_comp.hh
   include/minizinc/param_config.hh
   include/minizinc/parser.hh
   include/minizinc/passes/compile_pass.hh
   include/minizinc/pathfileprinter.hh
   include/minizinc/prettyprinter.hh
   include/minizinc/process.hh
+  include/minizinc/shared_bounds.hh
   include/minizinc/solns2out.hh
   include/minizinc/solver.hh
   include/minizinc/solver_config.hh
@@ -140,10 +145,6 @@ include(cmake/targets/libminizinc_osicbc.cmake)
 include(cmake/targets/libminizinc_scip.cmake)
 include(cmake/targets/libminizinc_xpress.cmake)
 
-if(GECODE_FOUND)
-  target_link_libraries(mzn Gecode::Minimodel Gecode::Support)
-endif()
-
 
 ### Add all necessary files to the install target
 install(
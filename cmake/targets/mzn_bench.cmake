@@ -0,0 +1,3 @@
+#### Benchmark suite for the compiler pipeline (not built by default)
+add_executable(mzn_bench EXCLUDE_FROM_ALL tests/benchmarking/mzn_bench.cpp)
+target_link_libraries(mzn_bench mzn)
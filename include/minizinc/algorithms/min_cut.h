@@ -5,18 +5,81 @@
 
 namespace Algorithms {
 
-/// An interface to some min-cut algorithm for undirected graphs
+/**
+ * \brief Minimum cuts of undirected graphs
+ *
+ * Computes an equivalent flow tree using Gusfield's algorithm, that is,
+ * n-1 maximum flows (Dinic's algorithm) over a compressed sparse row
+ * representation of the graph. The lightest of the resulting cuts is a global
+ * minimum cut, and all cuts lighter than \a threshold are reported.
+ * The buffers are kept between invocations, so that solving graphs that are
+ * not larger than before does not allocate memory.
+ */
 class MinCut {
 public:
   /// INPUT
   int nNodes = 0;
   std::vector<std::pair<int, int> > edges;
   std::vector<double> weights;
+  /// Report all cuts lighter than this
+  double threshold = 0.0;
+  /// Contract the edges at least this heavy first, so only cuts that do not
+  /// separate their ends are found
+  double contractWeight = 1e100;
   /// OUTPUT
   std::vector<bool> parities;
   double wMinCut = 1e100;
+  /// The cuts lighter than threshold, without repetitions. The nodes on the side
+  /// of cut k that does not contain node 0 are cutNodes[cutStart[k]..cutStart[k+1]).
+  std::vector<int> cutStart;
+  std::vector<int> cutNodes;
+  std::vector<double> cutWeights;
+  /// Number of cuts lighter than threshold
+  size_t nCuts() const { return cutWeights.size(); }
   /// Invocation
-  static void solve();
+  void solve();
+
+protected:
+  /// Node of the contracted graph for each node
+  std::vector<int> _super;
+  /// Arcs of the contracted graph leaving node i are _first[i].._first[i+1]-1
+  std::vector<int> _first;
+  /// Head of each arc
+  std::vector<int> _head;
+  /// Reverse of each arc
+  std::vector<int> _rev;
+  /// Capacity of each arc
+  std::vector<double> _cap;
+  /// Residual capacity of each arc
+  std::vector<double> _res;
+  /// Arcs whose residual capacity has changed
+  std::vector<int> _touched;
+  /// BFS level of each labelled node
+  std::vector<int> _level;
+  /// Nodes are labelled in the current BFS iff _mark[i] == _stamp
+  std::vector<unsigned int> _mark;
+  unsigned int _stamp = 0;
+  /// Next arc to try from each node in the current phase
+  std::vector<int> _iter;
+  /// BFS queue, and arcs of the current augmenting path
+  std::vector<int> _queue;
+  std::vector<int> _path;
+  /// Parent of each node in the flow tree
+  std::vector<int> _parent;
+  /// Side of the lightest cut found so far
+  std::vector<char> _minSide;
+  /// Hash values of the cuts found
+  std::vector<size_t> _cutHash;
+
+  /// Build the contracted graph, return its number of nodes
+  int buildGraph();
+  /// Whether node \a i has been labelled in the current BFS
+  bool labelled(int i) const { return _mark[i] == _stamp; }
+  /// Compute a maximum flow from \a s to \a t, afterwards exactly the nodes on the side of \a s
+  /// are labelled
+  double maxFlow(int s, int t);
+  /// Record the cut of weight \a w given by the labelled nodes, unless already known
+  void addCut(double w);
 };
 
-}  // namespace Algorithms
\ No newline at end of file
+}  // namespace Algorithms
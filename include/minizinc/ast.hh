@@ -140,17 +140,41 @@ protected:
     unsigned int lastColumn() const;
   };
 
+  /// Compact locations (64 bit pointers only) are stored in place of the LocVec pointer,
+  /// without any heap allocation:
+  ///   introduced flag (1 bit), compact flag (1 bit), index into the table of filenames
+  ///   (14 bit), first line (20 bit), last line-first line (8 bit), first column (10 bit),
+  ///   last column (10 bit)
   union LI {
     LocVec* lv;
     ptrdiff_t t;
   } _locInfo;
 
+  /// Whether compact mode is enabled (for the current thread)
+  static bool& compactModeFlag();
+  /// Whether locations are currently dropped (inside a DataScope in compact mode)
+  static bool& dropLocationsFlag();
+
+  bool isCompact() const { return (_locInfo.t & 2) != 0; }
+  unsigned int compactField(unsigned int shift, unsigned int bits) const {
+    return static_cast<unsigned int>((static_cast<unsigned long long>(_locInfo.t) >> shift) &
+                                     ((1ULL << bits) - 1));
+  }
+  ASTString compactFilename() const;
+
   LocVec* lv() const {
+    if (isCompact()) {
+      return nullptr;
+    }
     LI li = _locInfo;
     li.t &= ~static_cast<ptrdiff_t>(1);
     return li.lv;
   }
 
+  /// Initialise location, using the compact representation if possible
+  void init(const ASTString& filename, unsigned int first_line, unsigned int first_column,
+            unsigned int last_line, unsigned int last_column);
+
 public:
   /// Construct empty location
   Location() { _locInfo.lv = nullptr; }
@@ -161,12 +185,11 @@ public:
     if (last_line < first_line) {
       throw InternalError("invalid location");
     }
-    _locInfo.lv = LocVec::a(filename, first_line, first_column, last_line, last_column);
+    init(filename, first_line, first_column, last_line, last_column);
   }
 
   Location(const ParserLocation& loc) {
-    _locInfo.lv = LocVec::a(loc.filename(), loc.firstLine(), loc.firstColumn(), loc.lastLine(),
-                            loc.lastColumn());
+    init(loc.filename(), loc.firstLine(), loc.firstColumn(), loc.lastLine(), loc.lastColumn());
   }
 
   /// Return string representation
@@ -176,19 +199,31 @@ public:
   std::string toJSON() const;
 
   /// Return filename
-  ASTString filename() const { return lv() != nullptr ? lv()->filename() : ASTString(); }
+  ASTString filename() const {
+    return isCompact() ? compactFilename() : lv() != nullptr ? lv()->filename() : ASTString();
+  }
 
   /// Return first line number
-  unsigned int firstLine() const { return lv() != nullptr ? lv()->firstLine() : 0; }
+  unsigned int firstLine() const {
+    return isCompact() ? compactField(16, 20) : lv() != nullptr ? lv()->firstLine() : 0;
+  }
 
   /// Return last line number
-  unsigned int lastLine() const { return lv() != nullptr ? lv()->lastLine() : 0; }
+  unsigned int lastLine() const {
+    return isCompact() ? compactField(16, 20) + compactField(36, 8)
+           : lv() != nullptr ? lv()->lastLine()
+                             : 0;
+  }
 
   /// Return first column number
-  unsigned int firstColumn() const { return lv() != nullptr ? lv()->firstColumn() : 0; }
+  unsigned int firstColumn() const {
+    return isCompact() ? compactField(44, 10) : lv() != nullptr ? lv()->firstColumn() : 0;
+  }
 
   /// Return last column number
-  unsigned int lastColumn() const { return lv() != nullptr ? lv()->lastColumn() : 0; }
+  unsigned int lastColumn() const {
+    return isCompact() ? compactField(54, 10) : lv() != nullptr ? lv()->lastColumn() : 0;
+  }
 
   /// Return whether location is introduced by the compiler
   bool isIntroduced() const { return _locInfo.lv == nullptr || ((_locInfo.t & 1) != 0); }
@@ -196,7 +231,7 @@ public:
   /// Mark as alive for garbage collection
   void mark() const;
 
-  /// Return location with introduced flag set
+  /// Return location with introduced flag set (an empty location in compact mode)
   Location introduce() const;
 
   /// Location used for un-allocated expressions
@@ -208,6 +243,25 @@ public:
   ParserLocation parserLocation() const {
     return ParserLocation(filename(), firstLine(), firstColumn(), lastLine(), lastColumn());
   }
+
+  /// Enable or disable compact mode, in which locations of expressions read from data files and
+  /// of expressions introduced by the compiler are dropped
+  static void compactMode(bool b) { compactModeFlag() = b; }
+  /// Return whether compact mode is enabled
+  static bool compactMode() { return compactModeFlag(); }
+
+  /// Scope in which data files are parsed: all locations constructed while a DataScope is
+  /// alive are dropped if compact mode is enabled
+  class DataScope {
+  private:
+    bool _prev;
+
+  public:
+    DataScope() : _prev(dropLocationsFlag()) { dropLocationsFlag() = compactModeFlag(); }
+    ~DataScope() { dropLocationsFlag() = _prev; }
+    DataScope(const DataScope&) = delete;
+    DataScope& operator=(const DataScope&) = delete;
+  };
 };
 
 /// Output operator for locations
@@ -823,8 +877,13 @@ protected:
   // If _flag2 is true, then this is an array view. In that case,
   // the _dims array holds the sliced dimensions
   ASTIntVec _dims;
-  /// Set compressed vector (initial repetitions are removed)
+  /// Set compressed vector (initial repetitions are removed, and arithmetic
+  /// progressions of integers are stored as their first element and step)
   void compress(const std::vector<Expression*>& v, const std::vector<int>& dims);
+  /// Replace a progression by the explicit vector of its elements
+  void materialise();
+  /// Replace a shared element vector by a private copy
+  void unshare();
   /// Whether this is an array or a tuple
   enum ArrayLitType { AL_ARRAY, AL_TUPLE };
 
@@ -858,6 +917,10 @@ public:
   static ArrayLit* constructTuple(const Location& loc, const std::vector<Expression*>& v);
   /// Construct tuple (existing content)
   static ArrayLit* constructTuple(const Location& loc, ArrayLit* v);
+  /// Construct integer array \a first, \a first + \a step, ... with dimensions \a dims
+  /// (elements are only allocated if the array cannot be stored as a progression)
+  static ArrayLit* progression(const Location& loc, IntVal first, IntVal step,
+                               const std::vector<std::pair<int, int> >& dims);
   /// Recompute hash value
   void rehash();
 
@@ -878,6 +941,13 @@ public:
   /// Get underlying _dims vector
   ASTIntVec dimsInternal() const { return _dims; }
 
+  /// Whether this is an integer array stored as an arithmetic progression
+  bool isProgression() const { return !_flag2 && _u.v->flag2(); }
+  /// Return first element of a progression
+  IntVal progressionFirst() const;
+  /// Return step of a progression
+  IntVal progressionStep() const;
+
   /// Return number of dimensions
   unsigned int dims() const;
   /// Return minimum index of dimension \a i
@@ -903,6 +973,12 @@ public:
     if (_flag2 || _u.v->flag()) {
       setSlice(i, e);
     } else {
+      if (_u.v->shared()) {
+        if ((*_u.v)[i] == e) {
+          return;
+        }
+        unshare();
+      }
       (*_u.v)[i] = e;
     }
   }
@@ -1403,7 +1479,7 @@ public:
   /// Access TypeInst
   TypeInst* ti() const { return _ti; }
   /// Set TypeInst
-  void ti(TypeInst* t) { _ti = t; }
+  void ti(TypeInst* t);
   /// Access identifier
   Id* id() const { return _id; }
   /// Access initialisation expression
@@ -1429,6 +1505,13 @@ public:
   bool evaluated() const;
   /// Whether variable has been evaluated
   void evaluated(bool t);
+  /// Whether changes to the variable start a new GC::revision
+  bool watched() const;
+  /// Start a new GC::revision when the variable or its domain is changed (until the revision
+  /// changes for any reason)
+  void watch();
+  /// Stop watching the variable (called by the GC when the revision changes)
+  void unwatch() { _secondaryId &= ~4; }
   /// Access payload
   int payload() const { return _payload; }
   /// Set payload
@@ -1516,9 +1599,17 @@ public:
   /// Access domain
   Expression* domain() const { return _domain; }
   //// Set domain
-  void domain(Expression* d) { _domain = d; }
+  void domain(Expression* d) {
+    if (watched()) {
+      GC::newRevision();
+    }
+    _domain = d;
+  }
   /// Erase domain, preserving tuple types stored in domain field
   void eraseDomain() {
+    if (watched()) {
+      GC::newRevision();
+    }
     if (_domain == nullptr || !Expression::isa<ArrayLit>(_domain)) {
       _domain = nullptr;
       return;
@@ -1554,6 +1645,18 @@ public:
   bool isEnum() const { return _flag2; }
   /// Set if this TypeInst represents an enum
   void setIsEnum(bool b) { _flag2 = b; }
+  /// Whether changes to the domain start a new GC::revision
+  bool watched() const { return _secondaryId != 0U; }
+  /// Start a new GC::revision when the domain is changed (until the revision changes for any
+  /// reason)
+  void watch() {
+    if (!watched()) {
+      _secondaryId = 1;
+      GC::watch(this);
+    }
+  }
+  /// Stop watching the domain (called by the GC when the revision changes)
+  void unwatch() { _secondaryId = 0; }
 
   // Collect type ids for monomorphasation (assumes tuple TypeInst)
   void collectTypeIds(std::unordered_map<ASTString, size_t>& seen_tiids,
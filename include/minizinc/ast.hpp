@@ -640,8 +640,18 @@ inline Expression* VarDecl::e() const {
   return (_e == nullptr || isUnboxedVal(_e)) ? _e : untag(_e);
 }
 
+inline void VarDecl::ti(TypeInst* t) {
+  if (watched()) {
+    GC::newRevision();
+  }
+  _ti = t;
+}
+
 inline void VarDecl::e(Expression* rhs) {
   assert(rhs == nullptr || !Expression::isa<Id>(rhs) || Expression::cast<Id>(rhs) != _id);
+  if (watched()) {
+    GC::newRevision();
+  }
   _e = rhs;
 }
 
@@ -673,13 +683,29 @@ inline void VarDecl::evaluated(bool t) {
     }
   }
 }
-inline void VarDecl::flat(VarDecl* vd) { _flat = vd; }
+inline bool VarDecl::watched() const { return (_secondaryId & 4U) == 4U; }
+inline void VarDecl::watch() {
+  if (!watched()) {
+    _secondaryId |= 4;
+    GC::watch(this);
+  }
+  if (_ti != nullptr) {
+    _ti->watch();
+  }
+}
+inline void VarDecl::flat(VarDecl* vd) {
+  if (watched()) {
+    GC::newRevision();
+  }
+  _flat = vd;
+}
 
 inline TypeInst::TypeInst(const Location& loc, const Type& type, const ASTExprVec<TypeInst>& ranges,
                           Expression* domain)
     : BoxedExpression(loc, E_TI, type), _ranges(ranges), _domain(domain) {
   _flag1 = false;
   _flag2 = false;
+  _secondaryId = 0;
   rehash();
 }
 
@@ -687,6 +713,7 @@ inline TypeInst::TypeInst(const Location& loc, const Type& type, Expression* dom
     : BoxedExpression(loc, E_TI, type), _domain(domain) {
   _flag1 = false;
   _flag2 = false;
+  _secondaryId = 0;
   rehash();
 }
 
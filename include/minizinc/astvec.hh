@@ -158,11 +158,21 @@ public:
   bool flag() const { return _flag1; }
   /// Set flag
   void flag(bool f) { _flag1 = f; }
+  /// Check if second flag is set
+  bool flag2() const { return _flag2; }
+  /// Set second flag
+  void flag2(bool f) { _flag2 = f; }
+  /// Check if the vector may be shared by several owners, which have to copy it before writing
+  bool shared() const { return _flag3; }
+  /// Set whether the vector may be shared
+  void shared(bool s) { _flag3 = s; }
 };
 
 template <class T>
 ASTExprVecO<T>::ASTExprVecO(const std::vector<T>& v) : ASTVec(v.size()) {
   _flag1 = false;
+  _flag2 = false;
+  _flag3 = false;
   for (auto i = static_cast<unsigned int>(v.size()); (i--) != 0U;) {
     (*this)[i] = v[i];
   }
@@ -21,7 +21,16 @@ protected:
   ModelMap _modelMap;
 
   ASTNodeWeakMap _nodeMap;
+  /// Reverse of _nodeMap, only built when findOrig is first used
   ASTNodeWeakMap _revNodeMap;
+  bool _hasRevNodeMap = false;
+  void buildRevNodeMap();
+  ASTNode* findOrigNode(ASTNode* n) {
+    if (!_hasRevNodeMap) {
+      buildRevNodeMap();
+    }
+    return _revNodeMap.find(n);
+  }
 
 public:
   void insert(Expression* e0, Expression* e1);
@@ -43,7 +52,9 @@ public:
     assert(e0.empty() == e1.empty());
     if (!e0.empty()) {
       _nodeMap.insert(e0.vec(), e1.vec());
-      _revNodeMap.insert(e1.vec(), e0.vec());
+      if (_hasRevNodeMap) {
+        _revNodeMap.insert(e1.vec(), e0.vec());
+      }
     }
   }
   template <class T>
@@ -59,13 +70,14 @@ public:
     if (e.empty()) {
       return nullptr;
     }
-    ASTNode* n = _revNodeMap.find(e.vec());
+    ASTNode* n = findOrigNode(e.vec());
     return static_cast<ASTExprVecO<T*>*>(n);
   }
   void clear() {
     _modelMap.clear();
     _nodeMap.clear();
     _revNodeMap.clear();
+    _hasRevNodeMap = false;
   }
 };
 
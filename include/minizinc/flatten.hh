@@ -65,6 +65,8 @@ struct FlatteningOptions {
   std::unordered_set<std::string> notSections;
   /// Don't include stdlib
   bool ignoreStdlib;
+  /// Number of threads for evaluating par array comprehensions (0 = one per core)
+  unsigned int comprehensionThreads;
   /// Default constructor
   FlatteningOptions()
       : keepOutputInFzn(false),
@@ -80,7 +82,8 @@ struct FlatteningOptions {
         detailedTiming(false),
         debug(false),
         encapsulateJSON(false),
-        ignoreStdlib(false) {
+        ignoreStdlib(false),
+        comprehensionThreads(1) {
     // Initialise random number generator seed.
     // Try random_device, if that doesn't work, use time.
     std::vector<long unsigned int> seeds;
@@ -147,6 +150,10 @@ struct FlatModelStatistics {
   int n_imp_del;  // NOLINT(readability-identifier-naming)
   /// Number of linear expressions eliminated using path compression
   int n_lin_del;  // NOLINT(readability-identifier-naming)
+  /// Number of variable definitions whose bounds were found in the memo table
+  unsigned long long n_bounds_memo_hits;  // NOLINT(readability-identifier-naming)
+  /// Number of variable definitions whose bounds were computed and memoised
+  unsigned long long n_bounds_memo_misses;  // NOLINT(readability-identifier-naming)
   /// Constructor
   FlatModelStatistics()
       : n_int_vars(0),
@@ -160,7 +167,9 @@ struct FlatModelStatistics {
         n_reif_ct(0),
         n_imp_ct(0),
         n_imp_del(0),
-        n_lin_del(0) {}
+        n_lin_del(0),
+        n_bounds_memo_hits(0),
+        n_bounds_memo_misses(0) {}
 };
 
 /// Compute statistics for flat model in \a m
@@ -96,13 +96,24 @@ struct VarPathStore {
   // Mapping from arbitrary Expressions to paths
   typedef KeepAliveMap<std::string> ReversePathMap;
 
+  // Domain of a variable of a previous pass, as a VarDecl that only has the domain and fixed
+  // value, and the path of the variable it was unified with (or empty)
+  struct PathDomain {
+    KeepAlive decl;
+    std::string alias;
+  };
+  // Store mapping from path string to the domains found by previous passes
+  typedef std::unordered_map<std::string, PathDomain> DomainTable;
+
   PathMap pathMap;
   ReversePathMap reversePathMap;
+  DomainTable domainTable;
   ASTStringSet filenameSet;
 
   VarPathStore();
   PathMap& getPathMap() { return pathMap; }
   ReversePathMap& getReversePathMap() { return reversePathMap; }
+  DomainTable& getDomainTable() { return domainTable; }
   ASTStringSet& getFilenameSet() { return filenameSet; }
 };
 
@@ -384,7 +395,16 @@ public:
     int impConstraints;
     int impDel;
     int linDel;
+    unsigned long long boundsMemoHits;
+    unsigned long long boundsMemoMisses;
   } counters;
+  /// Memoised bounds of top-level variable definitions (see compute_int_bounds)
+  struct {
+    /// The GC::revision the memoised bounds are valid for
+    unsigned long long revision = 0;
+    std::unordered_map<VarDecl*, IntBounds> ints;
+    std::unordered_map<VarDecl*, FloatBounds> floats;
+  } boundsMemo;
   bool inReverseMapVar;
   FlatteningOptions fopts;
   ASTStringMap<Item*> reverseEnum;
@@ -27,6 +27,7 @@
 #include <minizinc/typecheck.hh>
 #include <minizinc/utils.hh>
 
+#include <cstdint>
 #include <ctime>
 #include <iomanip>
 #include <memory>
@@ -76,6 +77,8 @@ public:
   bool hasInputFiles() const {
     return !_filenames.empty() || _flags.stdinInput || !_flagSolutionCheckModel.empty();
   }
+  /// Hash of the model and data files and strings that were flattened
+  std::uint64_t inputHash() const;
 
   SolverInstance::Status status = SolverInstance::UNKNOWN;
 
@@ -85,6 +88,8 @@ private:
   bool _fOutputByDefault = false;  // if the class is used in mzn2fzn, write .fzn+.ozn by default
   std::vector<std::string> _filenames;
   std::vector<std::string> _datafiles;
+  /// Hash of the model string and standard input given to flatten()
+  std::uint64_t _inputTextHash = 0;
   std::vector<std::string> _includePaths;
   bool _isFlatzinc = false;
 
@@ -119,12 +124,14 @@ private:
     bool compileSolutionCheckModel = false;
     bool encapsulateJSON = false;
     bool ignoreStdlib = false;
+    bool compactLocations = false;
   } _flags;
 
   int _optMIPDmaxIntvEE = 0;
   double _optMIPDmaxDensEE = 0.0;
 
   unsigned int _flagPrePasses = 1;
+  unsigned int _flagSacThreads = 1;
 
   std::string _stdLibDir;
   std::string _globalsDir;
@@ -18,6 +18,7 @@
 #include <cstdlib>
 #include <new>
 #include <unordered_map>
+#include <vector>
 
 // #define MINIZINC_GC_STATS
 
@@ -56,6 +57,8 @@ protected:
   unsigned int _flag1 : 1;
   /// Flag
   unsigned int _flag2 : 1;
+  /// Flag
+  unsigned int _flag3 : 1;
 
   enum BaseNodes { NID_FL, NID_CHUNK, NID_VEC, NID_STR, NID_END = NID_STR };
 
@@ -128,6 +131,7 @@ class Expression;
 
 class GCMarker;
 class KeepAlive;
+class VarDecl;
 class WeakRef;
 
 class ASTNodeWeakMap;
@@ -143,12 +147,31 @@ class GC {
   friend class WeakRef;
   friend class ASTNodeWeakMap;
 
+public:
+  /// Statistics about the memory used for source locations
+  struct LocationStats {
+    /// Number of locations stored without heap allocation
+    unsigned long long compact = 0;
+    /// Number of locations stored in a heap-allocated vector
+    unsigned long long allocated = 0;
+    /// Number of locations dropped in compact mode
+    unsigned long long dropped = 0;
+    /// Heap memory saved by compact and dropped locations (in bytes)
+    unsigned long long savedBytes = 0;
+  };
+
 private:
   class Heap;
   /// The memory controlled by the collector
   Heap* _heap;
   /// Count how many locks are currently active
   unsigned int _lockCount;
+  /// Statistics about source locations
+  LocationStats _locationStats;
+  /// Revision counter for watched declarations
+  unsigned long long _revision;
+  /// Declarations and type-insts watched in the current revision
+  std::vector<Expression*> _watched;
   /// Return thread-local GC object
   static GC*& gc();
   /// Constructor
@@ -164,6 +187,9 @@ private:
   static void addNodeWeakMap(ASTNodeWeakMap* m);
   static void removeNodeWeakMap(ASTNodeWeakMap* m);
 
+  /// Stop watching all nodes and start a new revision
+  void nextRevision();
+
 public:
   /// Acquire garbage collector lock for this thread
   static void lock();
@@ -180,8 +206,9 @@ public:
 
   /// Put a mark on the trail
   static void mark();
-  /// Add a trail entry
-  static void trail(Expression** l, Expression* v);
+  /// Add a trail entry for location \a l of declaration \a owner (undoing it starts a new
+  /// revision if \a owner is watched at that time)
+  static void trail(Expression** l, Expression* v, VarDecl* owner = nullptr);
   /// Untrail to previous mark
   static void untrail();
 
@@ -191,6 +218,25 @@ public:
   /// Return maximum allocated memory (high water mark)
   static size_t maxMem();
 
+  /// Return statistics about the memory used for source locations
+  static LocationStats& locationStats();
+
+  /**
+   * \brief Return the current revision
+   *
+   * The revision changes whenever a watched VarDecl or TypeInst (see
+   * VarDecl::watch) is modified or restored from the trail, or memory is
+   * collected.
+   * Caches of information derived from watched declarations are valid as long
+   * as the revision stays the same. Nodes are only watched until the revision
+   * changes, after which the caches have to watch them again.
+   */
+  static unsigned long long revision();
+  /// Start a new revision
+  static void newRevision();
+  /// Register \a e as watched until the revision changes
+  static void watch(Expression* e);
+
 #if defined(MINIZINC_GC_STATS)
   /// Return statistics object
   static std::map<int, GCStat>& stats();
@@ -264,6 +310,9 @@ public:
   void insert(ASTNode* n0, ASTNode* n1);
   ASTNode* find(ASTNode* n);
   void clear() { _m.clear(); }
+  typedef NodeMap::const_iterator iterator;
+  iterator begin() const { return _m.begin(); }
+  iterator end() const { return _m.end(); }
 };
 
 /**
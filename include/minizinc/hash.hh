@@ -14,6 +14,8 @@
 #include <minizinc/ast.hh>
 #include <minizinc/exception.hh>
 
+#include <algorithm>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -263,6 +265,93 @@ public:
   }
 };
 
+/**
+ * \brief Map from identifiers of flat variables to \a T
+ *
+ * Identifiers are resolved to their declarations. Declarations of the flat
+ * model are numbered densely (in their payload) when the FlatZinc is
+ * finalised, so after reserve() was called with the number of items of the
+ * flat model, lookups are vector accesses. Declarations that do not carry
+ * such an index (or whose index is already taken) are kept in a hash map.
+ * References to values stay valid when further elements are inserted.
+ */
+template <class T>
+class FlatIdMap {
+protected:
+  /// The elements, in order of insertion
+  std::deque<std::pair<Id*, T>> _elems;
+  /// Declaration and element index for each payload index
+  std::vector<std::pair<VarDecl*, unsigned int>> _index;
+  /// Element index for declarations without payload index
+  std::unordered_map<VarDecl*, unsigned int> _other;
+
+  /// Return the element index of \a vd, or -1 if it is not in the map
+  long long int lookup(VarDecl* vd) const {
+    auto p = static_cast<unsigned int>(vd->payload());
+    if (p < _index.size() && _index[p].first == vd) {
+      return _index[p].second;
+    }
+    if (_other.empty()) {
+      return -1;
+    }
+    auto it = _other.find(vd);
+    return it == _other.end() ? -1 : it->second;
+  }
+
+public:
+  /// Iterator type
+  typedef typename std::deque<std::pair<Id*, T>>::iterator iterator;
+  /// Prepare for declarations with payload indices less than \a n
+  void reserve(unsigned int n) {
+    if (_index.size() < n) {
+      _index.resize(n, std::pair<VarDecl*, unsigned int>(nullptr, 0));
+    }
+  }
+  /// Insert mapping from \a e to \a t (unless \a e is already mapped)
+  void insert(Id* e, const T& t) {
+    assert(e != nullptr && e->decl() != nullptr);
+    VarDecl* vd = e->decl();
+    if (lookup(vd) != -1) {
+      return;
+    }
+    auto idx = static_cast<unsigned int>(_elems.size());
+    _elems.emplace_back(e, t);
+    auto p = static_cast<unsigned int>(vd->payload());
+    if (p < _index.size() && _index[p].first == nullptr) {
+      _index[p] = std::pair<VarDecl*, unsigned int>(vd, idx);
+    } else {
+      _other.emplace(vd, idx);
+    }
+  }
+  /// Find \a e in map
+  iterator find(Id* e) {
+    long long int idx = e->decl() == nullptr ? -1 : lookup(e->decl());
+    return idx == -1 ? _elems.end() : _elems.begin() + idx;
+  }
+  /// Begin of iterator
+  iterator begin() { return _elems.begin(); }
+  /// End of iterator
+  iterator end() { return _elems.end(); }
+  /// Return number of elements in the map
+  int size() const { return static_cast<int>(_elems.size()); }
+  /// Return whether map is empty
+  bool empty() const { return _elems.empty(); }
+  /// Remove all elements from the map
+  void clear() {
+    _elems.clear();
+    std::fill(_index.begin(), _index.end(), std::pair<VarDecl*, unsigned int>(nullptr, 0));
+    _other.clear();
+  }
+  /// Return the value for \a ident (throws InternalError if there is none)
+  T& get(Id* ident) {
+    long long int idx = ident->decl() == nullptr ? -1 : lookup(ident->decl());
+    if (idx == -1) {
+      throw InternalError("Id not found");
+    }
+    return _elems[idx].second;
+  }
+};
+
 /// Hash class for KeepAlive objects
 struct KAHash {
   size_t operator()(const Expression* e) const { return Expression::hash(e); }
@@ -0,0 +1,46 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <minizinc/ast.hh>
+#include <minizinc/values.hh>
+
+#include <vector>
+
+namespace MiniZinc {
+
+class EnvI;
+
+/// Values of a comprehension evaluated by eval_comp_parallel
+struct ParallelCompValues {
+  /// Base type of the values (BT_INT, BT_FLOAT or BT_BOOL)
+  Type::BaseType bt = Type::BT_INT;
+  /// Integer values (and Boolean values as 0/1)
+  std::vector<IntVal> ints;
+  /// Float values
+  std::vector<FloatVal> floats;
+};
+
+/**
+ * \brief Evaluate par array comprehension \a e on several threads
+ *
+ * Only comprehensions over par sets of integers whose body and where clauses
+ * are built from arithmetic, comparisons, Boolean connectives, conditionals,
+ * accesses to par arrays and a few builtins (abs, min, max, bool2int,
+ * int2float) are evaluated in parallel. Such expressions have no side
+ * effects, so the values of the outermost generator are split into chunks
+ * that are evaluated independently, without touching the environment or the
+ * garbage collected heap.
+ *
+ * Returns false if \a e has to be evaluated sequentially, either because it
+ * is not of the supported form, it is too small, or its evaluation fails
+ * (e.g. an undefined result). The sequential evaluation then reports errors
+ * as usual.
+ */
+bool eval_comp_parallel(EnvI& env, Comprehension* e, ParallelCompValues& values);
+
+}  // namespace MiniZinc
@@ -20,6 +20,8 @@ namespace MiniZinc {
 class Model;
 
 class PathFilePrinter {
+public:
+  /// Readable name and path of a variable
   typedef std::pair<std::string, std::string> NamePair;
   typedef std::unordered_map<Id*, NamePair> NameMap;
 
@@ -36,6 +38,11 @@ public:
   void print(Model* m);
   void print(Item* i);
   void json(Model* m);
+  /// Readable names and paths of the variables of \a m (as printed in the paths file)
+  const NameMap& names(Model* m) {
+    buildMap(m);
+    return _betternames;
+  }
 };
 
 }  // namespace MiniZinc
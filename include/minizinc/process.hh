@@ -19,15 +19,24 @@
 #include <tchar.h>
 #undef ERROR
 #else
+#include <fcntl.h>
+#include <pthread.h>
 #include <sys/select.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
+#include <atomic>
+#include <cerrno>
 #include <condition_variable>
 #include <csignal>
+#include <cstring>
 #include <deque>
+#include <exception>
+#include <functional>
 #include <mutex>
+#include <ostream>
+#include <streambuf>
 #include <string>
 #include <sys/types.h>
 #include <thread>
@@ -85,6 +94,242 @@ void ReadPipePrint(HANDLE g_hCh, bool* _done, std::ostream* pOs,
 }
 #endif
 
+#ifndef _WIN32
+/// Stream buffer writing to a file descriptor
+class FdOutBuf : public std::streambuf {
+protected:
+  int _fd;
+  char _buf[1 << 16];
+  /// Write the buffered characters, return false if the descriptor has been closed
+  bool writeBuffer() {
+    for (char* p = pbase(); p < pptr();) {
+      ssize_t n = ::write(_fd, p, pptr() - p);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      p += n;
+    }
+    setp(_buf, _buf + sizeof(_buf));
+    return true;
+  }
+  int_type overflow(int_type c) override {
+    if (!writeBuffer()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+  int sync() override { return writeBuffer() ? 0 : -1; }
+
+public:
+  FdOutBuf(int fd) : _fd(fd) { setp(_buf, _buf + sizeof(_buf)); }
+};
+
+/**
+ * \brief Writes the standard input of a child process on a separate thread
+ *
+ * The input is usually printed from the (garbage collected) model, so the
+ * garbage collector of the thread that starts the writer is locked until the
+ * writer has finished. If the child exits early, writing simply stops.
+ */
+class ProcessInputWriter {
+protected:
+  std::thread _thread;
+  std::atomic<bool> _done;
+  bool _locked;
+  std::exception_ptr _error;
+
+public:
+  ProcessInputWriter() : _done(false), _locked(false) {}
+  ~ProcessInputWriter() { join(); }
+  /// Start writing to \a fd using \a write, closing \a fd when finished
+  void start(int fd, const std::function<void(std::ostream&)>& write) {
+    GC::lock();
+    _locked = true;
+    _thread = std::thread([this, fd, write]() {
+      // Writing to a pipe without reader must fail with EPIPE instead of raising SIGPIPE
+      sigset_t sigpipe;
+      sigemptyset(&sigpipe);
+      sigaddset(&sigpipe, SIGPIPE);
+      pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+#ifdef F_SETNOSIGPIPE
+      fcntl(fd, F_SETNOSIGPIPE, 1);
+#endif
+      try {
+        FdOutBuf buf(fd);
+        std::ostream os(&buf);
+        write(os);
+        os.flush();
+      } catch (...) {
+        _error = std::current_exception();
+      }
+      close(fd);
+      _done = true;
+    });
+  }
+  /// Release the garbage collector if writing has finished
+  void poll() {
+    if (_locked && _done) {
+      join();
+    }
+  }
+  /// Wait until writing has finished
+  void join() {
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+    if (_locked) {
+      GC::unlock();
+      _locked = false;
+    }
+  }
+  /// Wait until writing has finished, and rethrow any exception that occurred
+  void finish() {
+    join();
+    if (_error) {
+      std::exception_ptr e = _error;
+      _error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+};
+
+/// Records SIGINT and SIGTERM while a child process is running, restoring the previous
+/// handlers on destruction
+class ProcessSignals {
+protected:
+  struct sigaction _oldInt;
+  struct sigaction _oldTerm;
+  static volatile sig_atomic_t& interruptFlag() {
+    static volatile sig_atomic_t flag = 0;
+    return flag;
+  }
+  static volatile sig_atomic_t& termFlag() {
+    static volatile sig_atomic_t flag = 0;
+    return flag;
+  }
+  static void handle(int signal) {
+    if (signal == SIGINT) {
+      interruptFlag() = 1;
+    } else {
+      termFlag() = 1;
+    }
+  }
+
+public:
+  ProcessSignals() {
+    interruptFlag() = 0;
+    termFlag() = 0;
+    struct sigaction sa;
+    sa.sa_handler = &handle;
+    sa.sa_flags = 0;
+    sigfillset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, &_oldInt);
+    sigaction(SIGTERM, &sa, &_oldTerm);
+  }
+  ~ProcessSignals() {
+    sigaction(SIGINT, &_oldInt, nullptr);
+    sigaction(SIGTERM, &_oldTerm, nullptr);
+  }
+  ProcessSignals(const ProcessSignals&) = delete;
+  ProcessSignals& operator=(const ProcessSignals&) = delete;
+  bool hadInterrupt() const { return interruptFlag() != 0; }
+  bool hadTerm() const { return termFlag() != 0; }
+};
+
+/// Send \a signal to the process group of \a pid (or only to \a pid if that fails)
+inline void kill_process(pid_t pid, int signal) {
+  if (killpg(pid, signal) == -1) {
+    kill(pid, signal);
+  }
+}
+
+/**
+ * \brief Start \a cmd in a new process group
+ *
+ * The standard input, output and error of the child are connected to pipes, whose
+ * parent ends are stored in \a fds (in that order). Returns the process id of the child.
+ */
+inline pid_t start_process(const std::vector<std::string>& cmd, int fds[3]) {
+  int pipes[3][2];
+  for (int i = 0; i < 3; ++i) {
+    if (pipe(pipes[i]) == -1) {
+      int err = errno;
+      for (int j = 0; j < i; ++j) {
+        close(pipes[j][0]);
+        close(pipes[j][1]);
+      }
+      throw Error(std::string("Failed to create pipe for solver: ") + strerror(err));
+    }
+  }
+  pid_t childPID = fork();
+  if (childPID == -1) {
+    int err = errno;
+    for (auto& p : pipes) {
+      close(p[0]);
+      close(p[1]);
+    }
+    throw Error(std::string("Failed to start solver: ") + strerror(err));
+  }
+  if (childPID != 0) {
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+    fds[0] = pipes[0][1];
+    fds[1] = pipes[1][0];
+    fds[2] = pipes[2][0];
+    return childPID;
+  }
+
+  // In the child, report errors on the standard error pipe and exit without unwinding
+  // into the parent's state
+  auto fail = [](const std::string& msg) {
+    for (size_t done = 0; done < msg.size();) {
+      ssize_t n = write(STDERR_FILENO, msg.c_str() + done, msg.size() - done);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      done += n;
+    }
+    _exit(1);
+  };
+  if (dup2(pipes[0][0], STDIN_FILENO) == -1 || dup2(pipes[1][1], STDOUT_FILENO) == -1 ||
+      dup2(pipes[2][1], STDERR_FILENO) == -1) {
+    _exit(1);
+  }
+  for (auto& p : pipes) {
+    close(p[0]);
+    close(p[1]);
+  }
+  if (setpgid(0, 0) == -1) {
+    fail("Error: Failed to set pgid of subprocess\n");
+  }
+
+  std::vector<char*> argv;
+  for (const auto& arg : cmd) {
+    argv.push_back(strdup(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  execvp(argv[0], argv.data());  // execvp only returns if an error occurs.
+  std::string msg = "Error: Error occurred when executing FZN solver with command \"";
+  for (const auto& arg : cmd) {
+    msg += arg + ' ';
+  }
+  msg += "\".\n";
+  fail(msg);
+  return -1;
+}
+#endif
+
 template <class S2O>
 class Process {
 protected:
@@ -92,6 +337,8 @@ protected:
   S2O* _pS2Out;
   int _timelimit;
   bool _sigint;
+  /// Function writing the standard input of the process (if set)
+  std::function<void(std::ostream&)> _input;
 #ifdef _WIN32
   static BOOL WINAPI handleInterrupt(DWORD fdwCtrlType) {
     switch (fdwCtrlType) {
@@ -107,23 +354,17 @@ protected:
   }
   static std::mutex _interruptMutex;
   static std::condition_variable _interruptCondition;
-#else
-  static void handleInterrupt(int signal) {
-    if (signal == SIGINT) {
-      hadInterrupt = true;
-    } else {
-      hadTerm = true;
-    }
-  }
-  static bool hadTerm;
-#endif
   static bool hadInterrupt;
+#endif
 
 public:
   Process(std::vector<std::string>& fzncmd, S2O* pso, int tl, bool si)
       : _fzncmd(fzncmd), _pS2Out(pso), _timelimit(tl), _sigint(si) {
     assert(nullptr != _pS2Out);
   }
+  /// Write the standard input of the process using \a input while it is running
+  /// (the input is left empty on Windows)
+  void input(std::function<void(std::ostream&)> input) { _input = std::move(input); }
   int run() {
 #ifdef _WIN32
     SetConsoleCtrlHandler(handleInterrupt, TRUE);
@@ -302,226 +543,169 @@ public:
     return timedOut ? 0 : exitCode;
   }
 #else
-    int pipes[3][2];
-    pipe(pipes[0]);
-    pipe(pipes[1]);
-    pipe(pipes[2]);
-
-    if (int childPID = fork()) {
-      close(pipes[0][0]);
-      close(pipes[1][1]);
-      close(pipes[2][1]);
-      close(pipes[0][1]);
-
-      fd_set fdset;
-      FD_ZERO(&fdset);  // NOLINT(readability-isolate-declaration)
-
-      struct timeval starttime;
-      gettimeofday(&starttime, nullptr);
-
-      struct timeval timeout_orig;
-      timeout_orig.tv_sec = _timelimit / 1000;
-      timeout_orig.tv_usec = (static_cast<suseconds_t>(_timelimit) % 1000) * 1000;
-      struct timeval timeout = timeout_orig;
-
-      hadInterrupt = false;
-      hadTerm = false;
-      struct sigaction sa;
-      struct sigaction old_sa_int;
-      struct sigaction old_sa_term;
-      sa.sa_handler = &handleInterrupt;
-      sa.sa_flags = 0;
-      sigfillset(&sa.sa_mask);
-      sigaction(SIGINT, &sa, &old_sa_int);
-      sigaction(SIGTERM, &sa, &old_sa_term);
-      int signal = _sigint ? SIGINT : SIGTERM;
-      bool handledInterrupt = false;
-      bool handledTerm = false;
-
-      bool done = hadTerm || hadInterrupt;
-      bool timed_out = false;
-      while (!done) {
-        FD_SET(pipes[1][0], &fdset);
-        FD_SET(pipes[2][0], &fdset);
-        int sel =
-            select(FD_SETSIZE, &fdset, nullptr, nullptr, _timelimit == 0 ? nullptr : &timeout);
-        if (sel == -1) {
-          if (errno != EINTR) {
-            // some error has happened
-            throw Error(std::string("Error in communication with solver: ") + strerror(errno));
-          }
-        }
-        bool timeoutImmediately = false;
-        if (hadInterrupt && !handledInterrupt) {
-          signal = SIGINT;
-          handledInterrupt = true;
-          timeoutImmediately = true;
+    int fds[3];
+    pid_t childPID = start_process(_fzncmd, fds);
+    ProcessInputWriter inputWriter;
+    if (_input) {
+      inputWriter.start(fds[0], _input);
+    } else {
+      close(fds[0]);
+    }
+
+    fd_set fdset;
+    FD_ZERO(&fdset);  // NOLINT(readability-isolate-declaration)
+
+    struct timeval starttime;
+    gettimeofday(&starttime, nullptr);
+
+    struct timeval timeout_orig;
+    timeout_orig.tv_sec = _timelimit / 1000;
+    timeout_orig.tv_usec = (static_cast<suseconds_t>(_timelimit) % 1000) * 1000;
+    struct timeval timeout = timeout_orig;
+
+    ProcessSignals signals;
+    int signal = _sigint ? SIGINT : SIGTERM;
+    bool handledInterrupt = false;
+    bool handledTerm = false;
+
+    bool done = signals.hadTerm() || signals.hadInterrupt();
+    bool timed_out = false;
+    while (!done) {
+      inputWriter.poll();
+      FD_SET(fds[1], &fdset);
+      FD_SET(fds[2], &fdset);
+      int sel = select(FD_SETSIZE, &fdset, nullptr, nullptr, _timelimit == 0 ? nullptr : &timeout);
+      if (sel == -1) {
+        if (errno != EINTR) {
+          // some error has happened
+          kill_process(childPID, SIGKILL);
+          throw Error(std::string("Error in communication with solver: ") + strerror(errno));
         }
-        if (hadTerm && !handledTerm) {
-          signal = SIGTERM;
-          handledTerm = true;
-          timeoutImmediately = true;
+      }
+      bool timeoutImmediately = false;
+      if (signals.hadInterrupt() && !handledInterrupt) {
+        signal = SIGINT;
+        handledInterrupt = true;
+        timeoutImmediately = true;
+      }
+      if (signals.hadTerm() && !handledTerm) {
+        signal = SIGTERM;
+        handledTerm = true;
+        timeoutImmediately = true;
+      }
+      if (timeoutImmediately) {
+        // Set timeout to immediately expire
+        _timelimit = -1;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 0;
+        timeout_orig = timeout;
+        timeval currentTime;
+        gettimeofday(&currentTime, nullptr);
+        starttime = currentTime;
+      }
+
+      bool killed = false;
+      if (_timelimit != 0) {
+        timeval currentTime;
+        gettimeofday(&currentTime, nullptr);
+        if (sel != 0) {
+          timeval elapsed;
+          elapsed.tv_sec = currentTime.tv_sec - starttime.tv_sec;
+          elapsed.tv_usec = currentTime.tv_usec - starttime.tv_usec;
+          if (elapsed.tv_usec < 0) {
+            elapsed.tv_sec--;
+            elapsed.tv_usec += 1000000;
+          }
+          // Reset timeout to original limit
+          timeout = timeout_orig;
+          // Subtract elapsed time
+          timeout.tv_usec = timeout.tv_usec - elapsed.tv_usec;
+          if (timeout.tv_usec < 0) {
+            timeout.tv_sec--;
+            timeout.tv_usec += 1000000;
+          }
+          timeout.tv_sec = timeout.tv_sec - elapsed.tv_sec;
+        } else {
+          timeout.tv_usec = 0;
+          timeout.tv_sec = 0;
         }
-        if (timeoutImmediately) {
-          // Set timeout to immediately expire
-          _timelimit = -1;
+        if (timeout.tv_sec < 0 || (timeout.tv_sec == 0 && timeout.tv_usec == 0)) {
+          timed_out = true;
+          if (signal == SIGKILL) {
+            killed = true;
+            done = true;
+          }
+          kill_process(childPID, signal);
           timeout.tv_sec = 0;
-          timeout.tv_usec = 0;
+          timeout.tv_usec = 200000;
           timeout_orig = timeout;
-          timeval currentTime;
-          gettimeofday(&currentTime, nullptr);
           starttime = currentTime;
+          // Upgrade signal for next attempt
+          signal = signal == SIGINT ? SIGTERM : SIGKILL;
         }
+      }
 
-        bool killed = false;
-        if (_timelimit != 0) {
-          timeval currentTime;
-          gettimeofday(&currentTime, nullptr);
-          if (sel != 0) {
-            timeval elapsed;
-            elapsed.tv_sec = currentTime.tv_sec - starttime.tv_sec;
-            elapsed.tv_usec = currentTime.tv_usec - starttime.tv_usec;
-            if (elapsed.tv_usec < 0) {
-              elapsed.tv_sec--;
-              elapsed.tv_usec += 1000000;
-            }
-            // Reset timeout to original limit
-            timeout = timeout_orig;
-            // Subtract elapsed time
-            timeout.tv_usec = timeout.tv_usec - elapsed.tv_usec;
-            if (timeout.tv_usec < 0) {
-              timeout.tv_sec--;
-              timeout.tv_usec += 1000000;
-            }
-            timeout.tv_sec = timeout.tv_sec - elapsed.tv_sec;
-          } else {
-            timeout.tv_usec = 0;
-            timeout.tv_sec = 0;
-          }
-          if (timeout.tv_sec < 0 || (timeout.tv_sec == 0 && timeout.tv_usec == 0)) {
-            timed_out = true;
-            if (signal == SIGKILL) {
-              killed = true;
-              done = true;
-            }
-            if (killpg(childPID, signal) == -1) {
-              // Fallback to killing the child if killing the process group fails
-              kill(childPID, signal);
-            }
-            timeout.tv_sec = 0;
-            timeout.tv_usec = 200000;
-            timeout_orig = timeout;
-            starttime = currentTime;
-            // Upgrade signal for next attempt
-            signal = signal == SIGINT ? SIGTERM : SIGKILL;
-          }
-        }
-
-        bool addedNl = false;
-        for (int i = 1; i <= 2; ++i) {
-          if (FD_ISSET(pipes[i][0], &fdset)) {
-            char buffer[1000];
-            size_t count = read(pipes[i][0], buffer, sizeof(buffer) - 1);
-            if (count > 0) {
-              buffer[count] = 0;
-              if (1 == i) {
-                //                       cerr << "mzn-fzn: raw chunk stdout:::  " << flush;
-                //                       cerr << buffer << flush;
-                try {
-                  _pS2Out->feedRawDataChunk(buffer);
-                } catch (...) {
-                  // Exception during solns2out, kill process and re-throw
-                  if (killpg(childPID, SIGKILL) == -1) {
-                    // Fallback to killing the child if killing the process group fails
-                    kill(childPID, SIGKILL);
-                  }
-                  throw;
-                }
-              } else {
-                _pS2Out->getLog() << buffer << std::flush;
+      bool addedNl = false;
+      for (int i = 1; i <= 2; ++i) {
+        if (FD_ISSET(fds[i], &fdset)) {
+          char buffer[1000];
+          size_t count = read(fds[i], buffer, sizeof(buffer) - 1);
+          if (count > 0) {
+            buffer[count] = 0;
+            if (1 == i) {
+              //                       cerr << "mzn-fzn: raw chunk stdout:::  " << flush;
+              //                       cerr << buffer << flush;
+              try {
+                _pS2Out->feedRawDataChunk(buffer);
+              } catch (...) {
+                // Exception during solns2out, kill process and re-throw
+                kill_process(childPID, SIGKILL);
+                throw;
               }
-            } else if (1 == i) {
-              _pS2Out->feedRawDataChunk("\n");  // in case last chunk did not end with \n
-              addedNl = true;
-              done = true;
+            } else {
+              _pS2Out->getLog() << buffer << std::flush;
             }
+          } else if (1 == i) {
+            _pS2Out->feedRawDataChunk("\n");  // in case last chunk did not end with \n
+            addedNl = true;
+            done = true;
           }
         }
-        if (killed && !addedNl) {
-          _pS2Out->feedRawDataChunk("\n");  // in case last chunk did not end with \n
-        }
       }
-
-      close(pipes[1][0]);
-      close(pipes[2][0]);
-      int exitStatus = timed_out ? 0 : 1;
-      int childStatus;
-      int pidStatus = waitpid(childPID, &childStatus, 0);
-      if (!timed_out && pidStatus > 0) {
-        if (WIFEXITED(childStatus)) {
-          exitStatus = WEXITSTATUS(childStatus);
-        }
-      }
-      sigaction(SIGINT, &old_sa_int, nullptr);
-      sigaction(SIGTERM, &old_sa_term, nullptr);
-      if (hadInterrupt) {
-        throw SignalRaised(SIGINT);
-      }
-      if (hadTerm) {
-        throw SignalRaised(SIGTERM);
+      if (killed && !addedNl) {
+        _pS2Out->feedRawDataChunk("\n");  // in case last chunk did not end with \n
       }
-      return exitStatus;
     }
-    if (setpgid(0, 0) == -1) {
-      throw Error("Failed to set pgid of subprocess");
-    }
-    close(STDOUT_FILENO);
-    close(STDERR_FILENO);
-    close(STDIN_FILENO);
-    dup2(pipes[0][0], STDIN_FILENO);
-    dup2(pipes[1][1], STDOUT_FILENO);
-    dup2(pipes[2][1], STDERR_FILENO);
-    close(pipes[0][0]);
-    close(pipes[0][1]);
-    close(pipes[1][1]);
-    close(pipes[1][0]);
-    close(pipes[2][1]);
-    close(pipes[2][0]);
 
-    std::vector<char*> cmd_line;
-    for (auto& iCmdl : _fzncmd) {
-      cmd_line.push_back(strdup(iCmdl.c_str()));
+    close(fds[1]);
+    close(fds[2]);
+    int exitStatus = timed_out ? 0 : 1;
+    int childStatus;
+    int pidStatus = waitpid(childPID, &childStatus, 0);
+    if (!timed_out && pidStatus > 0) {
+      if (WIFEXITED(childStatus)) {
+        exitStatus = WEXITSTATUS(childStatus);
+      }
     }
-
-    char** argv = new char*[cmd_line.size() + 1];
-    for (unsigned int i = 0; i < cmd_line.size(); i++) {
-      argv[i] = cmd_line[i];
+    inputWriter.finish();
+    if (signals.hadInterrupt()) {
+      throw SignalRaised(SIGINT);
     }
-    argv[cmd_line.size()] = nullptr;
-
-    int status = execvp(argv[0], argv);  // execvp only returns if an error occurs.
-    assert(status == -1);                // the returned value will always be -1
-    std::stringstream ssm;
-    ssm << "Error occurred when executing FZN solver with command \"";
-    for (auto& s : cmd_line) {
-      ssm << s << ' ';
+    if (signals.hadTerm()) {
+      throw SignalRaised(SIGTERM);
     }
-    ssm << "\".";
-    throw Error(ssm.str());
+    return exitStatus;
   }
 #endif
 };
 
+#ifdef _WIN32
 template <class S2O>
 bool Process<S2O>::hadInterrupt;
-#ifdef _WIN32
 template <class S2O>
 std::mutex Process<S2O>::_interruptMutex;
 template <class S2O>
 std::condition_variable Process<S2O>::_interruptCondition;
-#else
-template <class S2O>
-bool Process<S2O>::hadTerm;
 #endif
 
 }  // namespace MiniZinc
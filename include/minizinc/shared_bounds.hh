@@ -0,0 +1,85 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace MiniZinc {
+
+/// Incumbent and objective bound board shared between cooperating solvers.
+///
+/// The board lives in a small memory-mapped file, so that solvers running in
+/// different processes on the same machine can publish the objective value of
+/// the solutions they find and read the best value found by any of them.
+/// All updates are lock-free and monotone: the incumbent only ever improves,
+/// and the bound only ever tightens.
+///
+/// Every process using the board holds a shared lock on the file. A process
+/// that finds no other users resets the board and gives it a new run id, so
+/// values left over from earlier runs are never used. The board records a
+/// hash of the model it is used for, and processes solving a different model
+/// (or with the opposite objective sense) are rejected while it is in use.
+class SharedBounds {
+public:
+  struct Board;
+
+private:
+  std::string _filename;
+  bool _minimize;
+  std::uint64_t _model;
+  std::uint64_t _run = 0;
+  int _fd = -1;
+  Board* _board = nullptr;
+
+  /// Unmap and close the board
+  void release();
+
+public:
+  struct Statistics {
+    /// Number of incumbents published by this process
+    std::atomic<unsigned long long> published{0};
+    /// Number of published incumbents that improved the board
+    std::atomic<unsigned long long> improved{0};
+    /// Number of times an incumbent of another solver was used for pruning
+    std::atomic<unsigned long long> imported{0};
+  } stats;
+
+  /// Open (and create if necessary) board \a filename for a problem with the given direction,
+  /// identified by the hash \a model. Throws an Error if the file is not a board, cannot be
+  /// mapped, or is in use for a different model or the opposite direction.
+  SharedBounds(const std::string& filename, bool minimize, std::uint64_t model = 0);
+  ~SharedBounds();
+  SharedBounds(const SharedBounds&) = delete;
+  SharedBounds& operator=(const SharedBounds&) = delete;
+
+  /// Publish the objective value of a new solution. Returns whether the board improved.
+  bool publishIncumbent(double obj);
+  /// Publish a proven bound on the objective. Returns whether the board was tightened.
+  bool publishBound(double bound);
+
+  /// Get the best incumbent known to any solver; returns false if there is none
+  bool incumbent(double& obj) const;
+  /// Get the tightest proven bound known to any solver; returns false if there is none
+  bool bound(double& b) const;
+
+  /// Whether \a obj is strictly better than \a other for this board's direction
+  bool better(double obj, double other) const { return _minimize ? obj < other : obj > other; }
+  bool minimize() const { return _minimize; }
+  const std::string& filename() const { return _filename; }
+  /// Random id given to the board when it was last reset
+  std::uint64_t run() const { return _run; }
+
+  /// FNV-1a hash of \a data, continuing from hash \a h (used to identify models)
+  static std::uint64_t hash(const std::string& data, std::uint64_t h = 0xcbf29ce484222325ULL);
+
+  /// Environment variable used to pass the board file to external solvers
+  static const char* envVar() { return "MZN_SHARED_BOUNDS"; }
+};
+
+}  // namespace MiniZinc
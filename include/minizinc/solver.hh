@@ -156,6 +156,20 @@ private:
   bool _flagIntermediate = false;
   bool _supportsJSONStream = false;
 
+  /// Solvers given to --portfolio (the first one is selected as the main solver)
+  std::vector<std::string> _portfolioSolvers;
+  struct PortfolioMember {
+    SolverInstanceBase::Options* opt;
+    bool supportsA;
+    bool supportsI;
+  };
+  /// Options of the additional portfolio members (owned by _siOpt)
+  std::vector<PortfolioMember> _portfolio;
+  /// Incumbent/bound board shared with cooperating solvers
+  std::string _sharedBoundsFile;
+  /// Warm start cache of the final incumbent
+  std::string _warmStartCacheFile;
+
 public:
   Solns2Out s2out;
 
@@ -201,6 +215,11 @@ private:
   bool ifSolns2out() const;
   void addSolverInterface();
   void addSolverInterface(SolverFactory* sf);
+  /// Set up additional portfolio member \a solver, which must be compatible with \a lead
+  OptionStatus addPortfolioMember(const std::string& solver, const SolverConfig& lead);
+  /// Pass option to the selected solver factory (and to all portfolio members)
+  bool processSolverOption(int& i, std::vector<std::string>& argv,
+                           const std::string& workingDir = std::string());
   SolverInstance::Status solve();
 
   SolverInstance::Status getFltStatus() const { return _flt.status; }
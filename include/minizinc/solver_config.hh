@@ -87,6 +87,8 @@ protected:
   bool _needsStdlibDir = false;
   /// Whether solver needs path to symbol table (paths file) (passed as --paths)
   bool _needsPathsFile = false;
+  /// Whether solver can read the FlatZinc from its standard input (passed as /dev/stdin)
+  bool _supportsFznPipe = false;
   /// Supported standard command line flags
   std::vector<std::string> _stdFlags = {};
   /// The flags (or arguments) always passed to the solver
@@ -198,6 +200,11 @@ public:
   /// Set whether solver needs path to symbol table (paths file)
   void needsPathsFile(bool b) { _needsPathsFile = b; }
 
+  /// Whether solver can read the FlatZinc from its standard input (passed as /dev/stdin)
+  bool supportsFznPipe() const { return _supportsFznPipe; }
+  /// Set whether solver can read the FlatZinc from its standard input
+  void supportsFznPipe(bool b) { _supportsFznPipe = b; }
+
   /// Return short description
   std::string description() const { return _description; }
   /// Set short description
@@ -19,7 +19,9 @@
 #include <minizinc/solver_instance_defs.hh>
 #include <minizinc/statistics.hh>
 
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include <vector>
 
 namespace MiniZinc {
@@ -38,6 +40,14 @@ public:
   public:
     bool verbose = false;
     bool printStatistics = false;
+    /// File used to share incumbents and bounds with cooperating solvers (see SharedBounds)
+    std::string sharedBoundsFile;
+    /// Hash of the model and data, used to check that the shared bounds belong to this model
+    std::uint64_t sharedBoundsModel = 0;
+    /// File storing the final incumbent, used as a warm start by the next run (if supported)
+    std::string warmStartCacheFile;
+    /// Number of threads separating cuts in MIP solvers (0 for one per hardware thread)
+    unsigned int cutThreads = 1;
   };
 
 protected:
@@ -129,6 +139,24 @@ protected:
   std::vector<VarDecl*>
       _varsWithOutput;  // this is to extract fzn vars. Identical to output()?  TODO
 
+  /// Entry of the plan for extracting solutions
+  struct OutputPlanEntry {
+    /// Declaration in the flat model
+    VarDecl* vd;
+    /// Corresponding declaration in the output model
+    VarDecl* outputDecl;
+    /// Array that receives the solution values (only for output arrays)
+    KeepAlive values;
+    /// Positions of the variables in \a values, and their identifiers
+    std::vector<std::pair<unsigned int, Id*>> vars;
+  };
+  /// Plan for extracting solutions, built from _varsWithOutput for the first solution
+  std::vector<OutputPlanEntry> _outputPlan;
+  /// Whether _outputPlan has been built
+  bool _outputPlanReady = false;
+  /// Build _outputPlan
+  void buildOutputPlan();
+
 public:
   SolverInstanceBase2(Env& env, std::ostream& log, SolverInstanceBase::Options* opt)
       : SolverInstanceBase(env, log, opt) {}
@@ -145,6 +173,8 @@ public:
   void add(ASTString name, poster p);
   void add(const std::string& name, poster p);
   void post(Call* c);
+  /// Return the poster for constraints named \a name (throws InternalError if there is none)
+  poster lookup(ASTString name);
   void cleanup() { _registry.clear(); }
 };
 
@@ -157,12 +187,15 @@ public:
   typedef typename Solver::Variable VarId;
 
 protected:
-  IdMap<VarId> _variableMap;  // this to find solver's variables given an Id
+  FlatIdMap<VarId> _variableMap;  // this to find solver's variables given an Id
   Registry _constraintRegistry;
 
 public:
   SolverInstanceImpl(Env& env, std::ostream& log, SolverInstanceBase::Options* opt)
-      : SolverInstanceBase2(env, log, opt), _constraintRegistry(*this) {}
+      : SolverInstanceBase2(env, log, opt), _constraintRegistry(*this) {
+    // Declarations of the flat model are numbered by oldflatzinc
+    _variableMap.reserve(static_cast<unsigned int>(env.flat()->size()));
+  }
 };
 
 }  // namespace MiniZinc
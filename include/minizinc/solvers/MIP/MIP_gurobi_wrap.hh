@@ -268,6 +268,7 @@ public:
   int getFreeSearch() override;
   bool addSearch(const std::vector<VarId>& vars, const std::vector<int>& pri) override;
   bool addWarmStart(const std::vector<VarId>& vars, const std::vector<double>& vals) override;
+  bool setObjCutoff(double cutoff) override;
   bool defineMultipleObjectives(const MultipleObjectives& mo) override;
 
   int nRows = 0;  // to count rows in order tp notice lazy constraints
@@ -11,10 +11,19 @@
 
 #pragma once
 
+#include <minizinc/algorithms/min_cut.h>
 #include <minizinc/flattener.hh>
+#include <minizinc/shared_bounds.hh>
 #include <minizinc/solver.hh>
 #include <minizinc/solvers/MIP/MIP_wrap.hh>
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 namespace MiniZinc {
 
 // can be redefined as compilation parameter
@@ -28,16 +37,70 @@ public:
   typedef MiniZinc::Statistics Statistics;
 };
 
+/// Pool of the cuts found by one cut generator, without duplicates
+class CutPool {
+public:
+  /// Add \a cut (sorted by variable) unless the pool contains it, return whether it was added
+  bool add(MIPWrapper::CutDef cut);
+  /// Add the pool cuts violated by more than \a minViol in \a slvOut to \a cutsIn,
+  /// return how many were added
+  size_t separate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn, double minViol);
+  /// Number of cuts in the pool
+  size_t size() const { return _cuts.size(); }
+
+protected:
+  /// The cuts
+  std::vector<MIPWrapper::CutDef> _cuts;
+  /// Positions of the cuts by hash value
+  std::unordered_multimap<size_t, size_t> _index;
+  /// Variables occurring in the cuts
+  std::vector<int> _vars;
+  /// Fingerprint of the values of _vars in the last call to separate()
+  size_t _lastFingerprint = 0;
+  /// Pool size in the last call to separate()
+  size_t _lastSize = 0;
+  /// Positions of the cuts found violated in the last call to separate()
+  std::vector<size_t> _lastViolated;
+  /// Hash value of \a cut
+  static size_t hash(const MIPWrapper::CutDef& cut);
+  /// Fingerprint of the values of _vars in \a slvOut
+  size_t fingerprint(const MIPWrapper::Output& slvOut) const;
+};
+
 /// Generic cut generator
 /// Callback should be able to produce previously generated cuts again if needed [Gurobi]
 class CutGen {
 public:
+  /// Statistics
+  struct Stats {
+    /// Number of calls to separate()
+    unsigned long long calls = 0;
+    /// Number of cuts found by generate()
+    unsigned long long found = 0;
+    /// Number of violated cuts taken from the pool
+    unsigned long long reused = 0;
+    /// Time spent in separate() (seconds)
+    double time = 0.0;
+  };
+  Stats stats;
+  /// Cuts found so far
+  CutPool pool;
+
   virtual ~CutGen() {}
   /// Say what type of cuts
   virtual int getMask() = 0;
+  /// Minimal violation of a cut to be added
+  virtual double getMinViol() { return 0.0001; }
   /// Adds new cuts to the 2nd parameter
   virtual void generate(const MIPWrapper::Output&, MIPWrapper::CutInput&) = 0;
+  /// Adds the violated cuts from the pool to the 2nd parameter, or if there are none,
+  /// generates new ones and stores them in the pool
+  void separate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn);
   virtual void print(std::ostream& /*os*/) {}
+
+protected:
+  /// Protects pool and stats against concurrent callbacks
+  std::mutex _mutex;
 };
 
 /// XBZ cut generator
@@ -50,28 +113,85 @@ public:
   std::vector<MIPWrapper::VarId> varX, varB;
   /// Say what type of cuts
   int getMask() override { return MIPWrapper::MaskConsType_Usercut; }
+  double getMinViol() override { return 0.01; }
   MIPWrapper::VarId varZ;
   void generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn) override;
   void print(std::ostream& os) override;
 };
 
 /// SEC cut generator for circuit
+///
+/// The support graph of the solution is split into connected components. Each
+/// component of a disconnected graph yields a cut, and all cuts lighter than 2
+/// within each component carrying fractional flow are separated. With several
+/// threads, the components are distributed over helper threads that are started
+/// on first use and kept until the generator is destroyed.
 class SECCutGen : public CutGen {
   SECCutGen() {}
   MIPWrapper* _pMIP = nullptr;
 
 public:
   SECCutGen(MIPWrapper* pw) : _pMIP(pw) {}
+  ~SECCutGen() override;
   /// Say what type of cuts
   int getMask() override {
     return MIPWrapper::MaskConsType_Lazy | MIPWrapper::MaskConsType_Usercut;
   }
   std::vector<MIPWrapper::VarId> varXij;
   int nN = 0;  // N nodes
+  /// Number of threads for min cut separation, 0 for one per hardware thread
+  unsigned int nThreads = 1;
   /// returns error message if fails
   std::string validate() const;
   void generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn) override;
   void print(std::ostream& os) override;
+
+protected:
+  /// Min cut problems of the components, kept between calls
+  std::vector<Algorithms::MinCut> _minCuts;
+  /// Components whose min cut problems are solved in the current call
+  std::vector<int> _jobs;
+  /// Index of the next job to be taken by a thread
+  std::atomic<size_t> _nextJob{0};
+  /// Helper threads, kept between calls
+  std::vector<std::thread> _workers;
+  /// Protects the fields below, which coordinate the helper threads
+  std::mutex _workMutex;
+  std::condition_variable _workStart;
+  std::condition_variable _workDone;
+  /// Number of the current batch of jobs
+  unsigned long long _batch = 0;
+  /// Number of helper threads still working on the current batch
+  unsigned int _busy = 0;
+  /// Whether the helper threads should exit
+  bool _stop = false;
+  /// First error thrown while solving the current batch
+  std::exception_ptr _error;
+  /// Solve the min cut problems of _jobs using up to nThreads threads
+  void solveMinCuts();
+  /// Solve jobs of the current batch until none are left
+  void runJobs();
+  /// Main loop of a helper thread, started while \a batch is the current batch
+  void work(unsigned long long batch);
+  /// Cut sum(i in S, j not in S) x[i, j] >= 1 for the nodes S with inS[i]
+  MIPWrapper::CutDef secCut(const std::vector<bool>& inS) const;
+};
+
+/// Final incumbent saved to a file, used to warm start the next solve of a similar model
+///
+/// The file contains one line "key<TAB>value" per variable. Variables are identified
+/// by keys that do not depend on the numbering of introduced variables: the element of
+/// an output array (such as "x[3]"), the name of a variable declared in the model, or
+/// the path of the variable if the FlatZinc keeps paths (--keep-paths).
+class WarmStartCache {
+public:
+  /// Keys of the variables of \a flat, variables without a key are omitted
+  static std::unordered_map<VarDecl*, std::string> keys(EnvI& env, Model* flat);
+  /// Read the values from \a filename, return false if it cannot be opened
+  static bool read(const std::string& filename, std::unordered_map<std::string, double>& values);
+  /// Replace the contents of \a filename by \a values
+  static void write(const std::string& filename,
+                    const std::vector<std::pair<std::string, double> >& values);
 };
 
 template <class MIPWrapper>
@@ -82,6 +202,8 @@ protected:
   const std::unique_ptr<MIPWrapper> _mipWrapper;
   std::vector<std::unique_ptr<CutGen> > _cutGenerators;
   SolveI::SolveType _solveType = SolveI::SolveType::ST_SAT;
+  /// Keys and columns of the variables saved to the warm start cache
+  std::vector<std::pair<std::string, VarId> > _warmStartCacheVars;
 
 public:
   void registerCutGenerator(std::unique_ptr<CutGen>&& pCG) {
@@ -91,6 +213,10 @@ public:
 
   double lastIncumbent;
   double dObjVarLB = -1e300, dObjVarUB = 1e300;
+  /// Incumbents and bounds shared with cooperating solvers (if enabled)
+  std::unique_ptr<SharedBounds> sharedBounds;
+  /// Publish the objective bound \a bound to the shared bounds unless it is infinite
+  void publishSharedBound(double bound);
 
   MIPSolverinstance(Env& env, std::ostream& log, typename MIPWrapper::FactoryOptions& factoryOpt,
                     typename MIPWrapper::Options* opt)
@@ -108,6 +234,10 @@ public:
   virtual void processWarmstartAnnotations(const Annotation& ann);
   virtual void processSearchAnnotations(const Annotation& ann);
   virtual void processMultipleObjectives(const Annotation& ann);
+  /// Warm start from the cache file (if any), and remember the keys of the variables
+  virtual void processWarmStartCache();
+  /// Save the incumbent to the cache file
+  virtual void saveWarmStartCache();
   Status solve() override;
   void resetSolver() override {}
 
@@ -148,7 +278,7 @@ public:
   std::string getDescription(SolverInstanceBase::Options* opt = nullptr) override;
   std::string getVersion(SolverInstanceBase::Options* opt = nullptr) override;
   std::string getId() override;
-  void printHelp(std::ostream& os) override { MIPWrapper::Options::printHelp(os); }
+  void printHelp(std::ostream& os) override;
 
 private:
   typename MIPWrapper::FactoryOptions _factoryOptions;
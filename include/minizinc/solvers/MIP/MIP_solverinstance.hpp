@@ -28,6 +28,14 @@ bool MIPSolverFactory<MIPWrapper>::processFactoryOption(int& i, std::vector<std:
   return _factoryOptions.processOption(i, argv, workingDir);
 }
 
+template <class MIPWrapper>
+void MIPSolverFactory<MIPWrapper>::printHelp(std::ostream& os) {
+  MIPWrapper::Options::printHelp(os);
+  os << "  --cut-threads <n>\n    number of threads separating subtour elimination cuts for"
+        " circuit, 0 for one per core (default 1)"
+     << std::endl;
+}
+
 template <class MIPWrapper>
 void MIPSolverFactory<MIPWrapper>::finaliseSolverConfigs(SolverConfigs& solver_configs) {
   // Finalise solver config (needs DLLs)
@@ -54,6 +62,14 @@ bool MIPSolverFactory<MIPWrapper>::processOption(SolverInstanceBase::Options* op
     options.printStatistics = true;
     return true;
   }
+  int nThreads;
+  if (cop.get("--cut-threads", &nThreads)) {
+    if (nThreads < 0) {
+      return false;
+    }
+    options.cutThreads = static_cast<unsigned int>(nThreads);
+    return true;
+  }
   if (options.processOption(i, argv, workingDir)) {
     return true;
   }
@@ -279,6 +295,53 @@ void MIPSolverinstance<MIPWrapper>::processWarmstartAnnotations(const Annotation
   }
 }
 
+template <class MIPWrapper>
+void MIPSolverinstance<MIPWrapper>::processWarmStartCache() {
+  auto keys = WarmStartCache::keys(_env.envi(), getEnv()->flat());
+  _warmStartCacheVars.reserve(keys.size());
+  for (auto& vdi : getEnv()->flat()->vardecls()) {
+    auto it = keys.find(vdi.e());
+    if (it != keys.end()) {
+      _warmStartCacheVars.emplace_back(it->second, exprToVar(vdi.e()->id()));
+    }
+  }
+  std::unordered_map<std::string, double> values;
+  if (!WarmStartCache::read(_options->warmStartCacheFile, values)) {
+    return;  // First run
+  }
+  std::vector<double> coefs;
+  std::vector<MIPSolverinstance::VarId> vars;
+  for (const auto& kv : _warmStartCacheVars) {
+    auto it = values.find(kv.first);
+    if (it != values.end()) {
+      vars.push_back(kv.second);
+      coefs.push_back(it->second);
+    }
+  }
+  if (!coefs.empty() && !getMIPWrapper()->addWarmStart(vars, coefs)) {
+    std::cerr << "\nWARNING: MIP backend seems to ignore warm starts" << std::endl;
+    return;
+  }
+  if (getMIPWrapper()->fVerbose) {
+    std::cerr << "  MIP: added " << coefs.size() << " MIPstart values from the warm start cache ("
+              << _warmStartCacheVars.size() << " variables with keys)" << std::endl;
+  }
+}
+
+template <class MIPWrapper>
+void MIPSolverinstance<MIPWrapper>::saveWarmStartCache() {
+  const double* x = getMIPWrapper()->getValues();
+  if (x == nullptr) {
+    return;
+  }
+  std::vector<std::pair<std::string, double> > values;
+  values.reserve(_warmStartCacheVars.size());
+  for (const auto& kv : _warmStartCacheVars) {
+    values.emplace_back(kv.first, x[kv.second]);
+  }
+  WarmStartCache::write(_options->warmStartCacheFile, values);
+}
+
 template <class MIPWrapper>
 void MIPSolverinstance<MIPWrapper>::processMultipleObjectives(const Annotation& ann) {
   MultipleObjectives mo;
@@ -463,6 +526,10 @@ void MIPSolverinstance<MIPWrapper>::processFlatZinc() {
 
   processWarmstartAnnotations(solveItem->ann());
 
+  if (!_options->warmStartCacheFile.empty()) {
+    processWarmStartCache();
+  }
+
   processMultipleObjectives(solveItem->ann());
 }  // processFlatZinc
 
@@ -479,7 +546,7 @@ Expression* MIPSolverinstance<MIPWrapper>::getSolutionValue(Id* id) {
       case Type::BT_FLOAT:
         return FloatLit::a(val);
       case Type::BT_BOOL:
-        return new BoolLit(Location(), round_to_longlong(val) != 0);
+        return Constants::constants().boollit(round_to_longlong(val) != 0);
       default:
         return nullptr;
     }
@@ -493,7 +560,7 @@ void MIPSolverinstance<MIPWrapper>::genCuts(const typename MIPWrapper::Output& s
                                             typename MIPWrapper::CutInput& cutsIn, bool fMIPSol) {
   for (auto& pCG : _cutGenerators) {
     if (!fMIPSol || ((pCG->getMask() & MIPWrapper::MaskConsType_Lazy) != 0)) {
-      pCG->generate(slvOut, cutsIn);
+      pCG->separate(slvOut, cutsIn);
     }
   }
   /// Select some most violated? TODO
@@ -548,6 +615,32 @@ void MIPSolverinstance<MIPWrapper>::printStatistics() {
     };
     ss.precision(4, true);
     ss.add("solveTime", _mipWrapper->getCPUTime());
+    if (sharedBounds) {
+      ss.add("sharedBoundsPublished", sharedBounds->stats.published.load());
+      ss.add("sharedBoundsImproved", sharedBounds->stats.improved.load());
+      ss.add("sharedBoundsImported", sharedBounds->stats.imported.load());
+    }
+    if (!_cutGenerators.empty()) {
+      CutGen::Stats cutStats;
+      for (const auto& pCG : _cutGenerators) {
+        cutStats.calls += pCG->stats.calls;
+        cutStats.found += pCG->stats.found;
+        cutStats.reused += pCG->stats.reused;
+        cutStats.time += pCG->stats.time;
+      }
+      ss.add("cutCalls", cutStats.calls);
+      ss.add("cutsFound", cutStats.found);
+      ss.add("cutsReused", cutStats.reused);
+      ss.add("cutTime", cutStats.time);
+    }
+  }
+}
+
+template <class MIPWrapper>
+void MIPSolverinstance<MIPWrapper>::publishSharedBound(double bound) {
+  // Solvers report a missing bound as NaN or as a value beyond their infinity
+  if (std::isfinite(bound) && std::fabs(bound) < _mipWrapper->getInfBound()) {
+    sharedBounds->publishBound(bound);
   }
 }
 
@@ -559,6 +652,10 @@ void handle_solution_callback(const typename MIPWrapper::Output& out, void* pp)
   /// Not for -a:
   //   if (fabs(pSI->lastIncumbent - out.objVal) > 1e-12*(1.0 + fabs(out.objVal))) {
   pSI->lastIncumbent = out.objVal;
+  if (pSI->sharedBounds) {
+    pSI->sharedBounds->publishIncumbent(out.objVal);
+    pSI->publishSharedBound(out.bestBound);
+  }
 
   try {                    /// Sometimes the intermediate output is wrong, especially in SCIP
     pSI->printSolution();  // The solution in [out] is not used  TODO
@@ -624,6 +721,20 @@ SolverInstance::Status MIPSolverinstance<MIPWrapper>::solve() {
   if (SolverInstance::UNSAT == _status) {  // already deduced - exit now
     return _status;
   }
+  if (!_options->sharedBoundsFile.empty() && 0 != nProbType) {
+    sharedBounds.reset(new SharedBounds(_options->sharedBoundsFile, nProbType < 0,
+                                        _options->sharedBoundsModel));
+    double incumbent;
+    if (sharedBounds->incumbent(incumbent) && getMIPWrapper()->setObjCutoff(incumbent)) {
+      // Solutions no better than another solver's incumbent are not interesting.
+      // If none are left, the wrapper reports UNKNOWN rather than UNSAT.
+      ++sharedBounds->stats.imported;
+      if (_mipWrapper->fVerbose) {
+        std::cerr << "    MIPSolverinstance: objective cutoff " << incumbent
+                  << " from shared bounds." << std::endl;
+      }
+    }
+  }
   if (getMIPWrapper()->getNCols()) {  // If any variables, we need to run solver just to get values?
     getMIPWrapper()->provideSolutionCallback(handle_solution_callback<MIPWrapper>, this);
     if (!_cutGenerators.empty()) {  // only then, can modify presolve
@@ -678,6 +789,18 @@ SolverInstance::Status MIPSolverinstance<MIPWrapper>::solve() {
     default:
       s = SolverInstance::ERROR;
   }
+  if (!_options->warmStartCacheFile.empty() &&
+      (SolverInstance::SAT == s || SolverInstance::OPT == s)) {
+    saveWarmStartCache();
+  }
+  if (sharedBounds) {
+    // The bound is only meaningful if the search ended with a solution
+    if (SolverInstance::SAT == s || SolverInstance::OPT == s) {
+      sharedBounds->publishIncumbent(_mipWrapper->getObjValue());
+      publishSharedBound(SolverInstance::OPT == s ? _mipWrapper->getObjValue()
+                                                  : _mipWrapper->getBestBound());
+    }
+  }
   _pS2Out->stats.nNodes = _mipWrapper->getNNodes();
   return s;
 }
@@ -1058,6 +1181,7 @@ void p_sec_cutgen(SolverInstanceBase& si, const Call* call) {
   auto& gi = dynamic_cast<MIPSolverinstance<MIPWrapper>&>(si);
 
   std::unique_ptr<SECCutGen> pCG(new SECCutGen(gi.getMIPWrapper()));
+  pCG->nThreads = gi.options()->cutThreads;
 
   assert(call->argCount() == 1);
   gi.exprToVarArray(call->arg(0), pCG->varXij);  // WHAT ABOUT CONSTANTS?
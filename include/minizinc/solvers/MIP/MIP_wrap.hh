@@ -307,6 +307,8 @@ public:
   virtual bool addWarmStart(const std::vector<VarId>& vars, const std::vector<double>& vals) {
     return false;
   }
+  /// Discard solutions with an objective worse than \a cutoff. Returns false if not supported
+  virtual bool setObjCutoff(double cutoff) { return false; }
 
   using MultipleObjectives = MiniZinc::MultipleObjectivesTemplate<VarId>;
   virtual bool defineMultipleObjectives(const MultipleObjectives& mo) { return false; }
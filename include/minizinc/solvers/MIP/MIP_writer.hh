@@ -0,0 +1,84 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Streaming writer of LP and (free) MPS model files, independent of any solver library.
+///
+/// Rows are passed on as they are added to the MIPWrapper and spooled to temporary files next to
+/// the output, the columns are read from the MIPWrapper column vectors when the file is finished.
+/// The LP format is row-major and the spooled constraints are copied verbatim. The COLUMNS
+/// section of MPS files is column-major, it is produced by reading the spooled nonzeros once for
+/// every range of columns that fits into a buffer of at most \a chunkSize nonzeros.
+/// In either case the model is never held in memory a second time.
+class MIPModelWriter {
+public:
+  enum Format { LP, MPS };
+
+  /// Format given by the extension of \a filename: .mps for MPS, LP otherwise
+  static Format formatOf(const std::string& filename);
+
+  /// Write the model of \a mip, which is only read for the column names until finish()
+  MIPModelWriter(const MIPWrapper& mip, std::string filename, Format format,
+                 size_t chunkSize = 1 << 20);
+  ~MIPModelWriter();
+
+  /// Add a linear constraint
+  void addRow(int nnz, const int* rmatind, const double* rmatval, MIPWrapper::LinConType sense,
+              double rhs);
+  /// Add an indicator constraint: x[iBVar]==bVal -> lin constr
+  void addIndicatorConstraint(int iBVar, int bVal, int nnz, const int* rmatind,
+                              const double* rmatval, MIPWrapper::LinConType sense, double rhs);
+  /// Write the model file with objective sense \a objSense (+/-1 for max/min, 0 for none)
+  void finish(int objSense);
+
+  int getNRows() const { return _nRows; }
+
+protected:
+  const MIPWrapper& _mip;
+  std::string _filename;
+  Format _format;
+  size_t _chunkSize;
+  /// LP: the constraints. MPS: the ROWS and RHS entries
+  std::string _rowsFile;
+  std::ofstream _rows;
+  std::string _rhsFile;
+  std::ofstream _rhs;
+  /// MPS: the nonzeros (column, row, value) in row order
+  std::string _nzFile;
+  std::ofstream _nz;
+  /// MPS: number of nonzeros of each column
+  std::vector<size_t> _colNnz;
+  /// MPS: indicator constraints (row, variable, value)
+  std::vector<std::array<int, 3> > _indicators;
+  int _nRows = 0;
+  bool _finished = false;
+
+  struct Nonzero {
+    int col;
+    int row;
+    double val;
+  };
+
+  /// Spool a row, with indicator x[iBVar]==bVal if iBVar >= 0
+  void spoolRow(int nnz, const int* rmatind, const double* rmatval, MIPWrapper::LinConType sense,
+                double rhs, int iBVar, int bVal);
+  /// Name of column \a j, the MIPWrapper name if it is a valid LP/MPS name
+  std::string colName(int j) const;
+  void writeLP(std::ostream& os, int objSense);
+  void writeMPS(std::ostream& os, int objSense);
+  void writeColumns(std::ostream& os);
+  /// Close and remove the temporary files
+  void cleanup();
+};
@@ -0,0 +1,102 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <minizinc/solver_config.hh>
+#include <minizinc/solver_instance_base.hh>
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+#include <minizinc/solvers/MIP/MIP_writer.hh>
+
+#include <memory>
+#include <unordered_map>
+
+/// A MIP "solver" that writes the model to an LP or MPS file using MIPModelWriter,
+/// so that it can be solved elsewhere. Needs no solver library.
+class MIPWriterWrapper : public MIPWrapper {
+public:
+  class FactoryOptions {
+  public:
+    // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+    bool processOption(int& /*i*/, std::vector<std::string>& /*argv*/,
+                       const std::string& /*workingDir*/) {
+      return false;
+    }
+  };
+
+  class Options : public MiniZinc::SolverInstanceBase::Options {
+  public:
+    std::string sExportModel;
+    /// Maximal number of nonzeros buffered while transposing the matrix for MPS files
+    size_t nChunkSize = 1 << 20;
+
+    std::unordered_map<std::string, std::string> extraParams;
+
+    bool processOption(int& i, std::vector<std::string>& argv,
+                       const std::string& workingDir = std::string());
+    static void printHelp(std::ostream& os);
+  };
+
+private:
+  Options* _options = nullptr;
+  std::unique_ptr<MIPModelWriter> _writer;
+  int _nCols = 0;
+  int _objSense = 0;
+
+public:
+  MIPWriterWrapper(FactoryOptions& factoryOpt, Options* opt);
+  ~MIPWriterWrapper() override {}
+
+  static std::string getId() { return "writer"; }
+  static std::string getName() { return "MIP model writer"; }
+  static std::string getVersion(FactoryOptions& /*factoryOpt*/,
+                                MiniZinc::SolverInstanceBase::Options* /*opt*/ = nullptr) {
+    return "1.0.0";
+  }
+  static std::string getDescription(FactoryOptions& /*factoryOpt*/,
+                                    MiniZinc::SolverInstanceBase::Options* /*opt*/ = nullptr) {
+    return "MIP model writer, produces LP and free MPS files without a solver library";
+  }
+  static std::vector<std::string> getStdFlags() { return {"-v", "-s"}; }
+  static std::vector<std::string> getRequiredFlags(FactoryOptions& /*factoryOpt*/) {
+    return {"--writeModel"};
+  }
+  static std::vector<std::string> getFactoryFlags() { return {}; }
+  static std::vector<std::string> getTags() { return {"writer"}; }
+  static std::vector<MiniZinc::SolverConfig::ExtraFlag> getExtraFlags(
+      FactoryOptions& /*factoryOpt*/) {
+    return {};
+  }
+
+  /// The columns are read from colObj etc. when the file is written
+  void doAddVars(size_t n, double* /*obj*/, double* /*lb*/, double* /*ub*/, VarType* /*vt*/,
+                 std::string* /*names*/) override {
+    _nCols += static_cast<int>(n);
+  }
+  void addRow(int nnz, int* rmatind, double* rmatval, LinConType sense, double rhs,
+              int /*mask*/ = MaskConsType_Normal, const std::string& /*rowName*/ = "") override {
+    _writer->addRow(nnz, rmatind, rmatval, sense, rhs);
+  }
+  void addIndicatorConstraint(int iBVar, int bVal, int nnz, int* rmatind, double* rmatval,
+                              LinConType sense, double rhs,
+                              const std::string& /*rowName*/ = "") override {
+    _writer->addIndicatorConstraint(iBVar, bVal, nnz, rmatind, rmatval, sense, rhs);
+  }
+  void setVarBounds(int iVar, double lb, double ub) override {
+    colLB[iVar] = lb;
+    colUB[iVar] = ub;
+  }
+  void setVarLB(int iVar, double lb) override { colLB[iVar] = lb; }
+  void setVarUB(int iVar, double ub) override { colUB[iVar] = ub; }
+
+  void setObjSense(int s) override { _objSense = s; }
+  double getInfBound() override { return 1e20; }
+  int getNCols() override { return _nCols; }
+  int getNRows() override { return _writer->getNRows(); }
+
+  /// Write the model file, the status is UNKNOWN afterwards
+  void solve() override;
+};
@@ -0,0 +1,138 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <minizinc/shared_bounds.hh>
+#include <minizinc/solns2out.hh>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace MiniZinc {
+
+/// Runs several FlatZinc solver executables concurrently on the same FlatZinc file.
+///
+/// The raw output of each member is split into solution blocks. A block is only
+/// forwarded to the shared Solns2Out if it improves on the best objective value
+/// seen so far (or, for satisfaction problems, if it comes from the member that
+/// produced the first solution). The first member to report a final status
+/// (optimality, unsatisfiability or unboundedness) wins, and all other members
+/// are terminated.
+class FZNPortfolio {
+public:
+  struct Member {
+    /// Name used in log messages and statistics
+    std::string name;
+    /// Complete command line (including the FlatZinc file)
+    std::vector<std::string> cmd;
+  };
+  enum Direction { D_SAT, D_MIN, D_MAX };
+
+protected:
+  std::vector<Member> _members;
+  Solns2Out* _pS2Out;
+  int _timelimit;
+  bool _sigint;
+  Direction _direction;
+  /// Name of the objective variable in the raw output (empty if not tracked)
+  std::string _objVar;
+  /// Whether the objective assignment must be removed before forwarding
+  bool _stripObjVar;
+
+public:
+  struct Statistics {
+    /// Index of the member that reported the final status (-1 if none)
+    int winner = -1;
+    /// Number of solution blocks received from all members
+    unsigned long long received = 0;
+    /// Number of solution blocks forwarded to the output
+    unsigned long long forwarded = 0;
+  } stats;
+
+  /// Board to publish improving solutions to (optional)
+  SharedBounds* sharedBounds = nullptr;
+
+  FZNPortfolio(std::vector<Member> members, Solns2Out* pso, int timelimit, bool sigint,
+               Direction direction, std::string objVar, bool stripObjVar)
+      : _members(std::move(members)),
+        _pS2Out(pso),
+        _timelimit(timelimit),
+        _sigint(sigint),
+        _direction(direction),
+        _objVar(std::move(objVar)),
+        _stripObjVar(stripObjVar) {}
+
+  /// Run all members until one of them finishes or all have exited.
+  /// Returns the exit status of the winning member, or 0 if any member exited normally.
+  int run();
+
+  const std::vector<Member>& members() const { return _members; }
+};
+
+/// Output filter that publishes the solutions of a single FlatZinc solver to a SharedBounds board.
+///
+/// The raw output is forwarded line by line to \a S2O (Solns2Out or Solns2Log). The objective
+/// assignment is recorded (and removed if it was only added for the board), and its value is
+/// published when the solution separator arrives.
+template <class S2O>
+class SharedBoundsPublisher {
+protected:
+  S2O* _out;
+  SharedBounds& _sharedBounds;
+  const Solns2Out::Options& _opt;
+  /// Prefix of the objective assignment in the raw output
+  std::string _objPrefix;
+  bool _stripObjVar;
+  /// Incomplete last line of the output received so far
+  std::string _line;
+  bool _haveObj = false;
+  double _obj = 0.0;
+
+public:
+  SharedBoundsPublisher(S2O* out, SharedBounds& sharedBounds, const Solns2Out::Options& opt,
+                        const std::string& objVar, bool stripObjVar)
+      : _out(out),
+        _sharedBounds(sharedBounds),
+        _opt(opt),
+        _objPrefix(objVar + " = "),
+        _stripObjVar(stripObjVar) {}
+
+  bool feedRawDataChunk(const char* data) {
+    _line += data;
+    std::string forward;
+    size_t pos = 0;
+    size_t eol;
+    while ((eol = _line.find('\n', pos)) != std::string::npos) {
+      std::string line = _line.substr(pos, eol - pos);
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      bool keep = true;
+      if (line.compare(0, _objPrefix.size(), _objPrefix) == 0) {
+        char* end = nullptr;
+        const char* v = line.c_str() + _objPrefix.size();
+        _obj = std::strtod(v, &end);
+        _haveObj = end != v;
+        keep = !_stripObjVar;
+      } else if (line == _opt.solutionSeparatorDef && _haveObj) {
+        _sharedBounds.publishIncumbent(_obj);
+      } else if (line == _opt.searchCompleteMsgDef && _haveObj) {
+        _sharedBounds.publishBound(_obj);
+      }
+      if (keep) {
+        forward.append(_line, pos, eol - pos + 1);
+      }
+      pos = eol + 1;
+    }
+    _line.erase(0, pos);
+    return forward.empty() || _out->feedRawDataChunk(forward.c_str());
+  }
+  std::ostream& getLog() { return _out->getLog(); }
+};
+
+}  // namespace MiniZinc
@@ -14,8 +14,13 @@
 #include <minizinc/flattener.hh>
 #include <minizinc/solver.hh>
 
+#include <functional>
+#include <memory>
+
 namespace MiniZinc {
 
+class SharedBounds;
+
 class FZNSolverOptions : public SolverInstanceBase::Options {
 public:
   std::string fznSolver;
@@ -32,6 +37,8 @@ public:
 
   bool fznNeedsPaths = false;
   bool fznOutputPassthrough = false;
+  /// Write the FlatZinc to the standard input of the running solver instead of a file
+  bool fznPipe = false;
 
   bool supportsA = false;
   bool supportsN = false;
@@ -46,11 +53,18 @@ public:
   bool supportsAO = false;
   bool supportsCpprofiler = false;
   std::vector<MZNFZNSolverFlag> fznSolverFlags;
+
+  /// Additional solvers to run concurrently on the same FlatZinc (portfolio mode)
+  std::vector<std::unique_ptr<FZNSolverOptions>> portfolio;
 };
 
 class FZNSolverInstance : public SolverInstanceBase {
 private:
   std::string _fznSolver;
+  /// Name of the objective variable as printed in the FlatZinc (portfolio mode)
+  std::string _portfolioObjective;
+  /// Whether the objective was only added to the output for the portfolio
+  bool _portfolioStripObjective = false;
 
 protected:
   Model* _fzn;
@@ -71,6 +85,18 @@ public:
 
 protected:
   static Expression* getSolutionValue(Id* id);
+  /// Print the FlatZinc model to \a os
+  void printFlatZinc(std::ostream& os);
+  /// Build the command line for running solver \a opt (without the FlatZinc file)
+  static std::vector<std::string> cmdLine(FZNSolverOptions& opt, bool isSat);
+  /// Run the solver on \a cmdLine with output to \a pso, publishing solutions to \a sharedBounds
+  /// if given. Returns the exit status of the solver.
+  template <class S2O>
+  int runSolver(std::vector<std::string>& cmdLine, S2O* pso,
+                const std::function<void(std::ostream&)>& input, SharedBounds* sharedBounds);
+  /// Run all portfolio members on \a fznFile, publishing solutions to \a sharedBounds if given
+  Status solvePortfolio(std::vector<std::string>& cmdLine, const std::string& fznFile,
+                        const std::string& pathsFile, SharedBounds* sharedBounds);
 };
 
 class FZNSolverFactory : public SolverFactory {
@@ -89,6 +115,9 @@ public:
   void printHelp(std::ostream& os) override;
   static void setAcceptedFlags(SolverInstanceBase::Options* opt,
                                const std::vector<MZNFZNSolverFlag>& flags);
+  /// Add \a member (created using createOptions) to the portfolio of \a opt, taking ownership
+  static void addPortfolioMember(SolverInstanceBase::Options* opt,
+                                 SolverInstanceBase::Options* member);
 };
 
 }  // namespace MiniZinc
@@ -16,6 +16,8 @@
 
 #include <geas/solver/solver.h>
 
+#include <unordered_map>
+
 namespace MiniZinc {
 
 class GeasOptions : public SolverInstanceBase::Options {
@@ -106,6 +108,8 @@ public:
 protected:
   geas::solver _solver;
   Model* _flat;
+  // Fixed variables for the integer literals used as variables, shared between constraints
+  std::unordered_map<long long int, geas::intvar> _intConstants;
 
   SolveI::SolveType _objType = SolveI::ST_SAT;
   std::unique_ptr<GeasTypes::Variable> _objVar;
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <minizinc/shared_bounds.hh>
 #include <minizinc/solver_instance_base.hh>
 
 #include <gecode/driver.hh>
@@ -72,11 +73,13 @@ public:
   bool copyAuxVars;
   /// solve type (SAT, MIN or MAX)
   MiniZinc::SolveI::SolveType solveType;
+  /// Incumbents of cooperating solvers used to prune the search (or NULL)
+  SharedBounds* sharedBounds;
 
   /// copy constructor
   FznSpace(FznSpace& f);
   /// standard constructor
-  FznSpace() : optVarIsInt(true), optVarIdx(-1), copyAuxVars(true) {}
+  FznSpace() : optVarIsInt(true), optVarIdx(-1), copyAuxVars(true), sharedBounds(nullptr) {}
   ~FznSpace() override {}
 
   /// get the index of the Boolean variable in bv; return -1 if not exists
@@ -90,6 +93,10 @@ public:
     return -1;  // we should have found the boolvar in bv
   }
 
+  /// Constrain the objective to improve on the incumbent of cooperating solvers (if any)
+  /// and return whether this pruned the objective
+  bool importSharedIncumbent();
+
 protected:
   /// Implement optimization
   void constrain(const Space& s) override;
@@ -14,7 +14,9 @@
 #include <minizinc/flattener.hh>
 #include <minizinc/solver.hh>
 #include <minizinc/solvers/gecode/fzn_space.hh>
+#include <minizinc/timer.hh>
 
+#include <memory>
 #include <unordered_map>
 
 #if GECODE_VERSION_NUMBER < 600000
@@ -184,6 +186,8 @@ public:
   bool shave = false;
   bool verbose = false;
   unsigned int prePasses = 0;
+  /// Number of threads probing values during sac/shaving (0 = number of cores)
+  unsigned int sacThreads = 1;
   bool statistics = false;
   bool allSolutions = false;
   int nSolutions = -1;
@@ -205,11 +209,40 @@ private:
   bool _runSac;
   bool _runShave;
   unsigned int _prePasses;
+  unsigned int _sacThreads;
   bool _allSolutions;
   int _nMaxSolutions;
   int _nFoundSolutions;
   bool _allowUnboundedVars;
   Model* _flat;
+  /// Incumbents and bounds shared with cooperating solvers (if enabled)
+  std::unique_ptr<SharedBounds> _sharedBounds;
+  /// Objective value of a solution
+  double objectiveValue(const FznSpace* s) const;
+  /// Time (in seconds) spent constructing the root space
+  double _initTime = 0.0;
+  /// Increase of the peak memory of the process (in MB) while constructing the root space
+  double _initMemIncrease = 0.0;
+  /// Number of sac/shaving rounds performed
+  unsigned int _sacRounds = 0;
+  /// Number of values probed during sac/shaving
+  unsigned long long _sacProbes = 0;
+  /// Number of values removed by sac/shaving
+  unsigned long long _sacPruned = 0;
+  /// Report the statistics of a sac/shaving round
+  void sacRoundFinished(const Timer& roundTimer, unsigned long long probes,
+                        unsigned long long pruned, unsigned int threads,
+                        unsigned long long steals);
+  /// Run sac/shaving rounds with \a nThreads threads probing copies of the root space
+  bool sacParallel(bool toFixedPoint, bool shaving, unsigned int nThreads);
+  /// Whether constants are shared between constraints (only while constructing the root space).
+  /// Literal arguments then map to one fixed variable per value, instead of a new variable for
+  /// every occurrence; the argument arrays themselves are still created per constraint.
+  bool _shareConstants = false;
+  /// Integer constants already created in the root space
+  std::unordered_map<int, Gecode::IntVar> _intConstants;
+  /// Boolean constants already created in the root space
+  Gecode::BoolVar _boolConstants[2];
 
 public:
   /// the Gecode space that will be/has been solved
@@ -238,7 +271,7 @@ public:
   // Presolve the currently loaded model, updating variables with the same
   // names in the given Model* originalModel.
   bool presolve(Model* originalModel = nullptr);
-  bool sac(bool toFixedPoint, bool shaving) const;
+  bool sac(bool toFixedPoint, bool shaving);
   void printStatistics() override;
 
   void processSolution(bool last_sol = false);
@@ -262,6 +295,10 @@ public:
   Gecode::IntVarArgs arg2intvarargs(Expression* arg, int offset = 0);
   /// Convert \a arg to BoolVarArgs
   Gecode::BoolVarArgs arg2boolvarargs(Expression* a, int offset = 0, int siv = -1);
+  /// Return an integer variable fixed to \a v (shared if constants are shared)
+  Gecode::IntVar intConstant(int v);
+  /// Return a Boolean variable fixed to \a b (shared if constants are shared)
+  Gecode::BoolVar boolConstant(bool b);
   /// Convert \a n to BoolVar
   Gecode::BoolVar arg2boolvar(Expression* e);
   /// Convert \a n to IntVar
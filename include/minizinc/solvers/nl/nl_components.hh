@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <sstream>
@@ -116,6 +118,87 @@ public:
 // Declaration
 class NLFile;
 
+/** Output of the segments of an NL file.
+ *  An NL file is either written in text ('g' format) or in binary ('b' format). Both formats share
+ *  the same structure: a segment or an expression token starts with a key character, followed by
+ *  integers and doubles. In text format, items are separated by spaces and lines can end with a
+ *  comment; in binary format, integers and doubles are written as raw 4 and 8 bytes values in the
+ *  native byte order, and comments and line breaks are dropped.
+ *  Text output goes through the stream operators, so the precision and hexfloat settings of the
+ *  underlying stream apply.
+ */
+class NLOutput {
+protected:
+  std::ostream& _os;
+  bool _binary;
+  /** Does the next item in text format needs a separating space? */
+  bool _sep = false;
+
+public:
+  NLOutput(std::ostream& os, bool binary) : _os(os), _binary(binary) {}
+
+  bool isBinary() const { return _binary; }
+
+  std::ostream& stream() { return _os; }
+
+  /** Start a new item with its key, e.g. 'C' for a constraint segment or 'v' for a variable.
+   *  If \a spaced, the next item is separated from the key by a space in text format. */
+  NLOutput& key(char k, bool spaced = false) {
+    _os.put(k);
+    _sep = spaced;
+    return *this;
+  }
+
+  /** Write an integer. */
+  NLOutput& integer(int i) {
+    if (_binary) {
+      std::int32_t v = i;
+      _os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    } else {
+      if (_sep) {
+        _os.put(' ');
+      }
+      _os << i;
+      _sep = true;
+    }
+    return *this;
+  }
+
+  /** Write a double. */
+  NLOutput& real(double d) {
+    if (_binary) {
+      _os.write(reinterpret_cast<const char*>(&d), sizeof(d));
+    } else {
+      if (_sep) {
+        _os.put(' ');
+      }
+      _os << d;
+      _sep = true;
+    }
+    return *this;
+  }
+
+  /** End a line (text format only). */
+  NLOutput& eol() {
+    if (!_binary) {
+      _os.put('\n');
+      _sep = false;
+    }
+    return *this;
+  }
+
+  /** End a line with a comment (text format only). */
+  NLOutput& eol(const char* comment) {
+    if (!_binary) {
+      _os << "   # " << comment << '\n';
+      _sep = false;
+    }
+    return *this;
+  }
+
+  NLOutput& eol(const std::string& comment) { return eol(comment.c_str()); }
+};
+
 /** A Bound.
  *  A bound can represent various constraint on a variable or a constraint.
  *  Because it apply to both variables and constraints, we keep it general enough.
@@ -163,6 +246,9 @@ public:
 
   /** *** *** *** Printing Methods *** *** *** **/
 
+  /** Print the bound with a comment containing the name of the variable/constraint. */
+  void print(NLOutput& out, const std::string& vname) const;
+
   /** Print the bound with a comment containing the name of the variable/constraint. */
   std::ostream& printToStream(std::ostream& o, const std::string& vname) const;
 
@@ -171,17 +257,21 @@ public:
 };
 
 /** A Declared variable.
- *  A variable is identified by its name, which is supposed to be unique in the MZN representation.
- *  In an NL file, variables are identified by their index. However, those index are dependent on
- * the variable ordering, which can only be known once all variables are known. Hence, the
- * computation of the index can only be achieved at a later stage. A variable is always associated
- * to a bound, even if none are specified (See LNBound above)/
+ *  While collecting the model, a variable is identified by its position in the variables of the
+ *  NLFile (its "id", given by declaration order). In an NL file, variables are identified by their
+ * index. However, those index are dependent on the variable ordering, which can only be known once
+ * all variables are known. Hence, the computation of the index can only be achieved at a later
+ * stage. A variable is always associated to a bound, even if none are specified (See LNBound
+ * above)/
  */
 class NLVar {
 public:
   /** Variable name. */
   std::string name;
 
+  /** Index of the variable in the NL file. Only available after phase 2. */
+  int index = -1;
+
   /** Is the variable an integer variable? Else is a floating point variable. */
   bool isInteger = false;
 
@@ -220,18 +310,18 @@ public:
  */
 class NLArray {
 public:
-  /** Array item; if the string is empty, use the value. */
+  /** Array item; if the variable id is -1, use the value. */
   class Item {
   public:
-    std::string variable;
-    double value;
+    int variable = -1;
+    double value = 0;
   };
 
   /** Array name */
   std::string name;
 
-  /** Dimensions part, e.g. array2d( '0..4', '0..5' [ .... ]) */
-  std::vector<std::string> dimensions;
+  /** Index sets of the dimensions, e.g. (0,4) and (0,5) for array2d(0..4, 0..5, [ .... ]) */
+  std::vector<std::pair<int, int>> dimensions;
 
   /** Related variables */
   std::vector<Item> items;
@@ -349,10 +439,10 @@ public:
   Kind kind;
   double numericValue;  // if kind==NUMERIC
   int argCount;         // if kind==FUNCALL or kind==MOP
-  std::string
-      str;      // if kind==STRING or kind=VARIABLE (variable name) or kind=FUNCALL (function name)
-  OpCode oc;    // if kind==OP
-  MOpCode moc;  // if kind==MOP
+  int var;              // if kind==VARIABLE (variable id)
+  std::string str;      // if kind==STRING or kind=FUNCALL (function name)
+  OpCode oc;            // if kind==OP
+  MOpCode moc;          // if kind==MOP
 
   /* *** *** *** Constructor and helpers *** *** *** */
 
@@ -360,7 +450,7 @@ public:
 
   static NLToken n(double value);
 
-  static NLToken v(std::string vname);
+  static NLToken v(int var);
 
   static NLToken o(OpCode opc);
 
@@ -373,7 +463,7 @@ public:
 
   /* *** *** *** Printable *** *** *** */
 
-  std::ostream& printToStream(std::ostream& o, const NLFile& nl_file) const;
+  void print(NLOutput& out, const NLFile& nl_file) const;
 };
 
 /** A algebraic constraint.
@@ -382,9 +472,12 @@ public:
  */
 class NLAlgCons {
 public:
-  /** Constraint name, also acts as identifier. */
+  /** Constraint name. */
   std::string name;
 
+  /** Index of the constraint in the NL file. Only available after phase 2. */
+  int index = -1;
+
   /** Bound on the algebraic constraint.
    *  Used when producing the unique r of the NL file.
    */
@@ -396,16 +489,16 @@ public:
    */
   std::vector<NLToken> expressionGraph = {};
 
-  /** Jacobian, used for the linear part. Identify a variable by its name and associate a
+  /** Jacobian, used for the linear part. Identify a variable by its id and associate a
    * coefficent. Used to produce a new, standalone, J segment.
    */
-  std::vector<std::pair<std::string, double>> jacobian = {};
+  std::vector<std::pair<int, double>> jacobian = {};
 
   /** Method to build the var_coeff vector.
-   *  The NLFile is used to access the variables through their name in order to increase their
+   *  The NLFile is used to access the variables through their id in order to increase their
    * jacobian count.
    */
-  void setJacobian(const std::vector<std::string>& vnames, const std::vector<double>& coeffs,
+  void setJacobian(const std::vector<int>& vars, const std::vector<double>& coeffs,
                    NLFile* nl_file);
 
   /* *** *** *** Helpers *** *** *** */
@@ -415,7 +508,7 @@ public:
 
   /* *** *** *** Printable *** *** *** */
 
-  std::ostream& printToStream(std::ostream& o, const NLFile& nl_file) const;
+  void print(NLOutput& out, const NLFile& nl_file) const;
 };
 
 /** A logical constraint.
@@ -443,7 +536,7 @@ public:
 
   /* *** *** *** Printable *** *** *** */
 
-  std::ostream& printToStream(std::ostream& o, const NLFile& nl_file) const;
+  void print(NLOutput& out, const NLFile& nl_file) const;
 };
 
 /** The header. */
@@ -451,7 +544,9 @@ class NLHeader {
 public:
   /* *** *** *** Printable *** *** *** */
 
-  static std::ostream& printToStream(std::ostream& o, const NLFile& nl_file);
+  /** Print the header. The header is always in text, only its first letter and the arithmetic
+   * mode depend on the format of the rest of the file. */
+  static std::ostream& printToStream(std::ostream& o, const NLFile& nl_file, bool binary = false);
 };
 
 /** An Objective
@@ -475,13 +570,13 @@ public:
 
   /* *** *** *** Gradient *** *** *** */
 
-  /** Gradient, used for the linear part. Identify a variable by its name and associate a
+  /** Gradient, used for the linear part. Identify a variable by its id and associate a
    * coefficent. Used to produce a new, standalone, G segment.
    */
-  std::vector<std::pair<std::string, double>> gradient = {};
+  std::vector<std::pair<int, double>> gradient = {};
 
   /** Method to build the var_coeff vector. */
-  void setGradient(const std::vector<std::string>& vnames, const std::vector<double>& coeffs);
+  void setGradient(const std::vector<int>& vars, const std::vector<double>& coeffs);
 
   int gradientCount() const;
 
@@ -496,7 +591,7 @@ public:
   NLObjective() = default;
 
   /* *** *** *** Printable *** *** *** */
-  std::ostream& printToStream(std::ostream& o, const NLFile& nl_file) const;
+  void print(NLOutput& out, const NLFile& nl_file) const;
 };
 
 }  // namespace MiniZinc
@@ -14,10 +14,10 @@
 #include <minizinc/astvec.hh>
 #include <minizinc/solvers/nl/nl_components.hh>
 
-#include <map>
 #include <ostream>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 // This files declare data-structure describing the various components of a nl files.
 // A nl files is composed of two main parts: a header and a list of segments.
@@ -28,9 +28,9 @@
 
 /** NL File.
  *  Good to know:
- *      * We use string as variable unique identifier.
- *        Given a MZN variable declaration (can be obtain from a MZN variable), the 'getVarName'
- * helper produces the string.
+ *      * Variables are identified by their position in 'variables' (their id, in declaration
+ * order). Given a MZN variable declaration (can be obtain from a MZN variable), the 'getVarId'
+ * helper produces the id. The 'getVarName' helper produces the name used for output.
  *      * In our case, we only have one 'solve' per file.
  *      * NL file use double everywhere. Hence, even with dealing with integer variable, we store
  * the information with double.
@@ -64,18 +64,21 @@ public:
   /** Create a vector of double from a vector containing Expression being float literal FloatLit. */
   static std::vector<double> fromVecFloat(const ArrayLit* v_fp);
 
-  /** Create a vector of variable names from a vector containing Expression being identifier Id. */
-  static std::vector<std::string> fromVecId(const ArrayLit* v_id);
+  /** Get the id of a declared variable. */
+  int getVarId(const VarDecl* vd) const;
+
+  /** Create a vector of variable ids from a vector containing Expression being identifier Id. */
+  std::vector<int> fromVecId(const ArrayLit* v_id) const;
 
   /* *** *** *** Phase 1: collecting data from MZN *** *** *** */
 
-  // Variables collection, identified by name
+  // Variables collection, identified by id (position in the vector)
   // Needs ordering, see phase 2
-  std::map<std::string, NLVar> variables = {};
+  std::vector<NLVar> variables = {};
 
-  // Algebraic constraints collection, identified by name
+  // Algebraic constraints collection, in creation order
   // Needs ordering, see phase 2
-  std::map<std::string, NLAlgCons> constraints = {};
+  std::vector<NLAlgCons> constraints = {};
 
   // Logical constraints do not need ordering:
   std::vector<NLLogicalCons> logicalConstraints = {};
@@ -109,10 +112,12 @@ public:
   void addVarDecl(const VarDecl* vd, const TypeInst* ti, const Expression* rhs);
 
   /** Add an integer variable declaration to the NL File. */
-  void addVarDeclInteger(const std::string& name, const IntSetVal* isv, bool toReport);
+  void addVarDeclInteger(const VarDecl* vd, const std::string& name, const IntSetVal* isv,
+                         bool toReport);
 
   /** Add a floating point variable declaration to the NL File. */
-  void addVarDeclFloat(const std::string& name, const FloatSetVal* fsv, bool toReport);
+  void addVarDeclFloat(const VarDecl* vd, const std::string& name, const FloatSetVal* fsv,
+                       bool toReport);
 
   // --- --- --- Constraints analysis
 
@@ -125,25 +130,24 @@ public:
   /** Create a token from an expression representing a variable.
    * ONLY USE FOR CONSTRAINT, NOT OBJECTIVES! (UPDATE VARIABLES FLAG FOR CONSTRAINTS)
    */
-  static NLToken getTokenFromVar(const Expression* e);
+  NLToken getTokenFromVar(const Expression* e) const;
 
   /** Create a token from an expression representing either a variable or an integer numeric value.
    * ONLY USE FOR CONSTRAINT, NOT OBJECTIVES!
    */
-  static NLToken getTokenFromVarOrInt(const Expression* e);
+  NLToken getTokenFromVarOrInt(const Expression* e) const;
 
   /** Create a token from an expression representing either a variable or a floating point numeric
    * value. ONLY USE FOR CONSTRAINT, NOT OBJECTIVES!
    */
-  static NLToken getTokenFromVarOrFloat(const Expression* e);
+  NLToken getTokenFromVarOrFloat(const Expression* e) const;
 
   /** Update an expression graph (only by appending token) with a linear combination
    *  of coefficients and variables.
    *  ONLY USE FOR CONSTRAINTS, NOT OBJECTIVES!
    */
   static void makeSigmaMult(std::vector<NLToken>& expressionGraph,
-                            const std::vector<double>& coeffs,
-                            const std::vector<std::string>& vars);
+                            const std::vector<double>& coeffs, const std::vector<int>& vars);
 
   // --- --- --- Linear Builders
   // Use an array of literals 'coeffs' := c.arg(0), an array of variables 'vars' := c.arg(1),
@@ -155,11 +159,11 @@ public:
 
   /** Create a linear constraint [coeffs] *+ [vars] = value. */
   void linconsEq(const Call* c, const std::vector<double>& coeffs,
-                 const std::vector<std::string>& vars, const NLToken& value);
+                 const std::vector<int>& vars, const NLToken& value);
 
   /** Create a linear constraint [coeffs] *+ [vars] <= value. */
   void linconsLe(const Call* c, const std::vector<double>& coeffs,
-                 const std::vector<std::string>& vars, const NLToken& value);
+                 const std::vector<int>& vars, const NLToken& value);
 
   /** Create a linear logical constraint [coeffs] *+ [vars] PREDICATE value.
    *  Use a generic comparison operator.
@@ -167,7 +171,7 @@ public:
    *              - Only use for conmparisons that cannot be expressed with '=' xor '<='.
    */
   void linconsPredicate(const Call* c, NLToken::OpCode oc, const std::vector<double>& coeffs,
-                        const std::vector<std::string>& vars, const NLToken& value);
+                        const std::vector<int>& vars, const NLToken& value);
 
   // --- --- --- Non Linear Builders
   // For predicates, uses 2 variables or literals: x := c.arg(0), y := c.arg(1)
@@ -473,49 +477,46 @@ public:
 
   /** Non Linear Continuous Variables in BOTH an objective and a constraint. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nlcv_both = {};
+  std::vector<int> vid_nlcv_both = {};
 
   /** Non Linear Integer Variables in BOTH an objective and a constraint. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nliv_both = {};
+  std::vector<int> vid_nliv_both = {};
 
   /** Non Linear Continuous Variables in CONStraints only. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nlcv_cons = {};
+  std::vector<int> vid_nlcv_cons = {};
 
   /** Non Linear Integer Variables in CONStraints only. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nliv_cons = {};
+  std::vector<int> vid_nliv_cons = {};
 
   /** Non Linear Continuous Variables in OBJectives only. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nlcv_obj = {};
+  std::vector<int> vid_nlcv_obj = {};
 
   /** Non Linear Integer Variables in OBJectives only. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_nliv_obj = {};
+  std::vector<int> vid_nliv_obj = {};
 
   /** Linear arcs. (Network not implemented) */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_larc_all = {};
+  std::vector<int> vid_larc_all = {};
 
   /** Linear Continuous Variables (ALL of them). */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_lcv_all = {};
+  std::vector<int> vid_lcv_all = {};
 
   /** Binary Variables (ALL of them). */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_bv_all = {};
+  std::vector<int> vid_bv_all = {};
 
   /** Linear Integer Variables (ALL of them). */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> vname_liv_all = {};
-
-  /** Contained all ordered variable names. Mapping variable index -> variable name */
-  std::vector<std::string> vnames = {};
+  std::vector<int> vid_liv_all = {};
 
-  /** Mapping variable name -> variable index */
-  std::map<std::string, int> variableIndexes = {};
+  /** Contained all ordered variable ids. Mapping variable index -> variable id */
+  std::vector<int> vids = {};
 
   // --- --- --- Simple tests
 
@@ -577,29 +578,28 @@ public:
       Linear general          n_con - (nlc + lnc)
   */
 
+  // Constraints are identified by their position in 'constraints'.
+
   /** Nonlinear general constraints. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> cnames_nl_general = {};
+  std::vector<int> cids_nl_general = {};
 
   /** Nonlinear network constraints. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> cnames_nl_network = {};
+  std::vector<int> cids_nl_network = {};
 
   /** Linear network constraints. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> cnames_lin_network = {};
+  std::vector<int> cids_lin_network = {};
 
   /** Linear general constraints. */
   // NOLINTNEXTLINE(readability-identifier-naming)
-  std::vector<std::string> cnames_lin_general = {};
+  std::vector<int> cids_lin_general = {};
 
-  /** Contained all ordered algebraic (and network if they were implemented) constraints names.
-   *  Mapping constraint index -> constraint name
+  /** Contained all ordered algebraic (and network if they were implemented) constraints.
+   *  Mapping constraint index -> position in 'constraints'
    */
-  std::vector<std::string> cnames = {};
-
-  /** Mapping constraint name -> contraint index */
-  std::map<std::string, int> constraintIndexes = {};
+  std::vector<int> cids = {};
 
   // Count of algebraic constraints:
   // The header needs to know how many range algebraic constraints and equality algebraic
@@ -615,14 +615,23 @@ public:
 
   /* *** *** *** Printable *** *** *** */
 
-  /** Print the NLFile on a stream.
+  /** Print the NLFile on a stream, in text ('g') or binary ('b') format.
+   *  The algebraic and logical constraint segments of large models are formatted in parallel
+   * by up to \a nThreads threads (0: use the number of hardware threads).
    *  Note: this is not the 'Printable' interface as we do not pass any nl_file (that would be
    * 'this') as a reference.
    */
-  std::ostream& printToStream(std::ostream& o) const;
+  std::ostream& printToStream(std::ostream& o, bool binary = false,
+                              unsigned int nThreads = 1) const;
 
 private:
   unsigned int _jacobianCount = 0;
+
+  /** Mapping variable declaration -> variable id */
+  std::unordered_map<const VarDecl*, int> _varIds;
+
+  /** Add a variable, returning its id. */
+  int addVar(const VarDecl* vd, NLVar v);
 };
 
 }  // End of NameSpace MiniZinc
@@ -50,6 +50,12 @@
    (variable indice 0) 2                       # result for variable indice 1 objno 0 0 # Objectif 0
    <result code>
 */
+// Solvers reading a binary NL file write the same information in binary: every item above is a
+// record made of its length in bytes (4 bytes integer), its content, and its length again.
+// The message and the "Options" tag are records of characters, the options, the 4 counts, and the
+// objective number and result code are records of 4 bytes integers, and the duals and primals are
+// records of doubles.
+
 // Result code can be :
 // (from https://github.com/ampl/mp/blob/master/include/mp/common.h)
 // UNKNOWN     = -1,
@@ -92,7 +98,16 @@ public:
 
   // --- --- --- Static functions
 
-  static NLSol parseSolution(std::istream& in);
+  /** Parse a solution in text or binary format. The format is detected from the content, so the
+   *  stream must be opened in binary mode. The primal values are read straight into 'values',
+   *  indexed by NL variable number; \a nbVars (the number of variables in the NL file) is used to
+   *  preallocate them.
+   */
+  static NLSol parseSolution(std::istream& in, size_t nbVars = 0);
+
+private:
+  static NLSol parseText(std::istream& in, size_t nbVars);
+  static NLSol parseBinary(std::istream& in, size_t nbVars);
 };
 
 /** Our version of Solns2Out **/
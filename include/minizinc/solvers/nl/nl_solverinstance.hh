@@ -20,6 +20,7 @@ public:
   std::vector<MZNFZNSolverFlag> nlSolverFlags;
   bool doHexafloat = false;
   bool doKeepfile = false;
+  bool doBinary = false;
 };
 
 class NLSolverInstance : public SolverInstanceBase {
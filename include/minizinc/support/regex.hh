@@ -11,18 +11,13 @@
 
 #pragma once
 
-#ifdef HAS_GECODE
-
 // Regex Parser Requirements
-#include <minizinc/astmap.hh>
-#include <minizinc/aststring.hh>
 #include <minizinc/values.hh>
 
 #include <memory>
 #include <set>
-
-#include <gecode/minimodel.hh>
-#undef ERROR
+#include <string>
+#include <vector>
 
 // This is a workaround for a bug in flex that only shows up
 // with the Microsoft C++ compiler
@@ -40,15 +35,94 @@ extern "C" int isatty(int);
 #define fileno _fileno
 #endif
 
+namespace MiniZinc {
+
+/// Node of a parsed regular expression
+class RegexNode {
+public:
+  enum Kind {
+    RK_SYMBOLS,  ///< Any one of a set of symbols
+    RK_CONCAT,   ///< Concatenation of the children
+    RK_UNION,    ///< Union of the children
+    RK_REPEAT    ///< Between min and max repetitions of the only child
+  };
+  /// Kind of node
+  Kind kind;
+  /// Symbols (sorted, for RK_SYMBOLS)
+  std::vector<int> symbols;
+  /// Children (for RK_CONCAT, RK_UNION, RK_REPEAT)
+  std::vector<std::unique_ptr<RegexNode>> children;
+  /// Minimum number of repetitions (for RK_REPEAT)
+  int min = 0;
+  /// Maximum number of repetitions, -1 for unbounded (for RK_REPEAT)
+  int max = -1;
+
+  /// Node matching one symbol out of \a s
+  explicit RegexNode(std::vector<int> s) : kind(RK_SYMBOLS), symbols(std::move(s)) {}
+  /// Node of kind \a k (RK_CONCAT or RK_UNION) with children \a a and \a b
+  RegexNode(Kind k, RegexNode* a, RegexNode* b) : kind(k) {
+    children.emplace_back(a);
+    children.emplace_back(b);
+  }
+  /// Node repeating \a a between \a min0 and \a max0 times (-1 for unbounded)
+  RegexNode(RegexNode* a, int min0, int max0) : kind(RK_REPEAT), min(min0), max(max0) {
+    children.emplace_back(a);
+  }
+};
+
+/**
+ * \brief Minimal deterministic finite automaton accepting a regular expression
+ *
+ * The automaton is built by subset construction over the classes of symbols
+ * that the expression cannot distinguish, and then minimised using
+ * Hopcroft's algorithm. It does not contain a dead state: missing transitions
+ * lead to state 0. States are numbered from 1, the start state is state 1,
+ * and the final states form the range finalFirst()..finalLast() (which is
+ * empty if the expression accepts no sequence).
+ */
+class RegexDFA {
+protected:
+  /// Smallest symbol
+  int _minSymbol;
+  /// Number of symbols
+  int _nSymbols;
+  /// Number of states
+  int _nStates;
+  /// First final state
+  int _finalFirst;
+  /// Last final state
+  int _finalLast;
+  /// Dense transition table, row-major with one row per state
+  std::vector<int> _table;
+
+public:
+  /// Construct the automaton for \a re over the symbols \a minSymbol..\a maxSymbol
+  RegexDFA(const RegexNode& re, int minSymbol, int maxSymbol);
+  /// Number of states
+  int nStates() const { return _nStates; }
+  /// Number of symbols
+  int nSymbols() const { return _nSymbols; }
+  /// Smallest symbol
+  int minSymbol() const { return _minSymbol; }
+  /// First final state
+  int finalFirst() const { return _finalFirst; }
+  /// Last final state
+  int finalLast() const { return _finalLast; }
+  /// Successor of state \a q (from 1) for symbol \a s, or 0 if there is none
+  int transition(int q, int s) const {
+    return _table[static_cast<size_t>(q - 1) * _nSymbols + (s - _minSymbol)];
+  }
+  /// The transition table, containing the successors of state 1 first
+  const std::vector<int>& table() const { return _table; }
+};
+
+}  // namespace MiniZinc
+
 // Anonymous struct for when yyparse is exported
 typedef struct REContext REContext;
 // Parser generated header
 #include <minizinc/support/regex_parser.tab.hh>
 
-using namespace Gecode;
-using namespace MiniZinc;
-
 // Parsing function
-std::unique_ptr<REG> regex_from_string(const std::string& regex_str, const IntSetVal& domain);
-
-#endif  // HAS_GECODE
+std::unique_ptr<MiniZinc::RegexNode> regex_from_string(const std::string& regex_str,
+                                                       const MiniZinc::IntSetVal& domain);
@@ -15,12 +15,45 @@
 #include <minizinc/hash.hh>
 #include <minizinc/model.hh>
 
+#include <cstdint>
+#include <vector>
+
 namespace MiniZinc {
 
 /// Scoped variable declarations
 class Scopes {
 protected:
-  typedef IdMap<VarDecl*> DeclMap;
+  /// Open addressing hash table from identifiers to declarations
+  class DeclMap {
+  public:
+    /// Table entry (empty if \a vd is NULL)
+    struct Entry {
+      /// Interned identifier (see key())
+      uintptr_t key;
+      /// The declaration
+      VarDecl* vd;
+    };
+
+  protected:
+    /// The table, its size is zero or a power of two
+    std::vector<Entry> _t;
+    /// Number of non-empty entries
+    size_t _size = 0;
+    /// Return first table slot for \a key
+    size_t slot(uintptr_t key) const;
+    /// Grow the table to \a n entries
+    void resize(size_t n);
+
+  public:
+    /// Return key for \a ident (its interned string or tagged identifier number)
+    static uintptr_t key(const Id* ident);
+    /// Return declaration for \a ident, or NULL if not found
+    VarDecl* find(const Id* ident) const;
+    /// Insert \a vd, or return the declaration already present for its identifier
+    VarDecl* insert(VarDecl* vd);
+    /// Return all table entries (including empty ones)
+    const std::vector<Entry>& entries() const { return _t; }
+  };
   enum ScopeType { ST_TOPLEVEL, ST_FUN, ST_INNER };
   struct Scope {
     /// Map from identifiers to declarations
@@ -58,18 +91,24 @@ public:
   VarDecl* findSimilar(Id* ident);
 };
 
-/// Topological sorting of items
+/**
+ * \brief Topological sorting of items
+ *
+ * Declarations are numbered in an order in which every toplevel declaration
+ * comes after the toplevel declarations it depends on. The position of a
+ * sorted declaration (and the index into the stack of declarations that are
+ * being sorted, for those) is kept in its payload. Declarations that are
+ * referenced before they have been sorted are sorted afterwards using an
+ * explicit stack, so long chains of definitions do not cause deep recursion.
+ */
 class TopoSorter {
 public:
   typedef std::vector<KeepAlive> Decls;
-  typedef std::unordered_map<VarDecl*, int> PosMap;
 
   /// List of all declarations
   Decls decls;
   /// Scoped declarations
   Scopes scopes;
-  /// Map from declarations to positions
-  PosMap pos;
   /// The model
   Model* model;
   /// A set of identifiers that require a toString function (for enums)
@@ -91,6 +130,32 @@ public:
   VarDecl* checkId(EnvI& env, Id* ident, const Location& loc);
   /// Run the topological sorting for expression \a e
   void run(EnvI& env, Expression* e);
+  /// Return position of \a vd in decls, or -1 if it has not been sorted
+  int position(VarDecl* vd) const {
+    int p = vd->payload();
+    return p >= 0 && p < static_cast<int>(decls.size()) && decls[p]() == vd ? p : -1;
+  }
+
+protected:
+  /// Declarations that are currently being sorted
+  std::vector<VarDecl*> _active;
+  /// Declarations that have been referenced before they were sorted
+  std::vector<VarDecl*> _pending;
+  /// Return whether \a vd is currently being sorted
+  bool active(VarDecl* vd) const {
+    int p = -vd->payload() - 1;
+    return p >= 0 && p < static_cast<int>(_active.size()) && _active[p] == vd;
+  }
+  /// Start sorting \a vd
+  void start(VarDecl* vd);
+  /// Finish sorting \a vd (which must be the last active declaration)
+  void finish(VarDecl* vd);
+  /// Visit the type-inst, right hand side and annotations of \a vd
+  void visitDecl(EnvI& env, VarDecl* vd);
+  /// Visit expression \a e, resolving identifiers and recording pending declarations
+  void visit(EnvI& env, Expression* e);
+  /// Sort the pending declarations from index \a first on, then finish \a vd (if not NULL)
+  void sortPending(EnvI& env, size_t first, VarDecl* vd);
 };
 
 class TyperFn {
@@ -21,6 +21,13 @@
 #include <string>
 #include <vector>
 
+#if defined(__GNUC__) || defined(__clang__)
+#define MZN_HAS_OVERFLOW_BUILTINS
+#define MZN_UNLIKELY(c) __builtin_expect(static_cast<bool>(c), 0)
+#else
+#define MZN_UNLIKELY(c) (c)
+#endif
+
 namespace MiniZinc {
 class IntVal;
 }
@@ -40,6 +47,8 @@ class IntVal {
   friend IntVal operator%(const IntVal& x, const IntVal& y);
   friend IntVal std::abs(const MiniZinc::IntVal& x);
   friend bool operator==(const IntVal& x, const IntVal& y);
+  friend bool operator<=(const IntVal& x, const IntVal& y);
+  friend bool operator<(const IntVal& x, const IntVal& y);
   friend class FloatVal;
 
 private:
@@ -47,40 +56,72 @@ private:
   bool _infinity;
   IntVal(long long int v, bool infinity) : _v(v), _infinity(infinity) {}
 
+  /// Throw an overflow error (kept out of line so that the checked operations stay small)
+  [[noreturn]] static void overflow();
+  /// Throw an error for an arithmetic operation on an infinite value
+  [[noreturn]] static void infiniteOperand();
+
   static long long int safePlus(long long int x, long long int y) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+    long long int r;
+    if (MZN_UNLIKELY(__builtin_add_overflow(x, y, &r))) {
+      overflow();
+    }
+    return r;
+#else
     if (x < 0) {
       if (y < std::numeric_limits<long long int>::min() - x) {
-        throw ArithmeticError("integer overflow");
+        overflow();
       }
     } else {
       if (y > std::numeric_limits<long long int>::max() - x) {
-        throw ArithmeticError("integer overflow");
+        overflow();
       }
     }
     return x + y;
+#endif
   }
   static long long int safeMinus(long long int x, long long int y) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+    long long int r;
+    if (MZN_UNLIKELY(__builtin_sub_overflow(x, y, &r))) {
+      overflow();
+    }
+    return r;
+#else
     if (x < 0) {
       if (y > x - std::numeric_limits<long long int>::min()) {
-        throw ArithmeticError("integer overflow");
+        overflow();
       }
     } else {
       if (y < x - std::numeric_limits<long long int>::max()) {
-        throw ArithmeticError("integer overflow");
+        overflow();
       }
     }
     return x - y;
+#endif
   }
   static long long int safeMult(long long int x, long long int y) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+    // A product with absolute value 2^63 (i.e. minint) is treated as an overflow, like the
+    // portable implementation below does
+    long long int r;
+    if (MZN_UNLIKELY(__builtin_mul_overflow(x, y, &r) ||
+                     r == std::numeric_limits<long long int>::min())) {
+      overflow();
+    }
+    return r;
+#else
     if (y == 0) {
       return 0;
     }
     long long unsigned int x_abs = (x < 0 ? 0 - x : x);
     long long unsigned int y_abs = (y < 0 ? 0 - y : y);
     if (x_abs > std::numeric_limits<long long int>::max() / y_abs) {
-      throw ArithmeticError("integer overflow");
+      overflow();
     }
     return x * y;
+#endif
   }
   static long long int safeDiv(long long int x, long long int y) {
     if (y == 0) {
@@ -90,7 +131,7 @@ private:
       return 0;
     }
     if (x == std::numeric_limits<long long int>::min() && y == -1) {
-      throw ArithmeticError("integer overflow");
+      overflow();
     }
     return x / y;
   }
@@ -110,8 +151,8 @@ public:
   IntVal(const FloatVal& v);
 
   long long int toInt() const {
-    if (!isFinite()) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity)) {
+      infiniteOperand();
     }
     return _v;
   }
@@ -121,29 +162,29 @@ public:
   bool isMinusInfinity() const { return _infinity && _v == -1; }
 
   IntVal& operator+=(const IntVal& x) {
-    if (!(isFinite() && x.isFinite())) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity || x._infinity)) {
+      infiniteOperand();
     }
     _v = safePlus(_v, x._v);
     return *this;
   }
   IntVal& operator-=(const IntVal& x) {
-    if (!(isFinite() && x.isFinite())) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity || x._infinity)) {
+      infiniteOperand();
     }
     _v = safeMinus(_v, x._v);
     return *this;
   }
   IntVal& operator*=(const IntVal& x) {
-    if (!(isFinite() && x.isFinite())) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity || x._infinity)) {
+      infiniteOperand();
     }
     _v = safeMult(_v, x._v);
     return *this;
   }
   IntVal& operator/=(const IntVal& x) {
-    if (!(isFinite() && x.isFinite())) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity || x._infinity)) {
+      infiniteOperand();
     }
     _v = safeDiv(_v, x._v);
     return *this;
@@ -154,30 +195,30 @@ public:
     return r;
   }
   IntVal& operator++() {
-    if (!isFinite()) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity)) {
+      infiniteOperand();
     }
     _v = safePlus(_v, 1);
     return *this;
   }
   IntVal operator++(int) {
-    if (!isFinite()) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity)) {
+      infiniteOperand();
     }
     IntVal ret = *this;
     _v = safePlus(_v, 1);
     return ret;
   }
   IntVal& operator--() {
-    if (!isFinite()) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity)) {
+      infiniteOperand();
     }
     _v = safeMinus(_v, 1);
     return *this;
   }
   IntVal operator--(int) {
-    if (!isFinite()) {
-      throw ArithmeticError("arithmetic operation on infinite value");
+    if (MZN_UNLIKELY(_infinity)) {
+      infiniteOperand();
     }
     IntVal ret = *this;
     _v = safeMinus(_v, 1);
@@ -231,6 +272,18 @@ public:
     return *this;
   }
 
+  /// Return the sum of \a x
+  static IntVal sum(const std::vector<IntVal>& x);
+  /// Return \a d plus the sum of all \a c[i] * \a x[i] (\a c and \a x must have the same size)
+  static IntVal linear(const std::vector<IntVal>& c, const std::vector<IntVal>& x, IntVal d = 0) {
+    assert(c.size() == x.size());
+    return linear(c.data(), x.data(), c.size(), d);
+  }
+  /// Return \a d plus the sum of \a c[i] * \a x[i] for i < \a n
+  static IntVal linear(const IntVal* c, const IntVal* x, size_t n, IntVal d = 0);
+  /// Multiply all values in \a x by \a c
+  static void scale(std::vector<IntVal>& x, const IntVal& c);
+
   size_t hash() const {
     std::hash<long long int> longhash;
     return longhash(_v);
@@ -241,55 +294,58 @@ inline bool operator==(const IntVal& x, const IntVal& y) {
   return x._infinity == y._infinity && x._v == y._v;
 }
 inline bool operator<=(const IntVal& x, const IntVal& y) {
-  return y.isPlusInfinity() || x.isMinusInfinity() ||
-         (x.isFinite() && y.isFinite() && x.toInt() <= y.toInt());
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    return y.isPlusInfinity() || x.isMinusInfinity();
+  }
+  return x._v <= y._v;
 }
 inline bool operator<(const IntVal& x, const IntVal& y) {
-  return (y.isPlusInfinity() && !x.isPlusInfinity()) ||
-         (x.isMinusInfinity() && !y.isMinusInfinity()) ||
-         (x.isFinite() && y.isFinite() && x.toInt() < y.toInt());
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    return (y.isPlusInfinity() && !x.isPlusInfinity()) ||
+           (x.isMinusInfinity() && !y.isMinusInfinity());
+  }
+  return x._v < y._v;
 }
 inline bool operator>=(const IntVal& x, const IntVal& y) { return y <= x; }
 inline bool operator>(const IntVal& x, const IntVal& y) { return y < x; }
 inline bool operator!=(const IntVal& x, const IntVal& y) { return !(x == y); }
 inline IntVal operator+(const IntVal& x, const IntVal& y) {
-  if (!(x.isFinite() && y.isFinite())) {
-    throw ArithmeticError("arithmetic operation on infinite value");
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    IntVal::infiniteOperand();
   }
   return IntVal::safePlus(x._v, y._v);
 }
 inline IntVal operator-(const IntVal& x, const IntVal& y) {
-  if (!(x.isFinite() && y.isFinite())) {
-    throw ArithmeticError("arithmetic operation on infinite value");
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    IntVal::infiniteOperand();
   }
   return IntVal::safeMinus(x._v, y._v);
 }
 inline IntVal operator*(const IntVal& x, const IntVal& y) {
-  if (!x.isFinite()) {
-    if (y.isFinite() && (y._v == 1 || y._v == -1)) {
-      return IntVal(IntVal::safeMult(x._v, y._v), !x.isFinite());
-    }
-  } else if (!y.isFinite()) {
-    if (x.isFinite() && (y._v == 1 || y._v == -1)) {
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    if (!x.isFinite()) {
+      if (y.isFinite() && (y._v == 1 || y._v == -1)) {
+        return IntVal(IntVal::safeMult(x._v, y._v), !x.isFinite());
+      }
+    } else if (x.isFinite() && (y._v == 1 || y._v == -1)) {
       return IntVal(IntVal::safeMult(x._v, y._v), true);
     }
-  } else {
-    return IntVal::safeMult(x._v, y._v);
+    IntVal::infiniteOperand();
   }
-  throw ArithmeticError("arithmetic operation on infinite value");
+  return IntVal::safeMult(x._v, y._v);
 }
 inline IntVal operator/(const IntVal& x, const IntVal& y) {
   if (y.isFinite() && (y._v == 1 || y._v == -1)) {
     return IntVal(IntVal::safeMult(x._v, y._v), !x.isFinite());
   }
-  if (!(x.isFinite() && y.isFinite())) {
-    throw ArithmeticError("arithmetic operation on infinite value");
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    IntVal::infiniteOperand();
   }
   return IntVal::safeDiv(x._v, y._v);
 }
 inline IntVal operator%(const IntVal& x, const IntVal& y) {
-  if (!(x.isFinite() && y.isFinite())) {
-    throw ArithmeticError("arithmetic operation on infinite value");
+  if (MZN_UNLIKELY(x._infinity || y._infinity)) {
+    IntVal::infiniteOperand();
   }
   return IntVal::safeMod(x._v, y._v);
 }
@@ -1,72 +1,216 @@
 #include <minizinc/algorithms/min_cut.h>
-#include <minizinc/config.hh>
 
-#include <stdexcept>
+#include <cassert>
+#include <functional>
+#include <limits>
 
-#ifdef COMPILE_BOOST_MINCUT
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/graph_traits.hpp>
-#include <boost/graph/one_bit_color_map.hpp>
-#include <boost/graph/stoer_wagner_min_cut.hpp>
-#include <boost/property_map/property_map.hpp>
-#include <boost/typeof/typeof.hpp>
-#endif
+namespace {
+/// Residual capacities up to this are considered zero
+const double EPS_RES = 1e-9;
 
-void Algorithms::MinCut::solve() {
-#ifndef COMPILE_BOOST_MINCUT
-  throw std::runtime_error(
-      "MIP/circuit: Subtour Elimination Constraints: MinCut::solve not compiled. "
-      "Compile with COMPILE_BOOST_MINCUT (needs boost), or use -D nSECcuts=0 for flattening.");
-#else
-  typedef std::pair<unsigned long, unsigned long> edge_t;
-
-  // A graphic of the min-cut is available at
-  // <http://www.boost.org/doc/libs/release/libs/graph/doc/stoer_wagner_imgs/stoer_wagner.cpp.gif>
-  using namespace std;
-
-  typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS, boost::no_property,
-                                boost::property<boost::edge_weight_t, double> >
-      undirected_graph;
-  typedef boost::property_map<undirected_graph, boost::edge_weight_t>::type weight_map_type;
-  typedef boost::property_traits<weight_map_type>::value_type weight_type;
-
-  // define the 16 edges of the graph. {3, 4} means an undirected edge between vertices 3 and 4.
-  //   edge_t edges[] = {{3, 4}, {3, 6}, {3, 5}, {0, 4}, {0, 1}, {0, 6}, {0, 7},
-  //     {0, 5}, {0, 2}, {4, 1}, {1, 6}, {1, 5}, {6, 7}, {7, 5}, {5, 2}, {3, 4}};
-  std::vector<edge_t> edges_array;  // = edges;
-                                    //   std::vector< weight_type > ws_array;
-
-  edges_array.reserve(edges.size());
-  for (const auto& edg : edges)
-    edges_array.push_back(std::pair<unsigned long, unsigned long>(edg.first, edg.second));
-
-  // for each of the 16 edges, define the associated edge weight. ws[i] is the weight for the edge
-  // that is described by edges[i].
-  //   weight_type ws[] =
-  //   {0.2, 3.1, 1.3, 3.7, 1.5, 2.6, 6.44, 1.26, 8.77, 1.29, 1.95, 80.74, 2.23, 1.94, 1.23, 4.957};
-
-  // construct the graph object. 8 is the number of vertices, which are numbered from 0
-  // through 7, and 16 is the number of edges.
-  undirected_graph g(edges_array.data(), edges_array.data() + edges_array.size(), weights.data(),
-                     nNodes, edges_array.size());
+int uf_find(std::vector<int>& parent, int i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+}  // namespace
 
-  // define a property map, `parities`, that will store a boolean value for each vertex.
-  // Vertices that have the same parity after `stoer_wagner_min_cut` runs are on the same side of
-  // the min-cut.
-  BOOST_AUTO(parities00,
-             boost::make_one_bit_color_map(num_vertices(g), get(boost::vertex_index, g)));
+int Algorithms::MinCut::buildGraph() {
+  // Contract the heavy edges (union-find in _super, then number the roots densely)
+  _super.resize(nNodes);
+  for (int i = 0; i < nNodes; ++i) {
+    _super[i] = i;
+  }
+  for (size_t k = 0; k < edges.size(); ++k) {
+    if (weights[k] >= contractWeight) {
+      int a = uf_find(_super, edges[k].first);
+      int b = uf_find(_super, edges[k].second);
+      if (a != b) {
+        _super[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+  // Roots are the smallest nodes of their sets, so they are numbered before their members
+  int n = 0;
+  for (int i = 0; i < nNodes; ++i) {
+    _super[i] = _super[i] == i ? n++ : _super[_super[i]];
+  }
+  // Compressed sparse rows, each edge gives two arcs that are each other's reverse
+  _first.assign(n + 1, 0);
+  for (size_t k = 0; k < edges.size(); ++k) {
+    int a = _super[edges[k].first];
+    int b = _super[edges[k].second];
+    if (a != b) {
+      ++_first[a + 1];
+      ++_first[b + 1];
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    _first[i + 1] += _first[i];
+  }
+  const int nArcs = _first[n];
+  _head.resize(nArcs);
+  _rev.resize(nArcs);
+  _cap.resize(nArcs);
+  _iter.assign(_first.begin(), _first.end() - 1);
+  for (size_t k = 0; k < edges.size(); ++k) {
+    int a = _super[edges[k].first];
+    int b = _super[edges[k].second];
+    if (a != b) {
+      int ab = _iter[a]++;
+      int ba = _iter[b]++;
+      _head[ab] = b;
+      _head[ba] = a;
+      _rev[ab] = ba;
+      _rev[ba] = ab;
+      _cap[ab] = weights[k];
+      _cap[ba] = weights[k];
+    }
+  }
+  _res.assign(_cap.begin(), _cap.end());
+  _touched.clear();
+  _level.resize(n);
+  _mark.assign(n, 0);
+  _stamp = 0;
+  _queue.resize(n);
+  _path.resize(n);
+  return n;
+}
 
-  // run the Stoer-Wagner algorithm to obtain the min-cut weight. `parities` is also filled in.
-  wMinCut =
-      boost::stoer_wagner_min_cut(g, get(boost::edge_weight, g), boost::parity_map(parities00));
+double Algorithms::MinCut::maxFlow(int s, int t) {
+  // Undo the previous flow, only the arcs on augmenting paths have changed
+  for (int a : _touched) {
+    _res[a] = _cap[a];
+    _res[_rev[a]] = _cap[a];
+  }
+  _touched.clear();
+  double flow = 0.0;
+  for (;;) {
+    // Level graph, only up to t: all nodes of smaller levels are labelled when t is reached
+    if (++_stamp == 0) {
+      std::fill(_mark.begin(), _mark.end(), 0);
+      _stamp = 1;
+    }
+    _mark[s] = _stamp;
+    _level[s] = 0;
+    _iter[s] = _first[s];
+    int qHead = 0;
+    int qTail = 0;
+    _queue[qTail++] = s;
+    while (qHead < qTail && !labelled(t)) {
+      int u = _queue[qHead++];
+      for (int a = _first[u]; a < _first[u + 1]; ++a) {
+        int v = _head[a];
+        if (!labelled(v) && _res[a] > EPS_RES) {
+          _mark[v] = _stamp;
+          _level[v] = _level[u] + 1;
+          _iter[v] = _first[v];
+          _queue[qTail++] = v;
+        }
+      }
+    }
+    if (!labelled(t)) {
+      return flow;
+    }
+    // Blocking flow, searching augmenting paths depth-first along the level graph
+    int u = s;
+    int depth = 0;
+    for (;;) {
+      if (u == t) {
+        double delta = std::numeric_limits<double>::max();
+        for (int i = 0; i < depth; ++i) {
+          delta = std::min(delta, _res[_path[i]]);
+        }
+        for (int i = 0; i < depth; ++i) {
+          _res[_path[i]] -= delta;
+          _res[_rev[_path[i]]] += delta;
+          _touched.push_back(_path[i]);
+        }
+        flow += delta;
+        u = s;
+        depth = 0;
+        continue;
+      }
+      int& a = _iter[u];
+      while (a < _first[u + 1] &&
+             (_res[a] <= EPS_RES || !labelled(_head[a]) || _level[_head[a]] != _level[u] + 1)) {
+        ++a;
+      }
+      if (a < _first[u + 1]) {
+        _path[depth++] = a;
+        u = _head[a];
+      } else if (depth == 0) {
+        break;
+      } else {
+        // Dead end, retreat
+        _level[u] = -1;
+        u = _head[_rev[_path[--depth]]];
+        ++_iter[u];
+      }
+    }
+  }
+}
 
-  assert(nNodes == num_vertices(g));
+void Algorithms::MinCut::addCut(double w) {
+  // Use the side that does not contain node 0 (which is contracted node 0)
+  const bool side0 = labelled(0);
+  size_t h = 0;
+  const int start = static_cast<int>(cutNodes.size());
+  for (int i = 0; i < nNodes; ++i) {
+    if (labelled(_super[i]) != side0) {
+      cutNodes.push_back(i);
+      h = h * 31 + std::hash<int>()(i);
+    }
+  }
+  const int size = static_cast<int>(cutNodes.size()) - start;
+  for (size_t k = 0; k < _cutHash.size(); ++k) {
+    if (_cutHash[k] == h && cutStart[k + 1] - cutStart[k] == size &&
+        std::equal(cutNodes.begin() + cutStart[k], cutNodes.begin() + cutStart[k + 1],
+                   cutNodes.begin() + start)) {
+      cutNodes.resize(start);
+      return;
+    }
+  }
+  _cutHash.push_back(h);
+  cutWeights.push_back(w);
+  cutStart.push_back(static_cast<int>(cutNodes.size()));
+}
 
-  //   parities = parities00;
-  parities.clear();
-  parities.reserve(nNodes);
-  for (size_t i = 0; i < num_vertices(g); ++i) {
-    parities.push_back(get(parities00, i));
+void Algorithms::MinCut::solve() {
+  assert(edges.size() == weights.size());
+  wMinCut = 1e100;
+  cutStart.assign(1, 0);
+  cutNodes.clear();
+  cutWeights.clear();
+  _cutHash.clear();
+  const int n = buildGraph();
+  // Gusfield's algorithm: the flow tree starts as a star around node 0
+  _parent.assign(n, 0);
+  _minSide.resize(n);
+  for (int s = 1; s < n; ++s) {
+    const int t = _parent[s];
+    const double w = maxFlow(s, t);
+    if (w < wMinCut) {
+      wMinCut = w;
+      for (int i = 0; i < n; ++i) {
+        _minSide[i] = static_cast<char>(labelled(i));
+      }
+    }
+    if (w < threshold) {
+      addCut(w);
+    }
+    for (int i = s + 1; i < n; ++i) {
+      if (_parent[i] == t && labelled(i)) {
+        _parent[i] = s;
+      }
+    }
+  }
+  parities.assign(nNodes, false);
+  if (n > 1) {
+    for (int i = 0; i < nNodes; ++i) {
+      parities[i] = _minSide[_super[i]] != 0;
+    }
   }
-#endif
 }
@@ -18,7 +18,12 @@
 #include <minizinc/model.hh>
 #include <minizinc/prettyprinter.hh>
 
+#include <atomic>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace MiniZinc {
 
@@ -48,6 +53,177 @@ Expression* domain_shallow_copy(EnvI& env, Expression* orig, Type type) {
   return tup;
 }
 
+namespace {
+
+/// Table of the filenames referenced by compact locations.
+///
+/// The filenames are kept alive by the garbage collector of the thread that added them. When that
+/// thread exits, its entries are removed and their indices are reused, since the compact locations
+/// that refer to them lived in the same thread's heap.
+class LocationFileTable {
+public:
+  static const unsigned int capacity = 1 << 14;
+
+private:
+  class Marker : public GCMarker {
+  public:
+    std::vector<ASTStringData*> names;
+
+  protected:
+    void mark() override {
+      for (auto* n : names) {
+        n->mark();
+      }
+    }
+  };
+  /// The entries added by one thread, and a cache of its last lookup
+  struct ThreadState {
+    std::unique_ptr<Marker> marker;
+    ASTStringData* lastName = nullptr;
+    unsigned int lastIndex = 0;
+    /// Value of the table's generation when the cache was filled
+    unsigned int lastGeneration = 0;
+    ~ThreadState() {
+      if (marker != nullptr) {
+        table().release(marker->names);
+      }
+    }
+  };
+  static ThreadState& threadState() {
+    static thread_local ThreadState ts;
+    return ts;
+  }
+
+  std::mutex _mutex;
+  std::unordered_map<ASTStringData*, unsigned int> _index;
+  ASTStringData* _names[capacity];
+  /// Number of entries (index 0 is the empty filename)
+  unsigned int _size = 1;
+  /// Indices released by threads that have exited
+  std::vector<unsigned int> _free;
+  /// Incremented whenever entries are released, invalidates the per-thread caches
+  std::atomic<unsigned int> _generation;
+
+  LocationFileTable() : _generation(0) { _names[0] = nullptr; }
+
+  /// Remove the entries for \a names
+  void release(const std::vector<ASTStringData*>& names) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto* n : names) {
+      auto it = _index.find(n);
+      assert(it != _index.end());
+      _names[it->second] = nullptr;
+      _free.push_back(it->second);
+      _index.erase(it);
+    }
+    ++_generation;
+  }
+
+public:
+  static LocationFileTable& table() {
+    static LocationFileTable t;
+    return t;
+  }
+  /// Return the index of \a filename, or capacity if the table is full
+  unsigned int index(ASTStringData* filename) {
+    if (filename == nullptr) {
+      return 0;
+    }
+    ThreadState& ts = threadState();
+    unsigned int generation = _generation.load();
+    if (ts.lastName == filename && ts.lastGeneration == generation) {
+      return ts.lastIndex;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _index.find(filename);
+    unsigned int idx;
+    if (it != _index.end()) {
+      idx = it->second;
+    } else {
+      if (!_free.empty()) {
+        idx = _free.back();
+        _free.pop_back();
+      } else if (_size < capacity) {
+        idx = _size++;
+      } else {
+        return capacity;
+      }
+      if (ts.marker == nullptr) {
+        ts.marker.reset(new Marker());
+      }
+      _names[idx] = filename;
+      _index.emplace(filename, idx);
+      ts.marker->names.push_back(filename);
+    }
+    ts.lastName = filename;
+    ts.lastIndex = idx;
+    ts.lastGeneration = generation;
+    return idx;
+  }
+  /// Return the filename with index \a idx
+  ASTStringData* name(unsigned int idx) const { return _names[idx]; }
+};
+
+/// Heap memory used by a LocVec in its short layout
+const size_t locvec_bytes = (sizeof(ASTVec) + 7) & ~static_cast<size_t>(7);
+
+}  // namespace
+
+bool& Location::compactModeFlag() {
+#if defined(HAS_DECLSPEC_THREAD)
+  __declspec(thread) static bool compactMode = false;
+#elif defined(HAS_ATTR_THREAD)
+  static __thread bool compactMode = false;
+#else
+#error Need thread-local storage
+#endif
+  return compactMode;
+}
+
+bool& Location::dropLocationsFlag() {
+#if defined(HAS_DECLSPEC_THREAD)
+  __declspec(thread) static bool dropLocations = false;
+#elif defined(HAS_ATTR_THREAD)
+  static __thread bool dropLocations = false;
+#else
+#error Need thread-local storage
+#endif
+  return dropLocations;
+}
+
+void Location::init(const ASTString& filename, unsigned int first_line, unsigned int first_column,
+                    unsigned int last_line, unsigned int last_column) {
+  GC::LocationStats& stats = GC::locationStats();
+  if (dropLocationsFlag()) {
+    _locInfo.lv = nullptr;
+    ++stats.dropped;
+    stats.savedBytes += locvec_bytes;
+    return;
+  }
+  if (sizeof(ptrdiff_t) >= 8 && first_line < (1 << 20) && last_line - first_line < (1 << 8) &&
+      first_column < (1 << 10) && last_column < (1 << 10)) {
+    unsigned long long idx = LocationFileTable::table().index(filename.aststr());
+    if (idx < LocationFileTable::capacity) {
+      unsigned long long t = 2;
+      t |= idx << 2;
+      t |= static_cast<unsigned long long>(first_line) << 16;
+      t |= static_cast<unsigned long long>(last_line - first_line) << 36;
+      t |= static_cast<unsigned long long>(first_column) << 44;
+      t |= static_cast<unsigned long long>(last_column) << 54;
+      _locInfo.t = static_cast<ptrdiff_t>(t);
+      ++stats.compact;
+      stats.savedBytes += locvec_bytes;
+      return;
+    }
+  }
+  _locInfo.lv = LocVec::a(filename, first_line, first_column, last_line, last_column);
+  ++stats.allocated;
+}
+
+ASTString Location::compactFilename() const {
+  return LocationFileTable::table().name(compactField(2, 14));
+}
+
 Location::LocVec* Location::LocVec::a(const ASTString& filename, unsigned int first_line,
                                       unsigned int first_column, unsigned int last_line,
                                       unsigned int last_column) {
@@ -140,6 +316,9 @@ void Location::mark() const {
 }
 
 Location Location::introduce() const {
+  if (compactModeFlag()) {
+    return Location();
+  }
   Location l = *this;
   if (l._locInfo.lv != nullptr) {
     l._locInfo.t |= 1;
@@ -442,6 +621,9 @@ unsigned int ArrayLit::origIdx(unsigned int i) const {
 }
 
 Expression* ArrayLit::getSlice(unsigned int i) const {
+  if (!_flag2 && _u.v->flag2()) {
+    return IntLit::a(progressionFirst() + progressionStep() * static_cast<long long int>(i));
+  }
   if (!_flag2) {
     assert(_u.v->flag());
     int off = static_cast<int>(length()) - static_cast<int>(_u.v->size());
@@ -452,14 +634,25 @@ Expression* ArrayLit::getSlice(unsigned int i) const {
 }
 
 void ArrayLit::setSlice(unsigned int i, Expression* e) {
+  if (!_flag2 && _u.v->flag2()) {
+    if (e == getSlice(i)) {
+      return;
+    }
+    materialise();
+    (*_u.v)[i] = e;
+    return;
+  }
   if (!_flag2) {
     assert(_u.v->flag());
     int off = static_cast<int>(length()) - static_cast<int>(_u.v->size());
-    if (i <= off) {
-      (*_u.v)[0] = e;
-    } else {
-      (*_u.v)[i - off] = e;
+    unsigned int vi = i <= off ? 0 : i - off;
+    if (_u.v->shared()) {
+      if ((*_u.v)[vi] == e) {
+        return;
+      }
+      unshare();
     }
+    (*_u.v)[vi] = e;
   } else {
     assert(_flag2);
     _u.al->set(origIdx(i), e);
@@ -518,6 +711,33 @@ void ArrayLit::compress(const std::vector<Expression*>& v, const std::vector<int
     _u.v = ASTExprVec<Expression>(compress).vec();
     _u.v->flag(true);
     _dims = ASTIntVec(dims);
+  } else if (v.size() >= 4 && Expression::isUnboxedInt(v[0]) && Expression::isUnboxedInt(v[1])) {
+    IntVal prev = IntLit::v(Expression::cast<IntLit>(v[1]));
+    IntVal step = prev - IntLit::v(Expression::cast<IntLit>(v[0]));
+    unsigned int k = 2;
+    for (; k < v.size(); k++) {
+      if (!Expression::isUnboxedInt(v[k])) {
+        break;
+      }
+      IntVal cur = IntLit::v(Expression::cast<IntLit>(v[k]));
+      if (cur - prev != step) {
+        break;
+      }
+      prev = cur;
+    }
+    IntLit* stepLit = Expression::intToUnboxedInt(step.toInt());
+    if (k == v.size() && stepLit != nullptr) {
+      std::vector<Expression*> progression({v[0], stepLit});
+      _u.v = ASTExprVec<Expression>(progression).vec();
+      _u.v->flag(true);
+      _u.v->flag2(true);
+      _dims = ASTIntVec(dims);
+    } else {
+      _u.v = ASTExprVec<Expression>(v).vec();
+      if (dims.size() != 2 || dims[0] != 1) {
+        _dims = ASTIntVec(dims);
+      }
+    }
   } else {
     _u.v = ASTExprVec<Expression>(v).vec();
     if (dims.size() != 2 || dims[0] != 1) {
@@ -542,6 +762,70 @@ ArrayLit::ArrayLit(const Location& loc, const std::vector<Expression*>& v,
   rehash();
 }
 
+ArrayLit* ArrayLit::progression(const Location& loc, IntVal first, IntVal step,
+                               const std::vector<std::pair<int, int>>& dims) {
+  long long int length = 1;
+  for (const auto& d : dims) {
+    length *= std::max(0LL, static_cast<long long int>(d.second) - d.first + 1);
+  }
+  IntVal last = first + step * (length > 0 ? length - 1 : 0);
+  if (length < 4 || step == 0 || !first.isFinite() || !last.isFinite() ||
+      Expression::intToUnboxedInt(first.toInt()) == nullptr ||
+      Expression::intToUnboxedInt(last.toInt()) == nullptr ||
+      Expression::intToUnboxedInt(step.toInt()) == nullptr) {
+    // Same representation as compress would choose for the explicit elements
+    std::vector<Expression*> v(static_cast<size_t>(length));
+    for (long long int i = 0; i < length; i++) {
+      v[i] = IntLit::a(first + step * i);
+    }
+    return new ArrayLit(loc, v, dims);
+  }
+  auto* al = new ArrayLit(loc, std::vector<Expression*>(), dims);
+  std::vector<Expression*> progression({IntLit::a(first), IntLit::a(step)});
+  al->_u.v = ASTExprVec<Expression>(progression).vec();
+  al->_u.v->flag(true);
+  al->_u.v->flag2(true);
+  std::vector<int> d(dims.size() * 2);
+  for (size_t i = dims.size(); (i--) != 0U;) {
+    d[i * 2] = dims[i].first;
+    d[i * 2 + 1] = dims[i].second;
+  }
+  al->_dims = ASTIntVec(d);
+  al->flat(true);
+  al->rehash();
+  return al;
+}
+
+IntVal ArrayLit::progressionFirst() const {
+  assert(isProgression());
+  return IntLit::v(Expression::cast<IntLit>((*_u.v)[0]));
+}
+
+IntVal ArrayLit::progressionStep() const {
+  assert(isProgression());
+  return IntLit::v(Expression::cast<IntLit>((*_u.v)[1]));
+}
+
+void ArrayLit::materialise() {
+  assert(isProgression());
+  std::vector<Expression*> v(length());
+  for (unsigned int i = 0; i < v.size(); i++) {
+    v[i] = getSlice(i);
+  }
+  _u.v = ASTExprVec<Expression>(v).vec();
+}
+
+void ArrayLit::unshare() {
+  assert(!_flag2 && _u.v->shared());
+  std::vector<Expression*> v(_u.v->size());
+  for (unsigned int i = 0; i < v.size(); i++) {
+    v[i] = (*_u.v)[i];
+  }
+  bool compressed = _u.v->flag();
+  _u.v = ASTExprVec<Expression>(v).vec();
+  _u.v->flag(compressed);
+}
+
 void ArrayLit::rehash() {
   initHash();
   std::hash<int> h;
@@ -953,9 +1237,9 @@ void Call::args(const std::vector<Expression*>& args) {
 }
 
 void VarDecl::trail() {
-  GC::trail(&_e, e());
+  GC::trail(&_e, e(), this);
   if (!_ti->ranges().empty()) {
-    GC::trail(reinterpret_cast<Expression**>(&_ti), _ti);
+    GC::trail(reinterpret_cast<Expression**>(&_ti), _ti, this);
   }
 }
 
@@ -1812,6 +2096,10 @@ bool Expression::equalInternal(const Expression* e0, const Expression* e1) {
           return false;
         }
       }
+      if (a0->isProgression() && a1->isProgression()) {
+        return a0->progressionFirst() == a1->progressionFirst() &&
+               a0->progressionStep() == a1->progressionStep();
+      }
       for (unsigned int i = 0; i < a0->size(); i++) {
         if (!Expression::equal((*a0)[i], (*a1)[i])) {
           return false;
@@ -27,6 +27,7 @@
 #include <climits>
 #include <cmath>
 #include <iomanip>
+#include <limits>
 #include <random>
 #include <regex>
 
@@ -2133,12 +2134,20 @@ Expression* b_set2array(EnvI& env, Call* call) {
   assert(call->argCount() == 1);
   GCLock lock;
   IntSetVal* isv = eval_intset(env, call->arg(0));
-  std::vector<Expression*> elems;
-  IntSetRanges isr(isv);
-  for (Ranges::ToValues<IntSetRanges> isr_v(isr); isr_v(); ++isr_v) {
-    elems.push_back(IntLit::a(isr_v.val()));
+  ArrayLit* al;
+  if (isv->size() == 1 && isv->min().isFinite() && isv->max().isFinite() &&
+      isv->card() <= std::numeric_limits<int>::max()) {
+    // A single range is stored as a progression, without allocating its elements
+    std::vector<std::pair<int, int>> dims({{1, static_cast<int>(isv->card().toInt())}});
+    al = ArrayLit::progression(Expression::loc(call->arg(0)), isv->min(), 1, dims);
+  } else {
+    std::vector<Expression*> elems;
+    IntSetRanges isr(isv);
+    for (Ranges::ToValues<IntSetRanges> isr_v(isr); isr_v(); ++isr_v) {
+      elems.push_back(IntLit::a(isr_v.val()));
+    }
+    al = new ArrayLit(Expression::loc(call->arg(0)), elems);
   }
-  auto* al = new ArrayLit(Expression::loc(call->arg(0)), elems);
   Type t(Type::parint(1));
   t.typeId(Expression::type(call->arg(0)).typeId());
   al->type(t);
@@ -3339,8 +3348,6 @@ Expression* b_slice(EnvI& env, Call* call) {
 }
 
 Expression* b_regular_from_string(EnvI& env, Call* call) {
-#ifdef HAS_GECODE
-  using namespace Gecode;
   ArrayLit* vars = eval_array_lit(env, call->arg(0));
   std::string expr = eval_string(env, call->arg(1));
 
@@ -3459,27 +3466,19 @@ Expression* b_regular_from_string(EnvI& env, Call* call) {
     expr = oss.str();
   }
 
-  std::unique_ptr<REG> regex;
+  std::unique_ptr<RegexNode> regex;
   try {
     regex = regex_from_string(expr, *dom);
   } catch (const std::exception& e) {
     throw SyntaxError(Expression::loc(call->arg(1)), e.what());
   }
-  DFA dfa = DFA(*regex);
+  RegexDFA dfa = dom->empty() ? RegexDFA(*regex, 0, -1)
+                              : RegexDFA(*regex, static_cast<int>(dom->min().toInt()),
+                                         static_cast<int>(dom->max().toInt()));
 
-  std::vector<std::vector<Expression*>> reg_trans(
-      dfa.n_states(), std::vector<Expression*>(static_cast<size_t>(card), IntLit::a(IntVal(0))));
-
-  DFA::Transitions trans(dfa);
-  while (trans()) {
-    //      std::cerr << trans.i_state() + 1 << " -- " << trans.symbol() << " --> " <<
-    //      trans.o_state() + 1 << "\n";
-    if (!dom->empty() && trans.symbol() >= dom->min().toInt() &&
-        trans.symbol() <= dom->max().toInt()) {
-      reg_trans[trans.i_state()][trans.symbol() + offset - 1] =
-          IntLit::a(IntVal(trans.o_state() + 1));
-    }
-    ++trans;
+  std::vector<Expression*> reg_trans(dfa.table().size());
+  for (size_t i = 0; i < reg_trans.size(); i++) {
+    reg_trans[i] = IntLit::a(IntVal(dfa.table()[i]));
   }
 
   std::vector<Expression*> args(6);
@@ -3495,27 +3494,23 @@ Expression* b_regular_from_string(EnvI& env, Call* call) {
     args[0] = new ArrayLit(Expression::loc(call).introduce(), nvars);  // x
     Expression::type(args[0], Type::varint(1));
   }
-  args[1] = IntLit::a(IntVal(dfa.n_states()));  // Q
+  args[1] = IntLit::a(IntVal(dfa.nStates()));  // Q
   Expression::type(args[1], Type::parint());
   args[2] = IntLit::a(IntVal(card));  // S
   Expression::type(args[2], Type::parint());
-  args[3] = new ArrayLit(Expression::loc(call).introduce(), reg_trans);  // d
+  args[3] = new ArrayLit(Expression::loc(call).introduce(), reg_trans,
+                         {{1, dfa.nStates()}, {1, static_cast<int>(card)}});  // d
   Expression::type(args[3], Type::parint(2));
   args[4] = IntLit::a(IntVal(1));  // q0
   Expression::type(args[4], Type::parint());
   args[5] = new SetLit(Expression::loc(call).introduce(),
-                       IntSetVal::a(IntVal(dfa.final_fst() + 1), IntVal(dfa.final_lst())));  // F
+                       IntSetVal::a(IntVal(dfa.finalFirst()), IntVal(dfa.finalLast())));  // F
   Expression::type(args[5], Type::parsetint());
 
   auto* nc = Call::a(Expression::loc(call).introduce(), "regular", args);
   nc->type(Type::varbool());
 
   return nc;
-#else
-  throw FlatteningError(
-      env, Expression::loc(call),
-      "MiniZinc was compiled without built-in Gecode, cannot parse regular expression");
-#endif
 }
 
 Expression* b_show_checker_output(EnvI& env, Call* call) {
@@ -1,4 +1,4 @@
 set(lexer_lxx_md5_cached "c241581e149ddcc3c3eeb458883c40af")
 set(parser_yxx_md5_cached "a1a3ad0d5717f0cc50417099ff2ae02f")
 set(regex_lexer_lxx_md5_cached "8906a52bfa0c5ae26354cb272348e656")
-set(regex_parser_yxx_md5_cached "68ec070becef5e161c3b97d085b0810e")
\ No newline at end of file
+set(regex_parser_yxx_md5_cached "dae6495c3300a860646a7e48dd238808")
\ No newline at end of file
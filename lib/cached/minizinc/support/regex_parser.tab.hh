@@ -82,7 +82,7 @@ union YYSTYPE
   int iValue;
   char* sValue;
   std::set<int>* setValue;
-  Gecode::REG* rValue;
+  MiniZinc::RegexNode* rValue;
 
 
 };
@@ -81,7 +81,9 @@
 
 #include <minizinc/support/regex.hh>
 
-using namespace Gecode;
+#include <algorithm>
+#include <iterator>
+
 using namespace MiniZinc;
 
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
@@ -91,7 +93,7 @@ extern int yylex();
 extern FILE* yyin;
 
 typedef struct REContext{
-  REG* expr;
+  RegexNode* expr;
   const IntSetVal& dom;
 } REContext;
 
@@ -538,9 +540,9 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    71,    71,    78,    79,    87,    88,    96,    97,   102,
-     107,   112,   117,   122,   129,   131,   136,   146,   161,   165,
-     166,   176,   180
+       0,    73,    73,    79,    80,    86,    87,    93,    94,    96,
+      98,   100,   102,   104,   108,   110,   118,   128,   143,   147,
+     148,   158,   162
 };
 #endif
 
@@ -1119,77 +1121,57 @@ yyreduce:
     {
   case 2: /* regex: expression  */
   {
-    *ctx.expr = (*(yyvsp[0].rValue));
-    delete (yyvsp[0].rValue);
+    ctx.expr = (yyvsp[0].rValue);
   }
     break;
 
   case 4: /* expression: term "|" expression  */
     {
-      *(yyvsp[-2].rValue) = *(yyvsp[-2].rValue) | *(yyvsp[0].rValue);
-      delete (yyvsp[0].rValue);
-      (yyval.rValue) = (yyvsp[-2].rValue);
+      (yyval.rValue) = new RegexNode(RegexNode::RK_UNION, (yyvsp[-2].rValue), (yyvsp[0].rValue));
     }
     break;
 
   case 6: /* term: factor term  */
     {
-      *(yyvsp[-1].rValue) = *(yyvsp[-1].rValue) + *(yyvsp[0].rValue);
-      delete (yyvsp[0].rValue);
-      (yyval.rValue) = (yyvsp[-1].rValue);
+      (yyval.rValue) = new RegexNode(RegexNode::RK_CONCAT, (yyvsp[-1].rValue), (yyvsp[0].rValue));
     }
     break;
 
   case 8: /* factor: atom "*"  */
-    {
-      *(yyvsp[-1].rValue) = *(*(yyvsp[-1].rValue));
-      (yyval.rValue) = (yyvsp[-1].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-1].rValue), 0, -1); }
     break;
 
   case 9: /* factor: atom "+"  */
-    {
-      *(yyvsp[-1].rValue) = +(*(yyvsp[-1].rValue));
-      (yyval.rValue) = (yyvsp[-1].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-1].rValue), 1, -1); }
     break;
 
   case 10: /* factor: atom "?"  */
-    {
-      *(yyvsp[-1].rValue) = (*(yyvsp[-1].rValue))(0, 1);
-      (yyval.rValue) = (yyvsp[-1].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-1].rValue), 0, 1); }
     break;
 
   case 11: /* factor: atom "{" R_INTEGER "}"  */
-    {
-      *(yyvsp[-3].rValue) = (*(yyvsp[-3].rValue))((yyvsp[-1].iValue), (yyvsp[-1].iValue));
-      (yyval.rValue) = (yyvsp[-3].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-3].rValue), (yyvsp[-1].iValue), (yyvsp[-1].iValue)); }
     break;
 
   case 12: /* factor: atom "{" R_INTEGER "," "}"  */
-    {
-      *(yyvsp[-4].rValue) = (*(yyvsp[-4].rValue))((yyvsp[-2].iValue));
-      (yyval.rValue) = (yyvsp[-4].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-4].rValue), (yyvsp[-2].iValue), -1); }
     break;
 
   case 13: /* factor: atom "{" R_INTEGER "," R_INTEGER "}"  */
-    {
-      *(yyvsp[-5].rValue) = (*(yyvsp[-5].rValue))((yyvsp[-3].iValue), (yyvsp[-1].iValue));
-      (yyval.rValue) = (yyvsp[-5].rValue);
-    }
+    { (yyval.rValue) = new RegexNode((yyvsp[-5].rValue), (yyvsp[-3].iValue), (yyvsp[-1].iValue)); }
     break;
 
   case 14: /* atom: R_INTEGER  */
-    { (yyval.rValue) = new REG((yyvsp[0].iValue)); }
+    { (yyval.rValue) = new RegexNode(std::vector<int>({(yyvsp[0].iValue)})); }
     break;
 
   case 15: /* atom: "."  */
     {
-      IntArgs range = IntArgs::create(ctx.dom.max().toInt() - ctx.dom.min().toInt() + 1, ctx.dom.min().toInt());
-      (yyval.rValue) = new REG(range);
+      std::vector<int> range;
+      for(int i = ctx.dom.min().toInt(); i<=ctx.dom.max().toInt(); ++i) {
+        range.push_back(i);
+      }
+      (yyval.rValue) = new RegexNode(std::move(range));
     }
     break;
 
@@ -1201,7 +1183,7 @@ yyreduce:
         v.push_back(i);
       }
       delete (yyvsp[-1].setValue);
-      (yyval.rValue) = new REG(IntArgs(v));
+      (yyval.rValue) = new RegexNode(std::move(v));
     }
     break;
 
@@ -1218,7 +1200,7 @@ yyreduce:
         std::inserter(diff, diff.begin())
       );
       delete (yyvsp[-1].setValue);
-      (yyval.rValue) = new REG(IntArgs(diff));
+      (yyval.rValue) = new RegexNode(std::move(diff));
     }
     break;
 
@@ -1456,13 +1438,12 @@ void yyerror(REContext& ctx, const char* s) {
     throw std::runtime_error("Cannot parse regular expression: " + std::string(s));
 }
 
-std::unique_ptr<REG> regex_from_string(const std::string& regex_str, const IntSetVal& domain) {
-    REG* expr = new REG();
+std::unique_ptr<RegexNode> regex_from_string(const std::string& regex_str, const IntSetVal& domain) {
     regex_yy_scan_string(regex_str.c_str());
-    REContext rctx = REContext{expr, domain};
+    REContext rctx = REContext{nullptr, domain};
     int err = yyparse(rctx);
     if (err != 0) {
         throw std::runtime_error("Cannot parse regular expression, error code " + std::to_string(err));
     }
-    return std::unique_ptr<REG>(expr);
+    return std::unique_ptr<RegexNode>(rctx.expr);
 }
@@ -14,22 +14,40 @@
 
 namespace MiniZinc {
 
+void CopyMap::buildRevNodeMap() {
+  // Map nodes that are their own copy (e.g. copied variable declarations) back to their
+  // originals rather than to themselves
+  for (const auto& it : _nodeMap) {
+    if (it.first != it.second) {
+      _revNodeMap.insert(it.second, it.first);
+    }
+  }
+  for (const auto& it : _nodeMap) {
+    if (it.first == it.second) {
+      _revNodeMap.insert(it.second, it.first);
+    }
+  }
+  _hasRevNodeMap = true;
+}
+
 void CopyMap::insert(Expression* e0, Expression* e1) {
   if (!Expression::isUnboxedVal(e0) && !Expression::isUnboxedVal(e1)) {
     _nodeMap.insert(e0, e1);
-    _revNodeMap.insert(e1, e0);
+    if (_hasRevNodeMap) {
+      _revNodeMap.insert(e1, e0);
+    }
   }
 }
 Expression* CopyMap::find(Expression* e) { return static_cast<Expression*>(_nodeMap.find(e)); }
-Expression* CopyMap::findOrig(Expression* e) {
-  return static_cast<Expression*>(_revNodeMap.find(e));
-}
+Expression* CopyMap::findOrig(Expression* e) { return static_cast<Expression*>(findOrigNode(e)); }
 void CopyMap::insert(Item* e0, Item* e1) {
   _nodeMap.insert(e0, e1);
-  _revNodeMap.insert(e1, e0);
+  if (_hasRevNodeMap) {
+    _revNodeMap.insert(e1, e0);
+  }
 }
 Item* CopyMap::find(Item* e) { return static_cast<Item*>(_nodeMap.find(e)); }
-Item* CopyMap::findOrig(Item* e) { return static_cast<Item*>(_revNodeMap.find(e)); }
+Item* CopyMap::findOrig(Item* e) { return static_cast<Item*>(findOrigNode(e)); }
 void CopyMap::insert(Model* e0, Model* e1) { _modelMap.insert(std::make_pair(e0, e1)); }
 Model* CopyMap::find(Model* e) {
   auto it = _modelMap.find(e);
@@ -40,17 +58,21 @@ Model* CopyMap::find(Model* e) {
 }
 void CopyMap::insert(IntSetVal* e0, IntSetVal* e1) {
   _nodeMap.insert(e0, e1);
-  _revNodeMap.insert(e1, e0);
+  if (_hasRevNodeMap) {
+    _revNodeMap.insert(e1, e0);
+  }
 }
 IntSetVal* CopyMap::find(IntSetVal* e) { return static_cast<IntSetVal*>(_nodeMap.find(e)); }
-IntSetVal* CopyMap::findOrig(IntSetVal* e) { return static_cast<IntSetVal*>(_revNodeMap.find(e)); }
+IntSetVal* CopyMap::findOrig(IntSetVal* e) { return static_cast<IntSetVal*>(findOrigNode(e)); }
 void CopyMap::insert(FloatSetVal* e0, FloatSetVal* e1) {
   _nodeMap.insert(e0, e1);
-  _revNodeMap.insert(e1, e0);
+  if (_hasRevNodeMap) {
+    _revNodeMap.insert(e1, e0);
+  }
 }
 FloatSetVal* CopyMap::find(FloatSetVal* e) { return static_cast<FloatSetVal*>(_nodeMap.find(e)); }
 FloatSetVal* CopyMap::findOrig(FloatSetVal* e) {
-  return static_cast<FloatSetVal*>(_revNodeMap.find(e));
+  return static_cast<FloatSetVal*>(findOrigNode(e));
 }
 
 Location copy_location(CopyMap& m, const Location& _loc) { return _loc; }
@@ -60,6 +82,40 @@ Location copy_location(CopyMap& m, Item* i) { return copy_location(m, i->loc());
 void copy_ann(EnvI& env, CopyMap& m, Annotation& oldAnn, Annotation& newAnn, bool followIds,
               bool copyFundecls, bool isFlatModel);
 
+/// Whether \a v is uncompressed and all its elements are literals that copy() would return
+/// unchanged
+bool is_shared_literal_vec(const ASTExprVec<Expression>& v) {
+  if (v.vec()->flag() || v.vec()->flag2()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < v.size(); i++) {
+    Expression* e = v[i];
+    if (e == nullptr) {
+      return false;
+    }
+    if (Expression::isUnboxedVal(e) || e == Constants::constants().absent) {
+      continue;
+    }
+    switch (Expression::eid(e)) {
+      case Expression::E_BOOLLIT:
+        break;
+      case Expression::E_INTLIT:
+        if (IntLit::a(IntLit::v(Expression::cast<IntLit>(e))) != e) {
+          return false;
+        }
+        break;
+      case Expression::E_FLOATLIT:
+        if (FloatLit::a(FloatLit::v(Expression::cast<FloatLit>(e))) != e) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
 Expression* copy(EnvI& env, CopyMap& m, Expression* e, bool followIds, bool copyFundecls,
                  bool isFlatModel) {
   if (e == nullptr) {
@@ -72,38 +128,27 @@ Expression* copy(EnvI& env, CopyMap& m, Expression* e, bool followIds, bool copy
   switch (Expression::eid(e)) {
     case Expression::E_INTLIT: {
       IntLit* c = IntLit::a(IntLit::v(Expression::cast<IntLit>(e)));
-      m.insert(e, c);
+      if (c != e) {
+        m.insert(e, c);
+      }
       ret = c;
     } break;
     case Expression::E_FLOATLIT: {
       FloatLit* c = FloatLit::a(FloatLit::v(Expression::cast<FloatLit>(e)));
-      m.insert(e, c);
+      if (c != e) {
+        m.insert(e, c);
+      }
       ret = c;
     } break;
     case Expression::E_SETLIT: {
       auto* s = Expression::cast<SetLit>(e);
       auto* c = new SetLit(copy_location(m, e), static_cast<IntSetVal*>(nullptr));
       m.insert(e, c);
+      // Set values are immutable, so they are shared with the copy
       if (s->isv() != nullptr) {
-        IntSetVal* isv;
-        if (IntSetVal* isvc = m.find(s->isv())) {
-          isv = isvc;
-        } else {
-          IntSetRanges r(s->isv());
-          isv = IntSetVal::ai(r);
-          m.insert(s->isv(), isv);
-        }
-        c->isv(isv);
+        c->isv(s->isv());
       } else if (s->fsv() != nullptr) {
-        FloatSetVal* fsv;
-        if (FloatSetVal* fsvc = m.find(s->fsv())) {
-          fsv = fsvc;
-        } else {
-          FloatSetRanges r(s->fsv());
-          fsv = FloatSetVal::ai(r);
-          m.insert(s->fsv(), fsv);
-        }
-        c->fsv(fsv);
+        c->fsv(s->fsv());
       } else {
         if (ASTExprVecO<Expression*>* ve = m.find(s->v())) {
           c->v(ASTExprVec<Expression>(ve));
@@ -216,6 +261,11 @@ Expression* copy(EnvI& env, CopyMap& m, Expression* e, bool followIds, bool copy
                                dims, slice);
         m.insert(e, c);
         ret = c;
+      } else if (al->isProgression()) {
+        auto* c = ArrayLit::progression(copy_location(m, e), al->progressionFirst(),
+                                        al->progressionStep(), dims);
+        m.insert(e, c);
+        ret = c;
       } else {
         ArrayLit* c;
         if (al->isTuple()) {
@@ -228,6 +278,10 @@ Expression* copy(EnvI& env, CopyMap& m, Expression* e, bool followIds, bool copy
         ASTExprVecO<Expression*>* v;
         if (ASTExprVecO<Expression*>* cv = m.find(al->getVec())) {
           v = cv;
+        } else if (is_shared_literal_vec(al->getVec())) {
+          // Both arrays use the same elements until one of them is changed (see ArrayLit::set)
+          v = al->getVec().vec();
+          v->shared(true);
         } else {
           std::vector<Expression*> elems(al->size());
           for (unsigned int i = al->size(); (i--) != 0U;) {
@@ -20,10 +20,12 @@
 #include <minizinc/gc.hh>
 #include <minizinc/hash.hh>
 #include <minizinc/iter.hh>
+#include <minizinc/parallel_comp.hh>
 #include <minizinc/typecheck.hh>
 
 #include <cassert>
 #include <cmath>
+#include <limits>
 
 namespace MiniZinc {
 
@@ -700,11 +702,88 @@ Expression* eval_fieldaccess(EnvI& env, FieldAccess* fa) {
   return (*al)[i.toInt() - 1];
 }
 
+/// Evaluate a comprehension of the form [i | i in S] for a par set S of integers, without
+/// evaluating the generator body. Returns nullptr if \a e does not have this form.
+ArrayLit* eval_range_comp(EnvI& env, Comprehension* e) {
+  if (e->numberOfGenerators() != 1 || e->numberOfDecls(0) != 1 || e->in(0) == nullptr ||
+      e->where(0) != nullptr) {
+    return nullptr;
+  }
+  auto* ident = Expression::dynamicCast<Id>(e->e());
+  if (ident == nullptr || ident->decl() != e->decl(0, 0)) {
+    return nullptr;
+  }
+  Type inType = Expression::type(e->in(0));
+  if (inType.dim() != 0 || !inType.isPar() || inType.cv()) {
+    return nullptr;
+  }
+  GCLock lock;
+  IntSetVal* isv = eval_intset(env, e->in(0));
+  if (!isv->empty() && (!isv->min().isFinite() || !isv->max().isFinite())) {
+    return nullptr;
+  }
+  IntVal card = isv->card();
+  if (card > std::numeric_limits<int>::max()) {
+    return nullptr;
+  }
+  std::vector<std::pair<int, int>> dims({{1, static_cast<int>(card.toInt())}});
+  if (isv->size() == 1) {
+    return ArrayLit::progression(Expression::loc(e), isv->min(), 1, dims);
+  }
+  std::vector<Expression*> elems;
+  elems.reserve(static_cast<size_t>(card.toInt()));
+  IntSetRanges isr(isv);
+  for (Ranges::ToValues<IntSetRanges> isr_v(isr); isr_v(); ++isr_v) {
+    elems.push_back(IntLit::a(isr_v.val()));
+  }
+  return new ArrayLit(Expression::loc(e), elems, dims);
+}
+
+/// Evaluate comprehension \a e on several threads (see eval_comp_parallel). Returns nullptr
+/// if \a e has to be evaluated sequentially.
+ArrayLit* eval_parallel_comp(EnvI& env, Comprehension* e) {
+  if (env.fopts.comprehensionThreads == 1) {
+    return nullptr;
+  }
+  ParallelCompValues values;
+  if (!eval_comp_parallel(env, e, values)) {
+    return nullptr;
+  }
+  std::vector<Expression*> elems;
+  switch (values.bt) {
+    case Type::BT_FLOAT:
+      elems.reserve(values.floats.size());
+      for (const auto& f : values.floats) {
+        elems.push_back(FloatLit::a(f));
+      }
+      break;
+    case Type::BT_BOOL:
+      elems.reserve(values.ints.size());
+      for (const auto& b : values.ints) {
+        elems.push_back(env.constants.boollit(b != 0));
+      }
+      break;
+    default:
+      elems.reserve(values.ints.size());
+      for (const auto& i : values.ints) {
+        elems.push_back(IntLit::a(i));
+      }
+      break;
+  }
+  std::vector<std::pair<int, int>> dims({{1, static_cast<int>(elems.size())}});
+  return new ArrayLit(Expression::loc(e), elems, dims);
+}
+
 ArrayLit* eval_array_comp(EnvI& env, Comprehension* e) {
   ArrayLit* ret;
   bool plainParNonAbsent = e->type().ti() == Type::TI_PAR && e->type().st() == Type::ST_PLAIN &&
                            e->type().ot() == Type::OT_PRESENT;
-  if (plainParNonAbsent && e->type().bt() == Type::BT_INT) {
+  if (plainParNonAbsent && e->type().bt() == Type::BT_INT && !e->set() &&
+      (ret = eval_range_comp(env, e)) != nullptr) {
+    // Range comprehension, evaluated without generating its elements
+  } else if (plainParNonAbsent && !e->set() && (ret = eval_parallel_comp(env, e)) != nullptr) {
+    // Evaluated in parallel
+  } else if (plainParNonAbsent && e->type().bt() == Type::BT_INT) {
     auto a = eval_comp<EvalIntLit>(env, e);
     ret = new ArrayLit(Expression::loc(e), a.a, a.dims);
   } else if (plainParNonAbsent && e->type().bt() == Type::BT_BOOL) {
@@ -2594,11 +2673,47 @@ public:
     valid = false;
     bounds.emplace_back(0, 0);
   }
+  /// Compute bounds of the definition of \a vd, memoised for top-level variables
+  void vDefinition(VarDecl* vd) {
+    if (!vd->toplevel()) {
+      BottomUpIterator<ComputeIntBounds> cbi(*this);
+      cbi.run(vd->e());
+      return;
+    }
+    auto& memo = env.boundsMemo;
+    if (memo.revision != GC::revision()) {
+      memo.ints.clear();
+      memo.floats.clear();
+      memo.revision = GC::revision();
+    }
+    auto it = memo.ints.find(vd);
+    if (it != memo.ints.end()) {
+      env.counters.boundsMemoHits++;
+      valid = valid && it->second.valid;
+      bounds.emplace_back(it->second.l, it->second.u);
+      return;
+    }
+    env.counters.boundsMemoMisses++;
+    bool outerValid = valid;
+    size_t n = bounds.size();
+    unsigned long long revision = memo.revision;
+    valid = true;
+    BottomUpIterator<ComputeIntBounds> cbi(*this);
+    cbi.run(vd->e());
+    // All declarations the result depends on are watched, so it stays valid until the
+    // revision changes (a change during the computation may have unwatched some of them)
+    if (bounds.size() == n + 1 && revision == GC::revision()) {
+      memo.ints.emplace(vd, IntBounds(bounds.back().first, bounds.back().second, valid));
+    }
+    valid = valid && outerValid;
+  }
   /// Visit identifier
   void vId(const Id* id) {
     VarDecl* vd = id->decl();
+    vd->watch();
     while ((vd->flat() != nullptr) && vd->flat() != vd) {
       vd = vd->flat();
+      vd->watch();
     }
     if (vd->ti()->domain() != nullptr) {
       GCLock lock;
@@ -2611,8 +2726,7 @@ public:
       }
     } else {
       if (vd->e() != nullptr) {
-        BottomUpIterator<ComputeIntBounds> cbi(*this);
-        cbi.run(vd->e());
+        vDefinition(vd);
       } else {
         bounds.emplace_back(-IntVal::infinity(), IntVal::infinity());
       }
@@ -2635,8 +2749,10 @@ public:
       }
     }
     if (Id* id = Expression::dynamicCast<Id>(aa->v())) {
+      id->decl()->watch();
       while ((id->decl()->e() != nullptr) && Expression::isa<Id>(id->decl()->e())) {
         id = Expression::cast<Id>(id->decl()->e());
+        id->decl()->watch();
       }
       if (parAccess && (id->decl()->e() != nullptr)) {
         ArrayAccessSucess success;
@@ -2798,41 +2914,48 @@ public:
         }
       }
       assert(stacktop + al->size() == bounds.size());
+      // Bounds of the terms that contribute to the lower and upper bound of the sum, processed
+      // in chunks so that no memory needs to be allocated
+      const unsigned int chunkSize = 64;
+      IntVal cvs[chunkSize];
+      IntVal lbs[chunkSize];
+      IntVal ubs[chunkSize];
       IntVal lb = d;
       IntVal ub = d;
-      for (unsigned int i = 0; i < al->size(); i++) {
-        Bounds b = bounds.back();
-        bounds.pop_back();
-        IntVal cv = le ? eval_int(env, (*coeff)[i]) : 1;
-        if (cv > 0) {
-          if (b.first.isFinite()) {
-            if (lb.isFinite()) {
-              lb += cv * b.first;
-            }
-          } else {
-            lb = b.first;
+      for (unsigned int start = 0; start < al->size(); start += chunkSize) {
+        const unsigned int n = std::min(chunkSize, al->size() - start);
+        bool finite = true;
+        for (unsigned int i = 0; i < n; i++) {
+          Bounds b = bounds.back();
+          bounds.pop_back();
+          cvs[i] = le ? eval_int(env, (*coeff)[start + i]) : 1;
+          lbs[i] = cvs[i] > 0 ? b.first : b.second;
+          ubs[i] = cvs[i] > 0 ? b.second : b.first;
+          finite = finite && lbs[i].isFinite() && ubs[i].isFinite();
+        }
+        if (finite) {
+          if (lb.isFinite()) {
+            lb = IntVal::linear(cvs, lbs, n, lb);
           }
-          if (b.second.isFinite()) {
-            if (ub.isFinite()) {
-              ub += cv * b.second;
-            }
-          } else {
-            ub = b.second;
+          if (ub.isFinite()) {
+            ub = IntVal::linear(cvs, ubs, n, ub);
           }
-        } else {
-          if (b.second.isFinite()) {
+          continue;
+        }
+        for (unsigned int i = 0; i < n; i++) {
+          if (lbs[i].isFinite()) {
             if (lb.isFinite()) {
-              lb += cv * b.second;
+              lb += cvs[i] * lbs[i];
             }
           } else {
-            lb = -b.second;
+            lb = cvs[i] > 0 ? lbs[i] : -lbs[i];
           }
-          if (b.first.isFinite()) {
+          if (ubs[i].isFinite()) {
             if (ub.isFinite()) {
-              ub += cv * b.first;
+              ub += cvs[i] * ubs[i];
             }
           } else {
-            ub = -b.first;
+            ub = cvs[i] > 0 ? ubs[i] : -ubs[i];
           }
         }
       }
@@ -3042,11 +3165,45 @@ public:
     valid = false;
     bounds.emplace_back(0.0, 0.0);
   }
+  /// Compute bounds of the definition of \a vd, memoised for top-level variables
+  void vDefinition(VarDecl* vd) {
+    if (!vd->toplevel()) {
+      BottomUpIterator<ComputeFloatBounds> cbi(*this);
+      cbi.run(vd->e());
+      return;
+    }
+    auto& memo = env.boundsMemo;
+    if (memo.revision != GC::revision()) {
+      memo.ints.clear();
+      memo.floats.clear();
+      memo.revision = GC::revision();
+    }
+    auto it = memo.floats.find(vd);
+    if (it != memo.floats.end()) {
+      env.counters.boundsMemoHits++;
+      valid = valid && it->second.valid;
+      bounds.emplace_back(it->second.l, it->second.u);
+      return;
+    }
+    env.counters.boundsMemoMisses++;
+    bool outerValid = valid;
+    size_t n = bounds.size();
+    unsigned long long revision = memo.revision;
+    valid = true;
+    BottomUpIterator<ComputeFloatBounds> cbi(*this);
+    cbi.run(vd->e());
+    if (bounds.size() == n + 1 && revision == GC::revision()) {
+      memo.floats.emplace(vd, FloatBounds(bounds.back().first, bounds.back().second, valid));
+    }
+    valid = valid && outerValid;
+  }
   /// Visit identifier
   void vId(const Id* id) {
     VarDecl* vd = id->decl();
+    vd->watch();
     while ((vd->flat() != nullptr) && vd->flat() != vd) {
       vd = vd->flat();
+      vd->watch();
     }
     if (vd->ti()->domain() != nullptr) {
       GCLock lock;
@@ -3059,8 +3216,7 @@ public:
       }
     } else {
       if (vd->e() != nullptr) {
-        BottomUpIterator<ComputeFloatBounds> cbi(*this);
-        cbi.run(vd->e());
+        vDefinition(vd);
       } else {
         bounds.emplace_back(-FloatVal::infinity(), FloatVal::infinity());
       }
@@ -3082,8 +3238,10 @@ public:
       }
     }
     if (Id* id = Expression::dynamicCast<Id>(aa->v())) {
+      id->decl()->watch();
       while ((id->decl()->e() != nullptr) && Expression::isa<Id>(id->decl()->e())) {
         id = Expression::cast<Id>(id->decl()->e());
+        id->decl()->watch();
       }
       if (parAccess && (id->decl()->e() != nullptr)) {
         ArrayAccessSucess success;
@@ -748,12 +748,25 @@ VarDecl* new_vardecl(EnvI& env, const Ctx& ctx, TypeInst* ti, Id* origId, VarDec
           }
         }
       } else {
-        // Create new VarDecl and add it to the maps
+        VarPathStore::DomainTable& domainTable = env.varPathStore.getDomainTable();
+        auto dit = domainTable.find(path);
         vd = new VarDecl(get_loc(env, origVd, rhs), ti, get_id(env, origId));
         hasBeenAdded = false;
-        VarPathStore::PathVar vd_tup{vd, env.multiPassInfo.currentPassNumber};
-        pathMap[path] = vd_tup;
-        reversePathMap.insert(vd, path);
+        if (dit != domainTable.end()) {
+          // Variable of a previous pass, use its domain
+          update_bounds(env, Expression::cast<VarDecl>(dit->second.decl()), vd);
+          if (!dit->second.alias.empty()) {
+            VarPathStore::PathVar vd_tup{vd, env.multiPassInfo.currentPassNumber};
+            pathMap[path] = vd_tup;
+            pathMap[dit->second.alias] = vd_tup;
+            reversePathMap.insert(vd, path);
+          }
+        } else {
+          // Add new VarDecl to the maps
+          VarPathStore::PathVar vd_tup{vd, env.multiPassInfo.currentPassNumber};
+          pathMap[path] = vd_tup;
+          reversePathMap.insert(vd, path);
+        }
       }
     }
   }
@@ -976,7 +989,7 @@ EnvI::EnvI(Model* model0, std::ostream& outstream0, std::ostream& errstream0)
       inMaybePartial(0),
       inTraceExp(false),
       inReverseMapVar(false),
-      counters({0, 0, 0, 0}),
+      counters({0, 0, 0, 0, 0, 0}),
       _flat(new Model),
       _failed(false),
       _ids(0),
@@ -1213,12 +1226,78 @@ ArrayLit* EnvI::createAnnotationArray(const BCtx& ctx) {
   return al;
 }
 
+namespace {
+/// A declaration with the domain and fixed value of \a vd, which does not refer to any other
+/// declaration of the model that \a vd belongs to
+VarDecl* path_domain_decl(EnvI& env, VarDecl* vd) {
+  Expression* dom = vd->ti()->domain();
+  Expression* val = vd->e();
+  // Bounds of a variable that is fixed or unified with another one are only known now
+  bool follow = (val != nullptr || vd->id()->decl() != vd) && (dom != nullptr || val != nullptr);
+  Type t = vd->type();
+  if (t.isint()) {
+    t = Type::varint();
+    if (follow) {
+      IntBounds b = compute_int_bounds(env, vd->id());
+      if (b.valid && b.l.isFinite() && b.u.isFinite()) {
+        if (dom != nullptr && b.l != b.u) {
+          IntSetRanges dr(eval_intset(env, dom));
+          Ranges::Const<IntVal> br(b.l, b.u);
+          Ranges::Inter<IntVal, IntSetRanges, Ranges::Const<IntVal>> inter(dr, br);
+          dom = new SetLit(Location().introduce(), IntSetVal::ai(inter));
+        } else {
+          dom = new SetLit(Location().introduce(), IntSetVal::a(b.l, b.u));
+        }
+      }
+      val = nullptr;
+    }
+  } else if (t.isfloat()) {
+    t = Type::varfloat();
+    if (follow) {
+      FloatBounds b = compute_float_bounds(env, vd->id());
+      if (b.valid && (dom == nullptr || b.l == b.u)) {
+        dom = new SetLit(Location().introduce(), FloatSetVal::a(b.l, b.u));
+      }
+      val = nullptr;
+    }
+  } else if (t.isbool()) {
+    t = Type::varbool();
+    if (val != nullptr && !Expression::isa<BoolLit>(val)) {
+      val = nullptr;
+    }
+  } else {
+    dom = nullptr;
+    val = nullptr;
+  }
+  return new VarDecl(Location().introduce(), new TypeInst(Location().introduce(), t, dom),
+                     vd->id(), val);
+}
+}  // namespace
+
 void EnvI::copyPathMapsAndState(EnvI& env) {
   multiPassInfo.finalPassNumber = env.multiPassInfo.finalPassNumber;
   multiPassInfo.currentPassNumber = env.multiPassInfo.currentPassNumber;
 
-  varPathStore.pathMap = env.varPathStore.getPathMap();
-  varPathStore.reversePathMap = env.varPathStore.getReversePathMap();
+  // Only the domains of the variables of previous passes are used from now on, so they are kept
+  // in a table instead of the variables themselves, which would keep their flat model alive
+  GCLock lock;
+  varPathStore.domainTable = env.varPathStore.getDomainTable();
+  VarPathStore::ReversePathMap& reversePathMap = env.varPathStore.getReversePathMap();
+  for (auto& it : env.varPathStore.getPathMap()) {
+    auto* vd = Expression::dynamicCast<VarDecl>(it.second.decl());
+    if (vd == nullptr) {
+      continue;
+    }
+    VarPathStore::PathDomain pd{path_domain_decl(env, vd), ""};
+    // Check whether vd was unified
+    if (vd->id() != vd->id()->decl()->id()) {
+      auto aliasIt = reversePathMap.find(vd->id()->decl());
+      if (aliasIt != reversePathMap.end()) {
+        pd.alias = aliasIt->second;
+      }
+    }
+    varPathStore.domainTable[it.first] = pd;
+  }
 
   varPathStore.filenameSet = env.varPathStore.filenameSet;
   varPathStore.maxPathDepth = env.varPathStore.maxPathDepth;
@@ -5445,6 +5524,13 @@ void oldflatzinc(Env& e) {
   } _cmp;
   // Perform final sorting
   std::stable_sort(m->begin(), m->end(), _cmp);
+
+  // Number the declarations densely, so that solvers can map them to their variables
+  // using vectors (see FlatIdMap)
+  int vdIndex = 0;
+  for (VarDeclIterator it = m->vardecls().begin(); it != m->vardecls().end(); ++it) {
+    it->e()->payload(vdIndex++);
+  }
 }
 
 FlatModelStatistics statistics(Env& m) {
@@ -5454,6 +5540,8 @@ FlatModelStatistics statistics(Env& m) {
   stats.n_imp_ct = m.envi().counters.impConstraints;
   stats.n_imp_del = m.envi().counters.impDel;
   stats.n_lin_del = m.envi().counters.linDel;
+  stats.n_bounds_memo_hits = m.envi().counters.boundsMemoHits;
+  stats.n_bounds_memo_misses = m.envi().counters.boundsMemoMisses;
   for (auto& i : *flat) {
     if (!i->removed()) {
       if (auto* vdi = i->dynamicCast<VarDeclI>()) {
@@ -177,22 +177,42 @@ start_flatten_arrayaccess:
     if (Expression::type(aa_inner->v()).isPar()) {
       KeepAlive ka_al_inner = flat_cv_exp(env, ctx, aa_inner->v());
       auto* al_inner = Expression::cast<ArrayLit>(ka_al_inner());
-      std::vector<Expression*> composed_e(al_inner->size());
-      for (unsigned int i = 0; i < al_inner->size(); i++) {
-        GCLock lock;
-        IntVal inner_idx = eval_int(env, (*al_inner)[i]);
-        if (inner_idx < al->min(0) || inner_idx > al->max(0)) {
-          goto flatten_arrayaccess;
-        }
-        composed_e[i] = (*al)[static_cast<int>(inner_idx.toInt()) - al->min(0)];
-      }
       std::vector<std::pair<int, int>> dims(al_inner->dims());
       for (int i = 0; i < al_inner->dims(); i++) {
         dims[i] = std::make_pair(al_inner->min(i), al_inner->max(i));
       }
+      std::vector<Expression*> composed_e;
+      bool composeProgressions = al->isProgression() && al_inner->isProgression();
+      if (composeProgressions) {
+        // Both progressions are monotone, so only the first and last index need checking
+        IntVal first_idx = al_inner->progressionFirst();
+        IntVal last_idx = first_idx + al_inner->progressionStep() * (al_inner->size() - 1);
+        if (first_idx < al->min(0) || first_idx > al->max(0) || last_idx < al->min(0) ||
+            last_idx > al->max(0)) {
+          goto flatten_arrayaccess;
+        }
+      } else {
+        composed_e.resize(al_inner->size());
+        for (unsigned int i = 0; i < al_inner->size(); i++) {
+          GCLock lock;
+          IntVal inner_idx = eval_int(env, (*al_inner)[i]);
+          if (inner_idx < al->min(0) || inner_idx > al->max(0)) {
+            goto flatten_arrayaccess;
+          }
+          composed_e[i] = (*al)[static_cast<int>(inner_idx.toInt()) - al->min(0)];
+        }
+      }
       {
         GCLock lock;
-        Expression* newal = new ArrayLit(Expression::loc(al), composed_e, dims);
+        Expression* newal;
+        if (composeProgressions) {
+          IntVal first = al->progressionFirst() +
+                         al->progressionStep() * (al_inner->progressionFirst() - al->min(0));
+          newal = ArrayLit::progression(Expression::loc(al), first,
+                                        al->progressionStep() * al_inner->progressionStep(), dims);
+        } else {
+          newal = new ArrayLit(Expression::loc(al), composed_e, dims);
+        }
         Type t = al->type();
         t.dim(static_cast<int>(dims.size()));
         Expression::type(newal, t);
@@ -19,6 +19,7 @@
 #include <minizinc/file_utils.hh>
 #include <minizinc/flattener.hh>
 #include <minizinc/pathfileprinter.hh>
+#include <minizinc/shared_bounds.hh>
 #include <minizinc/statistics.hh>
 
 #include <fstream>
@@ -60,6 +61,13 @@ void Flattener::printHelp(ostream& os) const {
      << "  --no-optimize\n    Do not optimize the FlatZinc" << std::endl
      << "  --no-chain-compression\n    Do not simplify chains of implication constraints."
      << std::endl
+     << "  --compact-locations\n    Do not keep source locations of data and of expressions "
+        "introduced\n    by the compiler (reduces memory use, but makes error messages less "
+        "precise)."
+     << std::endl
+     << "  --comprehension-threads <n>\n    Number of threads evaluating large par array "
+        "comprehensions\n    (0 = one per core, 1 = default)"
+     << std::endl
      << "  -m <file>, --model <file>\n    File named <file> is the model." << std::endl
      << "  -d <file>, --data <file>\n    File named <file> contains data used by the model."
      << std::endl
@@ -110,6 +118,9 @@ void Flattener::printHelp(ostream& os) const {
      << "  --pre-passes <n>\n    Number of times to apply shave/sac pass (0 = fixed-point, 1 = "
         "default)"
      << std::endl
+     << "  --sac-threads <n>\n    Number of threads probing values during shave/sac (0 = one "
+        "per core, 1 = default)"
+     << std::endl
 #endif
      << "  -O<n>\n    Two-pass optimisation levels:" << std::endl
      << "    -O0:    Disable optimize (--no-optimize)  -O1:    Single pass (default)" << std::endl
@@ -192,6 +203,14 @@ bool Flattener::processOption(int& i, std::vector<std::string>& argv,
     _flags.optimize = false;
   } else if (cop.getOption("--no-chain-compression")) {
     _flags.chainCompression = false;
+  } else if (cop.getOption("--compact-locations")) {
+    _flags.compactLocations = true;
+  } else if (cop.getOption("--comprehension-threads", &intBuffer)) {
+    if (intBuffer < 0) {
+      _log << "% Error: The number of comprehension threads cannot be negative." << std::endl;
+      return false;
+    }
+    _fopts.comprehensionThreads = static_cast<unsigned int>(intBuffer);
   } else if (cop.getOption("--no-output-ozn -O-")) {
     _flags.noOutputOzn = true;
   } else if (cop.getOption("--output-base", &_flagOutputBase)) {  // NOLINT: Allow repeated empty if
@@ -324,6 +343,10 @@ bool Flattener::processOption(int& i, std::vector<std::string>& argv,
     if (intBuffer >= 0) {
       _flagPrePasses = static_cast<unsigned int>(intBuffer);
     }
+  } else if (cop.getOption("--sac-threads", &intBuffer)) {
+    if (intBuffer >= 0) {
+      _flagSacThreads = static_cast<unsigned int>(intBuffer);
+    }
   } else if (cop.getOption("-O", &intBuffer)) {
     switch (intBuffer) {
       case 0: {
@@ -555,6 +578,11 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
     }
   }
 
+  // Paths are built from the locations of introduced expressions, so they need full locations.
+  // This includes the paths that match variables between the passes of multi-pass compilation.
+  Location::compactMode(_flags.compactLocations && !_fopts.collectMznPaths && !_flags.twoPass &&
+                        !_flags.gecode);
+
   try {
     std::stringstream errstream;
 
@@ -673,6 +701,7 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
           std::string(istreambuf_iterator<char>(std::cin), istreambuf_iterator<char>());
       modelText += input;
     }
+    _inputTextHash = SharedBounds::hash(modelText);
 
     if (_flags.verbose) {
       _log << "Parsing file(s) ";
@@ -779,6 +808,7 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
           gopts.shave = _flags.shave;
           gopts.printStatistics = _flags.statistics;
           gopts.prePasses = _flagPrePasses;
+          gopts.sacThreads = _flagSacThreads;
 #endif
           FlatteningOptions pass_opts = _fopts;
           CompilePassFlags cfs;
@@ -832,7 +862,8 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
             _os << "% Generated FlatZinc statistics:\n";
           }
 
-          ss.add("paths", env->envi().varPathStore.getPathMap().size());
+          ss.add("paths", env->envi().varPathStore.getPathMap().size() +
+                             env->envi().varPathStore.getDomainTable().size());
 
           if (stats.n_bool_vars != 0) {
             ss.add("flatBoolVars", stats.n_bool_vars);
@@ -873,6 +904,10 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
           if (stats.n_lin_del != 0) {
             ss.add("eliminatedLinearConstraints", stats.n_lin_del);
           }
+          if (stats.n_bounds_memo_hits + stats.n_bounds_memo_misses != 0) {
+            ss.add("boundsMemoHits", stats.n_bounds_memo_hits);
+            ss.add("boundsMemoMisses", stats.n_bounds_memo_misses);
+          }
 
           /// Objective / SAT. These messages are used by mzn-test.py.
           SolveI* solveItem = env->flat()->solveItem();
@@ -887,6 +922,11 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
           }
 
           ss.add("flatTime", flatten_time.s());
+          if (Location::compactMode()) {
+            const GC::LocationStats& locStats = GC::locationStats();
+            ss.add("compactLocations", locStats.compact);
+            ss.add("locationBytesSaved", locStats.savedBytes);
+          }
         }
 
         if (_flags.outputPathsStdout) {
@@ -1003,6 +1043,7 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
       p.print(m);
     }
   } catch (ResultUndefinedError& e) {
+    Location::compactMode(false);
     // Ensure warnings are printed, but remove warning corresponding to this error
     if (getEnv() != nullptr) {
       getEnv()->dumpWarnings(_fopts.encapsulateJSON ? _os : _log, _flags.werror,
@@ -1011,6 +1052,7 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
     }
     throw;
   } catch (...) {
+    Location::compactMode(false);
     // Ensure warnings are printed
     if (getEnv() != nullptr) {
       getEnv()->dumpWarnings(_fopts.encapsulateJSON ? _os : _log, _flags.werror,
@@ -1019,6 +1061,7 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
     }
     throw;
   }
+  Location::compactMode(false);
 
   if (getEnv()->envi().failed()) {
     status = SolverInstance::UNSAT;
@@ -1036,7 +1079,34 @@ void Flattener::flatten(const std::string& modelString, const std::string& model
       _log << "Maximum memory " << mem / mb << " Mbytes";
     }
     _log << "." << std::endl;
+    const GC::LocationStats& locStats = GC::locationStats();
+    _log << "Source locations: " << locStats.compact << " compact, " << locStats.allocated
+         << " allocated, " << locStats.dropped << " dropped (" << locStats.savedBytes / kb
+         << " Kbytes saved)." << std::endl;
   }
 }
 
 void Flattener::printStatistics(ostream& /*os*/) {}
+
+std::uint64_t Flattener::inputHash() const {
+  std::uint64_t h = _inputTextHash;
+  auto hash_file = [](const std::string& f, std::uint64_t h) {
+    std::ifstream file(FILE_PATH(f), std::ios::binary);
+    if (!file.is_open()) {
+      return SharedBounds::hash(f, h);
+    }
+    return SharedBounds::hash(
+        std::string(istreambuf_iterator<char>(file), istreambuf_iterator<char>()), h);
+  };
+  for (const auto& f : _filenames) {
+    h = hash_file(f, h);
+  }
+  for (const auto& f : _datafiles) {
+    if (f.compare(0, 5, "cmd:/") == 0 || f.compare(0, 6, "json:/") == 0) {
+      h = SharedBounds::hash(f, h);
+    } else {
+      h = hash_file(f, h);
+    }
+  }
+  return h;
+}
@@ -102,8 +102,11 @@ protected:
   struct TItem {
     Expression** l;
     Expression* v;
+    /// Declaration that owns \a l (if any)
+    VarDecl* owner;
     bool mark;
-    TItem(Expression** l0, Expression* v0) : l(l0), v(v0), mark(false) {}
+    TItem(Expression** l0, Expression* v0, VarDecl* owner0 = nullptr)
+        : l(l0), v(v0), owner(owner0), mark(false) {}
   };
   /// Trail
   std::vector<TItem> _trail;
@@ -216,6 +219,8 @@ protected:
               << (_gcThreshold / 1024) << "\n";
 #endif
     size_t old_free = _freeMem;
+    // Addresses of collected nodes may be reused, and watched nodes may be collected
+    GC::gc()->nextRevision();
     mark();
     sweep();
     // GC strategy:
@@ -387,7 +392,7 @@ const size_t GC::Heap::_fl_size[GC::Heap::_max_fl + 1] = {
     sizeof(Item) + 9 * sizeof(void*), sizeof(Item) + 10 * sizeof(void*),
 };
 
-GC::GC() : _heap(new Heap()), _lockCount(0) {}
+GC::GC() : _heap(new Heap()), _lockCount(0), _revision(0) {}
 
 void GC::add(GCMarker* m) {
   if (gc() == nullptr) {
@@ -660,14 +665,19 @@ void GC::mark() {
   gc->_heap->_trail.emplace_back(nullptr, nullptr);
   gc->_heap->_trail.back().mark = true;
 }
-void GC::trail(Expression** l, Expression* v) {
+void GC::trail(Expression** l, Expression* v, VarDecl* owner) {
   GC* gc = GC::gc();
-  gc->_heap->_trail.emplace_back(l, v);
+  gc->_heap->_trail.emplace_back(l, v, owner);
 }
 void GC::untrail() {
   GC* gc = GC::gc();
   while (!gc->_heap->_trail.back().mark) {
     *gc->_heap->_trail.back().l = gc->_heap->_trail.back().v;
+    // The owner may have been watched after the entry was trailed
+    VarDecl* owner = gc->_heap->_trail.back().owner;
+    if (owner != nullptr && owner->watched()) {
+      gc->nextRevision();
+    }
     gc->_heap->_trail.pop_back();
   }
   assert(gc->_heap->_trail.back().mark);
@@ -679,6 +689,46 @@ size_t GC::maxMem() {
   return gc->_heap->_maxAllocedMem;
 }
 
+GC::LocationStats& GC::locationStats() {
+  if (gc() == nullptr) {
+    gc() = new GC();
+  }
+  return gc()->_locationStats;
+}
+
+unsigned long long GC::revision() {
+  if (gc() == nullptr) {
+    gc() = new GC();
+  }
+  return gc()->_revision;
+}
+
+void GC::nextRevision() {
+  for (auto* e : _watched) {
+    if (Expression::isa<VarDecl>(e)) {
+      Expression::cast<VarDecl>(e)->unwatch();
+    } else {
+      Expression::cast<TypeInst>(e)->unwatch();
+    }
+  }
+  _watched.clear();
+  _revision++;
+}
+
+void GC::newRevision() {
+  if (gc() == nullptr) {
+    gc() = new GC();
+  }
+  gc()->nextRevision();
+}
+
+void GC::watch(Expression* e) {
+  if (gc() == nullptr) {
+    gc() = new GC();
+  }
+  gc()->_watched.push_back(e);
+}
+
 #if defined(MINIZINC_GC_STATS)
 std::map<int, GCStat>& GC::stats() {
   GC* gc = GC::gc();
@@ -0,0 +1,968 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/eval_par.hh>
+#include <minizinc/flatten_internal.hh>
+#include <minizinc/parallel_comp.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace MiniZinc {
+
+namespace {
+
+/// Minimum (estimated) number of elements of a comprehension evaluated in parallel
+const IntVal parallel_comp_min_size = 4096;
+/// Number of chunks per thread (more chunks balance uneven generator bodies better)
+const unsigned int chunks_per_thread = 8;
+
+/// Thrown when a compiled expression cannot be evaluated (e.g. division by zero)
+struct PureEvalAbort {};
+
+/// Ranges of a set of integers
+typedef std::vector<std::pair<IntVal, IntVal>> PureRanges;
+
+/// Side-effect free par expression, compiled from an Expression
+///
+/// Evaluation only reads the compiled nodes, the generator variable values passed
+/// in, and par array literals that are not modified while the comprehension is
+/// evaluated, so it can run concurrently on several threads.
+class PureExpr {
+public:
+  enum ValKind { VK_INT, VK_FLOAT, VK_BOOL };
+  enum NodeKind {
+    NK_CONST,
+    NK_VAR,
+    NK_TOINT,
+    NK_TOFLOAT,
+    NK_BINOP,
+    NK_UNOP,
+    NK_ITE,
+    NK_ACCESS,
+    NK_IN,
+    NK_ABS,
+    NK_MIN,
+    NK_MAX
+  };
+  struct Node {
+    NodeKind kind;
+    ValKind vk;
+    /// Operator (for NK_BINOP and NK_UNOP)
+    int op = 0;
+    /// Constant value (for NK_CONST), Booleans are stored as 0/1
+    IntVal i;
+    FloatVal f;
+    /// Variable slot (NK_VAR), array (NK_ACCESS) or set (NK_IN)
+    unsigned int idx = 0;
+    /// Argument nodes
+    std::vector<int> args;
+    Node(NodeKind kind0, ValKind vk0) : kind(kind0), vk(vk0) {}
+  };
+  struct Array {
+    ArrayLit* al;
+    ValKind vk;
+  };
+
+  std::vector<Node> nodes;
+  std::vector<Array> arrays;
+  std::vector<PureRanges> sets;
+
+  IntVal evalInt(int n, const std::vector<IntVal>& slots) const;
+  FloatVal evalFloat(int n, const std::vector<IntVal>& slots) const;
+  bool evalBool(int n, const std::vector<IntVal>& slots) const;
+
+private:
+  Expression* access(const Node& node, const std::vector<IntVal>& slots) const;
+};
+
+Expression* PureExpr::access(const Node& node, const std::vector<IntVal>& slots) const {
+  ArrayLit* al = arrays[node.idx].al;
+  IntVal realidx = 0;
+  IntVal realdim = 1;
+  for (unsigned int i = 0; i < al->dims(); i++) {
+    realdim *= al->max(i) - al->min(i) + 1;
+  }
+  for (unsigned int i = 0; i < al->dims(); i++) {
+    IntVal ix = evalInt(node.args[i], slots);
+    if (ix < al->min(i) || ix > al->max(i)) {
+      throw PureEvalAbort();
+    }
+    realdim /= al->max(i) - al->min(i) + 1;
+    realidx += (ix - al->min(i)) * realdim;
+  }
+  // Progressions are constructed from unboxed integers, so this does not allocate
+  return (*al)[static_cast<unsigned int>(realidx.toInt())];
+}
+
+IntVal PureExpr::evalInt(int n, const std::vector<IntVal>& slots) const {
+  const Node& node = nodes[n];
+  assert(node.vk == VK_INT);
+  switch (node.kind) {
+    case NK_CONST:
+      return node.i;
+    case NK_VAR:
+      return slots[node.idx];
+    case NK_TOINT:
+      return evalBool(node.args[0], slots) ? 1 : 0;
+    case NK_BINOP: {
+      IntVal v0 = evalInt(node.args[0], slots);
+      IntVal v1 = evalInt(node.args[1], slots);
+      switch (node.op) {
+        case BOT_PLUS:
+          return v0 + v1;
+        case BOT_MINUS:
+          return v0 - v1;
+        case BOT_MULT:
+          return v0 * v1;
+        case BOT_POW:
+          if (v0 == 0 && v1 < 0) {
+            throw PureEvalAbort();
+          }
+          return v0.pow(v1);
+        case BOT_IDIV:
+          if (v1 == 0) {
+            throw PureEvalAbort();
+          }
+          return v0 / v1;
+        case BOT_MOD:
+          if (v1 == 0) {
+            throw PureEvalAbort();
+          }
+          return v0 % v1;
+        default:
+          throw PureEvalAbort();
+      }
+    }
+    case NK_UNOP: {
+      IntVal v0 = evalInt(node.args[0], slots);
+      return node.op == UOT_MINUS ? -v0 : v0;
+    }
+    case NK_ITE: {
+      for (unsigned int i = 0; i + 1 < node.args.size(); i += 2) {
+        if (evalBool(node.args[i], slots)) {
+          return evalInt(node.args[i + 1], slots);
+        }
+      }
+      return evalInt(node.args.back(), slots);
+    }
+    case NK_ACCESS: {
+      auto* il = Expression::dynamicCast<IntLit>(access(node, slots));
+      if (il == nullptr) {
+        throw PureEvalAbort();
+      }
+      return IntLit::v(il);
+    }
+    case NK_ABS:
+      return std::abs(evalInt(node.args[0], slots));
+    case NK_MIN:
+      return std::min(evalInt(node.args[0], slots), evalInt(node.args[1], slots));
+    case NK_MAX:
+      return std::max(evalInt(node.args[0], slots), evalInt(node.args[1], slots));
+    default:
+      throw PureEvalAbort();
+  }
+}
+
+FloatVal PureExpr::evalFloat(int n, const std::vector<IntVal>& slots) const {
+  const Node& node = nodes[n];
+  assert(node.vk == VK_FLOAT);
+  switch (node.kind) {
+    case NK_CONST:
+      return node.f;
+    case NK_TOFLOAT: {
+      const Node& arg = nodes[node.args[0]];
+      if (arg.vk == VK_BOOL) {
+        return static_cast<double>(evalBool(node.args[0], slots));
+      }
+      return FloatVal(evalInt(node.args[0], slots));
+    }
+    case NK_BINOP: {
+      FloatVal v0 = evalFloat(node.args[0], slots);
+      FloatVal v1 = evalFloat(node.args[1], slots);
+      switch (node.op) {
+        case BOT_PLUS:
+          return v0 + v1;
+        case BOT_MINUS:
+          return v0 - v1;
+        case BOT_MULT:
+          return v0 * v1;
+        case BOT_POW:
+          return std::pow(v0.toDouble(), v1.toDouble());
+        case BOT_DIV:
+          if (v1 == 0.0) {
+            throw PureEvalAbort();
+          }
+          return v0 / v1;
+        default:
+          throw PureEvalAbort();
+      }
+    }
+    case NK_UNOP: {
+      FloatVal v0 = evalFloat(node.args[0], slots);
+      return node.op == UOT_MINUS ? -v0 : v0;
+    }
+    case NK_ITE: {
+      for (unsigned int i = 0; i + 1 < node.args.size(); i += 2) {
+        if (evalBool(node.args[i], slots)) {
+          return evalFloat(node.args[i + 1], slots);
+        }
+      }
+      return evalFloat(node.args.back(), slots);
+    }
+    case NK_ACCESS: {
+      auto* fl = Expression::dynamicCast<FloatLit>(access(node, slots));
+      if (fl == nullptr) {
+        throw PureEvalAbort();
+      }
+      return FloatLit::v(fl);
+    }
+    case NK_ABS:
+      return std::abs(evalFloat(node.args[0], slots));
+    case NK_MIN:
+      return std::min(evalFloat(node.args[0], slots), evalFloat(node.args[1], slots));
+    case NK_MAX:
+      return std::max(evalFloat(node.args[0], slots), evalFloat(node.args[1], slots));
+    default:
+      throw PureEvalAbort();
+  }
+}
+
+bool PureExpr::evalBool(int n, const std::vector<IntVal>& slots) const {
+  const Node& node = nodes[n];
+  assert(node.vk == VK_BOOL);
+  switch (node.kind) {
+    case NK_CONST:
+      return node.i != 0;
+    case NK_BINOP: {
+      ValKind argKind = nodes[node.args[0]].vk;
+      if (argKind == VK_BOOL) {
+        switch (node.op) {
+          case BOT_AND:
+            return evalBool(node.args[0], slots) && evalBool(node.args[1], slots);
+          case BOT_OR:
+            return evalBool(node.args[0], slots) || evalBool(node.args[1], slots);
+          case BOT_IMPL:
+            return !evalBool(node.args[0], slots) || evalBool(node.args[1], slots);
+          case BOT_RIMPL:
+            return !evalBool(node.args[1], slots) || evalBool(node.args[0], slots);
+          default:
+            break;
+        }
+        int v0 = static_cast<int>(evalBool(node.args[0], slots));
+        int v1 = static_cast<int>(evalBool(node.args[1], slots));
+        switch (node.op) {
+          case BOT_LE:
+            return v0 < v1;
+          case BOT_LQ:
+            return v0 <= v1;
+          case BOT_GR:
+            return v0 > v1;
+          case BOT_GQ:
+            return v0 >= v1;
+          case BOT_EQ:
+          case BOT_EQUIV:
+            return v0 == v1;
+          case BOT_NQ:
+          case BOT_XOR:
+            return v0 != v1;
+          default:
+            throw PureEvalAbort();
+        }
+      }
+      if (argKind == VK_INT) {
+        IntVal v0 = evalInt(node.args[0], slots);
+        IntVal v1 = evalInt(node.args[1], slots);
+        switch (node.op) {
+          case BOT_LE:
+            return v0 < v1;
+          case BOT_LQ:
+            return v0 <= v1;
+          case BOT_GR:
+            return v0 > v1;
+          case BOT_GQ:
+            return v0 >= v1;
+          case BOT_EQ:
+            return v0 == v1;
+          case BOT_NQ:
+            return v0 != v1;
+          default:
+            throw PureEvalAbort();
+        }
+      }
+      FloatVal v0 = evalFloat(node.args[0], slots);
+      FloatVal v1 = evalFloat(node.args[1], slots);
+      switch (node.op) {
+        case BOT_LE:
+          return v0 < v1;
+        case BOT_LQ:
+          return v0 <= v1;
+        case BOT_GR:
+          return v0 > v1;
+        case BOT_GQ:
+          return v0 >= v1;
+        case BOT_EQ:
+          return v0 == v1;
+        case BOT_NQ:
+          return v0 != v1;
+        default:
+          throw PureEvalAbort();
+      }
+    }
+    case NK_UNOP:
+      return !evalBool(node.args[0], slots);
+    case NK_ITE: {
+      for (unsigned int i = 0; i + 1 < node.args.size(); i += 2) {
+        if (evalBool(node.args[i], slots)) {
+          return evalBool(node.args[i + 1], slots);
+        }
+      }
+      return evalBool(node.args.back(), slots);
+    }
+    case NK_ACCESS: {
+      auto* bl = Expression::dynamicCast<BoolLit>(access(node, slots));
+      if (bl == nullptr) {
+        throw PureEvalAbort();
+      }
+      return bl->v();
+    }
+    case NK_IN: {
+      IntVal v = evalInt(node.args[0], slots);
+      const PureRanges& ranges = sets[node.idx];
+      auto it = std::upper_bound(
+          ranges.begin(), ranges.end(), v,
+          [](const IntVal& x, const std::pair<IntVal, IntVal>& r) { return x < r.first; });
+      return it != ranges.begin() && v <= (it - 1)->second;
+    }
+    default:
+      throw PureEvalAbort();
+  }
+}
+
+/// Return whether \a t is the type of a par scalar that PureExpr can represent
+bool is_pure_scalar(const Type& t) {
+  return t.isPar() && !t.cv() && t.dim() == 0 && t.st() == Type::ST_PLAIN &&
+         t.ot() == Type::OT_PRESENT &&
+         (t.bt() == Type::BT_INT || t.bt() == Type::BT_FLOAT || t.bt() == Type::BT_BOOL);
+}
+
+PureExpr::ValKind val_kind(const Type& t) {
+  switch (t.bt()) {
+    case Type::BT_INT:
+      return PureExpr::VK_INT;
+    case Type::BT_FLOAT:
+      return PureExpr::VK_FLOAT;
+    default:
+      return PureExpr::VK_BOOL;
+  }
+}
+
+/// Compiles the generators, where clauses and body of a comprehension into PureExprs
+class PureCompiler {
+protected:
+  EnvI& _env;
+  Comprehension* _c;
+  PureExpr& _pe;
+  /// Slots of the generator variables
+  std::unordered_map<VarDecl*, unsigned int> _slots;
+  /// Arrays that are already accessed by a node
+  std::unordered_map<Expression*, unsigned int> _arrays;
+
+  int add(PureExpr::Node node) {
+    _pe.nodes.push_back(std::move(node));
+    return static_cast<int>(_pe.nodes.size()) - 1;
+  }
+  int addConst(PureExpr::ValKind vk, IntVal i, FloatVal f) {
+    PureExpr::Node node(PureExpr::NK_CONST, vk);
+    node.i = i;
+    node.f = f;
+    return add(node);
+  }
+  /// Whether \a e refers to a generator variable
+  bool dependsOnGenerators(Expression* e) { return _c->containsBoundVariable(e); }
+  /// Return the literal that identifier \a e is bound to (or \a e itself if it is not an
+  /// identifier). Nothing is evaluated here, so that a comprehension that is then evaluated
+  /// sequentially behaves exactly as if this compiler had never looked at it.
+  Expression* literal(Expression* e) {
+    while (Expression::isa<Id>(e)) {
+      VarDecl* vd = Expression::cast<Id>(e)->decl();
+      if (vd == nullptr || _slots.find(vd) != _slots.end() || vd->e() == nullptr) {
+        return nullptr;
+      }
+      e = vd->e();
+    }
+    return e;
+  }
+
+  int compileNative(Expression* e, PureExpr::ValKind vk);
+
+public:
+  PureCompiler(EnvI& env, Comprehension* c, PureExpr& pe) : _env(env), _c(c), _pe(pe) {}
+
+  unsigned int addSlot(VarDecl* vd) {
+    auto slot = static_cast<unsigned int>(_slots.size());
+    _slots.emplace(vd, slot);
+    return slot;
+  }
+
+  /// Compile \a e into a node of kind \a want, or return -1 if not supported
+  int compile(Expression* e, PureExpr::ValKind want);
+
+  /// Compute the ranges of the par set \a e that does not depend on generator variables. Only
+  /// set literals and ranges a..b of compiled expressions are supported.
+  bool constSet(Expression* e, PureRanges& ranges);
+};
+
+bool PureCompiler::constSet(Expression* e, PureRanges& ranges) {
+  const Type& t = Expression::type(e);
+  if (!t.isPar() || t.cv() || t.dim() != 0 || t.st() != Type::ST_SET || t.bt() != Type::BT_INT ||
+      dependsOnGenerators(e)) {
+    return false;
+  }
+  e = literal(e);
+  if (auto* sl = Expression::dynamicCast<SetLit>(e)) {
+    IntSetVal* isv = sl->isv();
+    if (isv == nullptr ||
+        (!isv->empty() && (!isv->min().isFinite() || !isv->max().isFinite()))) {
+      return false;
+    }
+    for (unsigned int i = 0; i < isv->size(); i++) {
+      ranges.emplace_back(isv->min(i), isv->max(i));
+    }
+    return true;
+  }
+  auto* bo = Expression::dynamicCast<BinOp>(e);
+  if (bo == nullptr || bo->op() != BOT_DOTDOT ||
+      (bo->decl() != nullptr && bo->decl()->e() != nullptr)) {
+    return false;
+  }
+  int lb = compile(bo->lhs(), PureExpr::VK_INT);
+  int ub = lb < 0 ? -1 : compile(bo->rhs(), PureExpr::VK_INT);
+  if (ub < 0) {
+    return false;
+  }
+  try {
+    std::vector<IntVal> noSlots;
+    IntVal l = _pe.evalInt(lb, noSlots);
+    IntVal u = _pe.evalInt(ub, noSlots);
+    if (l <= u) {
+      ranges.emplace_back(l, u);
+    }
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+int PureCompiler::compile(Expression* e, PureExpr::ValKind want) {
+  const Type& t = Expression::type(e);
+  if (!is_pure_scalar(t)) {
+    return -1;
+  }
+  PureExpr::ValKind vk = val_kind(t);
+  int n = compileNative(e, vk);
+  if (n < 0 || vk == want) {
+    return n;
+  }
+  // Same conversions as eval_int and eval_float
+  if (want == PureExpr::VK_INT && vk == PureExpr::VK_BOOL) {
+    PureExpr::Node node(PureExpr::NK_TOINT, want);
+    node.args.push_back(n);
+    return add(node);
+  }
+  if (want == PureExpr::VK_FLOAT) {
+    PureExpr::Node node(PureExpr::NK_TOFLOAT, want);
+    node.args.push_back(n);
+    return add(node);
+  }
+  return -1;
+}
+
+int PureCompiler::compileNative(Expression* e, PureExpr::ValKind vk) {
+  switch (Expression::eid(e)) {
+    case Expression::E_INTLIT: {
+      IntVal v = IntLit::v(Expression::cast<IntLit>(e));
+      if (vk == PureExpr::VK_BOOL) {
+        return -1;
+      }
+      return vk == PureExpr::VK_FLOAT ? addConst(vk, 0, FloatVal(v)) : addConst(vk, v, 0.0);
+    }
+    case Expression::E_FLOATLIT:
+      if (vk != PureExpr::VK_FLOAT) {
+        return -1;
+      }
+      return addConst(vk, 0, FloatLit::v(Expression::cast<FloatLit>(e)));
+    case Expression::E_BOOLLIT:
+      if (vk != PureExpr::VK_BOOL) {
+        return -1;
+      }
+      return addConst(vk, Expression::cast<BoolLit>(e)->v() ? 1 : 0, 0.0);
+    case Expression::E_ID: {
+      auto* ident = Expression::cast<Id>(e);
+      auto it = _slots.find(ident->decl());
+      if (it != _slots.end()) {
+        if (vk != PureExpr::VK_INT) {
+          return -1;
+        }
+        PureExpr::Node node(PureExpr::NK_VAR, vk);
+        node.idx = it->second;
+        return add(node);
+      }
+      if (dependsOnGenerators(e)) {
+        // generator variable of a later generator, not bound yet
+        return -1;
+      }
+      // Parameters that have already been evaluated become constants
+      Expression* lit = literal(e);
+      if (lit == nullptr || (!Expression::isa<IntLit>(lit) && !Expression::isa<FloatLit>(lit) &&
+                             !Expression::isa<BoolLit>(lit))) {
+        return -1;
+      }
+      return compileNative(lit, vk);
+    }
+    case Expression::E_ARRAYACCESS: {
+      auto* aa = Expression::cast<ArrayAccess>(e);
+      Expression* arr = aa->v();
+      const Type& at = Expression::type(arr);
+      if (!at.isPar() || at.cv() || at.st() != Type::ST_PLAIN || at.ot() != Type::OT_PRESENT ||
+          at.bt() != Expression::type(e).bt() ||
+          static_cast<unsigned int>(at.dim()) != aa->idx().size() ||
+          (!Expression::isa<Id>(arr) && !Expression::isa<ArrayLit>(arr)) ||
+          dependsOnGenerators(arr)) {
+        return -1;
+      }
+      unsigned int arrayIdx;
+      auto it = _arrays.find(arr);
+      if (it != _arrays.end()) {
+        arrayIdx = it->second;
+      } else {
+        // The array literal stays alive through its declaration or the comprehension
+        auto* al = Expression::dynamicCast<ArrayLit>(literal(arr));
+        if (al == nullptr || al->isTuple() || al->dims() != aa->idx().size()) {
+          return -1;
+        }
+        arrayIdx = static_cast<unsigned int>(_pe.arrays.size());
+        _pe.arrays.push_back({al, vk});
+        _arrays.emplace(arr, arrayIdx);
+      }
+      PureExpr::Node node(PureExpr::NK_ACCESS, vk);
+      node.idx = arrayIdx;
+      for (unsigned int i = 0; i < aa->idx().size(); i++) {
+        if (!Expression::type(aa->idx()[i]).isint()) {
+          return -1;
+        }
+        int idx = compile(aa->idx()[i], PureExpr::VK_INT);
+        if (idx < 0) {
+          return -1;
+        }
+        node.args.push_back(idx);
+      }
+      return add(node);
+    }
+    case Expression::E_ITE: {
+      ITE* ite = Expression::cast<ITE>(e);
+      if (ite->elseExpr() == nullptr) {
+        return -1;
+      }
+      PureExpr::Node node(PureExpr::NK_ITE, vk);
+      for (unsigned int i = 0; i < ite->size(); i++) {
+        int c = compile(ite->ifExpr(i), PureExpr::VK_BOOL);
+        int t = c < 0 ? -1 : compile(ite->thenExpr(i), vk);
+        if (t < 0) {
+          return -1;
+        }
+        node.args.push_back(c);
+        node.args.push_back(t);
+      }
+      int el = compile(ite->elseExpr(), vk);
+      if (el < 0) {
+        return -1;
+      }
+      node.args.push_back(el);
+      return add(node);
+    }
+    case Expression::E_BINOP: {
+      auto* bo = Expression::cast<BinOp>(e);
+      if (bo->decl() != nullptr && bo->decl()->e() != nullptr) {
+        // user-defined operator
+        return -1;
+      }
+      PureExpr::Node node(PureExpr::NK_BINOP, vk);
+      node.op = bo->op();
+      if (vk == PureExpr::VK_BOOL) {
+        const Type& lt = Expression::type(bo->lhs());
+        const Type& rt = Expression::type(bo->rhs());
+        if (bo->op() == BOT_IN) {
+          PureExpr::Node in(PureExpr::NK_IN, vk);
+          int x = lt.isint() ? compile(bo->lhs(), PureExpr::VK_INT) : -1;
+          PureRanges ranges;
+          if (x < 0 || !constSet(bo->rhs(), ranges)) {
+            return -1;
+          }
+          in.args.push_back(x);
+          in.idx = static_cast<unsigned int>(_pe.sets.size());
+          _pe.sets.push_back(ranges);
+          return add(in);
+        }
+        if (!is_pure_scalar(lt) || !is_pure_scalar(rt) || lt.bt() != rt.bt()) {
+          return -1;
+        }
+        PureExpr::ValKind argKind = val_kind(lt);
+        switch (bo->op()) {
+          case BOT_LE:
+          case BOT_LQ:
+          case BOT_GR:
+          case BOT_GQ:
+          case BOT_EQ:
+          case BOT_NQ:
+            break;
+          case BOT_EQUIV:
+          case BOT_IMPL:
+          case BOT_RIMPL:
+          case BOT_OR:
+          case BOT_AND:
+          case BOT_XOR:
+            if (argKind != PureExpr::VK_BOOL) {
+              return -1;
+            }
+            break;
+          default:
+            return -1;
+        }
+        int l = compile(bo->lhs(), argKind);
+        int r = l < 0 ? -1 : compile(bo->rhs(), argKind);
+        if (r < 0) {
+          return -1;
+        }
+        node.args = {l, r};
+        return add(node);
+      }
+      switch (bo->op()) {
+        case BOT_PLUS:
+        case BOT_MINUS:
+        case BOT_MULT:
+        case BOT_POW:
+          break;
+        case BOT_IDIV:
+        case BOT_MOD:
+          if (vk != PureExpr::VK_INT) {
+            return -1;
+          }
+          break;
+        case BOT_DIV:
+          if (vk != PureExpr::VK_FLOAT) {
+            return -1;
+          }
+          break;
+        default:
+          return -1;
+      }
+      int l = compile(bo->lhs(), vk);
+      int r = l < 0 ? -1 : compile(bo->rhs(), vk);
+      if (r < 0) {
+        return -1;
+      }
+      node.args = {l, r};
+      return add(node);
+    }
+    case Expression::E_UNOP: {
+      UnOp* uo = Expression::cast<UnOp>(e);
+      if (uo->decl() != nullptr && uo->decl()->e() != nullptr) {
+        return -1;
+      }
+      if ((vk == PureExpr::VK_BOOL) != (uo->op() == UOT_NOT)) {
+        return -1;
+      }
+      int a = compile(uo->e(), vk);
+      if (a < 0) {
+        return -1;
+      }
+      PureExpr::Node node(PureExpr::NK_UNOP, vk);
+      node.op = uo->op();
+      node.args.push_back(a);
+      return add(node);
+    }
+    case Expression::E_CALL: {
+      Call* ce = Expression::cast<Call>(e);
+      if (ce->decl() == nullptr || ce->decl()->e() != nullptr) {
+        return -1;
+      }
+      PureExpr::NodeKind kind;
+      if (ce->id() == _env.constants.ids.abs && ce->argCount() == 1) {
+        kind = PureExpr::NK_ABS;
+      } else if (ce->id() == "min" && ce->argCount() == 2) {
+        kind = PureExpr::NK_MIN;
+      } else if (ce->id() == "max" && ce->argCount() == 2) {
+        kind = PureExpr::NK_MAX;
+      } else if ((ce->id() == _env.constants.ids.bool2int ||
+                  ce->id() == _env.constants.ids.int2float) &&
+                 ce->argCount() == 1) {
+        // Conversions are inserted by compile, based on the argument type
+        return compile(ce->arg(0), vk);
+      } else {
+        return -1;
+      }
+      if (vk == PureExpr::VK_BOOL) {
+        return -1;
+      }
+      PureExpr::Node node(kind, vk);
+      for (unsigned int i = 0; i < ce->argCount(); i++) {
+        if (val_kind(Expression::type(ce->arg(i))) != vk) {
+          return -1;
+        }
+        int a = compile(ce->arg(i), vk);
+        if (a < 0) {
+          return -1;
+        }
+        node.args.push_back(a);
+      }
+      return add(node);
+    }
+    default:
+      return -1;
+  }
+}
+
+/// One generator variable of the comprehension
+struct PureLoop {
+  /// Slot of the variable
+  unsigned int slot;
+  /// Generator the variable belongs to
+  unsigned int gen;
+  /// Whether this is the first (last) variable of its generator
+  bool first;
+  bool last;
+  /// Set of the generator if it does not depend on earlier generators
+  PureRanges ranges;
+  /// Bounds of a generator a..b that depends on earlier generators (otherwise -1)
+  int lb = -1;
+  int ub = -1;
+  /// Where clause (evaluated after the last variable of the generator, or -1)
+  int where = -1;
+};
+
+/// Evaluates chunks of the outermost generator
+class PureCompRunner {
+protected:
+  const PureExpr& _pe;
+  const std::vector<PureLoop>& _loops;
+  int _body;
+  std::vector<IntVal> _slots;
+  /// Current set of each generator
+  std::vector<PureRanges> _current;
+
+public:
+  std::vector<IntVal> ints;
+  std::vector<FloatVal> floats;
+
+  PureCompRunner(const PureExpr& pe, const std::vector<PureLoop>& loops, int body,
+                 unsigned int nSlots)
+      : _pe(pe), _loops(loops), _body(body), _slots(nSlots), _current(loops.size()) {}
+
+  /// Evaluate for all values of the outermost variable with index in [from, to)
+  void run(const PureRanges& outer, IntVal from, IntVal to) {
+    _current[0] = outer;
+    IntVal pos = 0;
+    for (const auto& r : outer) {
+      IntVal size = r.second - r.first + 1;
+      if (pos + size > from && pos < to) {
+        IntVal lo = r.first + std::max(IntVal(0), from - pos);
+        IntVal hi = r.first + std::min(size, to - pos) - 1;
+        for (IntVal v = lo; v <= hi; ++v) {
+          bind(0, v);
+        }
+      }
+      pos += size;
+    }
+  }
+
+protected:
+  void bind(unsigned int level, IntVal v) {
+    const PureLoop& loop = _loops[level];
+    _slots[loop.slot] = v;
+    if (loop.last && loop.where >= 0 && !_pe.evalBool(loop.where, _slots)) {
+      return;
+    }
+    if (level + 1 == _loops.size()) {
+      emit();
+    } else {
+      iterate(level + 1);
+    }
+  }
+
+  void iterate(unsigned int level) {
+    const PureLoop& loop = _loops[level];
+    if (loop.first) {
+      if (loop.lb >= 0) {
+        IntVal lb = _pe.evalInt(loop.lb, _slots);
+        IntVal ub = _pe.evalInt(loop.ub, _slots);
+        _current[loop.gen].clear();
+        if (lb <= ub) {
+          _current[loop.gen].emplace_back(lb, ub);
+        }
+      } else {
+        _current[loop.gen] = loop.ranges;
+      }
+    }
+    for (const auto& r : _current[loop.gen]) {
+      for (IntVal v = r.first; v <= r.second; ++v) {
+        bind(level, v);
+      }
+    }
+  }
+
+  void emit() {
+    switch (_pe.nodes[_body].vk) {
+      case PureExpr::VK_INT:
+        ints.push_back(_pe.evalInt(_body, _slots));
+        break;
+      case PureExpr::VK_FLOAT:
+        floats.push_back(_pe.evalFloat(_body, _slots));
+        break;
+      default:
+        ints.push_back(_pe.evalBool(_body, _slots) ? 1 : 0);
+        break;
+    }
+  }
+};
+
+}  // namespace
+
+bool eval_comp_parallel(EnvI& env, Comprehension* e, ParallelCompValues& values) {
+  unsigned int nThreads = env.fopts.comprehensionThreads == 0
+                              ? std::max(1U, std::thread::hardware_concurrency())
+                              : env.fopts.comprehensionThreads;
+  if (nThreads <= 1 || e->set() || !is_pure_scalar(Expression::type(e->e()))) {
+    return false;
+  }
+  if (Expression::isa<ArrayLit>(e->e()) && Expression::cast<ArrayLit>(e->e())->isTuple()) {
+    return false;
+  }
+
+  PureExpr pe;
+  PureCompiler pc(env, e, pe);
+  std::vector<PureLoop> loops;
+  IntVal estimate = 1;
+  for (unsigned int g = 0; g < e->numberOfGenerators(); g++) {
+    if (e->in(g) == nullptr || e->numberOfDecls(g) == 0) {
+      return false;
+    }
+    PureLoop loop;
+    loop.gen = g;
+    if (!pc.constSet(e->in(g), loop.ranges)) {
+      // a..b depending on earlier generators
+      auto* bo = Expression::dynamicCast<BinOp>(e->in(g));
+      if (bo == nullptr || bo->op() != BOT_DOTDOT ||
+          (bo->decl() != nullptr && bo->decl()->e() != nullptr) || g == 0) {
+        return false;
+      }
+      loop.lb = pc.compile(bo->lhs(), PureExpr::VK_INT);
+      loop.ub = loop.lb < 0 ? -1 : pc.compile(bo->rhs(), PureExpr::VK_INT);
+      if (loop.ub < 0) {
+        return false;
+      }
+    } else {
+      IntVal card = 0;
+      for (const auto& r : loop.ranges) {
+        card += r.second - r.first + 1;
+      }
+      for (unsigned int d = 0; d < e->numberOfDecls(g); d++) {
+        estimate = std::min(estimate * card, parallel_comp_min_size);
+      }
+    }
+    for (unsigned int d = 0; d < e->numberOfDecls(g); d++) {
+      VarDecl* vd = e->decl(g, d);
+      if (!vd->type().isint()) {
+        return false;
+      }
+      loop.slot = pc.addSlot(vd);
+      loop.first = d == 0;
+      loop.last = d + 1 == e->numberOfDecls(g);
+      loops.push_back(loop);
+    }
+    if (e->where(g) != nullptr) {
+      loops.back().where = pc.compile(e->where(g), PureExpr::VK_BOOL);
+      if (loops.back().where < 0) {
+        return false;
+      }
+    }
+  }
+  if (loops.empty() || estimate < parallel_comp_min_size) {
+    return false;
+  }
+  int body = pc.compile(e->e(), val_kind(Expression::type(e->e())));
+  if (body < 0) {
+    return false;
+  }
+
+  // Split the values of the outermost variable into chunks
+  const PureRanges& outer = loops[0].ranges;
+  IntVal outerSize = 0;
+  for (const auto& r : outer) {
+    outerSize += r.second - r.first + 1;
+  }
+  IntVal nChunks = std::min(outerSize, IntVal(nThreads * chunks_per_thread));
+  if (nChunks < 2) {
+    return false;
+  }
+  nThreads = std::min(nThreads, static_cast<unsigned int>(nChunks.toInt()));
+  std::vector<std::unique_ptr<PureCompRunner>> chunks(nChunks.toInt());
+  std::atomic<long long int> nextChunk(0);
+  std::atomic<bool> failed(false);
+  auto slots = static_cast<unsigned int>(loops.size());
+  auto work = [&]() {
+    for (;;) {
+      long long int c = nextChunk++;
+      if (c >= nChunks || failed) {
+        return;
+      }
+      auto runner = std::unique_ptr<PureCompRunner>(new PureCompRunner(pe, loops, body, slots));
+      try {
+        runner->run(outer, outerSize * c / nChunks, outerSize * (c + 1) / nChunks);
+      } catch (...) {
+        // undefined result, overflow, or an array element that is not a literal
+        failed = true;
+        return;
+      }
+      chunks[c] = std::move(runner);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < nThreads; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& w : workers) {
+    w.join();
+  }
+  if (failed) {
+    return false;
+  }
+
+  values.bt = Expression::type(e->e()).bt();
+  size_t total = 0;
+  for (const auto& c : chunks) {
+    total += c->ints.size() + c->floats.size();
+  }
+  if (values.bt == Type::BT_FLOAT) {
+    values.floats.reserve(total);
+    for (const auto& c : chunks) {
+      values.floats.insert(values.floats.end(), c->floats.begin(), c->floats.end());
+    }
+  } else {
+    values.ints.reserve(total);
+    for (const auto& c : chunks) {
+      values.ints.insert(values.ints.end(), c->ints.begin(), c->ints.end());
+    }
+  }
+  return true;
+}
+
+}  // namespace MiniZinc
@@ -56,8 +56,8 @@ void ParamConfig::addValue(const ASTString& flag_input, Expression* e) {
   switch (Expression::eid(e)) {
     case Expression::E_ARRAYLIT: {
       auto* al = Expression::cast<ArrayLit>(e);
-      for (auto* exp : al->getVec()) {
-        addValue(ASTString(flag), exp);
+      for (unsigned int j = 0; j < al->size(); j++) {
+        addValue(ASTString(flag), (*al)[j]);
       }
       break;
     }
@@ -112,9 +112,9 @@ std::string ParamConfig::modelToString(Model& model) {
       switch (Expression::eid(e)) {
         case Expression::E_ARRAYLIT: {
           auto* al = Expression::cast<ArrayLit>(e);
-          for (auto* exp : al->getVec()) {
+          for (unsigned int j = 0; j < al->size(); j++) {
             ss << " " << flag;
-            ss << " " << exp;
+            ss << " " << (*al)[j];
           }
           break;
         }
@@ -23,7 +23,12 @@
 #include <minizinc/parser.hh>
 #include <minizinc/prettyprinter.hh>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <regex>
 
 using namespace std;
@@ -101,6 +106,382 @@ std::unordered_set<std::string> global_includes(const std::string& stdlib) {
   return files;
 }
 
+namespace {
+
+/// Reader for data files that only contain assignments of literal values.
+///
+/// Large data files usually consist of assignments of the form `x = <literal>;`, where the literal
+/// is a number, a Boolean, an integer range, a set of numbers, or a one or two dimensional array
+/// of numbers, Booleans and sets. This reader handles exactly these files directly on the file
+/// contents, without going through the lexer and the Bison parser, and without creating a location
+/// for each array element. It is all-or-nothing: as soon as it encounters anything else, it gives
+/// up and the file is parsed by the full parser (which also reports any syntax errors).
+class DznFastReader {
+protected:
+  const std::string& _s;
+  ASTString _filename;
+  size_t _pos = 0;
+  unsigned int _line = 1;
+  size_t _lineStart = 0;
+  // End of the last value read
+  unsigned int _lastLine = 1;
+  unsigned int _lastColumn = 0;
+
+  unsigned int column(size_t pos) const { return static_cast<unsigned int>(pos - _lineStart + 1); }
+  bool atEnd() const { return _pos >= _s.size(); }
+  char peek(size_t offset = 0) const {
+    return _pos + offset < _s.size() ? _s[_pos + offset] : '\0';
+  }
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+  /// Whether \a id has its own rule in the lexer (must be kept in sync with lexer.lxx), so that
+  /// the data must be read by the full parser
+  static bool isKeyword(const std::string& id) {
+    static const std::unordered_set<std::string> keywords = {
+        "_objective", "true", "false", "ann", "annotation", "any", "array", "bool", "case",
+        "constraint", "default", "div", "diff", "else", "elseif", "endif", "enum", "float",
+        "function", "if", "include", "infinity", "intersect", "in", "int", "let", "list",
+        "maximize", "minimize", "mod", "not", "of", "output", "opt", "par", "predicate", "record",
+        "satisfy", "set", "solve", "string", "subset", "superset", "symdiff", "test", "then",
+        "tuple", "type", "union", "var", "variant_record", "where", "xor"};
+    return keywords.find(id) != keywords.end();
+  }
+  void finish(size_t len) {
+    _lastLine = _line;
+    _lastColumn = column(_pos + len - 1);
+    _pos += len;
+  }
+  Location location(unsigned int firstLine, unsigned int firstColumn) const {
+    return Location(_filename, firstLine, firstColumn, _lastLine, _lastColumn);
+  }
+
+  /// Skip white space and comments. Returns false for doc comments and unterminated comments.
+  bool skipSpace() {
+    while (!atEnd()) {
+      char c = _s[_pos];
+      if (c == '\n') {
+        ++_line;
+        _lineStart = ++_pos;
+      } else if (c == ' ' || c == '\t' || c == '\r' || c == '\f') {
+        ++_pos;
+      } else if (c == '%') {
+        size_t eol = _s.find('\n', _pos);
+        _pos = eol == std::string::npos ? _s.size() : eol;
+      } else if (c == '/' && peek(1) == '*') {
+        if (peek(2) == '*') {
+          return false;
+        }
+        size_t end = _s.find("*/", _pos + 2);
+        if (end == std::string::npos) {
+          return false;
+        }
+        for (size_t i = _pos; i < end; ++i) {
+          if (_s[i] == '\n') {
+            ++_line;
+            _lineStart = i + 1;
+          }
+        }
+        _pos = end + 2;
+      } else {
+        return true;
+      }
+    }
+    return true;
+  }
+
+  /// Read an identifier that is not a keyword
+  bool identifier(std::string& id) {
+    size_t start = _pos;
+    if (peek() == '_') {
+      ++_pos;
+    }
+    if (!isAlpha(peek())) {
+      return false;
+    }
+    while (!atEnd() && (isAlpha(_s[_pos]) || isDigit(_s[_pos]) || _s[_pos] == '_')) {
+      ++_pos;
+    }
+    id = _s.substr(start, _pos - start);
+    return !isKeyword(id);
+  }
+
+  /// Read an integer or float literal, possibly negated
+  Expression* number() {
+    bool negative = false;
+    if (peek() == '-') {
+      negative = true;
+      ++_pos;
+      if (!skipSpace()) {
+        return nullptr;
+      }
+    }
+    if (!isDigit(peek()) ||
+        (peek() == '0' && (peek(1) == 'x' || peek(1) == 'o' || peek(1) == 'b'))) {
+      return nullptr;
+    }
+    size_t len = 0;
+    while (isDigit(peek(len))) {
+      ++len;
+    }
+    bool isFloat = false;
+    if (peek(len) == '.' && isDigit(peek(len + 1))) {
+      isFloat = true;
+      len += 2;
+      while (isDigit(peek(len))) {
+        ++len;
+      }
+    }
+    if (peek(len) == 'e' || peek(len) == 'E') {
+      size_t exp = len + 1;
+      if (peek(exp) == '+' || peek(exp) == '-') {
+        ++exp;
+      }
+      if (isDigit(peek(exp))) {
+        isFloat = true;
+        len = exp;
+        while (isDigit(peek(len))) {
+          ++len;
+        }
+      }
+    }
+    if (isFloat) {
+      const char* begin = _s.c_str() + _pos;
+      char* end = nullptr;
+      errno = 0;
+      double d = std::strtod(begin, &end);
+      if (errno == ERANGE || end != begin + len) {
+        return nullptr;
+      }
+      finish(len);
+      return FloatLit::a(negative ? -d : d);
+    }
+    long long int v = 0;
+    const long long int limit = std::numeric_limits<long long int>::max();
+    for (size_t i = 0; i < len; ++i) {
+      int digit = _s[_pos + i] - '0';
+      if (v > (limit - digit) / 10) {
+        return nullptr;
+      }
+      v = v * 10 + digit;
+    }
+    finish(len);
+    return IntLit::a(negative ? -v : v);
+  }
+
+  /// Read a number, Boolean or set literal
+  Expression* scalar() {
+    char c = peek();
+    if (c == '{') {
+      unsigned int firstLine = _line;
+      unsigned int firstColumn = column(_pos);
+      ++_pos;
+      std::vector<Expression*> elems;
+      if (!skipSpace()) {
+        return nullptr;
+      }
+      while (peek() != '}') {
+        Expression* e = number();
+        if (e == nullptr || !skipSpace()) {
+          return nullptr;
+        }
+        elems.push_back(e);
+        if (peek() == ',') {
+          ++_pos;
+          if (!skipSpace()) {
+            return nullptr;
+          }
+        } else if (peek() != '}') {
+          return nullptr;
+        }
+      }
+      finish(1);
+      return new SetLit(location(firstLine, firstColumn), elems);
+    }
+    if (c == '-' || isDigit(c)) {
+      return number();
+    }
+    for (bool b : {true, false}) {
+      const char* lit = b ? "true" : "false";
+      size_t len = b ? 4 : 5;
+      if (_s.compare(_pos, len, lit) == 0 && !isAlpha(peek(len)) && !isDigit(peek(len)) &&
+          peek(len) != '_') {
+        finish(len);
+        return Constants::constants().boollit(b);
+      }
+    }
+    return nullptr;
+  }
+
+  /// Read an array element and the separator following it. Returns false if the element is
+  /// not followed by one of the characters in \a separators.
+  bool element(std::vector<Expression*>& elems, const char* separators) {
+    Expression* e = scalar();
+    if (e == nullptr || !skipSpace() || atEnd() || std::strchr(separators, peek()) == nullptr) {
+      return false;
+    }
+    elems.push_back(e);
+    return true;
+  }
+
+  /// Number of array elements expected before the next closing bracket (an upper bound)
+  size_t sizeHint() const {
+    size_t end = _s.find(']', _pos);
+    if (end == std::string::npos) {
+      return 0;
+    }
+    return std::count(_s.begin() + static_cast<std::ptrdiff_t>(_pos),
+                      _s.begin() + static_cast<std::ptrdiff_t>(end), ',') +
+           1;
+  }
+
+  /// Read a one or two dimensional array literal
+  Expression* array() {
+    unsigned int firstLine = _line;
+    unsigned int firstColumn = column(_pos);
+    std::vector<Expression*> elems;
+    elems.reserve(sizeHint());
+    if (peek(1) != '|') {
+      ++_pos;
+      if (!skipSpace()) {
+        return nullptr;
+      }
+      while (peek() != ']') {
+        if (!element(elems, ",]")) {
+          return nullptr;
+        }
+        if (peek() == ',') {
+          ++_pos;
+          if (!skipSpace()) {
+            return nullptr;
+          }
+        }
+      }
+      finish(1);
+      return new ArrayLit(location(firstLine, firstColumn), elems);
+    }
+    _pos += 2;
+    if (!skipSpace()) {
+      return nullptr;
+    }
+    if (peek() == '|' && peek(1) == ']') {
+      finish(2);
+      return new ArrayLit(location(firstLine, firstColumn),
+                          std::vector<std::vector<Expression*>>());
+    }
+    size_t rows = 0;
+    size_t columns = 0;
+    for (;;) {
+      // Read one row, ending in '|' or '|]'
+      size_t rowStart = elems.size();
+      while (peek() != '|') {
+        if (!element(elems, ",|")) {
+          return nullptr;
+        }
+        if (peek() == ',') {
+          ++_pos;
+          if (!skipSpace()) {
+            return nullptr;
+          }
+        }
+      }
+      size_t rowSize = elems.size() - rowStart;
+      if (rowSize == 0 || (rows > 0 && rowSize != columns)) {
+        // Empty rows and rows of different length are left to the full parser
+        return nullptr;
+      }
+      columns = rowSize;
+      ++rows;
+      if (peek(1) == ']') {
+        finish(2);
+        break;
+      }
+      ++_pos;
+      if (!skipSpace()) {
+        return nullptr;
+      }
+      if (peek() == '|' && peek(1) == ']') {
+        finish(2);
+        break;
+      }
+    }
+    std::vector<std::pair<int, int>> dims = {{1, static_cast<int>(rows)},
+                                             {1, static_cast<int>(columns)}};
+    return new ArrayLit(location(firstLine, firstColumn), elems, dims);
+  }
+
+  /// Read the right hand side of an assignment
+  Expression* value() {
+    if (peek() == '[') {
+      return array();
+    }
+    unsigned int firstLine = _line;
+    unsigned int firstColumn = column(_pos);
+    Expression* e = scalar();
+    if (e == nullptr || !skipSpace()) {
+      return nullptr;
+    }
+    if (peek() == '.' && peek(1) == '.' && Expression::isa<IntLit>(e)) {
+      _pos += 2;
+      if (!skipSpace()) {
+        return nullptr;
+      }
+      Expression* ub = number();
+      if (ub == nullptr || !Expression::isa<IntLit>(ub)) {
+        return nullptr;
+      }
+      return new BinOp(location(firstLine, firstColumn), e, BOT_DOTDOT, ub);
+    }
+    return e;
+  }
+
+public:
+  DznFastReader(const std::string& filename, const std::string& s)
+      : _s(s), _filename(filename) {}
+
+  /// Read all assignments of the file into \a items.
+  /// Returns false if the file has to be parsed by the full parser.
+  bool read(std::vector<AssignI*>& items) {
+    if (_s.find('\0') != std::string::npos) {
+      return false;
+    }
+    for (;;) {
+      if (!skipSpace()) {
+        return false;
+      }
+      if (atEnd()) {
+        return true;
+      }
+      unsigned int firstLine = _line;
+      unsigned int firstColumn = column(_pos);
+      std::string id;
+      if (!identifier(id) || !skipSpace() || peek() != '=') {
+        return false;
+      }
+      ++_pos;
+      if (!skipSpace()) {
+        return false;
+      }
+      Expression* e = value();
+      if (e == nullptr) {
+        return false;
+      }
+      items.push_back(new AssignI(location(firstLine, firstColumn), id, e));
+      if (!skipSpace()) {
+        return false;
+      }
+      if (atEnd()) {
+        return true;
+      }
+      if (peek() != ';') {
+        return false;
+      }
+      ++_pos;
+    }
+  }
+};
+
+}  // namespace
+
 void parse(Env& env, Model*& model, const vector<string>& filenames,
            const vector<string>& datafiles, const std::string& modelString,
            const std::string& modelStringName, const vector<string>& ip,
@@ -287,6 +668,7 @@ void parse(Env& env, Model*& model, const vector<string>& filenames,
 
   for (const auto& f : datafiles) {
     GCLock lock;
+    Location::DataScope dataScope;
     if (f.size() >= 6 && f.substr(f.size() - 5, string::npos) == ".json") {
       JSONParser jp(env.envi());
       jp.parse(model, f, true);
@@ -308,6 +690,15 @@ void parse(Env& env, Model*& model, const vector<string>& filenames,
         s = get_file_contents(file);
       }
 
+      std::vector<AssignI*> assigns;
+      DznFastReader fastReader(f, s);
+      if (fastReader.read(assigns)) {
+        for (auto* ai : assigns) {
+          model->addItem(ai);
+        }
+        continue;
+      }
+
       ParserState pp(f, s, err, includePaths, files, seenModels, model, true, false, false,
                      parseDocComments);
       mzn_yylex_init(&pp.yyscanner);
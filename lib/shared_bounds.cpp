@@ -0,0 +1,244 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/exception.hh>
+#include <minizinc/shared_bounds.hh>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+namespace MiniZinc {
+
+/// Layout of the memory-mapped board. Values are stored as the bit pattern of a double.
+/// The model and run ids identify the run the board belongs to; the run id changes whenever the
+/// board is reset.
+struct SharedBounds::Board {
+  std::atomic<std::uint32_t> magic;
+  std::atomic<std::uint32_t> direction;
+  std::atomic<std::uint64_t> model;
+  std::atomic<std::uint64_t> run;
+  std::atomic<std::uint64_t> incumbent;
+  std::atomic<std::uint64_t> bound;
+  std::atomic<std::uint64_t> updates;
+};
+
+namespace {
+
+const std::uint32_t board_magic = 0x4d5a4e42;  // "MZNB"
+const std::uint32_t board_min = 1;
+const std::uint32_t board_max = 2;
+/// Bit pattern of a quiet NaN, used to mark values that have not been set
+const std::uint64_t board_unset = 0x7ff8000000000000ULL;
+
+std::uint64_t to_bits(double d) {
+  std::uint64_t b;
+  std::memcpy(&b, &d, sizeof(b));
+  return b;
+}
+
+double from_bits(std::uint64_t b) {
+  double d;
+  std::memcpy(&d, &b, sizeof(d));
+  return d;
+}
+
+/// Atomically replace \a slot by \a v if \a v improves on it according to \a improves
+template <class Improves>
+bool update_monotone(std::atomic<std::uint64_t>& slot, double v, Improves improves) {
+  std::uint64_t cur = slot.load();
+  while (cur == board_unset || improves(v, from_bits(cur))) {
+    if (slot.compare_exchange_weak(cur, to_bits(v))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+#ifndef _WIN32
+
+SharedBounds::SharedBounds(const std::string& filename, bool minimize, std::uint64_t model)
+    : _filename(filename), _minimize(minimize), _model(model) {
+  static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+                "shared bounds require lock-free 64 bit atomics");
+  _fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (_fd == -1) {
+    throw Error("Cannot open shared bounds file " + filename + ": " + strerror(errno));
+  }
+
+  // Every user of the board holds a shared lock. If we can get an exclusive lock, nobody else
+  // is using the board, and we (re-)initialise it before downgrading to a shared lock.
+  // Otherwise, we wait for the shared lock, which is only held back while another process
+  // initialises the board. Locks of processes that die are released by the kernel, so a
+  // crashed initialiser cannot block us; the timeout only guards against a stuck one.
+  bool exclusive = flock(_fd, LOCK_EX | LOCK_NB) == 0;
+  if (!exclusive) {
+    int waited = 0;
+    while (flock(_fd, LOCK_SH | LOCK_NB) == -1) {
+      if ((errno != EWOULDBLOCK && errno != EINTR) || waited >= 10000) {
+        int err = errno;
+        release();
+        throw Error("Cannot lock shared bounds file " + filename + ": " +
+                    (err == EWOULDBLOCK ? std::string("timed out") : strerror(err)));
+      }
+      usleep(1000);
+      ++waited;
+    }
+  }
+
+  // Never modify a file that is not a board, only resize an empty one
+  struct stat st;
+  if (fstat(_fd, &st) == -1) {
+    int err = errno;
+    release();
+    throw Error("Cannot access shared bounds file " + filename + ": " + strerror(err));
+  }
+  if (st.st_size == 0 && exclusive) {
+    if (ftruncate(_fd, sizeof(Board)) == -1) {
+      int err = errno;
+      release();
+      throw Error("Cannot resize shared bounds file " + filename + ": " + strerror(err));
+    }
+  } else if (st.st_size != static_cast<off_t>(sizeof(Board))) {
+    release();
+    throw Error("File " + filename + " is not a shared bounds file");
+  }
+  void* mem = mmap(nullptr, sizeof(Board), PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  if (mem == MAP_FAILED) {
+    int err = errno;
+    release();
+    throw Error("Cannot map shared bounds file " + filename + ": " + strerror(err));
+  }
+  _board = static_cast<Board*>(mem);
+  std::uint32_t magic = _board->magic.load();
+  if (magic != board_magic && (magic != 0 || !exclusive)) {
+    // A zero magic number is only valid for a board whose initialiser died
+    release();
+    throw Error("File " + filename + " is not a shared bounds file");
+  }
+
+  std::uint32_t dir = minimize ? board_min : board_max;
+  if (exclusive) {
+    std::random_device rd;
+    std::uint64_t run = (static_cast<std::uint64_t>(rd()) << 32) ^ rd() ^
+                        static_cast<std::uint64_t>(getpid());
+    _board->magic.store(0);
+    _board->run.store(run == 0 ? 1 : run);
+    _board->model.store(model);
+    _board->direction.store(dir);
+    _board->incumbent.store(board_unset);
+    _board->bound.store(board_unset);
+    _board->updates.store(0);
+    _board->magic.store(board_magic);
+    if (flock(_fd, LOCK_SH) == -1) {
+      int err = errno;
+      release();
+      throw Error("Cannot lock shared bounds file " + filename + ": " + strerror(err));
+    }
+  } else if (_board->model.load() != model) {
+    release();
+    throw Error("Shared bounds file " + filename + " is in use for a different model");
+  } else if (_board->direction.load() != dir) {
+    release();
+    throw Error("Shared bounds file " + filename + " is in use for the opposite objective sense");
+  }
+  _run = _board->run.load();
+}
+
+void SharedBounds::release() {
+  if (_board != nullptr) {
+    munmap(_board, sizeof(Board));
+    _board = nullptr;
+  }
+  if (_fd != -1) {
+    // Closing the file releases our lock
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+SharedBounds::~SharedBounds() { release(); }
+
+#else
+
+SharedBounds::SharedBounds(const std::string& filename, bool minimize, std::uint64_t model)
+    : _filename(filename), _minimize(minimize), _model(model) {
+  throw Error("Shared bounds are not supported on this platform");
+}
+
+void SharedBounds::release() {}
+
+SharedBounds::~SharedBounds() {}
+
+#endif
+
+bool SharedBounds::publishIncumbent(double obj) {
+  ++stats.published;
+  bool minimize = _minimize;
+  bool improved = update_monotone(_board->incumbent, obj, [minimize](double v, double cur) {
+    return minimize ? v < cur : v > cur;
+  });
+  if (improved) {
+    ++stats.improved;
+    ++_board->updates;
+  }
+  return improved;
+}
+
+bool SharedBounds::publishBound(double bound) {
+  if (bound != bound) {
+    // NaN means no bound available
+    return false;
+  }
+  bool minimize = _minimize;
+  bool tightened = update_monotone(_board->bound, bound, [minimize](double v, double cur) {
+    return minimize ? v > cur : v < cur;
+  });
+  if (tightened) {
+    ++_board->updates;
+  }
+  return tightened;
+}
+
+bool SharedBounds::incumbent(double& obj) const {
+  std::uint64_t b = _board->incumbent.load();
+  if (b == board_unset) {
+    return false;
+  }
+  obj = from_bits(b);
+  return true;
+}
+
+bool SharedBounds::bound(double& b) const {
+  std::uint64_t v = _board->bound.load();
+  if (v == board_unset) {
+    return false;
+  }
+  b = from_bits(v);
+  return true;
+}
+
+std::uint64_t SharedBounds::hash(const std::string& data, std::uint64_t h) {
+  for (unsigned char c : data) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+}  // namespace MiniZinc
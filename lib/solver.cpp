@@ -26,6 +26,7 @@
 #include <minizinc/param_config.hh>
 #include <minizinc/solver.hh>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
@@ -34,6 +35,7 @@
 #include <iomanip>
 #include <iostream>
 #include <ratio>
+#include <sstream>
 
 #ifdef HAS_OSICBC
 #include <minizinc/solvers/MIP/MIP_osicbc_solverfactory.hh>
@@ -62,6 +64,7 @@
 #ifdef HAS_HIGHS
 #include <minizinc/solvers/MIP/MIP_highs_solverfactory.hh>
 #endif
+#include <minizinc/solvers/MIP/MIP_writer_solverfactory.hh>
 #include <minizinc/solvers/fzn_solverfactory.hh>
 #include <minizinc/solvers/fzn_solverinstance.hh>
 #include <minizinc/solvers/mzn_solverfactory.hh>
@@ -101,6 +104,7 @@ SolverInitialiser::SolverInitialiser() {
 #ifdef HAS_HIGHS
   static HiGHSSolverFactoryInitialiser _highs_init;
 #endif
+  static MIPWriterSolverFactoryInitialiser _mip_writer_init;
   static MZNSolverFactoryInitialiser _mzn_init;
   static NLSolverFactoryInitialiser _nl_init;
 }
@@ -251,6 +255,16 @@ void MznSolver::printHelp(const std::string& selectedSolver) {
       << std::endl
       << "  --solver <solver id>, --solver <solver config file>.msc\n    Select solver to use."
       << std::endl
+      << "  --portfolio <solver id>,<solver id>,...\n    Run several FlatZinc solvers "
+         "concurrently on the\n    same compiled model and report the best solutions found. All "
+         "solvers\n    must use the same solver library."
+      << std::endl
+      << "  --shared-bounds <file>\n    Share objective incumbents and bounds with other solvers "
+         "running\n    on this machine through the given file."
+      << std::endl
+      << "  --warm-start-cache <file>\n    Save the final solution to the given file, and use the "
+         "values\n    saved by a previous run as a warm start (MIP solvers)."
+      << std::endl
       << "  --help <solver id>\n    Print help for a particular solver." << std::endl
       << "  -v, -l, --verbose\n    Print progress/log statements. Note that some solvers may log "
          "to "
@@ -572,6 +586,44 @@ MznSolver::OptionStatus MznSolver::processOptions(std::vector<std::string>& argv
         return OPTION_ERROR;
       }
       solver = argv[i];
+    } else if (argv[i] == "--portfolio") {
+      ++i;
+      if (i == argc) {
+        _log << "Argument required for --portfolio" << endl;
+        return OPTION_ERROR;
+      }
+      std::stringstream ss(argv[i]);
+      std::string member;
+      std::vector<std::string> members;
+      while (std::getline(ss, member, ',')) {
+        if (!member.empty()) {
+          members.push_back(member);
+        }
+      }
+      if (members.empty()) {
+        _log << "Argument required for --portfolio" << endl;
+        return OPTION_ERROR;
+      }
+      if (!solver.empty() && solver != members[0]) {
+        _log << "The first --portfolio solver must match the --solver option" << endl;
+        return OPTION_ERROR;
+      }
+      solver = members[0];
+      _portfolioSolvers.assign(members.begin() + 1, members.end());
+    } else if (argv[i] == "--shared-bounds") {
+      ++i;
+      if (i == argc) {
+        _log << "Argument required for --shared-bounds" << endl;
+        return OPTION_ERROR;
+      }
+      _sharedBoundsFile = FileUtils::file_path(argv[i], workingDirs.back());
+    } else if (argv[i] == "--warm-start-cache") {
+      ++i;
+      if (i == argc) {
+        _log << "Argument required for --warm-start-cache" << endl;
+        return OPTION_ERROR;
+      }
+      _warmStartCacheFile = FileUtils::file_path(argv[i], workingDirs.back());
     } else if (argv[i] == "-c" || argv[i] == "--compile") {
       _isMzn2fzn = true;
     } else if (argv[i] == "-v" || argv[i] == "--verbose" || argv[i] == "-l") {
@@ -780,6 +832,10 @@ MznSolver::OptionStatus MznSolver::processOptions(std::vector<std::string>& argv
               if (!sc.needsSolns2Out()) {
                 additionalArgs.emplace_back("--fzn-output-passthrough");
               }
+              if (sc.supportsFznPipe()) {
+                // Let FznSolverInstance print the FlatZinc while the solver is reading it
+                additionalArgs.emplace_back("--fzn-pipe");
+              }
               int i = 0;
               for (i = 0; i < additionalArgs.size(); ++i) {
                 bool success = _sf->processOption(_siOpt, i, additionalArgs);
@@ -830,6 +886,16 @@ MznSolver::OptionStatus MznSolver::processOptions(std::vector<std::string>& argv
             argv = addedArgs;
             argc = static_cast<int>(addedArgs.size());
           }
+          if (!_portfolioSolvers.empty() && !_isMzn2fzn) {
+            for (const auto& member : _portfolioSolvers) {
+              OptionStatus os = addPortfolioMember(member, sc);
+              if (os != OPTION_OK) {
+                return os;
+              }
+            }
+          }
+          _siOpt->sharedBoundsFile = _sharedBoundsFile;
+          _siOpt->warmStartCacheFile = _warmStartCacheFile;
           break;
         }
       }
@@ -871,7 +937,7 @@ MznSolver::OptionStatus MznSolver::processOptions(std::vector<std::string>& argv
       } else if (cop.get("--disable-all-satisfaction")) {
         _flagAllSatisfaction = false;
       } else if (_sf != nullptr &&
-                 _sf->processOption(_siOpt, i, argv)) {  // NOLINT: Allow repeated empty if
+                 processSolverOption(i, argv)) {  // NOLINT: Allow repeated empty if
         // Processed by Solver Factory
       } else {
         std::string executable_name(argv[0]);
@@ -901,6 +967,123 @@ MznSolver::OptionStatus MznSolver::processOptions(std::vector<std::string>& argv
   return OPTION_OK;
 }
 
+MznSolver::OptionStatus MznSolver::addPortfolioMember(const std::string& solver,
+                                                      const SolverConfig& lead) {
+  // Other solvers can cooperate with a portfolio through --shared-bounds in a separate process
+  if (_sf->getId() != "org.minizinc.mzn-fzn") {
+    _log << "Portfolio solver " << lead.id()
+         << " is not a FlatZinc solver executable. Only FlatZinc solver executables can be run "
+            "in a portfolio; use --shared-bounds to cooperate with other solvers."
+         << endl;
+    return OPTION_ERROR;
+  }
+  const SolverConfig& sc = _solverConfigs.config(solver);
+  if (sc.executable().empty() || sc.supportsMzn() || !sc.supportsFzn()) {
+    _log << "Portfolio solver " << sc.id()
+         << " is not a FlatZinc solver executable. Only FlatZinc solver executables can be run "
+            "in a portfolio; use --shared-bounds to cooperate with other solvers."
+         << endl;
+    return OPTION_ERROR;
+  }
+  if (!sc.needsSolns2Out()) {
+    _log << "Portfolio solver " << sc.id() << " does not produce FlatZinc solution output."
+         << endl;
+    return OPTION_ERROR;
+  }
+  // The model is only flattened once, so all members must agree on the solver library
+  auto library = [](const SolverConfig& c) {
+    return c.mznlibResolved().empty() ? c.mznlib() : c.mznlibResolved();
+  };
+  if (library(sc) != library(lead)) {
+    _log << "Portfolio solvers " << lead.id() << " and " << sc.id()
+         << " use different solver libraries, but the model is only compiled once for all "
+            "members of a portfolio. Run them in separate processes with --shared-bounds instead."
+         << endl;
+    return OPTION_ERROR;
+  }
+
+  PortfolioMember member{_sf->createOptions(), false, false};
+  std::vector<MZNFZNSolverFlag> acceptedFlags;
+  for (const auto& f : sc.stdFlags()) {
+    acceptedFlags.push_back(MZNFZNSolverFlag::std(f));
+    member.supportsA = member.supportsA || f == "-a";
+    member.supportsI = member.supportsI || f == "-i";
+  }
+  for (const auto& ef : sc.extraFlags()) {
+    acceptedFlags.push_back(MZNFZNSolverFlag::extra(ef));
+  }
+  FZNSolverFactory::setAcceptedFlags(member.opt, acceptedFlags);
+  FZNSolverFactory::addPortfolioMember(_siOpt, member.opt);
+
+  std::vector<std::string> additionalArgs;
+  additionalArgs.emplace_back("--fzn-cmd");
+  additionalArgs.push_back(sc.executableResolved().empty() ? sc.executable()
+                                                           : sc.executableResolved());
+  add_flags("--fzn-flag", sc.passFlags(), additionalArgs);
+  if (sc.needsStdlibDir()) {
+    additionalArgs.emplace_back("--fzn-flag");
+    additionalArgs.emplace_back("--stdlib-dir");
+    additionalArgs.emplace_back("--fzn-flag");
+    additionalArgs.push_back(FileUtils::share_directory());
+  }
+  if (sc.needsMznExecutable()) {
+    additionalArgs.emplace_back("--fzn-flag");
+    additionalArgs.emplace_back("--minizinc-exe");
+    additionalArgs.emplace_back("--fzn-flag");
+    additionalArgs.push_back(FileUtils::progpath() + "/" + _executableName);
+  }
+  if (sc.needsPathsFile()) {
+    if (!lead.needsPathsFile()) {
+      _log << "Portfolio solver " << sc.id() << " requires a paths file, but " << lead.id()
+           << " does not. List " << sc.id() << " first." << endl;
+      return OPTION_ERROR;
+    }
+    additionalArgs.emplace_back("--fzn-needs-paths");
+  }
+  for (const auto& df : sc.defaultFlags()) {
+    additionalArgs.push_back(df);
+  }
+  for (int i = 0; i < static_cast<int>(additionalArgs.size()); ++i) {
+    if (!_sf->processOption(member.opt, i, additionalArgs)) {
+      _log << "Solver backend " << sc.id() << " does not recognise option " << additionalArgs[i]
+           << "." << endl;
+      return OPTION_ERROR;
+    }
+  }
+  _portfolio.push_back(member);
+  return OPTION_OK;
+}
+
+bool MznSolver::processSolverOption(int& i, std::vector<std::string>& argv,
+                                    const std::string& workingDir) {
+  int first = i;
+  if (!_sf->processOption(_siOpt, i, argv, workingDir)) {
+    return false;
+  }
+  // Backend flags and executables are specific to the main solver
+  static const std::vector<std::string> leadOnly = {
+      "--fzn-cmd",   "--flatzinc-cmd",   "--fzn-flags",    "--flatzinc-flags", "--backend-flags",
+      "--fzn-flag",  "--flatzinc-flag",  "--backend-flag", "-b",               "--backend",
+      "--solver-backend"};
+  if (std::find(leadOnly.begin(), leadOnly.end(), argv[first]) != leadOnly.end()) {
+    return true;
+  }
+  for (auto& member : _portfolio) {
+    int j = first;
+    if (argv[first] == "-i" && !member.supportsI) {
+      // Fallback to -a if -i is not supported
+      std::vector<std::string> a_flag = {"-a"};
+      int k = 0;
+      if (member.supportsA) {
+        _sf->processOption(member.opt, k, a_flag);
+      }
+    } else if (argv[first] != "-a" || member.supportsA) {
+      _sf->processOption(member.opt, j, argv, workingDir);
+    }
+  }
+  return true;
+}
+
 void MznSolver::flatten(const std::string& modelString, const std::string& modelName) {
   std::exception_ptr exc;
   _flt.setFlagVerbose(flagCompilerVerbose);
@@ -1057,12 +1240,12 @@ SolverInstance::Status MznSolver::run(const std::vector<std::string>& args0,
       std::vector<std::string> timeoutArgs(
           {"--solver-time-limit", std::to_string(time_left.count())});
       int i = 0;
-      _sf->processOption(_siOpt, i, timeoutArgs);
+      processSolverOption(i, timeoutArgs);
     }
     if (flagRandomSeed) {
       std::vector<std::string> randomArgs({"--random-seed", std::to_string(randomSeed)});
       int i = 0;
-      _sf->processOption(_siOpt, i, randomArgs);
+      processSolverOption(i, randomArgs);
     }
   }
 
@@ -1076,7 +1259,7 @@ SolverInstance::Status MznSolver::run(const std::vector<std::string>& args0,
         if (_supportsA) {
           std::vector<std::string> a_flag = {"-a"};
           int i = 0;
-          _sf->processOption(_siOpt, i, a_flag);
+          processSolverOption(i, a_flag);
         } else {
           // Solver does not support -a
           _log << "WARNING: Solver does not support all solutions for satisfaction problems."
@@ -1087,9 +1270,12 @@ SolverInstance::Status MznSolver::run(const std::vector<std::string>& args0,
         std::vector<std::string> i_flag(1);
         i_flag[0] = _supportsI ? "-i" : "-a";  // Fallback to -a if -i is not supported
         int i = 0;
-        _sf->processOption(_siOpt, i, i_flag);
+        processSolverOption(i, i_flag);
       }
 
+      if (!_sharedBoundsFile.empty()) {
+        _siOpt->sharedBoundsModel = _flt.inputHash();
+      }
       // GCLock lock;                  // better locally, to enable cleanup after ProcessFlt()
       addSolverInterface();
       return solve();
@@ -355,6 +355,8 @@ SolverConfig SolverConfig::load(const string& filename) {
             sc._needsStdlibDir = get_bool(ai);
           } else if (ai->id() == "needsPathsFile") {
             sc._needsPathsFile = get_bool(ai);
+          } else if (ai->id() == "supportsFznPipe") {
+            sc._supportsFznPipe = get_bool(ai);
           } else if (ai->id() == "tags") {
             sc._tags = get_string_list(ai);
           } else if (ai->id() == "stdFlags") {
@@ -508,6 +510,7 @@ std::string SolverConfig::toJSON(const SolverConfigs& configs) const {
   oss << "  \"needsMznExecutable\": " << (needsMznExecutable() ? "true" : "false") << ",\n";
   oss << "  \"needsStdlibDir\": " << (needsStdlibDir() ? "true" : "false") << ",\n";
   oss << "  \"needsPathsFile\": " << (needsPathsFile() ? "true" : "false") << ",\n";
+  oss << "  \"supportsFznPipe\": " << (supportsFznPipe() ? "true" : "false") << ",\n";
   oss << "  \"isGUIApplication\": " << (isGUIApplication() ? "true" : "false") << "\n";
   oss << "}";
 
@@ -36,14 +36,16 @@ void Registry::add(const std::string& name, poster p) {
   ASTString str(name);
   return add(str, p);
 }
-void Registry::post(Call* c) {
-  auto it = _registry.find(c->id());
+void Registry::post(Call* c) { lookup(c->id())(_base, c); }
+
+poster Registry::lookup(ASTString name) {
+  auto it = _registry.find(name);
   if (it == _registry.end()) {
     std::ostringstream ss;
-    ss << "Error: solver backend cannot handle constraint: " << c->id();
+    ss << "Error: solver backend cannot handle constraint: " << name;
     throw InternalError(ss.str());
   }
-  it->second(_base, c);
+  return it->second;
 }
 
 void SolverInstanceBase::printSolution() {
@@ -74,13 +76,7 @@ void SolverInstanceBase2::printSolution() {
 //     }
 //   }
 
-void SolverInstanceBase2::assignSolutionToOutput() {
-  GCLock lock;
-
-  MZN_ASSERT_HARD_MSG(
-      nullptr != _pS2Out,
-      "Setup a Solns2Out object to use default solution extraction/reporting procs");
-
+void SolverInstanceBase2::buildOutputPlan() {
   if (_varsWithOutput.empty()) {
     for (VarDeclIterator it = getEnv()->flat()->vardecls().begin();
          it != getEnv()->flat()->vardecls().end(); ++it) {
@@ -96,12 +92,12 @@ void SolverInstanceBase2::assignSolutionToOutput() {
     }
   }
 
-  _pS2Out->declNewOutput();  // Even for empty output decl
-
-  // iterate over set of ids that have an output annotation && obtain their right hand side from the
-  // flat model
+  // The shapes of the output arrays and the declarations of the output model are only looked up
+  // once, and every solution is written into the same arrays
   for (auto* vd : _varsWithOutput) {
-    // std::cout << "DEBUG: Looking at var-decl with output-annotation: " << *vd << std::endl;
+    OutputPlanEntry entry;
+    entry.vd = vd;
+    entry.outputDecl = getSolns2Out()->findOutputVar(vd->id()->str()).first;
     if (Call* output_array_ann = Expression::dynamicCast<Call>(get_annotation(
             Expression::ann(vd), Constants::constants().ann.output_array.aststr()))) {
       assert(vd->e());
@@ -111,26 +107,18 @@ void SolverInstanceBase2::assignSolutionToOutput() {
         ArrayLit& array = *al;
         for (unsigned int j = 0; j < array.size(); j++) {
           if (Id* id = Expression::dynamicCast<Id>(array[j])) {
-            // std::cout << "DEBUG: getting solution value from " << *id  << " : " << id->v() <<
-            // std::endl;
-            array_elems.push_back(getSolutionValue(id));
-          } else if (auto* floatLit = Expression::dynamicCast<FloatLit>(array[j])) {
-            array_elems.push_back(floatLit);
-          } else if (auto* intLit = Expression::dynamicCast<IntLit>(array[j])) {
-            array_elems.push_back(intLit);
-          } else if (auto* boolLit = Expression::dynamicCast<BoolLit>(array[j])) {
-            array_elems.push_back(boolLit);
-          } else if (auto* setLit = Expression::dynamicCast<SetLit>(array[j])) {
-            array_elems.push_back(setLit);
-          } else if (auto* strLit = Expression::dynamicCast<StringLit>(array[j])) {
-            array_elems.push_back(strLit);
+            entry.vars.emplace_back(j, id);
+            array_elems.push_back(id);
+          } else if (Expression::isa<FloatLit>(array[j]) || Expression::isa<IntLit>(array[j]) ||
+                     Expression::isa<BoolLit>(array[j]) || Expression::isa<SetLit>(array[j]) ||
+                     Expression::isa<StringLit>(array[j])) {
+            array_elems.push_back(array[j]);
           } else {
             std::ostringstream oss;
             oss << "Error: array element " << *array[j] << " is not an id nor a literal";
             throw InternalError(oss.str());
           }
         }
-        GCLock lock;
         ArrayLit* dims;
         Expression* e = output_array_ann->arg(0);
         if (auto* al = Expression::dynamicCast<ArrayLit>(e)) {
@@ -150,16 +138,42 @@ void SolverInstanceBase2::assignSolutionToOutput() {
                                 static_cast<int>(isv->max().toInt()));
           }
         }
-        auto* array_solution = new ArrayLit(Location(), array_elems, dims_v);
-        KeepAlive ka(array_solution);
-        auto& de = getSolns2Out()->findOutputVar(vd->id()->str());
-        de.first->e(array_solution);
+        entry.values = new ArrayLit(Location(), array_elems, dims_v);
+      } else {
+        continue;
       }
-    } else if (Expression::ann(vd).contains(Constants::constants().ann.output_var)) {
-      Expression* sol = getSolutionValue(vd->id());
-      vd->e(sol);
-      auto& de = getSolns2Out()->findOutputVar(vd->id()->str());
-      de.first->e(sol);
+    } else if (!Expression::ann(vd).contains(Constants::constants().ann.output_var)) {
+      continue;
+    }
+    _outputPlan.push_back(entry);
+  }
+  _outputPlanReady = true;
+}
+
+void SolverInstanceBase2::assignSolutionToOutput() {
+  GCLock lock;
+
+  MZN_ASSERT_HARD_MSG(
+      nullptr != _pS2Out,
+      "Setup a Solns2Out object to use default solution extraction/reporting procs");
+
+  if (!_outputPlanReady) {
+    buildOutputPlan();
+  }
+
+  _pS2Out->declNewOutput();  // Even for empty output decl
+
+  for (auto& entry : _outputPlan) {
+    if (entry.values() != nullptr) {
+      auto* array_solution = Expression::cast<ArrayLit>(entry.values());
+      for (auto& var : entry.vars) {
+        array_solution->set(var.first, getSolutionValue(var.second));
+      }
+      entry.outputDecl->e(array_solution);
+    } else {
+      Expression* sol = getSolutionValue(entry.vd->id());
+      entry.vd->e(sol);
+      entry.outputDecl->e(sol);
     }
   }
 }
@@ -0,0 +1,421 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/support/regex.hh>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace MiniZinc {
+
+namespace {
+
+/// Nondeterministic automaton over symbol classes, with epsilon transitions
+struct NFA {
+  /// Epsilon successors of each state
+  std::vector<std::vector<int>> eps;
+  /// Pairs of symbol class and successor for each state
+  std::vector<std::vector<std::pair<int, int>>> trans;
+  /// Add a new state
+  int newState() {
+    eps.emplace_back();
+    trans.emplace_back();
+    return static_cast<int>(eps.size()) - 1;
+  }
+};
+
+/// Thompson's construction of an NFA for a regular expression
+class NFABuilder {
+protected:
+  /// The automaton under construction
+  NFA& _nfa;
+  /// The symbol class of each symbol
+  const std::vector<int>& _cls;
+  /// Smallest symbol
+  int _minSymbol;
+  /// Number of symbol classes
+  int _nClasses;
+
+public:
+  NFABuilder(NFA& nfa, const std::vector<int>& cls, int minSymbol, int nClasses)
+      : _nfa(nfa), _cls(cls), _minSymbol(minSymbol), _nClasses(nClasses) {}
+  /// Add states for \a n, return its start and end state
+  std::pair<int, int> build(const RegexNode& n) {
+    switch (n.kind) {
+      case RegexNode::RK_SYMBOLS: {
+        int s = _nfa.newState();
+        int e = _nfa.newState();
+        std::vector<bool> seen(_nClasses, false);
+        for (int sym : n.symbols) {
+          long long idx = static_cast<long long>(sym) - _minSymbol;
+          if (idx >= 0 && idx < static_cast<long long>(_cls.size()) && !seen[_cls[idx]]) {
+            seen[_cls[idx]] = true;
+            _nfa.trans[s].emplace_back(_cls[idx], e);
+          }
+        }
+        return {s, e};
+      }
+      case RegexNode::RK_CONCAT: {
+        auto a = build(*n.children[0]);
+        auto b = build(*n.children[1]);
+        _nfa.eps[a.second].push_back(b.first);
+        return {a.first, b.second};
+      }
+      case RegexNode::RK_UNION: {
+        int s = _nfa.newState();
+        int e = _nfa.newState();
+        for (const auto& c : n.children) {
+          auto a = build(*c);
+          _nfa.eps[s].push_back(a.first);
+          _nfa.eps[a.second].push_back(e);
+        }
+        return {s, e};
+      }
+      case RegexNode::RK_REPEAT: {
+        int s = _nfa.newState();
+        int cur = s;
+        for (int i = 0; i < n.min; i++) {
+          auto a = build(*n.children[0]);
+          _nfa.eps[cur].push_back(a.first);
+          cur = a.second;
+        }
+        int e = _nfa.newState();
+        if (n.max == -1) {
+          auto a = build(*n.children[0]);
+          _nfa.eps[cur].push_back(a.first);
+          _nfa.eps[a.second].push_back(a.first);
+          _nfa.eps[a.second].push_back(e);
+        } else {
+          for (int i = n.min; i < n.max; i++) {
+            auto a = build(*n.children[0]);
+            _nfa.eps[cur].push_back(e);
+            _nfa.eps[cur].push_back(a.first);
+            cur = a.second;
+          }
+        }
+        _nfa.eps[cur].push_back(e);
+        return {s, e};
+      }
+    }
+    return {-1, -1};
+  }
+};
+
+/// Collect the symbol sets of all leaves of \a n
+void collect_leaves(const RegexNode& n, std::vector<const std::vector<int>*>& leaves) {
+  if (n.kind == RegexNode::RK_SYMBOLS) {
+    leaves.push_back(&n.symbols);
+  }
+  for (const auto& c : n.children) {
+    collect_leaves(*c, leaves);
+  }
+}
+
+struct StateSetHash {
+  size_t operator()(const std::vector<int>& v) const {
+    size_t h = v.size();
+    for (int i : v) {
+      h ^= static_cast<size_t>(i) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+  }
+};
+
+}  // namespace
+
+RegexDFA::RegexDFA(const RegexNode& re, int minSymbol, int maxSymbol)
+    : _minSymbol(minSymbol), _nSymbols(std::max(0, maxSymbol - minSymbol + 1)) {
+  // Partition the symbols into classes that no leaf of the expression distinguishes
+  std::vector<int> cls(_nSymbols, 0);
+  int nClasses = _nSymbols == 0 ? 0 : 1;
+  {
+    std::vector<const std::vector<int>*> leaves;
+    collect_leaves(re, leaves);
+    std::vector<bool> in(_nSymbols, false);
+    std::vector<int> remap;
+    for (const auto* leaf : leaves) {
+      for (int sym : *leaf) {
+        long long idx = static_cast<long long>(sym) - minSymbol;
+        if (idx >= 0 && idx < _nSymbols) {
+          in[idx] = true;
+        }
+      }
+      remap.assign(static_cast<size_t>(nClasses) * 2, -1);
+      int next = 0;
+      for (int i = 0; i < _nSymbols; i++) {
+        int& r = remap[cls[i] * 2 + (in[i] ? 1 : 0)];
+        if (r == -1) {
+          r = next++;
+        }
+        cls[i] = r;
+        in[i] = false;
+      }
+      nClasses = next;
+    }
+  }
+
+  // Thompson's construction
+  NFA nfa;
+  NFABuilder builder(nfa, cls, minSymbol, nClasses);
+  auto se = builder.build(re);
+  int nfaFinal = se.second;
+
+  // Subset construction; transitions to the empty set are -1
+  std::vector<std::vector<int>> subsets;
+  std::unordered_map<std::vector<int>, int, StateSetHash> subsetIdx;
+  std::vector<int> dtrans;
+  std::vector<bool> dfinal;
+  std::vector<int> mark(nfa.eps.size(), -1);
+  int stamp = 0;
+  auto closure = [&](std::vector<int>& states) {
+    stamp++;
+    std::vector<int> todo(states);
+    states.clear();
+    for (int s : todo) {
+      mark[s] = stamp;
+    }
+    while (!todo.empty()) {
+      int s = todo.back();
+      todo.pop_back();
+      states.push_back(s);
+      for (int t : nfa.eps[s]) {
+        if (mark[t] != stamp) {
+          mark[t] = stamp;
+          todo.push_back(t);
+        }
+      }
+    }
+    std::sort(states.begin(), states.end());
+  };
+  auto lookup = [&](std::vector<int>& states) {
+    auto it = subsetIdx.find(states);
+    if (it != subsetIdx.end()) {
+      return it->second;
+    }
+    int idx = static_cast<int>(subsets.size());
+    subsetIdx.emplace(states, idx);
+    dfinal.push_back(std::binary_search(states.begin(), states.end(), nfaFinal));
+    subsets.push_back(std::move(states));
+    return idx;
+  };
+  {
+    std::vector<int> start({se.first});
+    closure(start);
+    lookup(start);
+  }
+  std::vector<std::vector<int>> buckets(nClasses);
+  for (size_t d = 0; d < subsets.size(); d++) {
+    for (int s : subsets[d]) {
+      for (const auto& t : nfa.trans[s]) {
+        buckets[t.first].push_back(t.second);
+      }
+    }
+    dtrans.resize((d + 1) * nClasses, -1);
+    for (int c = 0; c < nClasses; c++) {
+      if (!buckets[c].empty()) {
+        std::vector<int> next;
+        next.swap(buckets[c]);
+        closure(next);
+        dtrans[d * nClasses + c] = lookup(next);
+      }
+    }
+  }
+  subsetIdx.clear();
+  subsets.clear();
+
+  // Complete the automaton with a dead state if necessary
+  int n = static_cast<int>(dfinal.size());
+  if (std::find(dtrans.begin(), dtrans.end(), -1) != dtrans.end()) {
+    for (int& t : dtrans) {
+      if (t == -1) {
+        t = n;
+      }
+    }
+    dtrans.resize(static_cast<size_t>(n + 1) * nClasses, n);
+    dfinal.push_back(false);
+    n++;
+  }
+
+  // Hopcroft's minimisation. The states of each block are stored contiguously in elems.
+  std::vector<int> elems(n);
+  std::vector<int> loc(n);
+  std::vector<int> blockOf(n);
+  std::vector<int> blockStart;
+  std::vector<int> blockEnd;
+  {
+    int nf = 0;
+    for (int s = 0; s < n; s++) {
+      if (dfinal[s]) {
+        nf++;
+      }
+    }
+    int fi = 0;
+    int ni = nf;
+    for (int s = 0; s < n; s++) {
+      int pos = dfinal[s] ? fi++ : ni++;
+      elems[pos] = s;
+      loc[s] = pos;
+    }
+    if (nf > 0) {
+      blockStart.push_back(0);
+      blockEnd.push_back(nf);
+    }
+    if (nf < n) {
+      blockStart.push_back(nf);
+      blockEnd.push_back(n);
+    }
+    for (int b = 0; b < static_cast<int>(blockStart.size()); b++) {
+      for (int i = blockStart[b]; i < blockEnd[b]; i++) {
+        blockOf[elems[i]] = b;
+      }
+    }
+  }
+  // Predecessors for each class, in compressed row format
+  std::vector<int> predStart(static_cast<size_t>(nClasses) * (n + 1), 0);
+  std::vector<int> preds(static_cast<size_t>(nClasses) * n);
+  for (int c = 0; c < nClasses; c++) {
+    int* start = &predStart[static_cast<size_t>(c) * (n + 1)];
+    for (int s = 0; s < n; s++) {
+      start[dtrans[s * nClasses + c] + 1]++;
+    }
+    for (int s = 0; s < n; s++) {
+      start[s + 1] += start[s];
+    }
+    std::vector<int> fill(start, start + n);
+    for (int s = 0; s < n; s++) {
+      preds[static_cast<size_t>(c) * n + fill[dtrans[s * nClasses + c]]++] = s;
+    }
+  }
+  std::vector<std::pair<int, int>> work;
+  std::vector<bool> inWork;
+  if (blockStart.size() == 2) {
+    int smaller = blockEnd[0] - blockStart[0] <= blockEnd[1] - blockStart[1] ? 0 : 1;
+    inWork.assign(2 * static_cast<size_t>(nClasses), false);
+    for (int c = 0; c < nClasses; c++) {
+      work.emplace_back(smaller, c);
+      inWork[smaller * nClasses + c] = true;
+    }
+  }
+  std::vector<int> marked(blockStart.size(), 0);
+  std::vector<int> touched;
+  std::vector<int> splitter;
+  while (!work.empty()) {
+    int b = work.back().first;
+    int c = work.back().second;
+    work.pop_back();
+    inWork[b * nClasses + c] = false;
+    splitter.assign(elems.begin() + blockStart[b], elems.begin() + blockEnd[b]);
+    const int* start = &predStart[static_cast<size_t>(c) * (n + 1)];
+    const int* pc = &preds[static_cast<size_t>(c) * n];
+    for (int t : splitter) {
+      for (int i = start[t]; i < start[t + 1]; i++) {
+        int p = pc[i];
+        int pb = blockOf[p];
+        if (marked[pb] == 0) {
+          touched.push_back(pb);
+        }
+        // Move p to the marked part at the front of its block
+        int pos = blockStart[pb] + marked[pb]++;
+        int q = elems[pos];
+        elems[pos] = p;
+        elems[loc[p]] = q;
+        loc[q] = loc[p];
+        loc[p] = pos;
+      }
+    }
+    for (int pb : touched) {
+      int m = marked[pb];
+      marked[pb] = 0;
+      if (m == blockEnd[pb] - blockStart[pb]) {
+        continue;
+      }
+      // Split off the marked part as a new block
+      int nb = static_cast<int>(blockStart.size());
+      blockStart.push_back(blockStart[pb]);
+      blockEnd.push_back(blockStart[pb] + m);
+      blockStart[pb] += m;
+      marked.push_back(0);
+      inWork.resize(inWork.size() + nClasses, false);
+      for (int i = blockStart[nb]; i < blockEnd[nb]; i++) {
+        blockOf[elems[i]] = nb;
+      }
+      int smaller = m <= blockEnd[pb] - blockStart[pb] ? nb : pb;
+      for (int a = 0; a < nClasses; a++) {
+        if (inWork[pb * nClasses + a]) {
+          work.emplace_back(nb, a);
+          inWork[nb * nClasses + a] = true;
+        } else {
+          work.emplace_back(smaller, a);
+          inWork[smaller * nClasses + a] = true;
+        }
+      }
+    }
+    touched.clear();
+  }
+
+  // Number the blocks in breadth-first order from the start state, leaving out the dead block
+  int nBlocks = static_cast<int>(blockStart.size());
+  auto blockTrans = [&](int blk, int c) {
+    return blockOf[dtrans[elems[blockStart[blk]] * nClasses + c]];
+  };
+  auto isDead = [&](int blk) {
+    if (dfinal[elems[blockStart[blk]]]) {
+      return false;
+    }
+    for (int c = 0; c < nClasses; c++) {
+      if (blockTrans(blk, c) != blk) {
+        return false;
+      }
+    }
+    return true;
+  };
+  int startBlock = blockOf[0];
+  std::vector<int> order;
+  std::vector<int> number(nBlocks, 0);
+  if (!isDead(startBlock)) {
+    std::vector<bool> seen(nBlocks, false);
+    seen[startBlock] = true;
+    order.push_back(startBlock);
+    for (size_t i = 0; i < order.size(); i++) {
+      for (int c = 0; c < nClasses; c++) {
+        int t = blockTrans(order[i], c);
+        if (!seen[t]) {
+          seen[t] = true;
+          if (!isDead(t)) {
+            order.push_back(t);
+          }
+        }
+      }
+    }
+    // Keep the start state first and the final states contiguous
+    bool startFinal = dfinal[elems[blockStart[startBlock]]];
+    std::stable_partition(order.begin() + 1, order.end(), [&](int blk) {
+      return dfinal[elems[blockStart[blk]]] == startFinal;
+    });
+  }
+  _nStates = std::max(1, static_cast<int>(order.size()));
+  _finalFirst = 1;
+  _finalLast = 0;
+  for (int i = 0; i < static_cast<int>(order.size()); i++) {
+    number[order[i]] = i + 1;
+    if (dfinal[elems[blockStart[order[i]]]]) {
+      if (_finalLast == 0) {
+        _finalFirst = i + 1;
+      }
+      _finalLast = i + 1;
+    }
+  }
+
+  _table.assign(static_cast<size_t>(_nStates) * _nSymbols, 0);
+  for (int i = 0; i < static_cast<int>(order.size()); i++) {
+    for (int sym = 0; sym < _nSymbols; sym++) {
+      _table[static_cast<size_t>(i) * _nSymbols + sym] = number[blockTrans(order[i], cls[sym])];
+    }
+  }
+}
+
+}  // namespace MiniZinc
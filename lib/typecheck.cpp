@@ -28,6 +28,65 @@
 
 namespace MiniZinc {
 
+uintptr_t Scopes::DeclMap::key(const Id* ident) {
+  long long int idn = ident->idn();
+  if (idn == -1) {
+    return reinterpret_cast<uintptr_t>(ident->v().aststr());
+  }
+  // Interned strings are aligned, so odd keys cannot clash with them
+  return (static_cast<uintptr_t>(idn) << 1) | static_cast<uintptr_t>(1);
+}
+
+size_t Scopes::DeclMap::slot(uintptr_t key) const {
+  uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(h >> 32) & (_t.size() - 1);
+}
+
+void Scopes::DeclMap::resize(size_t n) {
+  std::vector<Entry> old(n, Entry{0, nullptr});
+  old.swap(_t);
+  for (const auto& e : old) {
+    if (e.vd != nullptr) {
+      size_t i = slot(e.key);
+      while (_t[i].vd != nullptr) {
+        i = (i + 1) & (_t.size() - 1);
+      }
+      _t[i] = e;
+    }
+  }
+}
+
+VarDecl* Scopes::DeclMap::find(const Id* ident) const {
+  if (_size == 0) {
+    return nullptr;
+  }
+  uintptr_t k = key(ident);
+  for (size_t i = slot(k);; i = (i + 1) & (_t.size() - 1)) {
+    if (_t[i].vd == nullptr) {
+      return nullptr;
+    }
+    if (_t[i].key == k) {
+      return _t[i].vd;
+    }
+  }
+}
+
+VarDecl* Scopes::DeclMap::insert(VarDecl* vd) {
+  if ((_size + 1) * 4 > _t.size() * 3) {
+    resize(_t.empty() ? 8 : _t.size() * 2);
+  }
+  uintptr_t k = key(vd->id());
+  size_t i = slot(k);
+  for (; _t[i].vd != nullptr; i = (i + 1) & (_t.size() - 1)) {
+    if (_t[i].key == k) {
+      return _t[i].vd;
+    }
+  }
+  _t[i] = Entry{k, vd};
+  _size++;
+  return nullptr;
+}
+
 Scopes::Scopes() { _s.emplace_back(ST_TOPLEVEL); }
 
 void Scopes::add(EnvI& env, VarDecl* vd) {
@@ -42,11 +101,11 @@ void Scopes::add(EnvI& env, VarDecl* vd) {
   if (_s.back().st == ST_INNER) {
     assert(_s.size() > 1);  // at least toplevel scope above
     for (int i = static_cast<int>(_s.size()) - 2; i >= 0; i--) {
-      auto previous = _s[i].m.find(vd->id());
-      if (previous != _s[i].m.end()) {
+      VarDecl* previous = _s[i].m.find(vd->id());
+      if (previous != nullptr) {
         std::ostringstream oss;
-        unsigned int earlier_l = Expression::loc(previous->second->id()).firstLine();
-        unsigned int earlier_c = Expression::loc(previous->second->id()).firstColumn();
+        unsigned int earlier_l = Expression::loc(previous->id()).firstLine();
+        unsigned int earlier_c = Expression::loc(previous->id()).firstColumn();
         oss << "variable `" << *vd->id() << "` shadows variable with the same name in line "
             << earlier_l << "." << earlier_c;
         env.addWarning(Expression::loc(vd), oss.str(), false);
@@ -58,10 +117,7 @@ void Scopes::add(EnvI& env, VarDecl* vd) {
     }
   }
 
-  auto vdi = _s.back().m.find(vd->id());
-  if (vdi == _s.back().m.end()) {
-    _s.back().m.insert(vd->id(), vd);
-  } else if (vd->id()->idn() >= -1) {
+  if (_s.back().m.insert(vd) != nullptr && vd->id()->idn() >= -1) {
     GCLock lock;
     std::ostringstream ss;
     ss << "identifier `" << vd->id()->str() << "' already defined";
@@ -80,8 +136,8 @@ void Scopes::pop() { _s.pop_back(); }
 VarDecl* Scopes::find(Id* ident) {
   int cur = static_cast<int>(_s.size()) - 1;
   for (;;) {
-    auto vdi = _s[cur].m.find(ident);
-    if (vdi == _s[cur].m.end()) {
+    VarDecl* vd = _s[cur].m.find(ident);
+    if (vd == nullptr) {
       if (_s[cur].toplevel()) {
         if (cur > 0) {
           cur = 0;
@@ -92,7 +148,7 @@ VarDecl* Scopes::find(Id* ident) {
         cur--;
       }
     } else {
-      return vdi->second;
+      return vd;
     }
   }
 }
@@ -102,12 +158,16 @@ VarDecl* Scopes::findSimilar(Id* ident) {
   int cur = static_cast<int>(_s.size()) - 1;
   int minEdits = 3;
   for (;;) {
-    for (auto decls : _s[cur].m) {
-      int edits = ident->levenshteinDistance(decls.first);
+    for (const auto& entry : _s[cur].m.entries()) {
+      if (entry.vd == nullptr) {
+        continue;
+      }
+      Id* other = entry.vd->id();
+      int edits = ident->levenshteinDistance(other);
       if (edits < minEdits && std::abs(static_cast<int>(ident->v().size()) -
-                                       static_cast<int>(decls.first->v().size())) <= 3) {
+                                       static_cast<int>(other->v().size())) <= 3) {
         minEdits = edits;
-        mostSimilar = decls.second;
+        mostSimilar = entry.vd;
       }
     }
     if (_s[cur].toplevel()) {
@@ -125,30 +185,14 @@ VarDecl* Scopes::findSimilar(Id* ident) {
 
 class VarDeclCmp {
 private:
-  std::unordered_map<VarDecl*, int>& _pos;
+  const TopoSorter& _ts;
 
 public:
-  VarDeclCmp(std::unordered_map<VarDecl*, int>& pos) : _pos(pos) {}
+  VarDeclCmp(const TopoSorter& ts) : _ts(ts) {}
   bool operator()(Expression* e0, Expression* e1) {
     if (auto* vd0 = Expression::dynamicCast<VarDecl>(e0)) {
       if (auto* vd1 = Expression::dynamicCast<VarDecl>(e1)) {
-        return _pos[vd0] < _pos[vd1];
-      }
-      return true;
-    }
-    return false;
-  }
-};
-class ItemCmp {
-private:
-  std::unordered_map<VarDecl*, int>& _pos;
-
-public:
-  ItemCmp(std::unordered_map<VarDecl*, int>& pos) : _pos(pos) {}
-  bool operator()(Item* i0, Item* i1) {
-    if (auto* vd0 = i0->cast<VarDeclI>()) {
-      if (auto* vd1 = i1->cast<VarDeclI>()) {
-        return _pos[vd0->e()] < _pos[vd1->e()];
+        return _ts.position(vd0) < _ts.position(vd1);
       }
       return true;
     }
@@ -1155,30 +1199,98 @@ VarDecl* TopoSorter::checkId(EnvI& env, Id* ident, const Location& loc) {
     }
     throw TypeError(env, loc, ss.str());
   }
-  auto pi = pos.find(decl);
-  if (pi == pos.end()) {
-    // new id
-    scopes.pushToplevel();
-    run(env, decl);
-    scopes.pop();
-  } else {
-    // previously seen, check if circular
-    if (pi->second == -1) {
+  if (position(decl) == -1) {
+    if (active(decl)) {
       std::ostringstream ss;
       ss << "circular definition of `" << ident->str() << "'";
       throw TypeError(env, loc, ss.str());
     }
+    // new id, sorted once the current declaration has been visited
+    _pending.push_back(decl);
   }
   return decl;
 }
 
+void TopoSorter::start(VarDecl* vd) {
+  vd->payload(-static_cast<int>(_active.size()) - 1);
+  _active.push_back(vd);
+}
+
+void TopoSorter::finish(VarDecl* vd) {
+  assert(!_active.empty() && _active.back() == vd);
+  _active.pop_back();
+  vd->payload(static_cast<int>(decls.size()));
+  decls.emplace_back(vd);
+}
+
+void TopoSorter::visitDecl(EnvI& env, VarDecl* vd) {
+  visit(env, vd->ti());
+  visit(env, vd->e());
+  for (auto it = Expression::ann(vd).begin(); it != Expression::ann(vd).end(); ++it) {
+    visit(env, *it);
+  }
+}
+
+void TopoSorter::sortPending(EnvI& env, size_t first, VarDecl* vd) {
+  // A declaration can be finished once all declarations it references (the
+  // pending declarations from index begin on) have been sorted
+  struct Frame {
+    VarDecl* vd;
+    size_t begin;
+    size_t next;
+  };
+  std::vector<Frame> stack;
+  stack.push_back({vd, first, first});
+  while (!stack.empty()) {
+    Frame& f = stack.back();
+    if (f.next == _pending.size()) {
+      if (f.vd != nullptr) {
+        finish(f.vd);
+      }
+      _pending.resize(f.begin);
+      stack.pop_back();
+      continue;
+    }
+    VarDecl* decl = _pending[f.next++];
+    if (position(decl) != -1) {
+      continue;
+    }
+    // All active declarations were already active when decl was referenced
+    assert(!active(decl));
+    size_t begin = _pending.size();
+    start(decl);
+    scopes.pushToplevel();
+    visitDecl(env, decl);
+    scopes.pop();
+    stack.push_back({decl, begin, begin});
+  }
+}
+
 void TopoSorter::run(EnvI& env, Expression* e) {
+  if (e == nullptr) {
+    return;
+  }
+  assert(_active.empty() && _pending.empty());
+  auto* vd = Expression::dynamicCast<VarDecl>(e);
+  if (vd != nullptr) {
+    if (position(vd) != -1) {
+      return;
+    }
+    start(vd);
+    visitDecl(env, vd);
+  } else {
+    visit(env, e);
+  }
+  sortPending(env, 0, vd);
+}
+
+void TopoSorter::visit(EnvI& env, Expression* e) {
   if (e == nullptr) {
     return;
   }
   if (Expression::eid(e) != Expression::E_VARDECL) {
     for (auto it = Expression::ann(e).begin(); it != Expression::ann(e).end(); ++it) {
-      run(env, *it);
+      visit(env, *it);
     }
   }
   switch (Expression::eid(e)) {
@@ -1192,7 +1304,7 @@ void TopoSorter::run(EnvI& env, Expression* e) {
       auto* sl = Expression::cast<SetLit>(e);
       if (sl->isv() == nullptr && sl->fsv() == nullptr) {
         for (unsigned int i = 0; i < sl->v().size(); i++) {
-          run(env, sl->v()[i]);
+          visit(env, sl->v()[i]);
         }
       }
     } break;
@@ -1205,44 +1317,44 @@ void TopoSorter::run(EnvI& env, Expression* e) {
     case Expression::E_ARRAYLIT: {
       auto* al = Expression::cast<ArrayLit>(e);
       for (unsigned int i = 0; i < al->size(); i++) {
-        run(env, (*al)[i]);
+        visit(env, (*al)[i]);
       }
     } break;
     case Expression::E_ARRAYACCESS: {
       auto* ae = Expression::cast<ArrayAccess>(e);
-      run(env, ae->v());
+      visit(env, ae->v());
       for (unsigned int i = 0; i < ae->idx().size(); i++) {
-        run(env, ae->idx()[i]);
+        visit(env, ae->idx()[i]);
       }
     } break;
     case Expression::E_FIELDACCESS: {
       auto* fa = Expression::cast<FieldAccess>(e);
-      run(env, fa->v());
+      visit(env, fa->v());
       // IGNORE fa->field(), must be IntLit or field identifier (checked later)
     } break;
     case Expression::E_COMP: {
       auto* ce = Expression::cast<Comprehension>(e);
       scopes.push();
       for (int i = 0; i < ce->numberOfGenerators(); i++) {
-        run(env, ce->in(i));
+        visit(env, ce->in(i));
         for (int j = 0; j < ce->numberOfDecls(i); j++) {
-          run(env, ce->decl(i, j));
+          visit(env, ce->decl(i, j));
           scopes.add(env, ce->decl(i, j));
         }
         if (ce->where(i) != nullptr) {
-          run(env, ce->where(i));
+          visit(env, ce->where(i));
         }
       }
-      run(env, ce->e());
+      visit(env, ce->e());
       scopes.pop();
     } break;
     case Expression::E_ITE: {
       ITE* ite = Expression::cast<ITE>(e);
       for (int i = 0; i < ite->size(); i++) {
-        run(env, ite->ifExpr(i));
-        run(env, ite->thenExpr(i));
+        visit(env, ite->ifExpr(i));
+        visit(env, ite->thenExpr(i));
       }
-      run(env, ite->elseExpr());
+      visit(env, ite->elseExpr());
     } break;
     case Expression::E_BINOP: {
       auto* be = Expression::cast<BinOp>(e);
@@ -1257,47 +1369,38 @@ void TopoSorter::run(EnvI& env, Expression* e) {
           todo.push_back(e_bo->rhs());
           for (ExpressionSetIter it = Expression::ann(e_bo).begin();
                it != Expression::ann(e_bo).end(); ++it) {
-            run(env, *it);
+            visit(env, *it);
           }
         } else {
-          run(env, be);
+          visit(env, be);
         }
       }
     } break;
     case Expression::E_UNOP: {
       UnOp* ue = Expression::cast<UnOp>(e);
-      run(env, ue->e());
+      visit(env, ue->e());
     } break;
     case Expression::E_CALL: {
       Call* ce = Expression::cast<Call>(e);
       for (unsigned int i = 0; i < ce->argCount(); i++) {
-        run(env, ce->arg(i));
+        visit(env, ce->arg(i));
       }
     } break;
     case Expression::E_VARDECL: {
       auto* ve = Expression::cast<VarDecl>(e);
-      auto pi = pos.find(ve);
-      if (pi == pos.end()) {
-        pos.insert(std::pair<VarDecl*, int>(ve, -1));
-        run(env, ve->ti());
-        run(env, ve->e());
-        for (auto it = Expression::ann(e).begin(); it != Expression::ann(e).end(); ++it) {
-          run(env, *it);
-        }
-        ve->payload(static_cast<int>(decls.size()));
-        decls.emplace_back(ve);
-        pi = pos.find(ve);
-        pi->second = static_cast<int>(decls.size()) - 1;
-      } else {
-        assert(pi->second != -1);
+      if (position(ve) == -1) {
+        assert(!active(ve));
+        start(ve);
+        visitDecl(env, ve);
+        finish(ve);
       }
     } break;
     case Expression::E_TI: {
       auto* ti = Expression::cast<TypeInst>(e);
       for (unsigned int i = 0; i < ti->ranges().size(); i++) {
-        run(env, ti->ranges()[i]);
+        visit(env, ti->ranges()[i]);
       }
-      run(env, ti->domain());
+      visit(env, ti->domain());
     } break;
     case Expression::E_TIID:
       break;
@@ -1305,13 +1408,13 @@ void TopoSorter::run(EnvI& env, Expression* e) {
       Let* let = Expression::cast<Let>(e);
       scopes.push();
       for (unsigned int i = 0; i < let->let().size(); i++) {
-        run(env, let->let()[i]);
+        visit(env, let->let()[i]);
         if (auto* vd = Expression::dynamicCast<VarDecl>(let->let()[i])) {
           scopes.add(env, vd);
         }
       }
-      run(env, let->in());
-      VarDeclCmp poscmp(pos);
+      visit(env, let->in());
+      VarDeclCmp poscmp(*this);
       std::stable_sort(let->let().begin(), let->let().end(), poscmp);
       for (unsigned int i = 0, j = 0; i < let->let().size(); i++) {
         if (auto* vd = Expression::dynamicCast<VarDecl>(let->let()[i])) {
@@ -1327,9 +1430,16 @@ void TopoSorter::run(EnvI& env, Expression* e) {
   if (env.ignoreUnknownIds) {
     std::vector<Expression*> toDelete;
     for (ExpressionSetIter it = Expression::ann(e).begin(); it != Expression::ann(e).end(); ++it) {
+      size_t nActive = _active.size();
+      size_t nPending = _pending.size();
       try {
-        run(env, *it);
+        visit(env, *it);
       } catch (TypeError&) {
+        for (size_t i = nActive; i < _active.size(); i++) {
+          _active[i]->payload(0);
+        }
+        _active.resize(nActive);
+        _pending.resize(nPending);
         toDelete.push_back(*it);
       }
       for (Expression* de : toDelete) {
@@ -1338,7 +1448,7 @@ void TopoSorter::run(EnvI& env, Expression* e) {
     }
   } else {
     for (ExpressionSetIter it = Expression::ann(e).begin(); it != Expression::ann(e).end(); ++it) {
-      run(env, *it);
+      visit(env, *it);
     }
   }
 }
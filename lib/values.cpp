@@ -11,6 +11,7 @@
 
 #include <minizinc/values.hh>
 
+#include <cassert>
 #include <climits>
 
 namespace MiniZinc {
@@ -19,6 +20,78 @@ IntVal IntVal::minint() { return IntVal(std::numeric_limits<long long int>::min(
 IntVal IntVal::maxint() { return IntVal(std::numeric_limits<long long int>::max()); }
 IntVal IntVal::infinity() { return IntVal(1, true); }
 
+void IntVal::overflow() { throw ArithmeticError("integer overflow"); }
+void IntVal::infiniteOperand() {
+  throw ArithmeticError("arithmetic operation on infinite value");
+}
+
+// The bulk operations below first compute their result without any branches, only recording
+// whether an operation overflowed or a value was infinite. Only in that case the result is
+// computed again using the checked operators, which then report the error (or handle the
+// infinite values) exactly like a loop over the individual operations would.
+
+IntVal IntVal::sum(const std::vector<IntVal>& x) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+  long long int acc = 0;
+  bool fail = false;
+  for (const auto& v : x) {
+    fail |= __builtin_add_overflow(acc, v._v, &acc);
+    fail |= v._infinity;
+  }
+  if (!fail) {
+    return acc;
+  }
+#endif
+  IntVal r = 0;
+  for (const auto& v : x) {
+    r += v;
+  }
+  return r;
+}
+
+IntVal IntVal::linear(const IntVal* c, const IntVal* x, size_t n, IntVal d) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+  long long int acc = d._v;
+  bool fail = d._infinity;
+  for (size_t i = 0; i < n; i++) {
+    long long int p;
+    fail |= __builtin_mul_overflow(c[i]._v, x[i]._v, &p);
+    fail |= p == std::numeric_limits<long long int>::min();
+    fail |= __builtin_add_overflow(acc, p, &acc);
+    fail |= c[i]._infinity | x[i]._infinity;
+  }
+  if (!fail) {
+    return acc;
+  }
+#endif
+  IntVal r = d;
+  for (size_t i = 0; i < n; i++) {
+    r += c[i] * x[i];
+  }
+  return r;
+}
+
+void IntVal::scale(std::vector<IntVal>& x, const IntVal& c) {
+#ifdef MZN_HAS_OVERFLOW_BUILTINS
+  bool fail = c._infinity;
+  for (const auto& v : x) {
+    long long int p;
+    fail |= __builtin_mul_overflow(v._v, c._v, &p);
+    fail |= p == std::numeric_limits<long long int>::min();
+    fail |= v._infinity;
+  }
+  if (!fail) {
+    for (auto& v : x) {
+      v._v *= c._v;
+    }
+    return;
+  }
+#endif
+  for (auto& v : x) {
+    v = v * c;
+  }
+}
+
 IntSetVal::IntSetVal(IntVal m, IntVal n) : ASTChunk(sizeof(Range)) {
   get(0).min = m;
   get(0).max = n;
@@ -586,6 +586,12 @@ bool MIPGurobiWrapper::addWarmStart(const std::vector<VarId>& vars,
   return true;
 }
 
+bool MIPGurobiWrapper::setObjCutoff(double cutoff) {
+  _error = dll_GRBsetdblparam(dll_GRBgetenv(_model), "Cutoff", cutoff);
+  wrapAssert(_error == 0, "Failed to set objective cutoff", false);
+  return _error == 0;
+}
+
 bool MIPGurobiWrapper::defineMultipleObjectives(const MultipleObjectives& mo) {
   setObjSense(1);  // Maximize
   for (int iobj = 0; iobj < mo.size(); ++iobj) {
@@ -20,14 +20,34 @@
 #endif
 
 #include <minizinc/algorithms/min_cut.h>
+#include <minizinc/file_utils.hh>
+#include <minizinc/pathfileprinter.hh>
 #include <minizinc/solvers/MIP/MIP_solverinstance.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX  // Ensure the words min/max remain available
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -75,6 +95,205 @@ int get_mask_cons_type(const Call* call) {
 
 using namespace MiniZinc;
 
+std::unordered_map<VarDecl*, std::string> WarmStartCache::keys(EnvI& env, Model* flat) {
+  std::unordered_map<VarDecl*, std::string> keys;
+  std::ostringstream unused;
+  PathFilePrinter pfp(unused, env);
+  const auto& names = pfp.names(flat);
+  for (auto& vdi : flat->vardecls()) {
+    VarDecl* vd = vdi.e();
+    if (vdi.removed() || vd->type().dim() != 0 || !vd->type().isvar()) {
+      continue;
+    }
+    auto it = names.find(vd->id());
+    if (it != names.end() && !it->second.first.empty() &&
+        it->second.first.find('?') == std::string::npos) {
+      // Element of an output array, or complete name derived from the path
+      keys.emplace(vd, it->second.first);
+    } else if (vd->id()->idn() == -1) {
+      keys.emplace(vd, std::string(vd->id()->str().c_str(), vd->id()->str().size()));
+    } else if (it != names.end() && !it->second.second.empty()) {
+      keys.emplace(vd, it->second.second);
+    }
+  }
+  return keys;
+}
+
+bool WarmStartCache::read(const std::string& filename,
+                          std::unordered_map<std::string, double>& values) {
+  std::ifstream ifs(FILE_PATH(filename));
+  if (!ifs.good()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(ifs, line)) {
+    size_t tab = line.rfind('\t');
+    if (tab == std::string::npos) {
+      continue;
+    }
+    std::istringstream iss(line.substr(tab + 1));
+    double v;
+    if (iss >> v) {
+      values[line.substr(0, tab)] = v;
+    }
+  }
+  return true;
+}
+
+void WarmStartCache::write(const std::string& filename,
+                           const std::vector<std::pair<std::string, double> >& values) {
+  std::ostringstream oss;
+  oss << std::setprecision(17);
+  for (const auto& v : values) {
+    oss << v.first << '\t' << v.second << '\n';
+  }
+  std::string contents = oss.str();
+  // Write to a unique temporary file in the same directory first, and rename it over the
+  // cache, so that concurrent or interrupted runs never see a partial cache
+#ifdef _WIN32
+  std::wstring dir = FileUtils::utf8_to_wide(FileUtils::dir_name(filename));
+  WCHAR tmpName[MAX_PATH];
+  if (GetTempFileNameW(dir.empty() ? L"." : dir.c_str(), L"mzn", 0, tmpName) == 0) {
+    throw Error("cannot create temporary file for warm start cache " + filename);
+  }
+  {
+    std::ofstream ofs(tmpName, std::ios::binary);
+    ofs << contents;
+    if (!ofs.good()) {
+      _wremove(tmpName);
+      throw Error("cannot write warm start cache file " + filename);
+    }
+  }
+  if (MoveFileExW(tmpName, FileUtils::utf8_to_wide(filename).c_str(),
+                  MOVEFILE_REPLACE_EXISTING) == 0) {
+    _wremove(tmpName);
+    throw Error("cannot write warm start cache file " + filename);
+  }
+#else
+  std::string tmpl = filename + ".XXXXXX";
+  std::vector<char> tmpName(tmpl.begin(), tmpl.end());
+  tmpName.push_back('\0');
+  int fd = mkstemp(tmpName.data());
+  if (fd == -1) {
+    throw Error("cannot create temporary file for warm start cache " + filename + ": " +
+                strerror(errno));
+  }
+  size_t written = 0;
+  while (written < contents.size()) {
+    ssize_t n = ::write(fd, contents.data() + written, contents.size() - written);
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    written += static_cast<size_t>(n);
+  }
+  // mkstemp creates the file for the owner only, keep the permissions of an existing cache
+  struct stat st;
+  mode_t mode = stat(filename.c_str(), &st) == 0 ? st.st_mode & 0777 : 0644;
+  bool ok = written == contents.size() && fchmod(fd, mode) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok || std::rename(tmpName.data(), filename.c_str()) != 0) {
+    std::remove(tmpName.data());
+    throw Error("cannot write warm start cache file " + filename);
+  }
+#endif
+}
+
+size_t CutPool::hash(const MIPWrapper::CutDef& cut) {
+  size_t h = std::hash<int>()(cut.sense) * 31 + std::hash<double>()(cut.rhs);
+  for (size_t i = 0; i < cut.rmatind.size(); ++i) {
+    h = h * 31 + std::hash<int>()(cut.rmatind[i]);
+    h = h * 31 + std::hash<double>()(cut.rmatval[i]);
+  }
+  return h;
+}
+
+size_t CutPool::fingerprint(const MIPWrapper::Output& slvOut) const {
+  size_t h = 0;
+  for (int i : _vars) {
+    assert(i < slvOut.nCols);
+    h = h * 31 + std::hash<double>()(slvOut.x[i]);
+  }
+  return h;
+}
+
+bool CutPool::add(MIPWrapper::CutDef cut) {
+  // Sort by variable so that equal cuts are stored identically
+  std::vector<std::pair<int, double> > coefs(cut.rmatind.size());
+  for (size_t i = 0; i < coefs.size(); ++i) {
+    coefs[i] = std::make_pair(cut.rmatind[i], cut.rmatval[i]);
+  }
+  std::sort(coefs.begin(), coefs.end());
+  for (size_t i = 0; i < coefs.size(); ++i) {
+    cut.rmatind[i] = coefs[i].first;
+    cut.rmatval[i] = coefs[i].second;
+  }
+  const size_t h = hash(cut);
+  auto range = _index.equal_range(h);
+  for (auto it = range.first; it != range.second; ++it) {
+    const auto& other = _cuts[it->second];
+    if (other.sense == cut.sense && other.rhs == cut.rhs && other.mask == cut.mask &&
+        other.rmatind == cut.rmatind && other.rmatval == cut.rmatval) {
+      return false;
+    }
+  }
+  _index.emplace(h, _cuts.size());
+  // Keep _vars sorted and free of duplicates
+  std::vector<int> vars;
+  vars.reserve(_vars.size() + cut.rmatind.size());
+  std::set_union(_vars.begin(), _vars.end(), cut.rmatind.begin(), cut.rmatind.end(),
+                 std::back_inserter(vars));
+  vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+  _vars.swap(vars);
+  _cuts.push_back(std::move(cut));
+  return true;
+}
+
+size_t CutPool::separate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn,
+                         double minViol) {
+  if (_cuts.empty()) {
+    return 0;
+  }
+  const size_t fp = fingerprint(slvOut);
+  if (fp != _lastFingerprint || _lastSize != _cuts.size()) {
+    // The values of the variables in the cuts have changed, check all cuts again
+    _lastViolated.clear();
+    for (size_t i = 0; i < _cuts.size(); ++i) {
+      if (_cuts[i].computeViol(slvOut.x, slvOut.nCols) > minViol) {
+        _lastViolated.push_back(i);
+      }
+    }
+    _lastFingerprint = fp;
+    _lastSize = _cuts.size();
+  }
+  for (size_t i : _lastViolated) {
+    cutsIn.push_back(_cuts[i]);
+  }
+  return _lastViolated.size();
+}
+
+void CutGen::separate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto start = std::chrono::steady_clock::now();
+  ++stats.calls;
+  const size_t nReused = pool.separate(slvOut, cutsIn, getMinViol());
+  if (nReused > 0) {
+    stats.reused += nReused;
+  } else {
+    const size_t nBefore = cutsIn.size();
+    generate(slvOut, cutsIn);
+    for (size_t i = nBefore; i < cutsIn.size(); ++i) {
+      if (pool.add(cutsIn[i])) {
+        ++stats.found;
+      }
+    }
+  }
+  stats.time +=
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 void XBZCutGen::generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn) {
   assert(_pMIP);
   const int n = static_cast<int>(varX.size());
@@ -100,7 +319,7 @@ void XBZCutGen::generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput&
     }
   }
   double dViol = cut.computeViol(slvOut.x, slvOut.nCols);
-  if (dViol > 0.01) {  // ?? PARAM?  TODO
+  if (dViol > getMinViol()) {
     cutsIn.push_back(cut);
     cerr << " vi" << dViol << flush;
     //     cout << cut.rmatind.size() << ' '
@@ -138,11 +357,38 @@ std::string SECCutGen::validate() const {
   return oss.str();
 }
 
+MIPWrapper::CutDef SECCutGen::secCut(const std::vector<bool>& inS) const {
+  MIPWrapper::CutDef cut(MIPWrapper::GQ,
+                         MIPWrapper::MaskConsType_Lazy | MIPWrapper::MaskConsType_Usercut);
+  cut.rhs = 1.0;
+  for (int i = 0; i < nN; ++i) {
+    if (inS[i]) {
+      for (int j = 0; j < nN; ++j) {
+        if (!inS[j]) {
+          cut.addVar(varXij[nN * i + j], 1.0);
+        }
+      }
+    }
+  }
+  return cut;
+}
+
+namespace {
+int uf_find(std::vector<int>& parent, int i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+}  // namespace
+
 void SECCutGen::generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput& cutsIn) {
   assert(_pMIP);
-  /// Extract graph, converting to undirected
-  typedef map<pair<int, int>, double> TMapFlow;
-  TMapFlow mapFlow;
+  /// Extract support graph, converting to undirected
+  std::vector<std::pair<int, int> > edges;
+  std::vector<double> weights;
+  std::vector<bool> fractional;
   for (int i = 0; i < nN; ++i) {
     for (int j = 0; j < nN; ++j) {
       const double xij = slvOut.x[varXij[nN * i + j]];
@@ -153,56 +399,189 @@ void SECCutGen::generate(const MIPWrapper::Output& slvOut, MIPWrapper::CutInput&
       MZN_ASSERT_HARD_MSG(
           -1e-4 < xij && 1.0 + 1e-4 > xij,  // adjusted from 1e-6 to 1e-4 for CBC. 7.8.19
           "circuit: X[" << (i + 1) << ", " << (j + 1) << "]==" << xij);
-      if (1e-4 <= xij) {
-        mapFlow[make_pair(min(i, j), max(i, j))] += xij;
+    }
+    for (int j = i + 1; j < nN; ++j) {
+      const double xij = slvOut.x[varXij[nN * i + j]];
+      const double xji = slvOut.x[varXij[nN * j + i]];
+      double w = 0.0;
+      bool frac = false;
+      for (double x : {xij, xji}) {
+        if (1e-4 <= x) {
+          w += x;
+          frac = frac || x < 1.0 - 1e-4;
+        }
+      }
+      if (w > 0.0) {
+        edges.emplace_back(i, j);
+        weights.push_back(w);
+        fractional.push_back(frac);
       }
     }
   }
-  /// Invoking Min Cut
-  //   cerr << "  MIN CUT... " << flush;
-  Algorithms::MinCut mc;
-  mc.nNodes = nN;
-  mc.edges.reserve(mapFlow.size());
-  mc.weights.reserve(mapFlow.size());
-  for (const auto& mf : mapFlow) {
-    mc.edges.push_back(mf.first);
-    mc.weights.push_back(mf.second);
-  }
-  Algorithms::MinCut::solve();
-  /// Check if violation
-  if (mc.wMinCut <= 1.999) {
-    MIPWrapper::CutDef cut(MIPWrapper::GQ,
-                           MIPWrapper::MaskConsType_Lazy | MIPWrapper::MaskConsType_Usercut);
-    cut.rhs = 1.0;
-    int nCutSize = 0;
-    constexpr int nElemPrint = 20;
-    // cerr << "  CUT: [ ";
-    for (int i = 0; i < nN; ++i) {
-      if (mc.parities[i]) {
-        ++nCutSize;
-        // if ( nCutSize<=nElemPrint )
-        //  cerr << (i+1) << ", ";
-        // else if ( nCutSize==nElemPrint+1 )
-        //  cerr << "...";
-        for (int j = 0; j < nN; ++j) {
-          if (!mc.parities[j]) {
-            cut.addVar(varXij[nN * i + j], 1.0);
-          }
-        }
+  /// Connected components of the support graph
+  std::vector<int> parent(nN);
+  for (int i = 0; i < nN; ++i) {
+    parent[i] = i;
+  }
+  for (const auto& e : edges) {
+    parent[uf_find(parent, e.first)] = uf_find(parent, e.second);
+  }
+  std::vector<int> comp(nN, -1);
+  std::vector<int> root2comp(nN, -1);
+  int nComp = 0;
+  for (int i = 0; i < nN; ++i) {
+    int& c = root2comp[uf_find(parent, i)];
+    if (c < 0) {
+      c = nComp++;
+    }
+    comp[i] = c;
+  }
+  /// Each component of a disconnected graph violates its SEC
+  if (nComp > 1) {
+    for (int c = 0; c < nComp; ++c) {
+      std::vector<bool> inS(nN);
+      for (int i = 0; i < nN; ++i) {
+        inS[i] = comp[i] == c;
+      }
+      MIPWrapper::CutDef cut = secCut(inS);
+      if (cut.computeViol(slvOut.x, slvOut.nCols) > getMinViol()) {
+        cutsIn.push_back(std::move(cut));
       }
     }
-    // cerr << "]. " << flush;
-    double dViol = cut.computeViol(slvOut.x, slvOut.nCols);
-    if (dViol > 0.0001) {  // ?? PARAM?  TODO. See also min cut value required
-      cutsIn.push_back(cut);
-      /* cerr << "  SEC: viol=" << dViol
-        << "  N NODES: " << nN
-        << "  |X|: : " << nCutSize
-        << flush; */
-    } else {
-      MZN_ASSERT_HARD_MSG(0, "  SEC cut: N nodes = " << nN << ": violation = " << dViol
-                                                     << ": too small compared to the min-cut value "
-                                                     << (2.0 - mc.wMinCut));
+  }
+  /// Min cut problems for the components with fractional flow. Integral components
+  /// are cycles and cannot contain a violated SEC. The min cut objects are reused
+  /// between calls to avoid reallocating their buffers.
+  if (_minCuts.size() < static_cast<size_t>(nComp)) {
+    _minCuts.resize(nComp);
+  }
+  auto& mcs = _minCuts;
+  for (int c = 0; c < nComp; ++c) {
+    mcs[c].edges.clear();
+    mcs[c].weights.clear();
+  }
+  std::vector<bool> fractionalComp(nComp, false);
+  std::vector<std::vector<int> > nodes(nComp);
+  std::vector<int> local(nN);
+  for (int i = 0; i < nN; ++i) {
+    local[i] = static_cast<int>(nodes[comp[i]].size());
+    nodes[comp[i]].push_back(i);
+  }
+  for (size_t k = 0; k < edges.size(); ++k) {
+    const int c = comp[edges[k].first];
+    mcs[c].edges.emplace_back(local[edges[k].first], local[edges[k].second]);
+    mcs[c].weights.push_back(weights[k]);
+    if (fractional[k]) {
+      fractionalComp[c] = true;
+    }
+  }
+  _jobs.clear();
+  for (int c = 0; c < nComp; ++c) {
+    if (fractionalComp[c] && nodes[c].size() > 2) {
+      mcs[c].nNodes = static_cast<int>(nodes[c].size());
+      // Every node has flow 2, so if a set S has a violated SEC and is separated from a
+      // neighbour v by an edge of weight >= 1, then S + v also has one (Padberg and
+      // Rinaldi). Such edges can therefore be contracted.
+      mcs[c].contractWeight = 1.0 - 1e-6;
+      mcs[c].threshold = 1.999;
+      _jobs.push_back(c);
+    }
+  }
+  /// Invoking Min Cut, in parallel for independent components
+  solveMinCuts();
+  /// Check if violation, for all cuts lighter than the threshold
+  std::vector<bool> inS(nN);
+  for (int c : _jobs) {
+    const auto& mc = mcs[c];
+    for (size_t k = 0; k < mc.nCuts(); ++k) {
+      std::fill(inS.begin(), inS.end(), false);
+      for (int i = mc.cutStart[k]; i < mc.cutStart[k + 1]; ++i) {
+        inS[nodes[c][mc.cutNodes[i]]] = true;
+      }
+      MIPWrapper::CutDef cut = secCut(inS);
+      double dViol = cut.computeViol(slvOut.x, slvOut.nCols);
+      if (dViol > getMinViol()) {  // See also min cut value required
+        cutsIn.push_back(std::move(cut));
+      } else if (_pMIP->fVerbose) {
+        // Edges with x < 1e-4 are left out of the support graph, but still count towards the
+        // violation, so a light cut does not always give a violated SEC
+        std::cerr << "  SEC cut: N nodes = " << nN << ": violation = " << dViol
+                  << " too small compared to the cut value " << (2.0 - mc.cutWeights[k])
+                  << ", skipped" << std::endl;
+      }
+    }
+  }
+}
+
+SECCutGen::~SECCutGen() {
+  {
+    std::lock_guard<std::mutex> lock(_workMutex);
+    _stop = true;
+  }
+  _workStart.notify_all();
+  for (auto& w : _workers) {
+    w.join();
+  }
+}
+
+void SECCutGen::solveMinCuts() {
+  unsigned int nWorkers = nThreads == 0 ? std::max(1U, std::thread::hardware_concurrency())
+                                        : nThreads;
+  nWorkers = std::min(nWorkers, static_cast<unsigned int>(_jobs.size()));
+  _nextJob = 0;
+  if (nWorkers <= 1) {
+    for (int c : _jobs) {
+      _minCuts[c].solve();
+    }
+    return;
+  }
+  while (_workers.size() + 1 < nWorkers) {
+    // Only this thread changes _batch, so it can be read without the lock
+    _workers.emplace_back(&SECCutGen::work, this, _batch);
+  }
+  {
+    std::lock_guard<std::mutex> lock(_workMutex);
+    _error = nullptr;
+    _busy = static_cast<unsigned int>(_workers.size());
+    ++_batch;
+  }
+  _workStart.notify_all();
+  runJobs();
+  std::unique_lock<std::mutex> lock(_workMutex);
+  _workDone.wait(lock, [this] { return _busy == 0; });
+  if (_error) {
+    std::rethrow_exception(_error);
+  }
+}
+
+void SECCutGen::runJobs() {
+  try {
+    for (size_t k = _nextJob++; k < _jobs.size(); k = _nextJob++) {
+      _minCuts[_jobs[k]].solve();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(_workMutex);
+    if (!_error) {
+      _error = std::current_exception();
+    }
+    _nextJob = _jobs.size();
+  }
+}
+
+void SECCutGen::work(unsigned long long batch) {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_workMutex);
+      _workStart.wait(lock, [this, batch] { return _stop || _batch != batch; });
+      if (_stop) {
+        return;
+      }
+      batch = _batch;
+    }
+    runJobs();
+    std::lock_guard<std::mutex> lock(_workMutex);
+    if (--_busy == 0) {
+      _workDone.notify_one();
     }
   }
 }
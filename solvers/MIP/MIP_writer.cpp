@@ -0,0 +1,414 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/solvers/MIP/MIP_writer.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+/// Bounds of at least this magnitude are infinite
+const double INF_BOUND = 1e20;
+/// Number of terms written on one line of an LP file
+const int LP_TERMS_PER_LINE = 8;
+
+/// Write \a d with the fewest digits that read back as \a d
+void write_num(std::ostream& os, double d) {
+  if (d == 0.0) {
+    os << '0';  // also for -0.0
+    return;
+  }
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.15g", d);
+  if (std::strtod(buf, nullptr) != d) {
+    snprintf(buf, sizeof(buf), "%.17g", d);
+  }
+  os << buf;
+}
+
+bool valid_name(const std::string& name) {
+  if (name.empty() || name.size() > 255 || name[0] == '.' || (name[0] >= '0' && name[0] <= '9')) {
+    return false;
+  }
+  for (char c : name) {
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' ||
+          c == '.')) {
+      return false;
+    }
+  }
+  // Avoid clashes with generated names and the keywords of the LP format
+  return name[0] != '_' && name != "inf" && name != "infinity" && name != "free";
+}
+
+std::string row_name(int i) { return "_c" + std::to_string(i); }
+
+bool is_integer(MIPWrapper::VarType vt) { return vt != MIPWrapper::REAL; }
+bool is_binary(const MIPWrapper& mip, int j) {
+  return mip.colTypes[j] == MIPWrapper::BINARY && mip.colLB[j] == 0.0 && mip.colUB[j] == 1.0;
+}
+
+/// Write term \a k of a linear expression in LP format, breaking long lines
+void write_lp_term(std::ostream& os, int k, double coef, const std::string& name) {
+  if (k > 0 && k % LP_TERMS_PER_LINE == 0) {
+    os << "\n  ";
+  }
+  os << (coef < 0.0 ? " - " : " + ");
+  write_num(os, std::fabs(coef));
+  os << ' ' << name;
+}
+
+void copy_file(std::ostream& os, const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if (in.peek() != std::ifstream::traits_type::eof()) {
+    os << in.rdbuf();
+  }
+}
+}  // namespace
+
+MIPModelWriter::Format MIPModelWriter::formatOf(const std::string& filename) {
+  if (filename.size() >= 4) {
+    std::string ext = filename.substr(filename.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".mps") {
+      return MPS;
+    }
+  }
+  return LP;
+}
+
+MIPModelWriter::MIPModelWriter(const MIPWrapper& mip, std::string filename, Format format,
+                               size_t chunkSize)
+    : _mip(mip),
+      _filename(std::move(filename)),
+      _format(format),
+      _chunkSize(std::max<size_t>(chunkSize, 1)) {
+  _rowsFile = _filename + ".rows.tmp";
+  _rows.open(_rowsFile, std::ios::binary);
+  if (_format == MPS) {
+    _rhsFile = _filename + ".rhs.tmp";
+    _rhs.open(_rhsFile, std::ios::binary);
+    _nzFile = _filename + ".nz.tmp";
+    _nz.open(_nzFile, std::ios::binary);
+  }
+  if (!_rows || (_format == MPS && (!_rhs || !_nz))) {
+    cleanup();
+    throw std::runtime_error("MIPModelWriter: cannot create temporary files for '" + _filename +
+                             "'");
+  }
+}
+
+MIPModelWriter::~MIPModelWriter() {
+  if (!_finished) {
+    cleanup();
+  }
+}
+
+void MIPModelWriter::cleanup() {
+  for (auto* f : {&_rows, &_rhs, &_nz}) {
+    if (f->is_open()) {
+      f->close();
+    }
+  }
+  for (const auto* name : {&_rowsFile, &_rhsFile, &_nzFile}) {
+    if (!name->empty()) {
+      std::remove(name->c_str());
+    }
+  }
+}
+
+std::string MIPModelWriter::colName(int j) const {
+  const std::string& name = _mip.colNames[j];
+  return valid_name(name) ? name : "_x" + std::to_string(j);
+}
+
+void MIPModelWriter::addRow(int nnz, const int* rmatind, const double* rmatval,
+                            MIPWrapper::LinConType sense, double rhs) {
+  spoolRow(nnz, rmatind, rmatval, sense, rhs, -1, 0);
+}
+
+void MIPModelWriter::addIndicatorConstraint(int iBVar, int bVal, int nnz, const int* rmatind,
+                                            const double* rmatval, MIPWrapper::LinConType sense,
+                                            double rhs) {
+  assert(iBVar >= 0);
+  assert(bVal == 0 || bVal == 1);
+  spoolRow(nnz, rmatind, rmatval, sense, rhs, iBVar, bVal);
+}
+
+void MIPModelWriter::spoolRow(int nnz, const int* rmatind, const double* rmatval,
+                              MIPWrapper::LinConType sense, double rhs, int iBVar, int bVal) {
+  assert(!_finished);
+  const int iRow = _nRows++;
+  if (_format == LP) {
+    _rows << ' ' << row_name(iRow) << ':';
+    if (iBVar >= 0) {
+      _rows << ' ' << colName(iBVar) << " = " << bVal << " ->";
+    }
+    if (nnz == 0) {
+      // Empty rows still need a term, they decide feasibility by their right hand side
+      _rows << " 0 " << (_mip.colNames.empty() ? "_x0" : colName(0));
+    }
+    for (int k = 0; k < nnz; ++k) {
+      write_lp_term(_rows, k, rmatval[k], colName(rmatind[k]));
+    }
+    _rows << (sense == MIPWrapper::LQ ? " <= " : sense == MIPWrapper::GQ ? " >= " : " = ");
+    write_num(_rows, rhs);
+    _rows << '\n';
+  } else {
+    _rows << ' ' << (sense == MIPWrapper::LQ ? 'L' : sense == MIPWrapper::GQ ? 'G' : 'E') << "  "
+          << row_name(iRow) << '\n';
+    if (rhs != 0.0) {
+      _rhs << "    RHS  " << row_name(iRow) << "  ";
+      write_num(_rhs, rhs);
+      _rhs << '\n';
+    }
+    for (int k = 0; k < nnz; ++k) {
+      const int j = rmatind[k];
+      assert(j >= 0);
+      if (static_cast<size_t>(j) >= _colNnz.size()) {
+        _colNnz.resize(j + 1, 0);
+      }
+      ++_colNnz[j];
+      Nonzero nz{j, iRow, rmatval[k]};
+      _nz.write(reinterpret_cast<const char*>(&nz), sizeof(Nonzero));
+    }
+    if (iBVar >= 0) {
+      _indicators.push_back({iRow, iBVar, bVal});
+    }
+  }
+  if (!_rows) {
+    throw std::runtime_error("MIPModelWriter: cannot write temporary files for '" + _filename +
+                             "'");
+  }
+}
+
+void MIPModelWriter::finish(int objSense) {
+  assert(!_finished);
+  for (auto* f : {&_rows, &_rhs, &_nz}) {
+    if (f->is_open()) {
+      f->close();
+    }
+  }
+  if (_format == MPS && (_rhs.fail() || _nz.fail())) {
+    cleanup();
+    throw std::runtime_error("MIPModelWriter: cannot write temporary files for '" + _filename +
+                             "'");
+  }
+  {
+    std::ofstream os(_filename, std::ios::binary);
+    if (!os) {
+      cleanup();
+      throw std::runtime_error("MIPModelWriter: cannot open '" + _filename + "' for writing");
+    }
+    try {
+      if (_format == LP) {
+        writeLP(os, objSense);
+      } else {
+        writeMPS(os, objSense);
+      }
+    } catch (...) {
+      cleanup();
+      throw;
+    }
+    os.close();
+    if (os.fail()) {
+      cleanup();
+      throw std::runtime_error("MIPModelWriter: cannot write '" + _filename + "'");
+    }
+  }
+  cleanup();
+  _finished = true;
+}
+
+void MIPModelWriter::writeLP(std::ostream& os, int objSense) {
+  const int nCols = static_cast<int>(_mip.colObj.size());
+  os << "\\ MiniZinc MIP model\n" << (objSense > 0 ? "Maximize\n" : "Minimize\n") << " obj:";
+  int nTerms = 0;
+  for (int j = 0; j < nCols; ++j) {
+    const double c = _mip.colObj[j];
+    if (c != 0.0) {
+      write_lp_term(os, nTerms++, c, colName(j));
+    }
+  }
+  os << "\nSubject To\n";
+  copy_file(os, _rowsFile);
+  os << "Bounds\n";
+  for (int j = 0; j < nCols; ++j) {
+    if (is_binary(_mip, j)) {
+      continue;
+    }
+    const double lb = _mip.colLB[j];
+    const double ub = _mip.colUB[j];
+    const bool noLB = lb <= -INF_BOUND;
+    const bool noUB = ub >= INF_BOUND;
+    if (noLB && noUB) {
+      os << ' ' << colName(j) << " free\n";
+    } else if (lb == ub) {
+      os << ' ' << colName(j) << " = ";
+      write_num(os, lb);
+      os << '\n';
+    } else if (noUB) {
+      // Default bounds are [0, inf)
+      if (lb != 0.0) {
+        os << ' ' << colName(j) << " >= ";
+        write_num(os, lb);
+        os << '\n';
+      }
+    } else {
+      if (noLB) {
+        os << " -inf";
+      } else {
+        os << ' ';
+        write_num(os, lb);
+      }
+      os << " <= " << colName(j) << " <= ";
+      write_num(os, ub);
+      os << '\n';
+    }
+  }
+  for (int binaries = 0; binaries < 2; ++binaries) {
+    nTerms = 0;
+    for (int j = 0; j < nCols; ++j) {
+      if (is_integer(_mip.colTypes[j]) && is_binary(_mip, j) == (binaries != 0)) {
+        if (nTerms == 0) {
+          os << (binaries != 0 ? "Binaries\n" : "Generals\n");
+        } else if (nTerms % LP_TERMS_PER_LINE == 0) {
+          os << '\n';
+        }
+        os << ' ' << colName(j);
+        ++nTerms;
+      }
+    }
+    if (nTerms > 0) {
+      os << '\n';
+    }
+  }
+  os << "End\n";
+}
+
+void MIPModelWriter::writeMPS(std::ostream& os, int objSense) {
+  const int nCols = static_cast<int>(_mip.colObj.size());
+  os << "NAME          MiniZinc\n";
+  if (objSense > 0) {
+    os << "OBJSENSE\n    MAX\n";
+  }
+  os << "ROWS\n N  obj\n";
+  copy_file(os, _rowsFile);
+  os << "COLUMNS\n";
+  writeColumns(os);
+  os << "RHS\n";
+  copy_file(os, _rhsFile);
+  os << "BOUNDS\n";
+  for (int j = 0; j < nCols; ++j) {
+    const std::string name = colName(j);
+    const double lb = _mip.colLB[j];
+    const double ub = _mip.colUB[j];
+    const bool noLB = lb <= -INF_BOUND;
+    const bool noUB = ub >= INF_BOUND;
+    if (is_binary(_mip, j)) {
+      os << " BV BND  " << name << '\n';
+    } else if (lb == ub) {
+      os << " FX BND  " << name << "  ";
+      write_num(os, lb);
+      os << '\n';
+    } else if (noLB && noUB) {
+      os << " FR BND  " << name << '\n';
+    } else {
+      // Integer columns have an upper bound of 1 by default in some readers, and a negative upper
+      // bound alone may imply an infinite lower bound
+      const bool isInt = is_integer(_mip.colTypes[j]);
+      if (noLB) {
+        os << " MI BND  " << name << '\n';
+      } else if (lb != 0.0 || isInt || ub < 0.0) {
+        os << " LO BND  " << name << "  ";
+        write_num(os, lb);
+        os << '\n';
+      }
+      if (!noUB) {
+        os << " UP BND  " << name << "  ";
+        write_num(os, ub);
+        os << '\n';
+      } else if (isInt) {
+        os << " PL BND  " << name << '\n';
+      }
+    }
+  }
+  if (!_indicators.empty()) {
+    os << "INDICATORS\n";
+    for (const auto& ind : _indicators) {
+      os << " IF  " << row_name(ind[0]) << "  " << colName(ind[1]) << "  " << ind[2] << '\n';
+    }
+  }
+  os << "ENDATA\n";
+}
+
+void MIPModelWriter::writeColumns(std::ostream& os) {
+  const int nCols = static_cast<int>(_mip.colObj.size());
+  _colNnz.resize(nCols, 0);
+  std::vector<std::pair<int, double> > buffer;
+  std::vector<size_t> start;
+  std::vector<Nonzero> block(std::min<size_t>(_chunkSize, 1 << 16));
+  bool intMarker = false;
+  int nMarkers = 0;
+  // Columns [c0, c1) have at most _chunkSize nonzeros (or consist of a single column)
+  for (int c0 = 0, c1 = 0; c0 < nCols; c0 = c1) {
+    size_t total = 0;
+    while (c1 < nCols && (c1 == c0 || total + _colNnz[c1] <= _chunkSize)) {
+      total += _colNnz[c1++];
+    }
+    buffer.resize(total);
+    start.assign(c1 - c0 + 1, 0);
+    for (int j = c0; j < c1; ++j) {
+      start[j - c0 + 1] = start[j - c0] + _colNnz[j];
+    }
+    if (total > 0) {
+      // Bucket the nonzeros of these columns, they stay in row order within each column
+      std::ifstream in(_nzFile, std::ios::binary);
+      while (in) {
+        in.read(reinterpret_cast<char*>(block.data()),
+                static_cast<std::streamsize>(block.size() * sizeof(Nonzero)));
+        const size_t n = static_cast<size_t>(in.gcount()) / sizeof(Nonzero);
+        for (size_t k = 0; k < n; ++k) {
+          const Nonzero& nz = block[k];
+          if (nz.col >= c0 && nz.col < c1) {
+            buffer[start[nz.col - c0]++] = std::make_pair(nz.row, nz.val);
+          }
+        }
+      }
+      if (start[c1 - c0 - 1] != total) {
+        throw std::runtime_error("MIPModelWriter: cannot read temporary files for '" + _filename +
+                                 "'");
+      }
+    }
+    size_t k = 0;
+    for (int j = c0; j < c1; ++j) {
+      if (is_integer(_mip.colTypes[j]) != intMarker) {
+        intMarker = !intMarker;
+        os << "    MARKER" << nMarkers++ << "  'MARKER'  " << (intMarker ? "'INTORG'" : "'INTEND'")
+           << '\n';
+      }
+      const std::string name = colName(j);
+      const size_t kEnd = k + _colNnz[j];
+      // Every column needs an entry to be declared
+      if (_mip.colObj[j] != 0.0 || k == kEnd) {
+        os << "    " << name << "  obj  ";
+        write_num(os, _mip.colObj[j]);
+        os << '\n';
+      }
+      for (; k < kEnd; ++k) {
+        os << "    " << name << "  " << row_name(buffer[k].first) << "  ";
+        write_num(os, buffer[k].second);
+        os << '\n';
+      }
+    }
+  }
+  if (intMarker) {
+    os << "    MARKER" << nMarkers << "  'MARKER'  'INTEND'\n";
+  }
+}
@@ -0,0 +1,16 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/solvers/MIP/MIP_solverinstance.hh>
+#include <minizinc/solvers/MIP/MIP_writer_solverfactory.hh>
+#include <minizinc/solvers/MIP/MIP_writer_wrap.hh>
+
+namespace MiniZinc {
+namespace {
+void get_wrapper() { static MIPSolverFactory<MIPWriterWrapper> _writer_solver_factory; }
+}  // namespace
+MIPWriterSolverFactoryInitialiser::MIPWriterSolverFactoryInitialiser() { get_wrapper(); }
+}  // namespace MiniZinc
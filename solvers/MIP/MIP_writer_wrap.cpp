@@ -0,0 +1,69 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <minizinc/exception.hh>
+#include <minizinc/file_utils.hh>
+#include <minizinc/solvers/MIP/MIP_writer_wrap.hh>
+#include <minizinc/utils.hh>
+
+#include <ctime>
+#include <iostream>
+
+MIPWriterWrapper::MIPWriterWrapper(FactoryOptions& /*factoryOpt*/, Options* opt)
+    : _options(opt) {
+  if (_options->sExportModel.empty()) {
+    throw MiniZinc::Error("MIP model writer: no output file given, use --writeModel <file>");
+  }
+  _writer.reset(new MIPModelWriter(*this, _options->sExportModel,
+                                   MIPModelWriter::formatOf(_options->sExportModel),
+                                   _options->nChunkSize));
+}
+
+void MIPWriterWrapper::Options::printHelp(std::ostream& os) {
+  os << "MIP model writer options:" << std::endl
+     << "  --writeModel <file>" << std::endl
+     << "    write model to <file> (.lp, .mps)" << std::endl
+     << "  --writer-chunk-size <n>" << std::endl
+     << "    buffer at most n nonzeros at a time when writing MPS files. Default 1048576"
+     << std::endl;
+}
+
+bool MIPWriterWrapper::Options::processOption(int& i, std::vector<std::string>& argv,
+                                              const std::string& workingDir) {
+  MiniZinc::CLOParser cop(i, argv);
+  std::string buffer;
+  int n = 0;
+  if (cop.get("--writeModel", &buffer)) {
+    sExportModel = MiniZinc::FileUtils::file_path(buffer, workingDir);
+  } else if (cop.get("--writer-chunk-size", &n)) {
+    if (n <= 0) {
+      return false;
+    }
+    nChunkSize = static_cast<size_t>(n);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void MIPWriterWrapper::solve() {
+  output.dWallTime0 = std::chrono::steady_clock::now();
+  output.cCPUTime0 = std::clock();
+  if (fVerbose) {
+    std::cerr << "  MIP model writer: writing " << getNCols() << " columns and " << getNRows()
+              << " rows to '" << _options->sExportModel << "'..." << std::flush;
+  }
+  _writer->finish(_objSense);
+  if (fVerbose) {
+    std::cerr << " done." << std::endl;
+  }
+  output.dWallTime =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - output.dWallTime0).count();
+  output.dCPUTime = double(std::clock() - output.cCPUTime0) / CLOCKS_PER_SEC;
+  output.status = UNKNOWN;
+  output.statusName = "Model written";
+  output.nCols = getNCols();
+}
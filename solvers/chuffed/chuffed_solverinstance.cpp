@@ -104,6 +104,7 @@ void ChuffedSolverInstance::processFlatZinc() {
               FlatZinc::AST::SetLit* sl = nullptr;
               if (isv->size() > 1) {
                 std::vector<int> vs;
+                vs.reserve(isv->card().toInt());
                 for (unsigned int i = 0; i < isv->size(); i++) {
                   for (auto j = isv->min(i); j <= isv->max(i); j++) {
                     vs.push_back(static_cast<int>(j.toInt()));
@@ -204,19 +205,19 @@ void ChuffedSolverInstance::processFlatZinc() {
         if (c->argCount() == 1) {
           return new FlatZinc::AST::Call(c->id().c_str(), toNode(c->arg(0)));
         }
-        std::vector<FlatZinc::AST::Node*> args(c->argCount());
+        auto* args = new FlatZinc::AST::Array(static_cast<int>(c->argCount()));
         for (unsigned int i = 0; i < c->argCount(); i++) {
-          args[i] = toNode(c->arg(i));
+          args->a[i] = toNode(c->arg(i));
         }
-        return new FlatZinc::AST::Call(c->id().c_str(), new FlatZinc::AST::Array(args));
+        return new FlatZinc::AST::Call(c->id().c_str(), args);
       }
       case Expression::E_ARRAYLIT: {
         auto* al = Expression::cast<ArrayLit>(e);
-        std::vector<FlatZinc::AST::Node*> elems(al->size());
+        auto* elems = new FlatZinc::AST::Array(static_cast<int>(al->size()));
         for (unsigned int i = 0; i < al->size(); i++) {
-          elems[i] = toNode((*al)[i]);
+          elems->a[i] = toNode((*al)[i]);
         }
-        return new FlatZinc::AST::Array(elems);
+        return elems;
       }
       case Expression::E_SETLIT: {
         auto* sl = Expression::cast<SetLit>(e);
@@ -226,7 +227,8 @@ void ChuffedSolverInstance::processFlatZinc() {
             return new FlatZinc::AST::SetLit(static_cast<int>(isv->min(0).toInt()),
                                              static_cast<int>(isv->max(0).toInt()));
           }
-          std::vector<int> vs(isv->card().toInt());
+          std::vector<int> vs;
+          vs.reserve(isv->card().toInt());
           for (unsigned int i = 0; i < isv->size(); i++) {
             for (auto j = isv->min(i); j <= isv->max(i); j++) {
               vs.push_back(static_cast<int>(j.toInt()));
@@ -245,9 +247,10 @@ void ChuffedSolverInstance::processFlatZinc() {
   for (auto& it : _flat->constraints()) {
     if (!it.removed()) {
       auto* c = Expression::cast<Call>(it.e());
-      std::vector<FlatZinc::AST::Node*> args(c->argCount());
+      // Arguments are converted directly into the array that is passed on to Chuffed
+      auto* args = new FlatZinc::AST::Array(static_cast<int>(c->argCount()));
       for (unsigned int i = 0; i < c->argCount(); i++) {
-        args[i] = toNode(c->arg(i));
+        args->a[i] = toNode(c->arg(i));
       }
 
       FlatZinc::AST::Array* ann = nullptr;
@@ -258,8 +261,7 @@ void ChuffedSolverInstance::processFlatZinc() {
         }
         ann = new FlatZinc::AST::Array(annotations);
       }
-      FlatZinc::FlatZincSpace::postConstraint(
-          FlatZinc::ConExpr(c->id().c_str(), new FlatZinc::AST::Array(args)), ann);
+      FlatZinc::FlatZincSpace::postConstraint(FlatZinc::ConExpr(c->id().c_str(), args), ann);
       delete ann;
     }
   }
@@ -0,0 +1,302 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <minizinc/exception.hh>
+#include <minizinc/process.hh>
+#include <minizinc/solvers/fzn_portfolio.hh>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+namespace MiniZinc {
+
+#ifndef _WIN32
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct MemberState {
+  pid_t pid = -1;
+  int fd[2] = {-1, -1};  // stdout, stderr
+  std::string linePart[2];
+  /// Text of the solution currently being received
+  std::string block;
+  /// Last status message that was not a proof (e.g. =====UNKNOWN=====)
+  std::string otherStatus;
+  /// Signal to send next when terminating this member (0 if not terminating)
+  int nextSignal = 0;
+  Clock::time_point signalAt;
+  int exitStatus = 1;
+
+  bool running() const { return fd[0] != -1 || fd[1] != -1; }
+};
+
+bool is_proof_status(const std::string& line, const Solns2Out::Options& opt) {
+  return line == opt.searchCompleteMsgDef || line == opt.unsatisfiableMsgDef ||
+         line == opt.unboundedMsgDef || line == opt.unsatorunbndMsgDef;
+}
+
+/// Find the value assigned to \a objVar in \a block, and remove the assignment if \a strip
+bool extract_objective(std::string& block, const std::string& objVar, bool strip, double& value) {
+  std::string prefix = objVar + " = ";
+  size_t pos = 0;
+  while (pos < block.size()) {
+    size_t eol = block.find('\n', pos);
+    if (eol == std::string::npos) {
+      eol = block.size();
+    }
+    if (block.compare(pos, prefix.size(), prefix) == 0) {
+      std::string v = block.substr(pos + prefix.size(), eol - pos - prefix.size());
+      char* end = nullptr;
+      value = std::strtod(v.c_str(), &end);
+      bool ok = end != v.c_str();
+      if (strip) {
+        block.erase(pos, eol < block.size() ? eol - pos + 1 : eol - pos);
+      }
+      return ok;
+    }
+    pos = eol + 1;
+  }
+  return false;
+}
+
+}  // namespace
+
+int FZNPortfolio::run() {
+  std::vector<MemberState> state(_members.size());
+
+  for (unsigned int i = 0; i < _members.size(); ++i) {
+    int fds[3];
+    try {
+      state[i].pid = start_process(_members[i].cmd, fds);
+    } catch (const Error& e) {
+      for (unsigned int j = 0; j < i; ++j) {
+        kill_process(state[j].pid, SIGKILL);
+        close(state[j].fd[0]);
+        close(state[j].fd[1]);
+        waitpid(state[j].pid, nullptr, 0);
+      }
+      throw Error("Failed to start portfolio member " + _members[i].name + ": " + e.msg());
+    }
+    // Members read the FlatZinc from a file, so their input is closed right away
+    close(fds[0]);
+    state[i].fd[0] = fds[1];
+    state[i].fd[1] = fds[2];
+  }
+
+  ProcessSignals signals;
+  const auto& opt = _pS2Out->opt;
+  const auto start = Clock::now();
+  const int firstSignal = _sigint ? SIGINT : SIGTERM;
+  bool timedOut = false;
+  bool handledInterrupt = false;
+  bool haveBest = false;
+  double best = 0.0;
+  int satSource = -1;
+
+  auto terminate = [&](MemberState& m, int signal) {
+    if (m.running() && (m.nextSignal == 0 || signal == SIGKILL)) {
+      kill_process(m.pid, signal);
+      m.nextSignal = signal == SIGINT ? SIGTERM : SIGKILL;
+      m.signalAt = Clock::now() + std::chrono::milliseconds(200);
+    }
+  };
+
+  auto processLine = [&](int i, std::string line) {
+    MemberState& m = state[i];
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (stats.winner != -1 && stats.winner != i) {
+      // Losing members are being terminated, ignore any further output
+      return;
+    }
+    if (line == opt.solutionSeparatorDef) {
+      ++stats.received;
+      bool forward = true;
+      double obj;
+      if (_direction != D_SAT && !_objVar.empty() &&
+          extract_objective(m.block, _objVar, _stripObjVar, obj)) {
+        forward = !haveBest || (_direction == D_MIN ? obj < best : obj > best);
+        if (forward) {
+          haveBest = true;
+          best = obj;
+          if (sharedBounds != nullptr) {
+            sharedBounds->publishIncumbent(obj);
+          }
+        }
+      } else {
+        forward = satSource == -1 || satSource == i;
+        if (forward) {
+          satSource = i;
+        }
+      }
+      if (forward) {
+        ++stats.forwarded;
+        m.block += line + '\n';
+        _pS2Out->feedRawDataChunk(m.block.c_str());
+      }
+      m.block.clear();
+    } else if (is_proof_status(line, opt)) {
+      stats.winner = i;
+      if (sharedBounds != nullptr && haveBest && line == opt.searchCompleteMsgDef) {
+        sharedBounds->publishBound(best);
+      }
+      m.block += line + '\n';
+      _pS2Out->feedRawDataChunk(m.block.c_str());
+      m.block.clear();
+      for (auto& other : state) {
+        if (&other != &m) {
+          terminate(other, firstSignal);
+        }
+      }
+    } else if (line == opt.unknownMsgDef || line == opt.errorMsgDef) {
+      m.otherStatus = line;
+    } else {
+      m.block += line + '\n';
+    }
+  };
+
+  fd_set fdset;
+  FD_ZERO(&fdset);  // NOLINT(readability-isolate-declaration)
+  for (;;) {
+    bool anyRunning = false;
+    FD_ZERO(&fdset);  // NOLINT(readability-isolate-declaration)
+    for (auto& m : state) {
+      for (int fd : m.fd) {
+        if (fd != -1) {
+          FD_SET(fd, &fdset);
+          anyRunning = true;
+        }
+      }
+    }
+    if (!anyRunning) {
+      break;
+    }
+
+    // Wake up at least every 100ms to check time limit and signal escalation
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 100000;
+    int sel = select(FD_SETSIZE, &fdset, nullptr, nullptr, &timeout);
+    if (sel == -1) {
+      if (errno != EINTR) {
+        for (auto& m : state) {
+          terminate(m, SIGKILL);
+        }
+        throw Error(std::string("Error in communication with solver: ") + strerror(errno));
+      }
+      FD_ZERO(&fdset);  // NOLINT(readability-isolate-declaration)
+    }
+
+    auto now = Clock::now();
+    if ((signals.hadInterrupt() || signals.hadTerm()) && !handledInterrupt) {
+      handledInterrupt = true;
+      for (auto& m : state) {
+        terminate(m, signals.hadInterrupt() ? SIGINT : SIGTERM);
+      }
+    }
+    if (_timelimit > 0 && !timedOut &&
+        now - start >= std::chrono::milliseconds(_timelimit)) {
+      timedOut = true;
+      for (auto& m : state) {
+        terminate(m, firstSignal);
+      }
+    }
+    for (auto& m : state) {
+      if (m.running() && m.nextSignal != 0 && now >= m.signalAt) {
+        int signal = m.nextSignal;
+        kill_process(m.pid, signal);
+        m.nextSignal = signal == SIGKILL ? SIGKILL : (signal == SIGINT ? SIGTERM : SIGKILL);
+        m.signalAt = now + std::chrono::milliseconds(200);
+      }
+    }
+
+    for (int i = 0; i < static_cast<int>(state.size()); ++i) {
+      MemberState& m = state[i];
+      for (int j = 0; j < 2; ++j) {
+        if (m.fd[j] == -1 || !FD_ISSET(m.fd[j], &fdset)) {
+          continue;
+        }
+        char buffer[4096];
+        ssize_t count = read(m.fd[j], buffer, sizeof(buffer));
+        if (count <= 0) {
+          if (count == -1 && errno == EINTR) {
+            continue;
+          }
+          close(m.fd[j]);
+          m.fd[j] = -1;
+          if (j == 0 && !m.linePart[0].empty()) {
+            // Last line did not end with a newline
+            std::string line;
+            std::swap(line, m.linePart[0]);
+            processLine(i, line);
+          }
+          continue;
+        }
+        if (j == 1) {
+          _pS2Out->getLog() << std::string(buffer, count) << std::flush;
+          continue;
+        }
+        std::string& part = m.linePart[0];
+        part.append(buffer, count);
+        size_t pos = 0;
+        size_t eol;
+        while ((eol = part.find('\n', pos)) != std::string::npos) {
+          processLine(i, part.substr(pos, eol - pos));
+          pos = eol + 1;
+        }
+        part.erase(0, pos);
+      }
+    }
+  }
+
+  int exitStatus = 1;
+  for (int i = 0; i < static_cast<int>(state.size()); ++i) {
+    int childStatus;
+    if (waitpid(state[i].pid, &childStatus, 0) > 0 && WIFEXITED(childStatus)) {
+      state[i].exitStatus = WEXITSTATUS(childStatus);
+    }
+    if (state[i].exitStatus == 0) {
+      exitStatus = 0;
+    }
+  }
+  if (stats.winner != -1) {
+    // Losers were terminated on purpose, so only the winner's exit status counts
+    exitStatus = state[stats.winner].exitStatus;
+  } else if (stats.forwarded == 0) {
+    bool allFailed = true;
+    for (auto& m : state) {
+      allFailed = allFailed && m.otherStatus == opt.errorMsgDef;
+    }
+    if (allFailed) {
+      _pS2Out->feedRawDataChunk((std::string(opt.errorMsgDef) + '\n').c_str());
+    }
+  }
+  if (signals.hadInterrupt()) {
+    throw SignalRaised(SIGINT);
+  }
+  if (signals.hadTerm()) {
+    throw SignalRaised(SIGTERM);
+  }
+  return timedOut ? 0 : exitStatus;
+}
+
+#else
+
+int FZNPortfolio::run() { throw Error("Solver portfolios are not supported on this platform"); }
+
+#endif
+
+}  // namespace MiniZinc
@@ -19,12 +19,16 @@
 #include <minizinc/pathfileprinter.hh>
 #include <minizinc/prettyprinter.hh>
 #include <minizinc/process.hh>
+#include <minizinc/shared_bounds.hh>
+#include <minizinc/solvers/fzn_portfolio.hh>
 #include <minizinc/solvers/fzn_solverinstance.hh>
 #include <minizinc/timer.hh>
 #include <minizinc/typecheck.hh>
 
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <memory>
 
 using namespace std;
 
@@ -65,6 +69,9 @@ void FZNSolverFactory::printHelp(ostream& os) {
      << "  -t <ms>, --solver-time-limit <ms>, --fzn-time-limit <ms>\n     Set time limit (in "
         "milliseconds) for solving.\n"
      << "  --fzn-sigint\n     Send SIGINT instead of SIGTERM.\n"
+     << "  --fzn-pipe\n     Write the FlatZinc to the standard input of the solver while it is "
+        "running,\n     instead of to a temporary file before it is started. The solver is "
+        "passed\n     /dev/stdin as the FlatZinc file and must read it sequentially.\n"
      << "  -n <n>, --num-solutions <n>\n"
      << "    An upper bound on the number of solutions to output for satisfaction problems. The "
         "default should be 1.\n"
@@ -127,6 +134,8 @@ bool FZNSolverFactory::processOption(SolverInstanceBase::Options* opt, int& i,
     _opt.fznNeedsPaths = true;
   } else if (cop.getOption("--fzn-output-passthrough")) {
     _opt.fznOutputPassthrough = true;
+  } else if (cop.getOption("--fzn-pipe")) {
+    _opt.fznPipe = true;
   } else if (cop.getOption("--fzn-flag --flatzinc-flag --backend-flag", &buffer)) {
     _opt.fznFlags.push_back(buffer);
   } else if (_opt.supportsN && cop.getOption("-n --num-solutions", &nn)) {
@@ -181,6 +190,12 @@ bool FZNSolverFactory::processOption(SolverInstanceBase::Options* opt, int& i,
   return true;
 }
 
+void FZNSolverFactory::addPortfolioMember(SolverInstanceBase::Options* opt,
+                                          SolverInstanceBase::Options* member) {
+  auto& _opt = static_cast<FZNSolverOptions&>(*opt);
+  _opt.portfolio.emplace_back(static_cast<FZNSolverOptions*>(member));
+}
+
 void FZNSolverFactory::setAcceptedFlags(SolverInstanceBase::Options* opt,
                                         const std::vector<MZNFZNSolverFlag>& flags) {
   auto& _opt = static_cast<FZNSolverOptions&>(*opt);
@@ -222,8 +237,7 @@ FZNSolverInstance::FZNSolverInstance(Env& env, std::ostream& log,
 
 FZNSolverInstance::~FZNSolverInstance() {}
 
-SolverInstance::Status FZNSolverInstance::solve() {
-  auto& opt = static_cast<FZNSolverOptions&>(*_options);
+std::vector<std::string> FZNSolverInstance::cmdLine(FZNSolverOptions& opt, bool isSat) {
   if (opt.fznSolver.empty()) {
     throw Error("No FlatZinc solver specified");
   }
@@ -231,7 +245,6 @@ SolverInstance::Status FZNSolverInstance::solve() {
   vector<string> cmd_line;
   cmd_line.push_back(opt.fznSolver);
   string sBE = opt.backend;
-  bool is_sat = _fzn->solveItem()->st() == SolveI::SolveType::ST_SAT;
   for (auto& f : opt.fznFlags) {
     cmd_line.push_back(f);
   }
@@ -239,16 +252,16 @@ SolverInstance::Status FZNSolverInstance::solve() {
     cmd_line.emplace_back("-b");
     cmd_line.push_back(sBE);
   }
-  if (opt.allOptimal && !is_sat) {
+  if (opt.allOptimal && !isSat) {
     cmd_line.emplace_back("-a-o");
   }
-  if (static_cast<int>(opt.numOptimal) != 1 && !is_sat) {
+  if (static_cast<int>(opt.numOptimal) != 1 && !isSat) {
     cmd_line.emplace_back("-n-o");
     ostringstream oss;
     oss << opt.numOptimal;
     cmd_line.push_back(oss.str());
   }
-  if (opt.numSols != 1 && is_sat) {
+  if (opt.numSols != 1 && isSat) {
     cmd_line.emplace_back("-n");
     ostringstream oss;
     oss << opt.numSols;
@@ -279,35 +292,60 @@ SolverInstance::Status FZNSolverInstance::solve() {
     }
     cerr << std::endl;
   }
-  int timelimit = opt.fznTimeLimitMilliseconds;
-  bool sigint = opt.fznSigint;
-
-  FileUtils::TmpFile fznFile(".fzn");
-  {  // Context to print FZN file, close file descriptor afterwards
-    std::ofstream os(FILE_PATH(fznFile.name()));
-    Printer p(os, 0, true, &_env.envi());
-    for (FunctionIterator it = _fzn->functions().begin(); it != _fzn->functions().end(); ++it) {
-      if (!it->removed()) {
-        Item& item = *it;
-        p.print(&item);
-      }
+  return cmd_line;
+}
+
+SolverInstance::Status FZNSolverInstance::solve() {
+  auto& opt = static_cast<FZNSolverOptions&>(*_options);
+  bool is_sat = _fzn->solveItem()->st() == SolveI::SolveType::ST_SAT;
+  vector<string> cmd_line = cmdLine(opt, is_sat);
+
+  std::unique_ptr<SharedBounds> sharedBounds;
+  if (!opt.sharedBoundsFile.empty()) {
+    // Side channel for solvers that can cooperate through the board themselves
+#ifdef _WIN32
+    _putenv_s(SharedBounds::envVar(), opt.sharedBoundsFile.c_str());
+#else
+    setenv(SharedBounds::envVar(), opt.sharedBoundsFile.c_str(), 1);
+#endif
+    if (!is_sat) {
+      sharedBounds.reset(new SharedBounds(opt.sharedBoundsFile,
+                                          _fzn->solveItem()->st() == SolveI::SolveType::ST_MIN,
+                                          opt.sharedBoundsModel));
     }
-    for (VarDeclIterator it = _fzn->vardecls().begin(); it != _fzn->vardecls().end(); ++it) {
-      if (!it->removed()) {
-        Item& item = *it;
-        p.print(&item);
+  }
+
+  if ((!opt.portfolio.empty() || sharedBounds != nullptr) && !is_sat) {
+    // Solutions must report the objective so that they can be compared and published
+    if (Id* obj = Expression::dynamicCast<Id>(_fzn->solveItem()->e())) {
+      VarDecl* vd = obj->decl();
+      Id* outputVar = _env.envi().constants.ann.output_var;
+      _portfolioStripObjective = !Expression::ann(vd).contains(outputVar);
+      if (_portfolioStripObjective) {
+        Expression::addAnnotation(vd, outputVar);
       }
+      std::ostringstream oss;
+      oss << *vd->id();
+      _portfolioObjective = oss.str();
     }
-    for (ConstraintIterator it = _fzn->constraints().begin(); it != _fzn->constraints().end();
-         ++it) {
-      if (!it->removed()) {
-        Item& item = *it;
-        p.print(&item);
-      }
+  }
+
+  // Without a portfolio, the FlatZinc can be printed while the solver is already reading it
+  bool pipeFzn = opt.fznPipe && opt.portfolio.empty();
+#ifdef _WIN32
+  pipeFzn = false;
+#endif
+  std::unique_ptr<FileUtils::TmpFile> fznFile;
+  if (pipeFzn) {
+    cmd_line.emplace_back("/dev/stdin");
+  } else {
+    fznFile = std::unique_ptr<FileUtils::TmpFile>(new FileUtils::TmpFile(".fzn"));
+    {  // Context to print FZN file, close file descriptor afterwards
+      std::ofstream os(FILE_PATH(fznFile->name()));
+      printFlatZinc(os);
     }
-    p.print(_fzn->solveItem());
+    cmd_line.push_back(fznFile->name());
   }
-  cmd_line.push_back(fznFile.name());
 
   std::unique_ptr<FileUtils::TmpFile> pathsFile;
   if (opt.fznNeedsPaths) {
@@ -320,17 +358,133 @@ SolverInstance::Status FZNSolverInstance::solve() {
     cmd_line.push_back(pathsFile->name());
   }
 
+  if (!opt.portfolio.empty()) {
+    // The portfolio members read the FlatZinc from the file, it is never piped
+    assert(fznFile != nullptr);
+    return solvePortfolio(cmd_line, fznFile->name(),
+                          pathsFile == nullptr ? std::string() : pathsFile->name(),
+                          sharedBounds.get());
+  }
+  std::function<void(std::ostream&)> input;
+  if (pipeFzn) {
+    input = [this](std::ostream& os) { printFlatZinc(os); };
+  }
   if (!opt.fznOutputPassthrough) {
-    Process<Solns2Out> proc(cmd_line, getSolns2Out(), timelimit, sigint);
-    int exitStatus = proc.run();
+    int exitStatus = runSolver(cmd_line, getSolns2Out(), input, sharedBounds.get());
     return exitStatus == 0 ? getSolns2Out()->status : SolverInstance::ERROR;
   }
   Solns2Log s2l(getSolns2Out()->getOutput(), _log);
-  Process<Solns2Log> proc(cmd_line, &s2l, timelimit, sigint);
-  int exitStatus = proc.run();
+  int exitStatus = runSolver(cmd_line, &s2l, input, sharedBounds.get());
   return exitStatus == 0 ? SolverInstance::NONE : SolverInstance::ERROR;
 }
 
+template <class S2O>
+int FZNSolverInstance::runSolver(std::vector<std::string>& cmdLine, S2O* pso,
+                                 const std::function<void(std::ostream&)>& input,
+                                 SharedBounds* sharedBounds) {
+  auto& opt = static_cast<FZNSolverOptions&>(*_options);
+  if (sharedBounds == nullptr) {
+    Process<S2O> proc(cmdLine, pso, opt.fznTimeLimitMilliseconds, opt.fznSigint);
+    proc.input(input);
+    return proc.run();
+  }
+  SharedBoundsPublisher<S2O> publisher(pso, *sharedBounds, getSolns2Out()->opt,
+                                       _portfolioObjective, _portfolioStripObjective);
+  Process<SharedBoundsPublisher<S2O>> proc(cmdLine, &publisher, opt.fznTimeLimitMilliseconds,
+                                           opt.fznSigint);
+  proc.input(input);
+  int exitStatus = proc.run();
+  if (opt.printStatistics) {
+    std::ostringstream oss;
+    oss << "%%%mzn-stat: sharedBoundsPublished=" << sharedBounds->stats.published.load() << "\n"
+        << "%%%mzn-stat: sharedBoundsImproved=" << sharedBounds->stats.improved.load() << "\n"
+        << "%%%mzn-stat-end\n";
+    pso->feedRawDataChunk(oss.str().c_str());
+  }
+  return exitStatus;
+}
+
+void FZNSolverInstance::printFlatZinc(std::ostream& os) {
+  Printer p(os, 0, true, &_env.envi());
+  for (FunctionIterator it = _fzn->functions().begin(); it != _fzn->functions().end(); ++it) {
+    if (!it->removed()) {
+      Item& item = *it;
+      p.print(&item);
+    }
+  }
+  for (VarDeclIterator it = _fzn->vardecls().begin(); it != _fzn->vardecls().end(); ++it) {
+    if (!it->removed()) {
+      Item& item = *it;
+      p.print(&item);
+    }
+  }
+  for (ConstraintIterator it = _fzn->constraints().begin(); it != _fzn->constraints().end();
+       ++it) {
+    if (!it->removed()) {
+      Item& item = *it;
+      p.print(&item);
+    }
+  }
+  p.print(_fzn->solveItem());
+}
+
+SolverInstance::Status FZNSolverInstance::solvePortfolio(std::vector<std::string>& cmdLine,
+                                                          const std::string& fznFile,
+                                                          const std::string& pathsFile,
+                                                          SharedBounds* sharedBounds) {
+  auto& opt = static_cast<FZNSolverOptions&>(*_options);
+  auto* solveItem = _fzn->solveItem();
+  bool is_sat = solveItem->st() == SolveI::SolveType::ST_SAT;
+
+  std::vector<FZNPortfolio::Member> members;
+  members.push_back({opt.fznSolver, cmdLine});
+  for (auto& m : opt.portfolio) {
+    m->verbose = m->verbose || opt.verbose;
+    std::vector<std::string> memberCmd = FZNSolverInstance::cmdLine(*m, is_sat);
+    memberCmd.push_back(fznFile);
+    if (m->fznNeedsPaths) {
+      if (pathsFile.empty()) {
+        throw Error("Portfolio member " + m->fznSolver +
+                    " requires a paths file, but the first portfolio member does not");
+      }
+      memberCmd.emplace_back("--paths");
+      memberCmd.push_back(pathsFile);
+    }
+    members.push_back({m->fznSolver, memberCmd});
+  }
+
+  FZNPortfolio::Direction dir = FZNPortfolio::D_SAT;
+  if (solveItem->st() == SolveI::SolveType::ST_MIN) {
+    dir = FZNPortfolio::D_MIN;
+  } else if (solveItem->st() == SolveI::SolveType::ST_MAX) {
+    dir = FZNPortfolio::D_MAX;
+  }
+  FZNPortfolio portfolio(members, getSolns2Out(), opt.fznTimeLimitMilliseconds, opt.fznSigint,
+                         dir, _portfolioObjective, _portfolioStripObjective);
+  portfolio.sharedBounds = sharedBounds;
+  int exitStatus = portfolio.run();
+  if (opt.printStatistics) {
+    std::ostringstream oss;
+    if (members.size() > 1) {
+      oss << "%%%mzn-stat: portfolioMembers=" << members.size() << "\n"
+          << "%%%mzn-stat: portfolioWinner=\""
+          << (portfolio.stats.winner == -1 ? std::string()
+                                           : Printer::escapeStringLit(
+                                                 members[portfolio.stats.winner].name))
+          << "\"\n"
+          << "%%%mzn-stat: portfolioSolutionsReceived=" << portfolio.stats.received << "\n"
+          << "%%%mzn-stat: portfolioSolutionsForwarded=" << portfolio.stats.forwarded << "\n";
+    }
+    if (sharedBounds != nullptr) {
+      oss << "%%%mzn-stat: sharedBoundsPublished=" << sharedBounds->stats.published.load() << "\n"
+          << "%%%mzn-stat: sharedBoundsImproved=" << sharedBounds->stats.improved.load() << "\n";
+    }
+    oss << "%%%mzn-stat-end\n";
+    getSolns2Out()->feedRawDataChunk(oss.str().c_str());
+  }
+  return exitStatus == 0 ? getSolns2Out()->status : SolverInstance::ERROR;
+}
+
 void FZNSolverInstance::processFlatZinc() {}
 
 void FZNSolverInstance::resetSolver() {}
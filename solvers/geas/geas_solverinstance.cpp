@@ -658,8 +658,14 @@ geas::intvar GeasSolverInstance::asIntVar(Expression* e) {
   if (i == 0) {
     return zero;
   }
-  return _solver.new_intvar(static_cast<geas::intvar::val_t>(i.toInt()),
-                            static_cast<geas::intvar::val_t>(i.toInt()));
+  auto it = _intConstants.find(i.toInt());
+  if (it != _intConstants.end()) {
+    return it->second;
+  }
+  geas::intvar iv = _solver.new_intvar(static_cast<geas::intvar::val_t>(i.toInt()),
+                                       static_cast<geas::intvar::val_t>(i.toInt()));
+  _intConstants.emplace(i.toInt(), iv);
+  return iv;
 }
 
 vec<geas::intvar> GeasSolverInstance::asIntVar(ArrayLit* al) {
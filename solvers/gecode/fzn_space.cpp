@@ -12,6 +12,8 @@
 #include <minizinc/solvers/gecode/fzn_space.hh>
 #include <minizinc/solvers/gecode_solverinstance.hh>
 
+#include <cmath>
+
 using namespace Gecode;
 
 namespace MiniZinc {
@@ -99,26 +101,64 @@ FznSpace::FznSpace(FznSpace& f) : Space(f) {
   optVarIdx = f.optVarIdx;
   copyAuxVars = f.copyAuxVars;
   solveType = f.solveType;
+  sharedBounds = f.sharedBounds;
 }
 
 Gecode::Space* FznSpace::copy() { return new FznSpace(*this); }
 
 void FznSpace::constrain(const Space& s) {
   if (optVarIsInt) {
+    long long int val = static_cast<const FznSpace*>(&s)->iv[optVarIdx].val();
     if (solveType == MiniZinc::SolveI::SolveType::ST_MIN) {
-      rel(*this, iv[optVarIdx], IRT_LE, static_cast<const FznSpace*>(&s)->iv[optVarIdx].val());
+      rel(*this, iv[optVarIdx], IRT_LE, val);
     } else if (solveType == MiniZinc::SolveI::SolveType::ST_MAX) {
-      rel(*this, iv[optVarIdx], IRT_GR, static_cast<const FznSpace*>(&s)->iv[optVarIdx].val());
+      rel(*this, iv[optVarIdx], IRT_GR, val);
     }
   } else {
 #ifdef GECODE_HAS_FLOAT_VARS
+    FloatVal val = static_cast<const FznSpace*>(&s)->fv[optVarIdx].val();
     if (solveType == MiniZinc::SolveI::SolveType::ST_MIN) {
-      rel(*this, fv[optVarIdx], FRT_LE, static_cast<const FznSpace*>(&s)->fv[optVarIdx].val());
+      rel(*this, fv[optVarIdx], FRT_LE, val);
     } else if (solveType == MiniZinc::SolveI::SolveType::ST_MAX) {
-      rel(*this, fv[optVarIdx], FRT_GR, static_cast<const FznSpace*>(&s)->fv[optVarIdx].val());
+      rel(*this, fv[optVarIdx], FRT_GR, val);
+    }
+#endif
+  }
+  // Another solver's incumbent may be better than the solution found here
+  importSharedIncumbent();
+}
+
+bool FznSpace::importSharedIncumbent() {
+  double shared;
+  if (sharedBounds == nullptr || !sharedBounds->incumbent(shared) || failed()) {
+    return false;
+  }
+  if (optVarIsInt) {
+    if (solveType == MiniZinc::SolveI::SolveType::ST_MIN &&
+        std::ceil(shared) <= static_cast<double>(iv[optVarIdx].max())) {
+      rel(*this, iv[optVarIdx], IRT_LE, static_cast<long long int>(std::ceil(shared)));
+    } else if (solveType == MiniZinc::SolveI::SolveType::ST_MAX &&
+               std::floor(shared) >= static_cast<double>(iv[optVarIdx].min())) {
+      rel(*this, iv[optVarIdx], IRT_GR, static_cast<long long int>(std::floor(shared)));
+    } else {
+      return false;
+    }
+  } else {
+#ifdef GECODE_HAS_FLOAT_VARS
+    if (solveType == MiniZinc::SolveI::SolveType::ST_MIN && shared <= fv[optVarIdx].max()) {
+      rel(*this, fv[optVarIdx], FRT_LE, FloatVal(shared));
+    } else if (solveType == MiniZinc::SolveI::SolveType::ST_MAX &&
+               shared >= fv[optVarIdx].min()) {
+      rel(*this, fv[optVarIdx], FRT_GR, FloatVal(shared));
+    } else {
+      return false;
     }
+#else
+    return false;
 #endif
   }
+  ++sharedBounds->stats.imported;
+  return true;
 }
 
 }  // namespace MiniZinc
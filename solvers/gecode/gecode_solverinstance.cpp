@@ -16,9 +16,19 @@
 #include <minizinc/solvers/gecode/gecode_constraints.hh>
 #include <minizinc/solvers/gecode_solverinstance.hh>
 #include <minizinc/statistics.hh>
+#include <minizinc/timer.hh>
 
 #include "aux_brancher.hh"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 using namespace std;
@@ -26,6 +36,25 @@ using namespace Gecode;
 
 namespace MiniZinc {
 
+namespace {
+
+/// Peak resident set size of the process in MB (0 if not available)
+double peak_memory_mb() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss) / 1048576.0;
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+  }
+#endif
+  return 0.0;
+}
+
+}  // namespace
+
 GecodeSolverFactory::GecodeSolverFactory() {
   SolverConfig sc("org.minizinc.gecode_presolver", GECODE_VERSION);
 #ifdef __EMSCRIPTEN__
@@ -91,6 +120,14 @@ bool GecodeSolverFactory::processOption(SolverInstanceBase::Options* opt, int& i
     if (passes >= 0) {
       _opt.prePasses = passes;
     }
+  } else if (string(argv[i]) == "--sac-threads") {
+    if (++i == argv.size()) {
+      return false;
+    }
+    int threads = atoi(argv[i].c_str());
+    if (threads >= 0) {
+      _opt.sacThreads = threads;
+    }
   } else if (string(argv[i]) == "-a" || string(argv[i]) == "--all-solutions") {
     _opt.allSolutions = true;
   } else if (string(argv[i]) == "-n" || string(argv[i]) == "--num-solutions") {
@@ -182,6 +219,9 @@ void GecodeSolverFactory::printHelp(ostream& os) {
      << "    shave domains" << std::endl
      << "  --pre-passes <n>" << std::endl
      << "    n passes of sac/shaving, 0 for fixed point" << std::endl
+     << "  --sac-threads <n>" << std::endl
+     << "    number of threads probing values during sac/shaving, 0 for one per core"
+     << std::endl
      << "  --c_d <n>" << std::endl
      << "    recomputation commit distance" << std::endl
      << "  --a_d <n>" << std::endl
@@ -511,12 +551,52 @@ void GecodeSolverInstance::processFlatZinc() {
   _runSac = _opt.sac;
   _runShave = _opt.shave;
   _prePasses = _opt.prePasses;
+  _sacThreads =
+      _opt.sacThreads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : _opt.sacThreads;
   _printStats = _opt.statistics;
   _allSolutions = _opt.allSolutions;
   _nMaxSolutions = _opt.nSolutions;
   _allowUnboundedVars = _opt.allowUnboundedVars;
+  Timer initTimer;
+  double initPeakMem = peak_memory_mb();
   currentSpace = new FznSpace();
 
+  // count the variables of each type, so that the arrays of the space are allocated only once
+  size_t nIntVars = 0;
+  size_t nBoolVars = 0;
+  size_t nFloatVars = 0;
+  size_t nSetVars = 0;
+  for (VarDeclIterator it = _flat->vardecls().begin(); it != _flat->vardecls().end(); ++it) {
+    if (!it->removed() && it->e()->type().isvar() && it->e()->type().dim() == 0) {
+      Type t = it->e()->type();
+      if (t.isint()) {
+        nIntVars++;
+      } else if (t.isbool()) {
+        nBoolVars++;
+      } else if (t.isfloat()) {
+        nFloatVars++;
+      } else if (t.isIntSet()) {
+        nSetVars++;
+      }
+    }
+  }
+  currentSpace->iv.reserve(nIntVars);
+  currentSpace->ivIntroduced.reserve(nIntVars);
+  currentSpace->ivDefined.reserve(nIntVars);
+  currentSpace->bv.reserve(nBoolVars);
+  currentSpace->bvIntroduced.reserve(nBoolVars);
+  currentSpace->bvDefined.reserve(nBoolVars);
+#ifdef GECODE_HAS_FLOAT_VARS
+  currentSpace->fv.reserve(nFloatVars);
+  currentSpace->fvIntroduced.reserve(nFloatVars);
+  currentSpace->fvDefined.reserve(nFloatVars);
+#endif
+#ifdef GECODE_HAS_SET_VARS
+  currentSpace->sv.reserve(nSetVars);
+  currentSpace->svIntroduced.reserve(nSetVars);
+  currentSpace->svDefined.reserve(nSetVars);
+#endif
+
   // iterate over VarDecls of the flat model and create variables
   for (VarDeclIterator it = _flat->vardecls().begin(); it != _flat->vardecls().end(); ++it) {
     if (!it->removed() && it->e()->type().isvar()) {
@@ -746,7 +826,10 @@ void GecodeSolverInstance::processFlatZinc() {
     }  // end if it is a variable
   }    // end for all var decls
 
-  // post the constraints
+  // post the constraints in their original order (which determines the propagator order),
+  // sharing constants between them
+  _intConstants.clear();
+  _shareConstants = true;
   for (ConstraintIterator it = _flat->constraints().begin(); it != _flat->constraints().end();
        ++it) {
     if (!it->removed()) {
@@ -755,6 +838,10 @@ void GecodeSolverInstance::processFlatZinc() {
       }
     }
   }
+  _shareConstants = false;
+  _intConstants.clear();
+  _boolConstants[0] = BoolVar();
+  _boolConstants[1] = BoolVar();
 
   // objective
   SolveI* si = _flat->solveItem();
@@ -797,6 +884,8 @@ void GecodeSolverInstance::processFlatZinc() {
       assert(false);
     }
   }
+  _initTime = initTimer.s();
+  _initMemIncrease = peak_memory_mb() - initPeakMem;
 
   // std::cout << "DEBUG: at end of processFlatZinc: " << std::endl
   //          << "iv has " << currentSpace->iv.size() << " variables " << std::endl
@@ -905,7 +994,7 @@ Gecode::IntVarArgs GecodeSolverInstance::arg2intvarargs(Expression* arg, int off
   }
   IntVarArgs ia(static_cast<int>(a->size()) + offset);
   for (int i = offset; (i--) != 0;) {
-    ia[i] = IntVar(*this->currentSpace, 0, 0);
+    ia[i] = intConstant(0);
   }
   for (int i = static_cast<int>(a->size()); (i--) != 0;) {
     Expression* e = (*a)[i];
@@ -918,8 +1007,7 @@ Gecode::IntVarArgs GecodeSolverInstance::arg2intvarargs(Expression* arg, int off
     } else {
       long long int value = IntLit::v(Expression::cast<IntLit>(e)).toInt();
       if (valueWithinBounds(static_cast<double>(value))) {
-        IntVar iv(*this->currentSpace, static_cast<int>(value), static_cast<int>(value));
-        ia[i + offset] = iv;
+        ia[i + offset] = intConstant(static_cast<int>(value));
       } else {
         std::stringstream ssm;
         ssm << "GecodeSolverInstance::arg2intvarargs Error: " << value << " outside 32-bit int."
@@ -939,7 +1027,7 @@ Gecode::BoolVarArgs GecodeSolverInstance::arg2boolvarargs(Expression* arg, int o
   }
   BoolVarArgs ia(static_cast<int>(a->length()) + offset - (siv == -1 ? 0 : 1));
   for (int i = offset; (i--) != 0;) {
-    ia[i] = BoolVar(*this->currentSpace, 0, 0);
+    ia[i] = boolConstant(false);
   }
   for (int i = 0; i < static_cast<int>(a->length()); i++) {
     if (i == siv) {
@@ -961,9 +1049,7 @@ Gecode::BoolVarArgs GecodeSolverInstance::arg2boolvarargs(Expression* arg, int o
       }
     } else {
       if (auto* bl = Expression::dynamicCast<BoolLit>(e)) {
-        bool value = bl->v();
-        BoolVar iv(*this->currentSpace, static_cast<int>(value), static_cast<int>(value));
-        ia[offset++] = iv;
+        ia[offset++] = boolConstant(bl->v());
       } else {
         std::stringstream ssm;
         ssm << "Expected bool literal instead of: " << *e;
@@ -974,6 +1060,28 @@ Gecode::BoolVarArgs GecodeSolverInstance::arg2boolvarargs(Expression* arg, int o
   return ia;
 }
 
+Gecode::IntVar GecodeSolverInstance::intConstant(int v) {
+  if (!_shareConstants) {
+    return IntVar(*this->currentSpace, v, v);
+  }
+  auto it = _intConstants.find(v);
+  if (it == _intConstants.end()) {
+    it = _intConstants.emplace(v, IntVar(*this->currentSpace, v, v)).first;
+  }
+  return it->second;
+}
+
+Gecode::BoolVar GecodeSolverInstance::boolConstant(bool b) {
+  if (!_shareConstants) {
+    return BoolVar(*this->currentSpace, static_cast<int>(b), static_cast<int>(b));
+  }
+  BoolVar& c = _boolConstants[static_cast<int>(b)];
+  if (c.varimp() == nullptr) {
+    c = BoolVar(*this->currentSpace, static_cast<int>(b), static_cast<int>(b));
+  }
+  return c;
+}
+
 Gecode::BoolVar GecodeSolverInstance::arg2boolvar(Expression* e) {
   BoolVar x0;
   if (Expression::type(e).isvar()) {
@@ -983,7 +1091,7 @@ Gecode::BoolVar GecodeSolverInstance::arg2boolvar(Expression* e) {
     x0 = var.boolVar(currentSpace);
   } else {
     if (auto* bl = Expression::dynamicCast<BoolLit>(e)) {
-      x0 = BoolVar(*this->currentSpace, static_cast<int>(bl->v()), static_cast<int>(bl->v()));
+      x0 = boolConstant(bl->v());
     } else {
       std::stringstream ssm;
       ssm << "Expected bool literal instead of: " << *e;
@@ -1011,8 +1119,7 @@ Gecode::IntVar GecodeSolverInstance::arg2intvar(Expression* e) {
       ssm << "Expected bool or int literal instead of: " << *e;
       throw InternalError(ssm.str());
     }
-    int ii = static_cast<int>(i.toInt());
-    x0 = IntVar(*this->currentSpace, ii, ii);
+    x0 = intConstant(static_cast<int>(i.toInt()));
   }
   return x0;
 }
@@ -1392,6 +1499,17 @@ void GecodeSolverInstance::printStatistics() {
   ss.add("failures", stat.fail);
   ss.add("restarts", stat.restart);
   ss.add("peak_depth", stat.depth);
+  ss.add("initTime", _initTime);
+  ss.add("initMemIncrease", _initMemIncrease);
+  if (_sacRounds > 0) {
+    ss.add("sacRounds", _sacRounds);
+    ss.add("sacProbes", _sacProbes);
+    ss.add("sacPruned", _sacPruned);
+  }
+  if (_sharedBounds) {
+    ss.add("sharedBoundsPublished", _sharedBounds->stats.published.load());
+    ss.add("sharedBoundsImported", _sharedBounds->stats.imported.load());
+  }
 }
 
 void GecodeSolverInstance::processSolution(bool last_sol) {
@@ -1445,10 +1563,31 @@ void GecodeSolverInstance::processSolution(bool last_sol) {
   }
 }
 
+double GecodeSolverInstance::objectiveValue(const FznSpace* s) const {
+  if (s->optVarIsInt) {
+    return static_cast<double>(s->iv[s->optVarIdx].val());
+  }
+#ifdef GECODE_HAS_FLOAT_VARS
+  return s->fv[s->optVarIdx].val().med();
+#else
+  return 0.0;
+#endif
+}
+
 SolverInstanceBase::Status GecodeSolverInstance::solve() {
   GCLock lock;
   SolverInstanceBase::Status ret;
 
+  if (!_options->sharedBoundsFile.empty() && engine == nullptr &&
+      currentSpace->solveType != MiniZinc::SolveI::SolveType::ST_SAT) {
+    bool minimize = currentSpace->solveType == MiniZinc::SolveI::SolveType::ST_MIN;
+    _sharedBounds.reset(new SharedBounds(_options->sharedBoundsFile, minimize,
+                                         _options->sharedBoundsModel));
+    currentSpace->sharedBounds = _sharedBounds.get();
+    // Start from the best solution that another solver has already found
+    currentSpace->importSharedIncumbent();
+  }
+
   prepareEngine();
 
   if (_runSac || _runShave) {
@@ -1469,6 +1608,9 @@ SolverInstanceBase::Status GecodeSolverInstance::solve() {
     delete solution;
     solution = next_sol;
     _nFoundSolutions++;
+    if (_sharedBounds) {
+      _sharedBounds->publishIncumbent(objectiveValue(solution));
+    }
 
     if (n_max_solutions == 0 || _nFoundSolutions <= n_max_solutions) {
       processSolution();
@@ -1499,6 +1641,21 @@ SolverInstanceBase::Status GecodeSolverInstance::solve() {
   } else {
     ret = SolverInstance::SAT;
   }
+  if (_sharedBounds) {
+    double shared;
+    bool hasShared = _sharedBounds->incumbent(shared);
+    if (ret == SolverInstance::OPT) {
+      if (hasShared && _sharedBounds->better(shared, objectiveValue(solution))) {
+        // The search was cut off by a better solution found elsewhere
+        ret = SolverInstance::SAT;
+      } else {
+        _sharedBounds->publishBound(objectiveValue(solution));
+      }
+    } else if (ret == SolverInstance::UNSAT && _sharedBounds->stats.imported > 0) {
+      // Only proves that there is no solution better than another solver's incumbent
+      ret = SolverInstance::UNKNOWN;
+    }
+  }
   _pS2Out->stats.nFails = engine->statistics().fail;
   _pS2Out->stats.nNodes = engine->statistics().node;
   delete engine;
@@ -1520,7 +1677,144 @@ public:
   static void init(const IntVar& x) { Int::IntVarImpBwd(x.varimp()); }
 };
 
-bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false) const {
+namespace {
+
+/// A variable to probe during sac/shaving
+struct SacTask {
+  bool isBool;
+  unsigned int idx;
+};
+
+/// Probing tasks of one thread. The owner takes tasks from the front, idle threads steal from
+/// the back.
+class SacQueue {
+protected:
+  std::mutex _mutex;
+  std::deque<SacTask> _tasks;
+
+public:
+  void push(const SacTask& t) { _tasks.push_back(t); }
+  bool pop(SacTask& t) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    t = _tasks.front();
+    _tasks.pop_front();
+    return true;
+  }
+  bool steal(SacTask& t) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    t = _tasks.back();
+    _tasks.pop_back();
+    return true;
+  }
+};
+
+/// Values removed by one probing thread
+struct SacPrunings {
+  std::vector<std::pair<unsigned int, int> > bv;
+  std::vector<std::pair<unsigned int, int> > iv;
+  unsigned long long probes = 0;
+  unsigned long long steals = 0;
+};
+
+/// Whether assigning \a val to the variable of task \a t fails in \a root
+bool sac_probe_fails(FznSpace* root, const SacTask& t, int val) {
+  auto* f = static_cast<FznSpace*>(root->clone());
+  if (t.isBool) {
+    rel(*f, f->bv[t.idx], IRT_EQ, val);
+  } else {
+    rel(*f, f->iv[t.idx], IRT_EQ, val);
+  }
+  bool failed = f->status() == SS_FAILED;
+  delete f;
+  return failed;
+}
+
+/// Probe the variable of task \a t and remove the failing values from \a root.
+/// Returns false if \a root fails.
+bool sac_probe(FznSpace* root, const SacTask& t, bool shaving, SacPrunings& p) {
+  std::vector<int> nq;
+  if (t.isBool) {
+    BoolVar bvar = root->bv[t.idx];
+    if (bvar.assigned()) {
+      return true;
+    }
+    for (int val = 0; val <= 1 && nq.empty(); ++val) {
+      ++p.probes;
+      if (sac_probe_fails(root, t, val)) {
+        nq.push_back(val);
+      }
+    }
+    for (int val : nq) {
+      p.bv.emplace_back(t.idx, val);
+      rel(*root, bvar, IRT_NQ, val);
+    }
+  } else {
+    IntVar ivar = root->iv[t.idx];
+    if (ivar.assigned()) {
+      return true;
+    }
+    bool tight = false;
+    bool consistent = false;
+    int fwdMin = ivar.min();
+    for (IntVarValues vv(ivar); vv() && !tight; ++vv) {
+      ++p.probes;
+      if (sac_probe_fails(root, t, vv.val())) {
+        nq.push_back(vv.val());
+      } else {
+        fwdMin = vv.val();
+        consistent = true;
+        tight = shaving;
+      }
+    }
+    if (shaving && consistent) {
+      tight = false;
+      for (IntVarRangesBwd vr(ivar); vr() && !tight; ++vr) {
+        for (int i = vr.max(); i >= vr.min() && i > fwdMin && !tight; i--) {
+          ++p.probes;
+          if (sac_probe_fails(root, t, i)) {
+            nq.push_back(i);
+          } else {
+            tight = true;
+          }
+        }
+      }
+    }
+    for (int val : nq) {
+      p.iv.emplace_back(t.idx, val);
+      rel(*root, ivar, IRT_NQ, val);
+    }
+  }
+  return nq.empty() || root->status() != SS_FAILED;
+}
+
+}  // namespace
+
+void GecodeSolverInstance::sacRoundFinished(const Timer& roundTimer, unsigned long long probes,
+                                            unsigned long long pruned, unsigned int threads,
+                                            unsigned long long steals) {
+  ++_sacRounds;
+  _sacProbes += probes;
+  _sacPruned += pruned;
+  if (_printStats || _options->printStatistics) {
+    _log << "% Gecode sac round " << _sacRounds << ": " << probes << " probes, " << pruned
+         << " values removed";
+    if (threads > 1) {
+      _log << ", " << threads << " threads, " << steals << " steals";
+    }
+    _log << ", " << roundTimer.stoptime() << std::endl;
+  }
+}
+
+bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false) {
+  if (_sacThreads > 1) {
+    return sacParallel(toFixedPoint, shaving, _sacThreads);
+  }
   if (currentSpace->status() == SS_FAILED) {
     return false;
   }
@@ -1536,6 +1830,9 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
   sort(sorted_iv.begin(), sorted_iv.end(), ivc);
 
   do {
+    Timer roundTimer;
+    unsigned long long probes = 0;
+    unsigned long long pruned = 0;
     modified = false;
     for (unsigned int idx = 0; idx < currentSpace->bv.size(); idx++) {
       BoolVar bvar = currentSpace->bv[idx];
@@ -1543,9 +1840,11 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
         for (int val = bvar.min(); val <= bvar.max(); ++val) {
           auto* f = static_cast<FznSpace*>(currentSpace->clone());
           rel(*f, f->bv[idx], IRT_EQ, val);
+          probes++;
           if (f->status() == SS_FAILED) {
             rel(*currentSpace, bvar, IRT_NQ, val);
             modified = true;
+            pruned++;
             if (currentSpace->status() == SS_FAILED) {
               return false;
             }
@@ -1564,6 +1863,7 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
       for (IntVarValues vv(ivar); vv() && !tight; ++vv) {
         auto* f = static_cast<FznSpace*>(currentSpace->clone());
         rel(*f, f->iv[idx], IRT_EQ, vv.val());
+        probes++;
         if (f->status() == SS_FAILED) {
           nq[nnq++] = vv.val();
         } else {
@@ -1578,6 +1878,7 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
           for (int i = vr.max(); i >= vr.min() && i >= fwd_min; i--) {
             auto* f = static_cast<FznSpace*>(currentSpace->clone());
             rel(*f, f->iv[idx], IRT_EQ, i);
+            probes++;
             if (f->status() == SS_FAILED) {
               nq[nnq++] = i;
             } else {
@@ -1589,6 +1890,7 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
       }
       if (nnq != 0U) {
         modified = true;
+        pruned += nnq;
       }
       while ((nnq--) != 0U) {
         rel(*currentSpace, ivar, IRT_NQ, nq[nnq]);
@@ -1597,6 +1899,115 @@ bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false)
         return false;
       }
     }
+    sacRoundFinished(roundTimer, probes, pruned, 1, 0);
+  } while (toFixedPoint && modified);
+  return true;
+}
+
+bool GecodeSolverInstance::sacParallel(bool toFixedPoint, bool shaving, unsigned int nThreads) {
+  if (currentSpace->status() == SS_FAILED) {
+    return false;
+  }
+  std::vector<size_t> sorted_iv;
+  for (size_t i = 0; i < currentSpace->iv.size(); i++) {
+    if (!currentSpace->iv[i].assigned()) {
+      sorted_iv.push_back(i);
+    }
+  }
+  IntVarComp ivc(currentSpace->iv);
+  sort(sorted_iv.begin(), sorted_iv.end(), ivc);
+
+  bool modified;
+  do {
+    Timer roundTimer;
+    // deal the unassigned variables out to the threads
+    std::vector<SacQueue> queues(nThreads);
+    unsigned int next = 0;
+    for (unsigned int idx = 0; idx < currentSpace->bv.size(); idx++) {
+      if (!currentSpace->bv[idx].assigned()) {
+        queues[next++ % nThreads].push({true, idx});
+      }
+    }
+    for (size_t idx : sorted_iv) {
+      if (!currentSpace->iv[idx].assigned()) {
+        queues[next++ % nThreads].push({false, static_cast<unsigned int>(idx)});
+      }
+    }
+
+    // each thread probes on its own copy of the root space, since a space cannot be cloned by
+    // several threads at once
+    std::vector<FznSpace*> roots(nThreads);
+    for (auto& r : roots) {
+      r = static_cast<FznSpace*>(currentSpace->clone());
+    }
+    std::vector<SacPrunings> prunings(nThreads);
+    std::vector<std::exception_ptr> errors(nThreads);
+    std::atomic<bool> failed(false);
+    auto work = [&](unsigned int self) {
+      try {
+        SacTask t;
+        while (!failed.load()) {
+          bool have = queues[self].pop(t);
+          for (unsigned int k = 1; !have && k < nThreads; k++) {
+            have = queues[(self + k) % nThreads].steal(t);
+            if (have) {
+              ++prunings[self].steals;
+            }
+          }
+          if (!have) {
+            break;
+          }
+          if (!sac_probe(roots[self], t, shaving, prunings[self])) {
+            failed = true;
+          }
+        }
+      } catch (...) {
+        errors[self] = std::current_exception();
+        failed = true;
+      }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < nThreads; i++) {
+      workers.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& w : workers) {
+      w.join();
+    }
+    for (auto* r : roots) {
+      delete r;
+    }
+    for (auto& e : errors) {
+      if (e) {
+        std::rethrow_exception(e);
+      }
+    }
+    if (failed.load()) {
+      // all removed values are inconsistent with the root space, so a failure is global
+      currentSpace->fail();
+      return false;
+    }
+
+    // merge the values removed by all threads into the root space
+    unsigned long long probes = 0;
+    unsigned long long pruned = 0;
+    unsigned long long steals = 0;
+    for (auto& p : prunings) {
+      for (auto& v : p.bv) {
+        rel(*currentSpace, currentSpace->bv[v.first], IRT_NQ, v.second);
+      }
+      for (auto& v : p.iv) {
+        rel(*currentSpace, currentSpace->iv[v.first], IRT_NQ, v.second);
+      }
+      probes += p.probes;
+      pruned += p.bv.size() + p.iv.size();
+      steals += p.steals;
+    }
+    modified = pruned != 0;
+    if (currentSpace->status() == SS_FAILED) {
+      return false;
+    }
+    sacRoundFinished(roundTimer, probes, pruned, nThreads, steals);
   } while (toFixedPoint && modified);
   return true;
 }
@@ -1626,7 +2037,7 @@ bool GecodeSolverInstance::presolve(Model* originalModel) {
       vds[vd->id()->str()] = vd;
     }
 
-    IdMap<GecodeVariable>::iterator it;
+    FlatIdMap<GecodeVariable>::iterator it;
     for (it = _variableMap.begin(); it != _variableMap.end(); it++) {
       VarDecl* vd = it->first->decl();
       long long int old_domsize = 0;
@@ -149,31 +149,60 @@ void NLBound::updateEq(double new_eq) {
   }
 }
 
-/** Printing with a name. */
-ostream& NLBound::printToStream(ostream& os, const string& vname) const {
+/** Printing with a name, as one line of a 'b' or 'r' segment. */
+void NLBound::print(NLOutput& out, const string& vname) const {
+  out.key(static_cast<char>('0' + tag), true);
   switch (tag) {
     case LB_UB: {
-      os << "0 " << lb << " " << ub << "   # " << lb << " =< " << vname << " =< " << ub;
+      out.real(lb).real(ub);
       break;
     }
     case UB: {
-      os << "1 " << ub << "   # " << vname << " =< " << ub;
+      out.real(ub);
+      break;
+    }
+    case LB:
+    case EQ: {
+      out.real(lb);
+      break;
+    }
+    case NONE: {
+      break;
+    }
+  }
+  if (out.isBinary()) {
+    return;
+  }
+  ostream& os = out.stream();
+  os << "   # ";
+  switch (tag) {
+    case LB_UB: {
+      os << lb << " =< " << vname << " =< " << ub;
+      break;
+    }
+    case UB: {
+      os << vname << " =< " << ub;
       break;
     }
     case LB: {
-      os << "2 " << lb << "   # " << lb << " =< " << vname;
+      os << lb << " =< " << vname;
       break;
     }
     case NONE: {
-      os << "3"
-         << "   # No constraint";
+      os << "No constraint";
       break;
     }
     case EQ: {
-      os << "4 " << lb << "   # " << vname << " = " << lb;
+      os << vname << " = " << lb;
       break;
     }
   }
+}
+
+/** Printing with a name. */
+ostream& NLBound::printToStream(ostream& os, const string& vname) const {
+  NLOutput out(os, false);
+  print(out, vname);
   return os;
 }
 
@@ -358,10 +387,10 @@ NLToken NLToken::n(double value) {
   return tok;
 }
 
-NLToken NLToken::v(string vname) {
+NLToken NLToken::v(int var) {
   NLToken tok;
   tok.kind = Kind::VARIABLE;
-  tok.str = std::move(vname);
+  tok.var = var;
   return tok;
 }
 
@@ -384,15 +413,16 @@ bool NLToken::isVariable() const { return kind == VARIABLE; }
 
 bool NLToken::isConstant() const { return kind == NUMERIC; }
 
-ostream& NLToken::printToStream(ostream& os, const NLFile& nl_file) const {
+void NLToken::print(NLOutput& out, const NLFile& nl_file) const {
   switch (kind) {
     case Kind::NUMERIC: {
-      os << "n" << numericValue;
+      out.key('n').real(numericValue).eol();
       break;
     }
 
     case Kind::VARIABLE: {
-      os << "v" << nl_file.variableIndexes.at(str) << " # " << str;
+      const NLVar& v = nl_file.variables[var];
+      out.key('v').integer(v.index).eol(v.name);
       break;
     }
 
@@ -405,33 +435,31 @@ ostream& NLToken::printToStream(ostream& os, const NLFile& nl_file) const {
     }
 
     case Kind::OP: {
-      os << "o" << oc << " # " << getName(oc);
+      out.key('o').integer(oc).eol(getName(oc));
       break;
     }
 
     case Kind::MOP: {
-      os << "o" << moc << " # " << getName(moc) << " " << argCount << endl;
-      os << argCount;
+      out.key('o').integer(moc).eol(getName(moc));
+      out.integer(argCount).eol();
       break;
     }
 
     default:
       should_not_happen("Unknown token kind: " << kind);
   }
-
-  return os;
 }
 
 /* *** *** *** NLAlgCons *** *** *** */
 
 /** Method to build the var_coeff vector. */
-void NLAlgCons::setJacobian(const vector<string>& vnames, const vector<double>& coeffs,
+void NLAlgCons::setJacobian(const vector<int>& vars, const vector<double>& coeffs,
                             NLFile* nl_file) {
-  assert(vnames.size() == coeffs.size());
-  for (int i = 0; i < vnames.size(); ++i) {
-    string vn = vnames[i];
-    nl_file->variables.at(vn).jacobianCount++;
-    jacobian.emplace_back(vn, coeffs[i]);
+  assert(vars.size() == coeffs.size());
+  jacobian.reserve(jacobian.size() + vars.size());
+  for (size_t i = 0; i < vars.size(); ++i) {
+    nl_file->variables[vars[i]].jacobianCount++;
+    jacobian.emplace_back(vars[i], coeffs[i]);
   }
 }
 
@@ -439,43 +467,50 @@ void NLAlgCons::setJacobian(const vector<string>& vnames, const vector<double>&
 bool NLAlgCons::isLinear() const { return expressionGraph.empty(); }
 
 /** Printing. */
-ostream& NLAlgCons::printToStream(ostream& os, const NLFile& nl_file) const {
-  int idx = nl_file.constraintIndexes.at(name);
-
+void NLAlgCons::print(NLOutput& out, const NLFile& nl_file) const {
   // Print the 'C' segment: if no expression graph, print "n0".
-  os << "C" << idx << "   # Non linear part of " << name << endl;
+  out.key('C').integer(index);
+  if (out.isBinary()) {
+    out.eol();
+  } else {
+    out.eol("Non linear part of " + name);
+  }
   if (expressionGraph.empty()) {
-    os << "n0   # No non linear part coded as the value '0'" << endl;
+    out.key('n').real(0).eol("No non linear part coded as the value '0'");
   } else {
     for (const auto& t : expressionGraph) {
-      t.printToStream(os, nl_file);
-      os << endl;
+      t.print(out, nl_file);
     }
   }
 
   // Print the 'J' segment if present.
   if (!jacobian.empty()) {
-    os << "J" << idx << " " << jacobian.size() << "   # Linear part of " << name << endl;
-    for (const auto& vn_coef : jacobian) {
-      os << nl_file.variableIndexes.at(vn_coef.first) << " " << vn_coef.second << "   # "
-         << vn_coef.first << endl;
+    out.key('J').integer(index).integer(static_cast<int>(jacobian.size()));
+    if (out.isBinary()) {
+      out.eol();
+    } else {
+      out.eol("Linear part of " + name);
+    }
+    for (const auto& v_coef : jacobian) {
+      const NLVar& v = nl_file.variables[v_coef.first];
+      out.integer(v.index).real(v_coef.second).eol(v.name);
     }
   }
-
-  return os;
 }
 
 /* *** *** *** NLLogicalCons *** *** *** */
 
 /** Printing. */
-ostream& NLLogicalCons::printToStream(ostream& os, const NLFile& nl_file) const {
-  os << "L" << index << "   # Logical constraint " << name << endl;
+void NLLogicalCons::print(NLOutput& out, const NLFile& nl_file) const {
+  out.key('L').integer(index);
+  if (out.isBinary()) {
+    out.eol();
+  } else {
+    out.eol("Logical constraint " + name);
+  }
   for (const auto& t : expressionGraph) {
-    t.printToStream(os, nl_file);
-    os << endl;
+    t.print(out, nl_file);
   }
-
-  return os;
 }
 
 /* *** *** *** NLHeader *** *** *** */
@@ -483,11 +518,11 @@ ostream& NLLogicalCons::printToStream(ostream& os, const NLFile& nl_file) const
 /** Printing the header.
  *  The header is composed of then lines that we describe as we proceed.
  *  A '#' starts a comment until the end of the line. However, it cannot be a line on its own!*/
-ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file) {
+ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file, bool binary) {
   // 1st line:
-  // 'g': file will be in text format
+  // 'g': file will be in text format, 'b': file will be in binary format
   // other numbers: as given in the doc (no other explanation...)
-  os << "g3 1 1 0" << endl;
+  os << (binary ? "b" : "g") << "3 1 1 0" << endl;
 
   // 2nd line:
   os << nl_file.variables.size() << " "  // Total number of variables
@@ -502,7 +537,7 @@ ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file) {
      << endl;
 
   // 3rd line: Nonlinear and complementary information
-  os << nl_file.cnames_nl_general.size() << " "        // Non linear constraints
+  os << nl_file.cids_nl_general.size() << " "        // Non linear constraints
      << (nl_file.objective.isLinear() ? 0 : 1) << " "  // Non linear objective
      << "# Nb of nonlinear constraints,  nonlinar objectives." << endl;
   /* This was found in the online source of the ASL parser, but is not produce in our ampl tests.
@@ -517,8 +552,8 @@ ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file) {
   */
 
   // 4th line: Network constraints
-  os << nl_file.cnames_nl_network.size() << " "   // Number of nonlinear network constraints
-     << nl_file.cnames_lin_network.size() << " "  // Number of linear network constraints
+  os << nl_file.cids_nl_network.size() << " "   // Number of nonlinear network constraints
+     << nl_file.cids_lin_network.size() << " "  // Number of linear network constraints
      << "# Nb of network constraints: nonlinear,  linear." << endl;
 
   // 5th line: nonlinear variables:
@@ -528,10 +563,19 @@ ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file) {
      << "# Nb of non linear vars in:  constraints,  objectives,  both." << endl;
 
   // 6th line:
+  // The arithmetic mode of a binary file is the byte order of its numbers: 1 for IEEE little
+  // endian, 2 for IEEE big endian.
+  int arith = 0;
+  if (binary) {
+    const std::uint32_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    arith = first == 1 ? 1 : 2;
+  }
   os << nl_file.wvCount() << " "  // Nb of linear network vars
      << "0"
      << " "  // Nb of functions. Not Implemented
-     << "0 1 "
+     << arith << " 1 "
      << "# Nb of: linear network vars,  functions. Floating point arithmetic mode (TEXT == 0). "
         "Flag: if 1, add .sol suffixe."
      << endl;
@@ -580,11 +624,10 @@ ostream& NLHeader::printToStream(ostream& os, const NLFile& nl_file) {
 int NLObjective::gradientCount() const { return static_cast<int>(gradient.size()); }
 
 /** Set the gradient. */
-void NLObjective::setGradient(const vector<string>& vnames, const vector<double>& coeffs) {
-  assert(vnames.size() == coeffs.size());
-  for (int i = 0; i < vnames.size(); ++i) {
-    string vn = vnames[i];
-    gradient.emplace_back(vn, coeffs[i]);
+void NLObjective::setGradient(const vector<int>& vars, const vector<double>& coeffs) {
+  assert(vars.size() == coeffs.size());
+  for (size_t i = 0; i < vars.size(); ++i) {
+    gradient.emplace_back(vars[i], coeffs[i]);
   }
 }
 
@@ -596,31 +639,30 @@ bool NLObjective::isLinear() const { return expressionGraph.empty(); }
 bool NLObjective::isOptimisation() const { return minmax >= MINIMIZE; }
 
 /** Printing. */
-ostream& NLObjective::printToStream(ostream& os, const NLFile& nl_file) const {
+void NLObjective::print(NLOutput& out, const NLFile& nl_file) const {
   if (minmax != UNDEF) {
     if (minmax == SATISFY) {
-      os << "O0 0   # Satisfy objectif implemented as 'minimize 0'" << endl;
-      os << "n0" << endl;
+      out.key('O').integer(0).integer(0).eol("Satisfy objectif implemented as 'minimize 0'");
+      out.key('n').real(0).eol();
     } else {
-      os << "O0 " << minmax << "   # Objectif (0: minimize, 1: maximize)" << endl;
+      out.key('O').integer(0).integer(minmax).eol("Objectif (0: minimize, 1: maximize)");
       if (expressionGraph.empty()) {
-        os << "n0  # No expression graph" << endl;
+        out.key('n').real(0).eol("No expression graph");
       } else {
         for (const auto& tok : expressionGraph) {
-          tok.printToStream(os, nl_file) << endl;
+          tok.print(out, nl_file);
         }
       }
       // Print gradient
       if (!gradient.empty()) {
-        os << "G0 " << gradient.size() << "   # Objective Linear part" << endl;
-        for (const auto& vn_coef : gradient) {
-          os << nl_file.variableIndexes.at(vn_coef.first) << " " << vn_coef.second << "   # "
-             << vn_coef.first << endl;
+        out.key('G').integer(0).integer(static_cast<int>(gradient.size()));
+        out.eol("Objective Linear part");
+        for (const auto& v_coef : gradient) {
+          const NLVar& v = nl_file.variables[v_coef.first];
+          out.integer(v.index).real(v_coef.second).eol(v.name);
         }
       }
     }
   }
-
-  return os;
 }
 }  // namespace MiniZinc
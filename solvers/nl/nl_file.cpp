@@ -7,6 +7,11 @@
 #include <minizinc/hash.hh>
 #include <minizinc/solvers/nl/nl_file.hh>
 
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <thread>
+
 /**
  *  A NL File reprensentation.
  *  The purpose of this file is mainly to be a writer.
@@ -85,12 +90,21 @@ vector<double> NLFile::fromVecFloat(const ArrayLit* v_fp) {
   return v;
 }
 
-/** Create a vector of variable names from a vector containing Expression being identifier Id. */
-vector<string> NLFile::fromVecId(const ArrayLit* v_id) {
-  vector<string> v = {};
+/** Get the id of a declared variable. */
+int NLFile::getVarId(const VarDecl* vd) const {
+  auto it = _varIds.find(vd);
+  if (it == _varIds.end()) {
+    should_not_happen("Variable " << getVarName(vd) << " used before its declaration.");
+  }
+  return it->second;
+}
+
+/** Create a vector of variable ids from a vector containing Expression being identifier Id. */
+vector<int> NLFile::fromVecId(const ArrayLit* v_id) const {
+  vector<int> v;
+  v.reserve(v_id->size());
   for (unsigned int i = 0; i < v_id->size(); ++i) {
-    string s = getVarName(Expression::cast<Id>((*v_id)[i])->decl());
-    v.push_back(s);
+    v.push_back(getVarId(Expression::cast<Id>((*v_id)[i])->decl()));
   }
   return v;
 }
@@ -125,13 +139,12 @@ void NLFile::addVarDecl(const VarDecl* vd, const TypeInst* ti, const Expression*
         const ArrayLit* aa = getArrayLit(c->arg(0));
         for (int i = 0; i < aa->size(); ++i) {
           IntSetVal* r = Expression::cast<SetLit>((*aa)[i])->isv();
-          stringstream ss;
           if (r->empty()) {
-            ss << "1..0";
+            array.dimensions.emplace_back(1, 0);
           } else {
-            ss << r->min().toInt() << ".." << r->max().toInt();
+            array.dimensions.emplace_back(static_cast<int>(r->min().toInt()),
+                                          static_cast<int>(r->max().toInt()));
           }
-          array.dimensions.push_back(ss.str());
         }
 
         // Search the 'real' array. Items can be an identifier or a litteral.
@@ -140,7 +153,7 @@ void NLFile::addVarDecl(const VarDecl* vd, const TypeInst* ti, const Expression*
           NLArray::Item item;
 
           if (Expression::isa<Id>((*ra)[i])) {
-            item.variable = getVarName(Expression::cast<Id>((*ra)[i]));
+            item.variable = getVarId(Expression::cast<Id>((*ra)[i])->decl());
           } else if (Expression::isa<IntLit>((*ra)[i])) {
             assert(array.isInteger);
             item.value = static_cast<double>(IntLit::v(Expression::cast<IntLit>((*ra)[i])).toInt());
@@ -179,23 +192,31 @@ void NLFile::addVarDecl(const VarDecl* vd, const TypeInst* ti, const Expression*
       if (domain != nullptr) {
         isv = Expression::cast<SetLit>(domain)->isv();
       }
-      addVarDeclInteger(name, isv, toReport);
+      addVarDeclInteger(vd, name, isv, toReport);
     } else {
       // Floating point
       FloatSetVal* fsv = nullptr;
       if (domain != nullptr) {
         fsv = Expression::cast<SetLit>(domain)->fsv();
       }
-      addVarDeclFloat(name, fsv, toReport);
+      addVarDeclFloat(vd, name, fsv, toReport);
     }
   }
 }
 
-/** Add an integer variable declaration to the NL File. */
-void NLFile::addVarDeclInteger(const string& name, const IntSetVal* isv, bool toReport) {
+/** Add a variable, returning its id. */
+int NLFile::addVar(const VarDecl* vd, NLVar v) {
   // Check that we do not have naming conflict
-  assert(variables.find(name) == variables.end());
+  assert(_varIds.find(vd) == _varIds.end());
+  int id = static_cast<int>(variables.size());
+  variables.push_back(std::move(v));
+  _varIds[vd] = id;
+  return id;
+}
 
+/** Add an integer variable declaration to the NL File. */
+void NLFile::addVarDeclInteger(const VarDecl* vd, const string& name, const IntSetVal* isv,
+                               bool toReport) {
   // Check the domain.
   NLBound bound;
   if (isv == nullptr) {
@@ -208,14 +229,12 @@ void NLFile::addVarDeclInteger(const string& name, const IntSetVal* isv, bool to
     should_not_happen("Range: switch on mzn_opt_only_range_domains" << endl);
   }
   // Create the variable and update the NLFile
-  NLVar v = NLVar(name, true, toReport, bound);
-  variables[name] = v;
+  addVar(vd, NLVar(name, true, toReport, bound));
 }
 
 /** Add a floating point variable declaration to the NL File. */
-void NLFile::addVarDeclFloat(const string& name, const FloatSetVal* fsv, bool toReport) {
-  // Check that we do not have naming conflict
-  assert(variables.find(name) == variables.end());
+void NLFile::addVarDeclFloat(const VarDecl* vd, const string& name, const FloatSetVal* fsv,
+                             bool toReport) {
   // Check the domain.
   NLBound bound;
   if (fsv == nullptr) {
@@ -228,8 +247,7 @@ void NLFile::addVarDeclFloat(const string& name, const FloatSetVal* fsv, bool to
     should_not_happen("Range: switch on mzn_opt_only_range_domains" << std::endl);
   }
   // Create the variable and update the NLFile
-  NLVar v = NLVar(name, false, toReport, bound);
-  variables[name] = v;
+  addVar(vd, NLVar(name, false, toReport, bound));
 }
 
 // --- --- --- Constraints analysis
@@ -397,44 +415,38 @@ void NLFile::analyseConstraint(const Call* c) {
 // --- --- --- Helpers
 
 /** Create a token from an expression representing a variable */
-NLToken NLFile::getTokenFromVarOrInt(const Expression* e) {
+NLToken NLFile::getTokenFromVarOrInt(const Expression* e) const {
   if (Expression::type(e).isPar()) {
     // Constant
     double value = static_cast<double>(IntLit::v(Expression::cast<IntLit>(e)).toInt());
     return NLToken::n(value);
   }  // Variable
-  VarDecl* vd = Expression::cast<Id>(e)->decl();
-  string n = getVarName(vd);
-  return NLToken::v(n);
+  return NLToken::v(getVarId(Expression::cast<Id>(e)->decl()));
 }
 
 /** Create a token from an expression representing either a variable or a floating point numeric
  * value. */
-NLToken NLFile::getTokenFromVarOrFloat(const Expression* e) {
+NLToken NLFile::getTokenFromVarOrFloat(const Expression* e) const {
   if (Expression::type(e).isPar()) {
     // Constant
     double value = FloatLit::v(Expression::cast<FloatLit>(e)).toDouble();
     return NLToken::n(value);
   }  // Variable
-  VarDecl* vd = Expression::cast<Id>(e)->decl();
-  string n = getVarName(vd);
-  return NLToken::v(n);
+  return NLToken::v(getVarId(Expression::cast<Id>(e)->decl()));
 }
 
 /** Create a token from an expression representing either a variable. */
-NLToken NLFile::getTokenFromVar(const Expression* e) {
+NLToken NLFile::getTokenFromVar(const Expression* e) const {
   assert(!Expression::type(e).isPar());
   // Variable
-  VarDecl* vd = Expression::cast<Id>(e)->decl();
-  string n = getVarName(vd);
-  return NLToken::v(n);
+  return NLToken::v(getVarId(Expression::cast<Id>(e)->decl()));
 }
 
 /** Update an expression graph (only by appending token) with a linear combination
  *  of coefficients and variables. Count as "non linear" for the variables occuring here.
  */
 void NLFile::makeSigmaMult(vector<NLToken>& expressionGraph, const vector<double>& coeffs,
-                           const vector<string>& vars) {
+                           const vector<int>& vars) {
   assert(coeffs.size() == vars.size());
   assert(coeffs.size() >= 2);
 
@@ -462,7 +474,7 @@ void NLFile::makeSigmaMult(vector<NLToken>& expressionGraph, const vector<double
 // --- --- --- Linear Builders
 
 /** Create a linear constraint [coeffs] *+ [vars] = value. */
-void NLFile::linconsEq(const Call* c, const vector<double>& coeffs, const vector<string>& vars,
+void NLFile::linconsEq(const Call* c, const vector<double>& coeffs, const vector<int>& vars,
                        const NLToken& value) {
   // Create the Algebraic Constraint and set the data
   NLAlgCons cons;
@@ -487,17 +499,17 @@ void NLFile::linconsEq(const Call* c, const vector<double>& coeffs, const vector
     // Linear part: set the jacobian
     vector<double> coeffs_(coeffs);
     coeffs_.push_back(-1);
-    vector<string> vars_(vars);
-    vars_.push_back(value.str);
+    vector<int> vars_(vars);
+    vars_.push_back(value.var);
     cons.setJacobian(vars_, coeffs_, this);
   }
 
-  // Add the constraint in our mapping
-  constraints[cname] = cons;
+  // Add the constraint
+  constraints.push_back(std::move(cons));
 }
 
 /** Create a linear constraint [coeffs] *+ [vars] <= value. */
-void NLFile::linconsLe(const Call* c, const vector<double>& coeffs, const vector<string>& vars,
+void NLFile::linconsLe(const Call* c, const vector<double>& coeffs, const vector<int>& vars,
                        const NLToken& value) {
   // Create the Algebraic Constraint and set the data
   NLAlgCons cons;
@@ -522,13 +534,13 @@ void NLFile::linconsLe(const Call* c, const vector<double>& coeffs, const vector
     // Linear part: set the jacobian
     vector<double> coeffs_(coeffs);
     coeffs_.push_back(-1);
-    vector<string> vars_(vars);
-    vars_.push_back(value.str);
+    vector<int> vars_(vars);
+    vars_.push_back(value.var);
     cons.setJacobian(vars_, coeffs_, this);
   }
 
-  // Add the constraint in our mapping
-  constraints[cname] = cons;
+  // Add the constraint
+  constraints.push_back(std::move(cons));
 }
 
 /** Create a linear logical constraint [coeffs] *+ [vars] PREDICATE value.
@@ -537,7 +549,7 @@ void NLFile::linconsLe(const Call* c, const vector<double>& coeffs, const vector
  *              - Only use for conmparisons that cannot be expressed with '=' xor '<='.
  */
 void NLFile::linconsPredicate(const Call* c, NLToken::OpCode oc, const vector<double>& coeffs,
-                              const vector<string>& vars, const NLToken& value) {
+                              const vector<int>& vars, const NLToken& value) {
   // Create the Logical Constraint and set the data
   NLLogicalCons cons(static_cast<int>(logicalConstraints.size()));
 
@@ -556,7 +568,7 @@ void NLFile::linconsPredicate(const Call* c, NLToken::OpCode oc, const vector<do
   cons.expressionGraph.push_back(value);
 
   // Store the constraint
-  logicalConstraints.push_back(cons);
+  logicalConstraints.push_back(std::move(cons));
 }
 
 // --- --- --- Non Linear Builders
@@ -575,15 +587,15 @@ void NLFile::nlconsEq(const Call* c, const NLToken& x, const NLToken& y) {
     if (x.isConstant()) {
       // Update bound on y
       double value = x.numericValue;
-      NLVar& v = variables.at(y.str);
+      NLVar& v = variables[y.var];
       v.bound.updateEq(value);
     } else {
       // Update bound on x
       double value = y.numericValue;
-      NLVar& v = variables.at(x.str);
+      NLVar& v = variables[x.var];
       v.bound.updateEq(value);
     }
-  } else if (x.str != y.str) {  // both must be variables anyway.
+  } else if (x.var != y.var) {  // both must be variables anyway.
     assert(x.isVariable() && y.isVariable());
     // Create the Algebraic Constraint and set the data
     NLAlgCons cons;
@@ -598,11 +610,11 @@ void NLFile::nlconsEq(const Call* c, const NLToken& x, const NLToken& y) {
 
     // Create the jacobian
     vector<double> coeffs = {1, -1};
-    vector<string> vars = {x.str, y.str};
+    vector<int> vars = {x.var, y.var};
     cons.setJacobian(vars, coeffs, this);
 
     // Store the constraint
-    constraints[cname] = cons;
+    constraints.push_back(std::move(cons));
   }
 }
 
@@ -615,15 +627,15 @@ void NLFile::nlconsLe(const Call* c, const NLToken& x, const NLToken& y) {
     if (x.isConstant()) {
       // Update lower bound on y
       double value = x.numericValue;
-      NLVar& v = variables.at(y.str);
+      NLVar& v = variables[y.var];
       v.bound.updateLB(value);
     } else {
       // Update upper bound on x
       double value = y.numericValue;
-      NLVar& v = variables.at(x.str);
+      NLVar& v = variables[x.var];
       v.bound.updateUB(value);
     }
-  } else if (x.str != y.str) {  // both must be variables anyway.
+  } else if (x.var != y.var) {  // both must be variables anyway.
     assert(x.isVariable() && y.isVariable());
 
     // Create the Algebraic Constraint and set the data
@@ -639,11 +651,11 @@ void NLFile::nlconsLe(const Call* c, const NLToken& x, const NLToken& y) {
 
     // Create the jacobian
     vector<double> coeffs = {1, -1};
-    vector<string> vars = {x.str, y.str};
+    vector<int> vars = {x.var, y.var};
     cons.setJacobian(vars, coeffs, this);
 
     // Store the constraint
-    constraints[cname] = cons;
+    constraints.push_back(std::move(cons));
   }
 }
 
@@ -667,7 +679,7 @@ void NLFile::nlconsPredicate(const Call* c, NLToken::OpCode oc, const NLToken& x
   cons.expressionGraph.push_back(y);
 
   // Store the constraint
-  logicalConstraints.push_back(cons);
+  logicalConstraints.push_back(std::move(cons));
 }
 
 /** Create a non linear constraint with a binary operator: x OPERATOR y = z */
@@ -692,24 +704,24 @@ void NLFile::nlconsOperatorBinary(const Call* c, NLToken::OpCode oc, const NLTok
     cons.range = bound;
 
     vector<double> coeffs = {};
-    vector<string> vars = {};
+    vector<int> vars = {};
 
     // If x is a variable different from y (and must be different from z), give it 0 for the linear
     // part
-    if (x.isVariable() && x.str != y.str) {
-      assert(x.str != z.str);
+    if (x.isVariable() && x.var != y.var) {
+      assert(x.var != z.var);
       coeffs.push_back(0);
-      vars.push_back(x.str);
+      vars.push_back(x.var);
     }
     // Same as above for y.
     if (y.isVariable()) {
-      assert(y.str != z.str);
+      assert(y.var != z.var);
       coeffs.push_back(0);
-      vars.push_back(y.str);
+      vars.push_back(y.var);
     }
     // z is a variable whose value is substracted from the result
     coeffs.push_back(-1);
-    vars.push_back(z.str);
+    vars.push_back(z.var);
 
     // Finish jacobian
     cons.setJacobian(vars, coeffs, this);
@@ -721,7 +733,7 @@ void NLFile::nlconsOperatorBinary(const Call* c, NLToken::OpCode oc, const NLTok
   cons.expressionGraph.push_back(y);
 
   // Store the constraint
-  constraints[cname] = cons;
+  constraints.push_back(std::move(cons));
 }
 
 /** Create a non linear constraint with a binary operator: x OPERATOR y = z.
@@ -748,24 +760,24 @@ void NLFile::nlconsOperatorBinary(const Call* c, NLToken::MOpCode moc, const NLT
     cons.range = bound;
 
     vector<double> coeffs = {};
-    vector<string> vars = {};
+    vector<int> vars = {};
 
     // If x is a variable different from y (and must be different from z), give it 0 for the linear
     // part
-    if (x.isVariable() && x.str != y.str) {
-      assert(x.str != z.str);
+    if (x.isVariable() && x.var != y.var) {
+      assert(x.var != z.var);
       coeffs.push_back(0);
-      vars.push_back(x.str);
+      vars.push_back(x.var);
     }
     // Same as above for y.
     if (y.isVariable()) {
-      assert(y.str != z.str);
+      assert(y.var != z.var);
       coeffs.push_back(0);
-      vars.push_back(y.str);
+      vars.push_back(y.var);
     }
     // z is a variable whose value is substracted from the result
     coeffs.push_back(-1);
-    vars.push_back(z.str);
+    vars.push_back(z.var);
 
     // Finish jacobian
     cons.setJacobian(vars, coeffs, this);
@@ -777,7 +789,7 @@ void NLFile::nlconsOperatorBinary(const Call* c, NLToken::MOpCode moc, const NLT
   cons.expressionGraph.push_back(y);
 
   // Store the constraint
-  constraints[cname] = cons;
+  constraints.push_back(std::move(cons));
 }
 
 /** Create a non linear constraint with an unary operator: OPERATOR x = y */
@@ -802,18 +814,18 @@ void NLFile::nlconsOperatorUnary(const Call* c, NLToken::OpCode oc, const NLToke
     cons.range = bound;
 
     vector<double> coeffs = {};
-    vector<string> vars = {};
+    vector<int> vars = {};
 
     // If x is a variable (must be different from y), give it '0' for the linear part
     if (x.isVariable()) {
-      assert(x.str != y.str);
+      assert(x.var != y.var);
       coeffs.push_back(0);
-      vars.push_back(x.str);
+      vars.push_back(x.var);
     }
 
     // z is a variable whose value is substracted from the result
     coeffs.push_back(-1);
-    vars.push_back(y.str);
+    vars.push_back(y.var);
 
     // Finish jacobian
     cons.setJacobian(vars, coeffs, this);
@@ -824,7 +836,7 @@ void NLFile::nlconsOperatorUnary(const Call* c, NLToken::OpCode oc, const NLToke
   cons.expressionGraph.push_back(x);
 
   // Store the constraint
-  constraints[cname] = cons;
+  constraints.push_back(std::move(cons));
 }
 
 /** Create a non linear constraint, specialized for log2 unary operator: Log2(x) = y */
@@ -848,17 +860,17 @@ void NLFile::nlconsOperatorUnaryLog2(const Call* c, const NLToken& x, const NLTo
     cons.range = bound;
 
     vector<double> coeffs = {};
-    vector<string> vars = {};
+    vector<int> vars = {};
 
     // If x is a variable (must be different from y), give it '0' for the linear part
     if (x.isVariable()) {
-      assert(x.str != y.str);
+      assert(x.var != y.var);
       coeffs.push_back(0);
-      vars.push_back(x.str);
+      vars.push_back(x.var);
     }
     // z is a variable whose value is substracted from the result
     coeffs.push_back(-1);
-    vars.push_back(y.str);
+    vars.push_back(y.var);
 
     // Finish jacobian
     cons.setJacobian(vars, coeffs, this);
@@ -872,7 +884,7 @@ void NLFile::nlconsOperatorUnaryLog2(const Call* c, const NLToken& x, const NLTo
   cons.expressionGraph.push_back(NLToken::n(2));
 
   // Store the constraint
-  constraints[cname] = cons;
+  constraints.push_back(std::move(cons));
 }
 
 // --- --- --- Integer Linear Constraints
@@ -882,7 +894,7 @@ void NLFile::nlconsOperatorUnaryLog2(const Call* c, const NLToken& x, const NLTo
 void NLFile::consint_lin_eq(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecInt(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrInt(c->arg(2));
   // Create the constraint
   linconsEq(c, coeffs, vars, value);
@@ -893,7 +905,7 @@ void NLFile::consint_lin_eq(const Call* c) {
 void NLFile::consint_lin_le(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecInt(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrInt(c->arg(2));
   // Create the constraint
   linconsLe(c, coeffs, vars, value);
@@ -904,7 +916,7 @@ void NLFile::consint_lin_le(const Call* c) {
 void NLFile::consint_lin_ne(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecInt(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrInt(c->arg(2));
   // Create the constraint
   linconsPredicate(c, NLToken::OpCode::NE, coeffs, vars, value);
@@ -998,7 +1010,7 @@ void NLFile::int_abs(const Call* c) {
 void NLFile::consfp_lin_eq(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecFloat(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrFloat(c->arg(2));
   // Create the constraint
   linconsEq(c, coeffs, vars, value);
@@ -1009,7 +1021,7 @@ void NLFile::consfp_lin_eq(const Call* c) {
 void NLFile::consfp_lin_le(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecFloat(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrFloat(c->arg(2));
   // Create the constraint
   linconsLe(c, coeffs, vars, value);
@@ -1020,7 +1032,7 @@ void NLFile::consfp_lin_le(const Call* c) {
 void NLFile::consfp_lin_ne(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecFloat(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrFloat(c->arg(2));
   // Create the constraint
   linconsPredicate(c, NLToken::OpCode::NE, coeffs, vars, value);
@@ -1031,7 +1043,7 @@ void NLFile::consfp_lin_ne(const Call* c) {
 void NLFile::consfp_lin_lt(const Call* c) {
   // Get the arguments arg0 (array0 = coeffs), arg1 (array = variables) and arg2 (value)
   vector<double> coeffs = fromVecFloat(getArrayLit(c->arg(0)));
-  vector<string> vars = fromVecId(getArrayLit(c->arg(1)));
+  vector<int> vars = fromVecId(getArrayLit(c->arg(1)));
   NLToken value = getTokenFromVarOrFloat(c->arg(2));
   // Create the constraint
   linconsPredicate(c, NLToken::OpCode::LT, coeffs, vars, value);
@@ -1257,9 +1269,9 @@ void NLFile::float_tanh(const Call* c) {
  */
 void NLFile::int2float(const Call* c) {
   vector<double> coeffs = {1, -1};
-  vector<string> vars = {};
-  vars.push_back(getTokenFromVar(c->arg(0)).str);
-  vars.push_back(getTokenFromVar(c->arg(1)).str);
+  vector<int> vars = {};
+  vars.push_back(getTokenFromVar(c->arg(0)).var);
+  vars.push_back(getTokenFromVar(c->arg(1)).var);
   // Create the constraint
   linconsEq(c, coeffs, vars, NLToken::n(0));
 }
@@ -1280,20 +1292,20 @@ void NLFile::addSolve(SolveI::SolveType st, const Expression* e) {
     case SolveI::SolveType::ST_MIN: {
       // Maximize an objective represented by a variable
       objective.minmax = objective.MINIMIZE;
-      string v = getTokenFromVar(e).str;
+      int v = getTokenFromVar(e).var;
       // Use the gradient
       vector<double> coeffs = {1};
-      vector<string> vars = {v};
+      vector<int> vars = {v};
       objective.setGradient(vars, coeffs);
       break;
     }
     case SolveI::SolveType::ST_MAX: {
       // Maximize an objective represented by a variable
       objective.minmax = objective.MAXIMIZE;
-      string v = getTokenFromVar(e).str;
+      int v = getTokenFromVar(e).var;
       // Use the gradient
       vector<double> coeffs = {1};
-      vector<string> vars = {v};
+      vector<int> vars = {v};
       objective.setGradient(vars, coeffs);
       break;
     }
@@ -1307,10 +1319,10 @@ void NLFile::addSolve(SolveI::SolveType st, const Expression* e) {
 
 void NLFile::phase2() {
   // --- --- --- Go over all constraint (algebraic AND logical) and mark non linear variables
-  for (auto const& n_c : constraints) {
-    for (auto const& tok : n_c.second.expressionGraph) {
+  for (auto const& c : constraints) {
+    for (auto const& tok : c.expressionGraph) {
       if (tok.isVariable()) {
-        variables.at(tok.str).isInNLConstraint = true;
+        variables[tok.var].isInNLConstraint = true;
       }
     }
   }
@@ -1318,7 +1330,7 @@ void NLFile::phase2() {
   for (auto const& c : logicalConstraints) {
     for (auto const& tok : c.expressionGraph) {
       if (tok.isVariable()) {
-        variables.at(tok.str).isInNLConstraint = true;
+        variables[tok.var].isInNLConstraint = true;
       }
     }
   }
@@ -1326,13 +1338,14 @@ void NLFile::phase2() {
   // --- --- --- Go over the objective and mark non linear variables
   for (auto const& tok : objective.expressionGraph) {
     if (tok.isVariable()) {
-      variables.at(tok.str).isInNLObjective = true;
+      variables[tok.var].isInNLObjective = true;
     }
   }
 
   // --- --- --- Variables ordering and indexing
-  for (auto const& name_var : variables) {
-    const NLVar& v = name_var.second;
+  for (size_t i = 0; i < variables.size(); ++i) {
+    const auto id = static_cast<int>(i);
+    const NLVar& v = variables[id];
 
     // Accumulate jacobian count
     _jacobianCount += v.jacobianCount;
@@ -1340,33 +1353,33 @@ void NLFile::phase2() {
     // First check non linear variables in BOTH objective and constraint.
     if (v.isInNLObjective && v.isInNLConstraint) {
       if (v.isInteger) {
-        vname_nliv_both.push_back(v.name);
+        vid_nliv_both.push_back(id);
       } else {
-        vname_nlcv_both.push_back(v.name);
+        vid_nlcv_both.push_back(id);
       }
     }
     // Variables in non linear constraint ONLY
     else if (!v.isInNLObjective && v.isInNLConstraint) {
       if (v.isInteger) {
-        vname_nliv_cons.push_back(v.name);
+        vid_nliv_cons.push_back(id);
       } else {
-        vname_nlcv_cons.push_back(v.name);
+        vid_nlcv_cons.push_back(id);
       }
     }
     // Variables in non linear objective ONLY
     else if (v.isInNLObjective && !v.isInNLConstraint) {
       if (v.isInteger) {
-        vname_nliv_obj.push_back(v.name);
+        vid_nliv_obj.push_back(id);
       } else {
-        vname_nlcv_obj.push_back(v.name);
+        vid_nlcv_obj.push_back(id);
       }
     }
     // Variables not appearing nonlinearly
     else if (!v.isInNLObjective && !v.isInNLConstraint) {
       if (v.isInteger) {
-        vname_liv_all.push_back(v.name);
+        vid_liv_all.push_back(id);
       } else {
-        vname_lcv_all.push_back(v.name);
+        vid_lcv_all.push_back(id);
       }
     }
     // Should not happen
@@ -1375,38 +1388,39 @@ void NLFile::phase2() {
     }
   }
 
-  // Note:  In the above, we dealt with all 'vname_*' vectors BUT 'vname_larc_all' and
-  // 'vname_bv_all'
+  // Note:  In the above, we dealt with all 'vid_*' vectors BUT 'vid_larc_all' and
+  // 'vid_bv_all'
   //        networks and boolean are not implemented. Nevertheless, we keep the vectors and deal
   //        with them below to ease further implementations.
 
-  vnames.reserve(variables.size());
-
-  vnames.insert(vnames.end(), vname_nlcv_both.begin(), vname_nlcv_both.end());
-  vnames.insert(vnames.end(), vname_nliv_both.begin(), vname_nliv_both.end());
-  vnames.insert(vnames.end(), vname_nlcv_cons.begin(), vname_nlcv_cons.end());
-  vnames.insert(vnames.end(), vname_nliv_cons.begin(), vname_nliv_cons.end());
-  vnames.insert(vnames.end(), vname_nlcv_obj.begin(), vname_nlcv_obj.end());
-  vnames.insert(vnames.end(), vname_nliv_obj.begin(), vname_nliv_obj.end());
-  vnames.insert(vnames.end(), vname_larc_all.begin(), vname_larc_all.end());
-  vnames.insert(vnames.end(), vname_lcv_all.begin(), vname_lcv_all.end());
-  vnames.insert(vnames.end(), vname_bv_all.begin(), vname_bv_all.end());
-  vnames.insert(vnames.end(), vname_liv_all.begin(), vname_liv_all.end());
-
-  // Create the mapping name->index
-  for (int i = 0; i < vnames.size(); ++i) {
-    variableIndexes[vnames[i]] = i;
+  vids.reserve(variables.size());
+
+  vids.insert(vids.end(), vid_nlcv_both.begin(), vid_nlcv_both.end());
+  vids.insert(vids.end(), vid_nliv_both.begin(), vid_nliv_both.end());
+  vids.insert(vids.end(), vid_nlcv_cons.begin(), vid_nlcv_cons.end());
+  vids.insert(vids.end(), vid_nliv_cons.begin(), vid_nliv_cons.end());
+  vids.insert(vids.end(), vid_nlcv_obj.begin(), vid_nlcv_obj.end());
+  vids.insert(vids.end(), vid_nliv_obj.begin(), vid_nliv_obj.end());
+  vids.insert(vids.end(), vid_larc_all.begin(), vid_larc_all.end());
+  vids.insert(vids.end(), vid_lcv_all.begin(), vid_lcv_all.end());
+  vids.insert(vids.end(), vid_bv_all.begin(), vid_bv_all.end());
+  vids.insert(vids.end(), vid_liv_all.begin(), vid_liv_all.end());
+
+  // Create the mapping id->index
+  for (size_t i = 0; i < vids.size(); ++i) {
+    variables[vids[i]].index = static_cast<int>(i);
   }
 
   // --- --- --- Constraint ordering, couting, and indexing
-  for (auto const& name_cons : constraints) {
-    const NLAlgCons& c = name_cons.second;
+  for (size_t i = 0; i < constraints.size(); ++i) {
+    const auto id = static_cast<int>(i);
+    const NLAlgCons& c = constraints[id];
 
     // Sort by linearity. We do not have network constraint.
     if (c.isLinear()) {
-      cnames_lin_general.push_back(c.name);
+      cids_lin_general.push_back(id);
     } else {
-      cnames_nl_general.push_back(c.name);
+      cids_nl_general.push_back(id);
     }
 
     // Count the number of ranges and eqns constraints
@@ -1423,15 +1437,15 @@ void NLFile::phase2() {
     }
   }
 
-  cnames.reserve(constraints.size());
-  cnames.insert(cnames.end(), cnames_nl_general.begin(), cnames_nl_general.end());
-  cnames.insert(cnames.end(), cnames_nl_network.begin(), cnames_nl_network.end());
-  cnames.insert(cnames.end(), cnames_lin_network.begin(), cnames_lin_network.end());
-  cnames.insert(cnames.end(), cnames_lin_general.begin(), cnames_lin_general.end());
+  cids.reserve(constraints.size());
+  cids.insert(cids.end(), cids_nl_general.begin(), cids_nl_general.end());
+  cids.insert(cids.end(), cids_nl_network.begin(), cids_nl_network.end());
+  cids.insert(cids.end(), cids_lin_network.begin(), cids_lin_network.end());
+  cids.insert(cids.end(), cids_lin_general.begin(), cids_lin_general.end());
 
-  // Create the mapping name->index
-  for (int i = 0; i < cnames.size(); ++i) {
-    constraintIndexes[cnames[i]] = i;
+  // Create the mapping id->index
+  for (size_t i = 0; i < cids.size(); ++i) {
+    constraints[cids[i]].index = static_cast<int>(i);
   }
 }
 
@@ -1454,95 +1468,158 @@ unsigned int NLFile::varCount() const { return variables.size(); }
 /** Number of variables appearing nonlinearly in constraints. */
 unsigned int NLFile::lvcCount() const {
   // Variables in both + variables in constraint only (integer+continuous)
-  return lvbCount() + vname_nliv_cons.size() + vname_nlcv_cons.size();
+  return lvbCount() + vid_nliv_cons.size() + vid_nlcv_cons.size();
 }
 
 /** Number of variables appearing nonlinearly in objectives. */
 unsigned int NLFile::lvoCount() const {
   // Variables in both + variables in objective only (integer+continuous)
-  return lvbCount() + vname_nliv_obj.size() + vname_nlcv_obj.size();
+  return lvbCount() + vid_nliv_obj.size() + vid_nlcv_obj.size();
 }
 
 /** Number of variables appearing nonlinearly in both constraints and objectives.*/
-unsigned int NLFile::lvbCount() const { return vname_nlcv_both.size() + vname_nliv_both.size(); }
+unsigned int NLFile::lvbCount() const { return vid_nlcv_both.size() + vid_nliv_both.size(); }
 
 /** Number of integer variables appearing nonlinearly in both constraints and objectives.*/
-unsigned int NLFile::lvbiCount() const { return vname_nliv_both.size(); }
+unsigned int NLFile::lvbiCount() const { return vid_nliv_both.size(); }
 
 /** Number of integer variables appearing nonlinearly in constraints **only**.*/
-unsigned int NLFile::lvciCount() const { return vname_nliv_cons.size(); }
+unsigned int NLFile::lvciCount() const { return vid_nliv_cons.size(); }
 
 /** Number of integer variables appearing nonlinearly in objectives **only**.*/
-unsigned int NLFile::lvoiCount() const { return vname_nliv_obj.size(); }
+unsigned int NLFile::lvoiCount() const { return vid_nliv_obj.size(); }
 
 /** Number of linear arcs. Network nor implemented, so always 0.*/
-unsigned int NLFile::wvCount() const { return vname_larc_all.size(); }
+unsigned int NLFile::wvCount() const { return vid_larc_all.size(); }
 
 /** Number of "other" integer variables.*/
-unsigned int NLFile::ivCount() const { return vname_liv_all.size(); }
+unsigned int NLFile::ivCount() const { return vid_liv_all.size(); }
 
 /** Number of binary variables.*/
-unsigned int NLFile::bvCount() const { return vname_bv_all.size(); }
+unsigned int NLFile::bvCount() const { return vid_bv_all.size(); }
 
 /** *** *** *** Printable *** *** *** **/
+
+namespace {
+
+/** Print the items [0, n) of a segment list with \a printItem. Large lists are split into
+ *  chunks that are formatted into separate buffers by several threads, and then written in order.
+ */
+template <class PrintItem>
+void print_segments(ostream& os, bool binary, size_t n, unsigned int nThreads,
+                    const PrintItem& printItem) {
+  // Minimum number of items per chunk, so that small models do not pay for threads
+  const size_t minChunk = 4096;
+  size_t nChunks = std::min<size_t>(nThreads, n / minChunk);
+  if (nChunks <= 1) {
+    NLOutput out(os, binary);
+    for (size_t i = 0; i < n; ++i) {
+      printItem(out, i);
+    }
+    return;
+  }
+  std::vector<std::ostringstream> buffers(nChunks);
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(nChunks);
+  size_t chunkSize = (n + nChunks - 1) / nChunks;
+  for (size_t c = 0; c < nChunks; ++c) {
+    // Use the same formatting (precision, hexfloat) as the target stream
+    buffers[c].copyfmt(os);
+    threads.emplace_back([&, c]() {
+      try {
+        NLOutput out(buffers[c], binary);
+        size_t end = std::min(n, (c + 1) * chunkSize);
+        for (size_t i = c * chunkSize; i < end; ++i) {
+          printItem(out, i);
+        }
+      } catch (...) {
+        errors[c] = std::current_exception();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (size_t c = 0; c < nChunks; ++c) {
+    if (errors[c]) {
+      std::rethrow_exception(errors[c]);
+    }
+    std::string chunk = buffers[c].str();
+    os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+  }
+}
+
+}  // namespace
+
 // Note:  * empty line not allowed
 //        * comment only not allowed
-ostream& NLFile::printToStream(ostream& os) const {
-  // Print the header
-  {
-    NLHeader header;
-    NLHeader::printToStream(os, *this);
+ostream& NLFile::printToStream(ostream& os, bool binary, unsigned int nThreads) const {
+  if (nThreads == 0) {
+    nThreads = std::max(1U, std::thread::hardware_concurrency());
   }
-  os << endl;
+
+  // Print the header
+  NLHeader::printToStream(os, *this, binary);
+  os << '\n';
+
+  NLOutput out(os, binary);
 
   // Print the unique segments about the variables
   if (varCount() > 1) {
     // Print the 'k' segment Maybe to adjust with the presence of 'J' segments
-    os << "k" << (varCount() - 1)
-       << "   # Cumulative Sum of non-zero in the jacobian matrix's (nbvar-1) columns." << endl;
+    out.key('k').integer(varCount() - 1);
+    out.eol("Cumulative Sum of non-zero in the jacobian matrix's (nbvar-1) columns.");
     unsigned int acc = 0;
     // Note stop before the last var. Total jacobian count is in the header.
     for (int i = 0; i < varCount() - 1; ++i) {
-      string name = vnames[i];
-      acc += variables.at(name).jacobianCount;
-      os << acc << "   # " << name << endl;
+      const NLVar& v = variables[vids[i]];
+      acc += v.jacobianCount;
+      out.integer(static_cast<int>(acc)).eol(v.name);
     }
 
     // Print the 'b' segment
-    os << "b   # Bounds on variables (" << varCount() << ")" << endl;
-    for (const auto& n : vnames) {
-      NLVar v = variables.at(n);
-      v.bound.printToStream(os, n);
-      os << endl;
+    out.key('b');
+    if (binary) {
+      out.eol();
+    } else {
+      out.eol("Bounds on variables (" + std::to_string(varCount()) + ")");
+    }
+    for (int vid : vids) {
+      const NLVar& v = variables[vid];
+      v.bound.print(out, v.name);
+      out.eol();
     }
   }
 
   // Print the unique segments about the constraints
-  if (!cnames.empty()) {
+  if (!cids.empty()) {
     // Create the 'r' range segment per constraint
     // For now, it is NOT clear if the network constraint should appear in the range constraint or
     // not. To be determine if later implemented.
-    os << "r   # Bounds on algebraic constraint bodies (" << cnames.size() << ")" << endl;
-    for (const auto& n : cnames) {
-      NLAlgCons c = constraints.at(n);
-      c.range.printToStream(os, n);
-      os << endl;
+    out.key('r');
+    if (binary) {
+      out.eol();
+    } else {
+      out.eol("Bounds on algebraic constraint bodies (" + std::to_string(cids.size()) + ")");
+    }
+    for (int cid : cids) {
+      const NLAlgCons& c = constraints[cid];
+      c.range.print(out, c.name);
+      out.eol();
     }
   }
 
   // Print the Algebraic Constraints
-  for (const auto& n : cnames) {
-    NLAlgCons c = constraints.at(n);
-    c.printToStream(os, *this);
-  }
+  print_segments(os, binary, cids.size(), nThreads, [this](NLOutput& o, size_t i) {
+    constraints[cids[i]].print(o, *this);
+  });
 
   // Print the Logical constraint
-  for (const auto& lc : logicalConstraints) {
-    lc.printToStream(os, *this);
-  }
+  print_segments(os, binary, logicalConstraints.size(), nThreads,
+                 [this](NLOutput& o, size_t i) { logicalConstraints[i].print(o, *this); });
 
   // Print the objective
-  objective.printToStream(os, *this);
+  objective.print(out, *this);
   return os;
 }
 
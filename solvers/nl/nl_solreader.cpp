@@ -6,14 +6,117 @@
 
 #include <minizinc/solvers/nl/nl_solreader.hh>
 
+#include <algorithm>
+#include <cstdint>
+
 using namespace std;
 
 namespace MiniZinc {
 
 // *** *** *** NLSol *** *** ***
 
-// Parse a string into a NLSol object
-NLSol NLSol::parseSolution(istream& in) {
+namespace {
+
+/** Status corresponding to a solver result code. */
+NL_Solver_Status status_from_code(int resultCode) {
+  // Not this case, this one is our own: case -2: st = NL_Solver_Status::PARSE_ERROR;
+  if (resultCode >= 0 && resultCode < 100) {
+    return NL_Solver_Status::SOLVED;
+  }
+  if (resultCode >= 100 && resultCode < 200) {
+    return NL_Solver_Status::UNCERTAIN;
+  }
+  if (resultCode >= 200 && resultCode < 300) {
+    return NL_Solver_Status::INFEASIBLE;
+  }
+  if (resultCode >= 300 && resultCode < 400) {
+    return NL_Solver_Status::UNBOUNDED;
+  }
+  if (resultCode >= 400 && resultCode < 500) {
+    return NL_Solver_Status::LIMIT;
+  }
+  if (resultCode >= 500 && resultCode < 600) {
+    return NL_Solver_Status::FAILURE;
+  }
+  if (resultCode == 600) {
+    return NL_Solver_Status::INTERRUPTED;
+  }
+  return NL_Solver_Status::UNKNOWN;
+}
+
+/** Read a line, removing a trailing carriage return. */
+bool get_line(istream& in, string& buffer) {
+  if (!getline(in, buffer)) {
+    return false;
+  }
+  if (!buffer.empty() && buffer.back() == '\r') {
+    buffer.pop_back();
+  }
+  return true;
+}
+
+/** Read a 4 bytes integer from a binary .sol file. */
+bool read_int(istream& in, std::int32_t& i) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&i), sizeof(i)));
+}
+
+/** Read the header of a record of a binary .sol file (its length in bytes). */
+bool record_begin(istream& in, std::int32_t& length) { return read_int(in, length) && length >= 0; }
+
+/** Read the footer of a record of a binary .sol file, which repeats its length. */
+bool record_end(istream& in, std::int32_t length) {
+  std::int32_t check;
+  return read_int(in, check) && check == length;
+}
+
+/** Read a whole record of a binary .sol file. */
+bool read_record(istream& in, string& record) {
+  std::int32_t length;
+  if (!record_begin(in, length)) {
+    return false;
+  }
+  record.resize(length);
+  if (length > 0 && !in.read(&record[0], length)) {
+    return false;
+  }
+  return record_end(in, length);
+}
+
+/** Read a record of \a n doubles of a binary .sol file into \a values. */
+bool read_doubles(istream& in, std::int32_t n, double* values) {
+  std::int32_t length;
+  if (!record_begin(in, length) || length != n * static_cast<std::int32_t>(sizeof(double))) {
+    return false;
+  }
+  return in.read(reinterpret_cast<char*>(values), length) && record_end(in, length);
+}
+
+/** Literal for the value of a variable in a solution. */
+Expression* solution_value(bool isInteger, double value) {
+  if (isInteger) {
+    return IntLit::a(static_cast<long long int>(value));
+  }
+  return FloatLit::a(value);
+}
+
+}  // namespace
+
+// Parse a .sol file into a NLSol object
+NLSol NLSol::parseSolution(istream& in, size_t nbVars) {
+  // A binary file starts with a record: its length, the message, and the length again. A text file
+  // starts with a message made of printable characters, which can never look like this.
+  bool binary = false;
+  std::int32_t length;
+  if (record_begin(in, length) && in.seekg(length, ios::cur)) {
+    std::int32_t check;
+    binary = read_int(in, check) && check == length;
+  }
+  in.clear();
+  in.seekg(0, ios::beg);
+  return binary ? parseBinary(in, nbVars) : parseText(in, nbVars);
+}
+
+NLSol NLSol::parseText(istream& in, size_t nbVars) {
   string buffer;
   string msg;
   vector<double> vec;
@@ -21,7 +124,7 @@ NLSol NLSol::parseSolution(istream& in) {
 
   try {
     // Read the message
-    while (getline(in, buffer) && !buffer.empty()) {
+    while (get_line(in, buffer) && !buffer.empty()) {
       msg += buffer + '\n';
     }
 
@@ -30,83 +133,64 @@ NLSol NLSol::parseSolution(istream& in) {
     }
 
     // Check if we have 'Options', and skip them
-    if (getline(in, buffer)) {
-      if (buffer == "Options") {
-        if (getline(in, buffer)) {
-          int nb_options = stoi(buffer);
-          while (nb_options > 0) {
-            getline(in, buffer);
-            nb_options--;
-          }
-        }
+    if (in.peek() == 'O') {
+      get_line(in, buffer);
+      if (buffer != "Options") {
+        return NLSol("Error reading the solver Options", NL_Solver_Status::PARSE_ERROR, {});
+      }
+      int nb_options;
+      in >> nb_options;
+      vector<int> options(nb_options);
+      for (int i = 0; i < nb_options; ++i) {
+        in >> options[i];
+      }
+      // When the second option is 3, the options are followed by a tolerance
+      if (nb_options >= 2 && options[1] == 3) {
+        double vbtol;
+        in >> vbtol;
+      }
+      if (!in) {
+        return NLSol("Error reading the solver Options", NL_Solver_Status::PARSE_ERROR, {});
       }
     }
 
-    if (in.bad()) {
-      return NLSol("Error reading the solver Options", NL_Solver_Status::PARSE_ERROR, {});
-    }
-
-    // Check the dual: we ignore the first, read the second. If non zero, some lines are to be
-    // skipped
-    (getline(in, buffer) && getline(in, buffer));
-    if (in.bad()) {
+    // Number of constraints and of duals, number of variables and of primals
+    int nb_cons;
+    int nb_duals;
+    int nb_vars;
+    int nb_primals;
+    if (!(in >> nb_cons >> nb_duals)) {
       return NLSol("Error reading the number of dual", NL_Solver_Status::PARSE_ERROR, {});
     }
-    int nb_duals = stoi(buffer);
-
-    // Check the primal: we ignore the first, read the second
-    getline(in, buffer) && getline(in, buffer);
-    if (in.bad()) {
+    if (!(in >> nb_vars >> nb_primals)) {
       return NLSol("Error reading the number of primal", NL_Solver_Status::PARSE_ERROR, {});
     }
-    int nb_vars = stoi(buffer);
 
     // Skip the duals
-    while (nb_duals > 0 && getline(in, buffer)) {
-      nb_duals--;
+    double d;
+    for (int i = 0; i < nb_duals && (in >> d); ++i) {
     }
-
-    if (in.bad()) {
+    if (!in) {
       return NLSol("Error reading the dual values", NL_Solver_Status::PARSE_ERROR, {});
     }
 
     // Read the vars
-    while (nb_vars > 0 && getline(in, buffer)) {
-      double d = stod(buffer);
+    vec.reserve(std::max(nbVars, static_cast<size_t>(nb_primals)));
+    for (int i = 0; i < nb_primals && (in >> d); ++i) {
       vec.push_back(d);
-      nb_vars--;
     }
-
-    if (in.bad()) {
+    if (!in) {
       return NLSol("Error reading the primal values", NL_Solver_Status::PARSE_ERROR, {});
     }
 
     // Reading status code
     // objno 0 EXIT
-    // ........
-    // 8 char
-    getline(in, buffer);
-    string sub = buffer.substr(8, buffer.length() - 8);
-    int resultCode = stoi(sub);
-    st = NL_Solver_Status::UNKNOWN;
-    // Not this case, this one is our own: case -2: st = NL_Solver_Status::PARSE_ERROR;
-    if (resultCode == -1) {
-      st = NL_Solver_Status::UNKNOWN;
-    } else if (resultCode >= 0 && resultCode < 100) {
-      st = NL_Solver_Status::SOLVED;
-    } else if (resultCode >= 100 && resultCode < 200) {
-      st = NL_Solver_Status::UNCERTAIN;
-    } else if (resultCode >= 200 && resultCode < 300) {
-      st = NL_Solver_Status::INFEASIBLE;
-    } else if (resultCode >= 300 && resultCode < 400) {
-      st = NL_Solver_Status::UNBOUNDED;
-    } else if (resultCode >= 400 && resultCode < 500) {
-      st = NL_Solver_Status::LIMIT;
-    } else if (resultCode >= 500 && resultCode < 600) {
-      st = NL_Solver_Status::FAILURE;
-    } else if (resultCode == 600) {
-      st = NL_Solver_Status::INTERRUPTED;
+    int objno;
+    int resultCode;
+    if (!(in >> buffer >> objno >> resultCode) || buffer != "objno") {
+      return NLSol("Error reading the result code", NL_Solver_Status::PARSE_ERROR, vec);
     }
+    st = status_from_code(resultCode);
 
   } catch (...) {
     return NLSol("Parsing error (probably a bad number)", NL_Solver_Status::PARSE_ERROR, vec);
@@ -115,6 +199,60 @@ NLSol NLSol::parseSolution(istream& in) {
   return NLSol(msg, st, vec);
 }
 
+NLSol NLSol::parseBinary(istream& in, size_t nbVars) {
+  string msg;
+  string record;
+  vector<double> vec;
+
+  // Read the message
+  if (!read_record(in, msg)) {
+    return NLSol("Error reading the solver message", NL_Solver_Status::PARSE_ERROR, {});
+  }
+
+  // Check if we have 'Options', and skip them
+  if (!read_record(in, record)) {
+    return NLSol("Error reading the number of primal", NL_Solver_Status::PARSE_ERROR, {});
+  }
+  if (record == "Options") {
+    if (!read_record(in, record) || !read_record(in, record)) {
+      return NLSol("Error reading the solver Options", NL_Solver_Status::PARSE_ERROR, {});
+    }
+  }
+
+  // Number of constraints and of duals, number of variables and of primals
+  std::int32_t counts[4];
+  if (record.size() != sizeof(counts)) {
+    return NLSol("Error reading the number of primal", NL_Solver_Status::PARSE_ERROR, {});
+  }
+  std::memcpy(counts, record.data(), sizeof(counts));
+  std::int32_t nb_duals = counts[1];
+  std::int32_t nb_primals = counts[3];
+
+  // Skip the duals
+  if (nb_duals > 0 && !read_record(in, record)) {
+    return NLSol("Error reading the dual values", NL_Solver_Status::PARSE_ERROR, {});
+  }
+
+  // Read the vars straight into the result
+  vec.reserve(std::max(nbVars, static_cast<size_t>(std::max(nb_primals, 0))));
+  if (nb_primals > 0) {
+    vec.resize(nb_primals);
+    if (!read_doubles(in, nb_primals, vec.data())) {
+      return NLSol("Error reading the primal values", NL_Solver_Status::PARSE_ERROR, {});
+    }
+  }
+
+  // Reading objective number and status code. A missing code means the status is unknown.
+  NL_Solver_Status st = NL_Solver_Status::UNKNOWN;
+  if (read_record(in, record) && record.size() == 2 * sizeof(std::int32_t)) {
+    std::int32_t objno_code[2];
+    std::memcpy(objno_code, record.data(), sizeof(objno_code));
+    st = status_from_code(objno_code[1]);
+  }
+
+  return NLSol(msg, st, vec);
+}
+
 // *** *** *** NLSolns2Out *** *** ***
 
 /** Our "feedrawdatachunk" directly gets the solver's output, which is not the result.
@@ -149,8 +287,12 @@ bool NLSolns2Out::feedRawDataChunk(const char* data) {
 }
 
 void NLSolns2Out::parseSolution(const string& filename) {
-  ifstream f(FILE_PATH(filename));
-  NLSol sol = NLSol::parseSolution(f);
+  ifstream f(FILE_PATH(filename), ios::in | ios::binary);
+  NLSol sol = NLSol::parseSolution(f, _nlFile.vids.size());
+  if (sol.status == NL_Solver_Status::SOLVED && sol.values.size() < _nlFile.vids.size()) {
+    DEBUG_MSG("NL_Solver_Status: wrong number of primal values" << endl);
+    sol.status = NL_Solver_Status::PARSE_ERROR;
+  }
 
   switch (sol.status) {
     case NL_Solver_Status::PARSE_ERROR: {
@@ -168,69 +310,34 @@ void NLSolns2Out::parseSolution(const string& filename) {
     case NL_Solver_Status::SOLVED: {
       DEBUG_MSG("NL_Solver_Status: SOLVED" << endl);
 
-      stringstream sb;
-      // sb << std::hexfloat;  // Use hexadecimal format for FP
-      sb << std::showpoint;  // Always shows the decimal point, so we have e.g. '256.0' when 256 is
-                             // the answer for a fp value.
-      sb.precision(numeric_limits<double>::digits10 + 2);
-
-      for (int i = 0; i < _nlFile.variables.size(); ++i) {
-        string n = _nlFile.vnames[i];
-        NLVar v = _nlFile.variables[n];
+      // The values are assigned directly to the output model, without printing and parsing them
+      GCLock lock;
+      _out->declNewOutput();
+      for (size_t i = 0; i < _nlFile.vids.size(); ++i) {
+        const NLVar& v = _nlFile.variables[_nlFile.vids[i]];
         if (v.toReport) {
-          sb << v.name << " = ";
-          if (v.isInteger) {
-            auto value = static_cast<long long int>(sol.values[i]);
-            sb << value;
-          } else {
-            double value = sol.values[i];
-            sb << value;
-          }
-          sb << ";\n";
+          auto& de = _out->findOutputVar(ASTString(v.name));
+          de.first->e(solution_value(v.isInteger, sol.values[i]));
         }
       }
 
       // Output the arrays
       for (auto& a : _nlFile.outputArrays) {
-        sb << a.name << " = array" << a.dimensions.size() << "d( ";
-        for (const string& s : a.dimensions) {
-          sb << s << ", ";
-        }
-        sb << "[";
+        std::vector<Expression*> items(a.items.size());
         for (int j = 0; j < a.items.size(); ++j) {
-          const NLArray::Item& item = a.items.at(j);
-
-          // Case of the literals
-          if (item.variable.empty()) {
-            if (a.isInteger) {
-              sb << static_cast<long long int>(item.value);
-            } else {
-              sb << item.value;
-            }
-          } else {
-            int index = _nlFile.variableIndexes.at(item.variable);
-            if (a.isInteger) {
-              auto value = static_cast<long long int>(sol.values[index]);
-              sb << value;
-            } else {
-              double value = sol.values[index];
-              sb << value;
-            }
-          }
-
-          if (j < a.items.size() - 1) {
-            sb << ", ";
-          }
+          const NLArray::Item& item = a.items[j];
+          // Literals are stored in the item itself
+          double value = item.variable == -1 ? item.value
+                                             : sol.values[_nlFile.variables[item.variable].index];
+          items[j] = solution_value(a.isInteger, value);
         }
-
-        sb << "]);\n";
+        auto& de = _out->findOutputVar(ASTString(a.name));
+        de.first->e(new ArrayLit(Location(), items, a.dimensions));
       }
 
-      string s = sb.str();
-      _out->feedRawDataChunk(s.c_str());
-      _out->feedRawDataChunk(_out->opt.solutionSeparatorDef);
+      _out->flushStatistics(_out->getOutput());
+      _out->evalOutput();
       if (_nlFile.objective.isOptimisation()) {
-        _out->feedRawDataChunk("\n");
         _out->feedRawDataChunk(_out->opt.searchCompleteMsgDef);
       }
 
@@ -61,6 +61,7 @@ void NLSolverFactory::printHelp(ostream& os) {
         "solver.\n"
      << "  --keepfile\n     Write the nl and sol files next to the input file and don't remove "
         "them.\n"
+     << "  --nl-binary\n     Write the nl file in binary format instead of text.\n"
       // << "  --nl-sigint\n     Send SIGINT instead of SIGTERM.\n"
       // << "  -t <ms>, --solver-time-limit <ms>, --fzn-time-limit <ms>\n     Set time limit (in
       // milliseconds) for solving.\n"
@@ -98,6 +99,8 @@ bool NLSolverFactory::processOption(SolverInstanceBase::Options* opt, int& i,
     _opt.nlFlags.push_back(buffer);
   } else if (cop.getOption("--keepfile")) {
     _opt.doKeepfile = true;
+  } else if (cop.getOption("--nl-binary")) {
+    _opt.doBinary = true;
   } else if (cop.getOption("-s --solver-statistics")) {
     // ignore statistics flags for now
   } else if (cop.getOption("-v --verbose-solving")) {
@@ -157,7 +160,8 @@ SolverInstance::Status NLSolverInstance::solve() {
     file_nl = tmpdir->name() + "/model.nl";
     file_sol = tmpdir->name() + "/model.sol";
   }
-  std::ofstream outfile(FILE_PATH(file_nl));
+  std::ofstream outfile(FILE_PATH(file_nl),
+                        opt.doBinary ? std::ios::out | std::ios::binary : std::ios::out);
   // Configure floating point output
   if (opt.doHexafloat) {
     outfile << hexfloat;
@@ -193,8 +197,9 @@ SolverInstance::Status NLSolverInstance::solve() {
     analyse(_fzn->solveItem());
     // Phase 2
     _nlFile.phase2();
-    // Print to the files
-    _nlFile.printToStream(outfile);
+    // Print to the files, formatting large constraint sections on all hardware threads
+    _nlFile.printToStream(outfile, opt.doBinary, 0);
+    outfile.close();
 
     // --- --- --- Call the solver
     NLSolns2Out s2o = NLSolns2Out(out, _nlFile, opt.verbose);
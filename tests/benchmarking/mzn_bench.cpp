@@ -0,0 +1,762 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Benchmark suite for the compiler pipeline.
+ * Each model of the corpus is run through the individual phases of the compiler
+ * (parsing, type checking, flattening, MIP domains, optimisation, FlatZinc
+ * conversion, output) and through Solns2Out, and the time, number of heap
+ * allocations and GC high water mark of each phase are reported as JSON.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <minizinc/MIPdomains.hh>
+#include <minizinc/algorithms/min_cut.h>
+#include <minizinc/astexception.hh>
+#include <minizinc/builtins.hh>
+#include <minizinc/eval_par.hh>
+#include <minizinc/file_utils.hh>
+#include <minizinc/flatten.hh>
+#include <minizinc/optimize.hh>
+#include <minizinc/parser.hh>
+#include <minizinc/prettyprinter.hh>
+#include <minizinc/solns2out.hh>
+#include <minizinc/solver_config.hh>
+#include <minizinc/solver_instance_base.hh>
+#include <minizinc/timer.hh>
+#include <minizinc/typecheck.hh>
+#include <minizinc/utils.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<unsigned long long> bench_allocations(0);
+std::atomic<unsigned long long> bench_allocated_bytes(0);
+
+}  // namespace
+
+// Count all heap allocations of the process
+void* operator new(std::size_t size) {
+  ++bench_allocations;
+  bench_allocated_bytes += size;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t /*size*/) noexcept { std::free(p); }
+
+using namespace MiniZinc;
+
+namespace {
+
+/// Stream buffer that discards its output, but counts the bytes written to it
+class CountingBuf : public std::streambuf {
+public:
+  unsigned long long count = 0;
+
+protected:
+  int overflow(int c) override {
+    ++count;
+    return c;
+  }
+  std::streamsize xsputn(const char* /*s*/, std::streamsize n) override {
+    count += n;
+    return n;
+  }
+};
+
+struct Instance {
+  std::string name;
+  /// Model and data files (empty for generated models)
+  std::vector<std::string> files;
+  std::vector<std::string> datafiles;
+  /// Model text (for generated models)
+  std::string text;
+};
+
+/// Measurements of one phase, accumulated over all repetitions
+struct PhaseResult {
+  std::string phase;
+  double minTime = -1.0;
+  double totalTime = 0.0;
+  unsigned long long allocations = 0;
+  unsigned long long allocatedBytes = 0;
+  size_t gcMaxMem = 0;
+  /// Phase specific counter (e.g. bytes written or solutions processed)
+  unsigned long long items = 0;
+};
+
+/// Measures the phases of one run
+class PhaseTimer {
+protected:
+  std::vector<PhaseResult>& _results;
+  size_t _next = 0;
+  Timer _timer;
+  unsigned long long _allocations;
+  unsigned long long _bytes;
+
+public:
+  PhaseTimer(std::vector<PhaseResult>& results) : _results(results) { start(); }
+  void start() {
+    _allocations = bench_allocations.load();
+    _bytes = bench_allocated_bytes.load();
+    _timer.reset();
+  }
+  /// Record the phase that has just finished and start the next one
+  void finish(const std::string& phase, unsigned long long items = 0) {
+    double t = _timer.s();
+    if (_next == _results.size()) {
+      _results.emplace_back();
+      _results.back().phase = phase;
+    }
+    PhaseResult& r = _results[_next++];
+    r.minTime = r.minTime < 0 ? t : std::min(r.minTime, t);
+    r.totalTime += t;
+    r.allocations += bench_allocations.load() - _allocations;
+    r.allocatedBytes += bench_allocated_bytes.load() - _bytes;
+    r.gcMaxMem = GC::maxMem();
+    r.items += items;
+    start();
+  }
+};
+
+/// Generated models, their size grows linearly with \a scale
+std::vector<Instance> generated_instances(int scale) {
+  std::vector<Instance> instances;
+  {
+    std::ostringstream oss;
+    oss << "int: n = " << 2000 * scale << ";\n"
+        << "array[1..n] of var 0..n: x;\n"
+        << "constraint forall (i in 1..n-1) (x[i] + (i mod 7) <= x[i+1] + 3);\n"
+        << "constraint forall (i in 1..n div 2) (x[i] != x[n+1-i]);\n"
+        << "constraint sum (i in 1..n) (i * x[i]) <= n * n;\n"
+        << "solve minimize sum (x);\n"
+        << "output [\"x = \\(x)\\n\"];\n";
+    instances.push_back({"generated/linear", {}, {}, oss.str()});
+  }
+  {
+    std::ostringstream oss;
+    oss << "include \"globals.mzn\";\n"
+        << "int: n = " << 40 * scale << ";\n"
+        << "array[1..n,1..n] of var 1..n: q;\n"
+        << "constraint forall (i in 1..n) (all_different([q[i,j] | j in 1..n]));\n"
+        << "constraint forall (j in 1..n) (all_different([q[i,j] | i in 1..n]));\n"
+        << "array[1..n] of var bool: b;\n"
+        << "constraint forall (i in 1..n-1) (b[i] -> q[i,1] < q[i+1,1]);\n"
+        << "constraint count (b, true) >= n div 2;\n"
+        << "solve satisfy;\n"
+        << "output [show(q[i,j]) ++ if j = n then \"\\n\" else \" \" endif | i,j in 1..n];\n";
+    instances.push_back({"generated/latin", {}, {}, oss.str()});
+  }
+  {
+    // Large data arrays stress the parser and the evaluation of par expressions
+    int n = 100000 * scale;
+    std::ostringstream oss;
+    oss << "int: n = " << n << ";\n"
+        << "array[1..n] of int: w = [";
+    for (int i = 0; i < n; i++) {
+      oss << (i == 0 ? "" : ",") << (i * 7919) % 1000;
+    }
+    oss << "];\n"
+        << "array[1..100] of var 0..1: y;\n"
+        << "constraint sum (i in 1..100) (w[i] * y[i]) <= sum (w) div n * 50;\n"
+        << "solve maximize sum (i in 1..100) (w[n+1-i] * y[i]);\n";
+    instances.push_back({"generated/data", {}, {}, oss.str()});
+  }
+  {
+    // Large par comprehensions (evaluated in parallel with --comprehension-threads)
+    std::ostringstream oss;
+    oss << "int: n = " << 600 * scale << ";\n"
+        << "array[1..n] of int: w = [(i * 7919) mod 1000 | i in 1..n];\n"
+        << "array[1..n,1..n] of int: d = array2d(1..n, 1..n, "
+           "[abs(w[i] - w[j]) + (i * j) mod 17 | i, j in 1..n]);\n"
+        << "array[int] of int: c = [d[i,j] * (j - i) div (w[i] + 1) | i in 1..n, j in i..n "
+           "where (i + j) mod 3 != 0];\n"
+        << "array[int] of float: f = [int2float(d[i,j]) / (1.0 + i) | i, j in 1..n];\n"
+        << "array[1..n] of var 0..1: y;\n"
+        << "constraint sum (i in 1..n) (w[i] * y[i]) <= sum (c) div length(c) * 10;\n"
+        << "solve maximize sum (i in 1..n) (d[i,n+1-i] * y[i]) + "
+           "round(sum (f) / n) * y[1];\n";
+    instances.push_back({"generated/comprehension", {}, {}, oss.str()});
+  }
+  {
+    // A chain of variables without bounds, whose bounds are recomputed at every step
+    std::ostringstream oss;
+    oss << "int: n = " << 2000 * scale << ";\n"
+        << "var int: q;\n"
+        << "array[1..n] of var 1..3: x;\n"
+        << "array[0..n] of var int: t;\n"
+        << "constraint t[0] = q;\n"
+        << "constraint forall (i in 1..n) (t[i] = t[i-1] * x[i]);\n"
+        << "solve satisfy;\n";
+    instances.push_back({"generated/bounds", {}, {}, oss.str()});
+  }
+  {
+    // Many toplevel declarations, each used before its definition, so that type
+    // checking has to sort a long chain of dependencies
+    int n = 50000 * scale;
+    std::ostringstream oss;
+    for (int i = 0; i < n; i++) {
+      oss << "int: a" << i << " = a" << i + 1 << " + " << i % 7 << ";\n"
+          << "var 0..10: v" << i << ";\n"
+          << "constraint v" << i << " <= v" << (i + 1) % n << " + a" << i << " mod 3;\n";
+    }
+    oss << "int: a" << n << " = 0;\n"
+        << "solve satisfy;\n";
+    instances.push_back({"generated/declarations", {}, {}, oss.str()});
+  }
+  return instances;
+}
+
+/// Read a list of instances, one per line: a model file followed by data files.
+/// Relative paths are relative to the list file.
+std::vector<Instance> read_instance_list(const std::string& filename) {
+  std::ifstream ifs(FILE_PATH(filename));
+  if (!ifs.good()) {
+    throw Error("Cannot open instance list " + filename);
+  }
+  std::string dir = FileUtils::dir_name(filename);
+  std::vector<Instance> instances;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream iss(line);
+    std::string file;
+    Instance inst;
+    while (iss >> file) {
+      if (file[0] == '#') {
+        break;
+      }
+      std::string path = FileUtils::is_absolute(file) ? file : dir + "/" + file;
+      if (inst.files.empty()) {
+        inst.name = file;
+        inst.files.push_back(path);
+      } else {
+        inst.name += " " + file;
+        inst.datafiles.push_back(path);
+      }
+    }
+    if (!inst.files.empty()) {
+      instances.push_back(inst);
+    }
+  }
+  return instances;
+}
+
+/// Write a value for variable \a vd that is within its bounds
+void print_value(EnvI& envi, VarDecl* vd, std::ostream& os) {
+  Type t = vd->type();
+  if (t.isbool()) {
+    os << "false";
+  } else if (t.isint()) {
+    IntBounds ib = compute_int_bounds(envi, vd->id());
+    os << (ib.valid && ib.l.isFinite() ? ib.l : IntVal(0));
+  } else if (t.isfloat()) {
+    FloatBounds fb = compute_float_bounds(envi, vd->id());
+    os << (fb.valid && fb.l.isFinite() ? fb.l : FloatVal(0.0));
+  } else {
+    os << "{}";
+  }
+}
+
+/// Construct the raw solver output for one solution of the flat model in \a env
+std::string fake_solution(Env& env) {
+  GCLock lock;
+  EnvI& envi = env.envi();
+  std::ostringstream oss;
+  for (auto& vdi : env.flat()->vardecls()) {
+    if (vdi.removed()) {
+      continue;
+    }
+    VarDecl* vd = vdi.e();
+    const Annotation& ann = Expression::ann(vd);
+    if (ann.contains(Constants::constants().ann.output_var)) {
+      oss << *vd->id() << " = ";
+      print_value(envi, vd, oss);
+      oss << ";\n";
+    } else if (Call* c = ann.getCall(Constants::constants().ann.output_array)) {
+      auto* dims = Expression::cast<ArrayLit>(c->arg(0));
+      auto* al = Expression::cast<ArrayLit>(vd->e());
+      oss << *vd->id() << " = array" << dims->size() << "d(";
+      for (unsigned int i = 0; i < dims->size(); i++) {
+        oss << *(*dims)[i] << ", ";
+      }
+      oss << "[";
+      for (unsigned int i = 0; i < al->size(); i++) {
+        oss << (i == 0 ? "" : ", ");
+        if (Id* id = Expression::dynamicCast<Id>((*al)[i])) {
+          print_value(envi, id->decl(), oss);
+        } else {
+          oss << *(*al)[i];
+        }
+      }
+      oss << "]);\n";
+    }
+  }
+  oss << "----------\n";
+  return oss.str();
+}
+
+/// In-process solver instance that reports the same solution values as fake_solution
+class BenchSolverInstance : public SolverInstanceBase2 {
+protected:
+  /// Solution value for each declaration of the flat model (indexed by payload)
+  std::vector<KeepAlive> _values;
+  Expression* getSolutionValue(Id* id) override {
+    return _values[static_cast<unsigned int>(id->decl()->payload())]();
+  }
+
+public:
+  BenchSolverInstance(Env& env, std::ostream& log)
+      : SolverInstanceBase2(env, log, new SolverInstanceBase::Options()) {
+    GCLock lock;
+    EnvI& envi = env.envi();
+    for (auto& vdi : env.flat()->vardecls()) {
+      VarDecl* vd = vdi.e();
+      auto idx = static_cast<unsigned int>(vd->payload());
+      if (_values.size() <= idx) {
+        _values.resize(idx + 1);
+      }
+      Type t = vd->type();
+      if (t.dim() != 0) {
+        continue;
+      }
+      if (t.isbool()) {
+        _values[idx] = Constants::constants().literalFalse;
+      } else if (t.isint()) {
+        IntBounds ib = compute_int_bounds(envi, vd->id());
+        _values[idx] = IntLit::a(ib.valid && ib.l.isFinite() ? ib.l : IntVal(0));
+      } else if (t.isfloat()) {
+        FloatBounds fb = compute_float_bounds(envi, vd->id());
+        _values[idx] = FloatLit::a(fb.valid && fb.l.isFinite() ? fb.l : FloatVal(0.0));
+      } else {
+        _values[idx] = new SetLit(Location().introduce(), IntSetVal::a());
+      }
+    }
+  }
+  Status next() override { return SolverInstance::ERROR; }
+  void processFlatZinc() override {}
+  void resetSolver() override {}
+};
+
+/// Run all phases on instance \a inst
+void run_instance(const Instance& inst, const std::string& stdlibDir, int nSolutions,
+                  unsigned int comprehensionThreads, std::vector<PhaseResult>& results) {
+  CountingBuf nullBuf;
+  std::ostream nullStream(&nullBuf);
+  std::vector<std::string> includePaths = {FileUtils::file_path(stdlibDir + "/std/")};
+
+  Env env(nullptr, nullStream, nullStream);
+  PhaseTimer pt(results);
+  std::stringstream errstream;
+  Model* m = parse(env, inst.files, inst.datafiles, inst.text, inst.name + ".mzn", includePaths,
+                   global_includes(stdlibDir), false, false, false, false, errstream);
+  if (m == nullptr) {
+    throw Error(errstream.str());
+  }
+  env.model(m);
+  pt.finish("parse");
+
+  std::vector<TypeError> typeErrors;
+  typecheck(env, m, typeErrors, false, false);
+  if (!typeErrors.empty()) {
+    throw MultipleErrors<TypeError>(typeErrors);
+  }
+  register_builtins(env);
+  m->checkFnValid(env.envi(), typeErrors);
+  if (!typeErrors.empty()) {
+    throw MultipleErrors<TypeError>(typeErrors);
+  }
+  pt.finish("typecheck");
+
+  FlatteningOptions fopts;
+  fopts.comprehensionThreads = comprehensionThreads;
+  flatten(env, fopts);
+  pt.finish("flatten");
+  mip_domains(env);
+  pt.finish("mip_domains");
+  optimize(env);
+  pt.finish("optimize");
+  oldflatzinc(env);
+  pt.finish("oldflatzinc");
+
+  {
+    Printer p(nullStream, 0, true, &env.envi());
+    unsigned long long before = nullBuf.count;
+    p.print(env.flat());
+    pt.finish("print_fzn", nullBuf.count - before);
+  }
+  {
+    Printer p(nullStream, 0, true, &env.envi());
+    unsigned long long before = nullBuf.count;
+    p.print(env.output());
+    pt.finish("print_ozn", nullBuf.count - before);
+  }
+
+  std::string sol = fake_solution(env);
+  pt.start();
+  {
+    Solns2Out s2o(nullStream, nullStream, stdlibDir);
+    s2o.opt.flagOutputFlush = false;
+    s2o.opt.flagUnique = false;
+    s2o.initFromEnv(&env);
+    for (int i = 0; i < nSolutions; i++) {
+      s2o.feedRawDataChunk(sol.c_str());
+    }
+  }
+  pt.finish("solns2out", static_cast<unsigned long long>(nSolutions));
+
+  {
+    Solns2Out s2o(nullStream, nullStream, stdlibDir);
+    s2o.opt.flagOutputFlush = false;
+    s2o.opt.flagUnique = false;
+    s2o.initFromEnv(&env);
+    BenchSolverInstance si(env, nullStream);
+    si.setSolns2Out(&s2o);
+    pt.start();
+    for (int i = 0; i < nSolutions; i++) {
+      si.printSolution();
+    }
+    pt.finish("solver_solutions", static_cast<unsigned long long>(nSolutions));
+  }
+}
+
+/// Support graph of a random fractional solution of circuit over \a n nodes: a Hamiltonian
+/// cycle of weight 1/2 plus cycles of weight 1/2 over blocks of 3 to 30 consecutive nodes of
+/// the first cycle. The subtour elimination constraint of every block is violated.
+void random_fractional_circuit(int n, Algorithms::MinCut& mc) {
+  std::mt19937 rng(n);
+  auto shuffle = [&rng](std::vector<int>& v) {
+    for (size_t i = v.size(); i > 1; i--) {
+      std::swap(v[i - 1], v[rng() % i]);
+    }
+  };
+  std::vector<int> perm(n);
+  for (int i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  shuffle(perm);
+  std::map<std::pair<int, int>, double> weights;
+  auto add = [&weights](int i, int j) {
+    weights[std::make_pair(std::min(i, j), std::max(i, j))] += 0.5;
+  };
+  for (int i = 0; i < n; i++) {
+    add(perm[i], perm[(i + 1) % n]);
+  }
+  for (int b = 0; b < n;) {
+    int e = std::min(n, b + 3 + static_cast<int>(rng() % 28));
+    if (n - e < 3) {
+      e = n;
+    }
+    std::vector<int> block(perm.begin() + b, perm.begin() + e);
+    shuffle(block);
+    for (size_t i = 0; i < block.size(); i++) {
+      add(block[i], block[(i + 1) % block.size()]);
+    }
+    b = e;
+  }
+  mc.nNodes = n;
+  mc.edges.clear();
+  mc.weights.clear();
+  for (const auto& w : weights) {
+    mc.edges.push_back(w.first);
+    mc.weights.push_back(w.second);
+  }
+  // As used for subtour elimination constraints
+  mc.threshold = 1.999;
+  mc.contractWeight = 1.0 - 1e-6;
+}
+
+/// Microbenchmarks of the min cut separation of subtour elimination constraints
+void run_micro_min_cut(int scale, PhaseTimer& pt) {
+  for (int n : {100, 500, 1000, 2000, 5000}) {
+    Algorithms::MinCut mc;
+    random_fractional_circuit(n, mc);
+    // The first run allocates the buffers, which are reused by the measured runs
+    mc.solve();
+    size_t cuts = 0;
+    pt.start();
+    for (int i = 0; i < scale; i++) {
+      mc.solve();
+      cuts += mc.nCuts();
+    }
+    pt.finish("min_cut_" + std::to_string(n), cuts);
+  }
+}
+
+/// Microbenchmarks of the integer arithmetic used by bounds computation
+void run_micro(const std::string& stdlibDir, int scale, std::vector<PhaseResult>& results) {
+  const int n = 1000000 * scale;
+  std::vector<IntVal> x(n);
+  std::vector<IntVal> c(n);
+  for (int i = 0; i < n; i++) {
+    x[i] = (i * 7919LL) % 1000 - 500;
+    c[i] = i % 13 - 6;
+  }
+  PhaseTimer pt(results);
+  IntVal sumLoop = 0;
+  for (const auto& v : x) {
+    sumLoop += v;
+  }
+  pt.finish("intval_sum_loop", n);
+  IntVal sum = IntVal::sum(x);
+  pt.finish("intval_sum", n);
+  IntVal linLoop = 0;
+  for (int i = 0; i < n; i++) {
+    linLoop += c[i] * x[i];
+  }
+  pt.finish("intval_linear_loop", n);
+  IntVal lin = IntVal::linear(c, x);
+  pt.finish("intval_linear", n);
+  IntVal::scale(x, 3);
+  pt.finish("intval_scale", n);
+  if (sumLoop != sum || linLoop != lin || IntVal::sum(x) != sum * 3) {
+    throw Error("inconsistent results of IntVal bulk operations");
+  }
+
+  // Bounds of a linear expression over 10000 variables, and of the same sum as a tree of BinOps
+  CountingBuf nullBuf;
+  std::ostream nullStream(&nullBuf);
+  std::vector<std::string> includePaths = {FileUtils::file_path(stdlibDir + "/std/")};
+  Env env(nullptr, nullStream, nullStream);
+  std::stringstream errstream;
+  Model* m = parse(env, {}, {}, "array[1..10000] of var -10..10: x;\n", "micro.mzn", includePaths,
+                   global_includes(stdlibDir), false, false, false, false, errstream);
+  if (m == nullptr) {
+    throw Error(errstream.str());
+  }
+  env.model(m);
+  std::vector<TypeError> typeErrors;
+  typecheck(env, m, typeErrors, false, false);
+  register_builtins(env);
+  flatten(env, FlatteningOptions());
+  GCLock lock;
+  ArrayLit* xs = nullptr;
+  for (auto& vdi : env.flat()->vardecls()) {
+    if (vdi.e()->id()->str() == "x") {
+      xs = Expression::dynamicCast<ArrayLit>(vdi.e()->e());
+    }
+  }
+  if (xs == nullptr) {
+    throw Error("cannot find flattened variable array");
+  }
+  std::vector<Expression*> coeffs(xs->size());
+  Expression* tree = nullptr;
+  for (unsigned int i = 0; i < xs->size(); i++) {
+    coeffs[i] = IntLit::a(static_cast<long long int>(i % 13) - 6);
+    auto* term = new BinOp(Location().introduce(), coeffs[i], BOT_MULT, (*xs)[i]);
+    Expression::type(term, Type::varint());
+    if (tree == nullptr) {
+      tree = term;
+    } else {
+      tree = new BinOp(Location().introduce(), tree, BOT_PLUS, term);
+      Expression::type(tree, Type::varint());
+    }
+  }
+  auto* coeffsAl = new ArrayLit(Location().introduce(), coeffs);
+  Expression::type(coeffsAl, Type::parint(1));
+  Call* linExp = Call::a(Location().introduce(), env.envi().constants.ids.lin_exp,
+                         {coeffsAl, xs, IntLit::a(0)});
+  Expression::type(linExp, Type::varint());
+  const int rounds = 20 * scale;
+  pt.start();
+  for (int i = 0; i < rounds; i++) {
+    compute_int_bounds(env.envi(), linExp);
+  }
+  pt.finish("int_bounds_lin_exp", rounds);
+  for (int i = 0; i < rounds; i++) {
+    compute_int_bounds(env.envi(), tree);
+  }
+  pt.finish("int_bounds_binop", rounds);
+  run_micro_min_cut(scale, pt);
+}
+
+void print_json_string(std::ostream& os, const std::string& s) {
+  os << "\"" << Printer::escapeStringLit(s) << "\"";
+}
+
+void usage(const char* exe) {
+  std::cerr << "Usage: " << exe << " [options] [model.mzn [data.dzn ...]]\n"
+            << "Options:\n"
+            << "  --stdlib-dir <dir>\n    MiniZinc standard library directory\n"
+            << "  -l <file>\n    Read instances from <file> (one model and its data files per "
+               "line)\n"
+            << "  --no-generated\n    Do not run the generated models\n"
+            << "  --scale <n>\n    Scale the size of the generated models (default 1)\n"
+            << "  --repeat <n>\n    Number of runs per instance (default 3)\n"
+            << "  --solutions <n>\n    Number of solutions fed to Solns2Out (default 1000)\n"
+            << "  --micro\n    Also run microbenchmarks of integer arithmetic, bounds "
+               "computation\n    and min cuts\n"
+            << "  --comprehension-threads <n>[,<n>...]\n    Run every instance once for each "
+               "number of threads\n    evaluating par comprehensions (default 1)\n"
+            << "  -o <file>\n    Write the JSON results to <file> instead of standard output\n";
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+#ifdef _WIN32
+  OverflowHandler::install();
+#else
+  OverflowHandler::install(argv);
+#endif
+  std::string stdlibDir;
+  if (char* dir = getenv("MZN_STDLIB_DIR")) {
+    stdlibDir = dir;
+  }
+  std::vector<Instance> instances;
+  Instance cmdline;
+  bool generated = true;
+  int scale = 1;
+  int repeat = 3;
+  int nSolutions = 1000;
+  std::vector<unsigned int> comprehensionThreads;
+  bool micro = false;
+  std::string outputFile;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string arg(argv[i]);
+      bool hasValue = i + 1 < argc;
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return EXIT_SUCCESS;
+      }
+      if (arg == "--stdlib-dir" && hasValue) {
+        stdlibDir = argv[++i];
+      } else if (arg == "-l" && hasValue) {
+        auto list = read_instance_list(argv[++i]);
+        instances.insert(instances.end(), list.begin(), list.end());
+      } else if (arg == "--no-generated") {
+        generated = false;
+      } else if (arg == "--micro") {
+        micro = true;
+      } else if (arg == "--scale" && hasValue) {
+        scale = std::max(1, atoi(argv[++i]));
+      } else if (arg == "--repeat" && hasValue) {
+        repeat = std::max(1, atoi(argv[++i]));
+      } else if (arg == "--solutions" && hasValue) {
+        nSolutions = std::max(0, atoi(argv[++i]));
+      } else if (arg == "--comprehension-threads" && hasValue) {
+        std::istringstream iss(argv[++i]);
+        std::string n;
+        while (std::getline(iss, n, ',')) {
+          comprehensionThreads.push_back(static_cast<unsigned int>(std::max(0, atoi(n.c_str()))));
+        }
+      } else if (arg == "-o" && hasValue) {
+        outputFile = argv[++i];
+      } else if (!arg.empty() && arg[0] == '-') {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+      } else if (cmdline.files.empty()) {
+        cmdline.name = arg;
+        cmdline.files.push_back(arg);
+      } else {
+        cmdline.name += " " + arg;
+        cmdline.datafiles.push_back(arg);
+      }
+    }
+    if (!cmdline.files.empty()) {
+      instances.push_back(cmdline);
+    }
+    if (comprehensionThreads.empty()) {
+      comprehensionThreads.push_back(1);
+    }
+    if (generated) {
+      auto gen = generated_instances(scale);
+      instances.insert(instances.begin(), gen.begin(), gen.end());
+    }
+    if (micro) {
+      // Marks the microbenchmarks, which are run instead of the compiler phases
+      instances.push_back({"micro/intval", {}, {}, ""});
+    }
+    if (stdlibDir.empty()) {
+      SolverConfigs configs(std::cerr);
+      stdlibDir = configs.mznlibDir();
+    }
+    if (stdlibDir.empty()) {
+      throw Error(
+          "unknown minizinc standard library directory, specify --stdlib-dir or set the "
+          "MZN_STDLIB_DIR environment variable");
+    }
+  } catch (const Exception& e) {
+    e.print(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream ofs;
+  if (!outputFile.empty()) {
+    ofs.open(FILE_PATH(outputFile));
+  }
+  std::ostream& os = outputFile.empty() ? std::cout : ofs;
+  bool failed = false;
+  os << "{\"scale\": " << scale << ", \"repeat\": " << repeat << ", \"instances\": [";
+  size_t entry = 0;
+  for (const Instance& inst : instances) {
+    for (unsigned int threads : comprehensionThreads) {
+      bool isMicro = micro && &inst == &instances.back();
+      if (isMicro && threads != comprehensionThreads[0]) {
+        continue;
+      }
+      std::vector<PhaseResult> results;
+      std::string error;
+      try {
+        for (int r = 0; r < repeat; r++) {
+          if (isMicro) {
+            run_micro(stdlibDir, scale, results);
+          } else {
+            run_instance(inst, stdlibDir, nSolutions, threads, results);
+          }
+        }
+      } catch (const Exception& e) {
+        std::ostringstream oss;
+        e.print(oss);
+        error = oss.str();
+        failed = true;
+      } catch (const std::exception& e) {
+        error = e.what();
+        failed = true;
+      }
+      os << (entry++ == 0 ? "\n" : ",\n") << "  {\"name\": ";
+      print_json_string(os, inst.name);
+      os << ", \"comprehensionThreads\": " << threads;
+      if (!error.empty()) {
+        os << ", \"error\": ";
+        print_json_string(os, error);
+      }
+      os << ", \"phases\": [";
+      for (size_t j = 0; j < results.size(); j++) {
+        const PhaseResult& r = results[j];
+        os << (j == 0 ? "\n" : ",\n") << "    {\"phase\": \"" << r.phase << "\""
+           << ", \"time\": " << r.minTime << ", \"meanTime\": " << r.totalTime / repeat
+           << ", \"allocations\": " << r.allocations / repeat
+           << ", \"allocatedBytes\": " << r.allocatedBytes / repeat
+           << ", \"gcMaxMem\": " << r.gcMaxMem;
+        if (r.items != 0) {
+          os << ", \"items\": " << r.items / repeat;
+        }
+        os << "}";
+      }
+      os << (results.empty() ? "" : "\n  ") << "]}";
+    }
+  }
+  os << "\n]}" << std::endl;
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+from pathlib import Path
+import subprocess
+import json
+import os
+import re
+import stat
+import sys
+import pytest
+from tempfile import TemporaryDirectory
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="the FlatZinc is never piped on Windows")
+def test_fzn_pipe():
+    from minizinc import default_driver, Driver
+
+    here = Path(__file__).resolve().parent
+    assert isinstance(default_driver, Driver)
+    model_file = here / "test_fzn_pipe.mzn"
+    with TemporaryDirectory() as tmp:
+        # The solver is called as <executable> <file>.fzn, so run this file through a script
+        solver = Path(tmp) / "solver.sh"
+        solver.write_text(
+            '#!/bin/sh\nexec "{}" "{}" "$@"\n'.format(
+                Path(sys.executable).resolve().as_posix(),
+                Path(__file__).resolve().as_posix(),
+            )
+        )
+        solver.chmod(solver.stat().st_mode | stat.S_IXUSR)
+        config = Path(tmp) / "solver.msc"
+        config.write_text(
+            json.dumps(
+                {
+                    "name": "Test FlatZinc solver",
+                    "version": "1.0",
+                    "id": "org.minizinc.test_fzn_solver",
+                    "executable": solver.as_posix(),
+                    "mznlib": "",
+                    "supportsFzn": True,
+                }
+            )
+        )
+        fzn_file = Path(tmp) / "model.fzn"
+        p = subprocess.run(
+            [default_driver._executable, model_file, "--solver", config, "-c", "-o", fzn_file],
+            stdin=None,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+        assert p.returncode == 0, p.stderr
+        outputs = []
+        for flags in [[], ["--fzn-pipe"]]:
+            fzn_copy = Path(tmp) / "copy.fzn"
+            env = dict(os.environ, TEST_FZN_COPY=fzn_copy.as_posix())
+            p = subprocess.run(
+                [
+                    default_driver._executable,
+                    model_file,
+                    "--solver",
+                    config,
+                    "--output-mode",
+                    "json",
+                ]
+                + flags,
+                stdin=None,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+                env=env,
+            )
+            assert p.returncode == 0, p.stderr
+            outputs.append(p.stdout.decode())
+            # The solver must receive the same FlatZinc, read from its standard input when piped
+            lines = fzn_copy.read_text().split("\n", 1)
+            assert (lines[0] == "/dev/stdin") == ("--fzn-pipe" in flags)
+            assert lines[1] == fzn_file.read_text()
+        assert outputs[0] == outputs[1]
+        lines = outputs[0].splitlines()
+        assert lines[-1] == "----------"
+        solution = json.loads("\n".join(lines[:-1]))
+        assert solution == {"x": 3, "y": -4, "a": [2, 2]}
+
+
+if __name__ == "__main__":
+    # Dummy FlatZinc solver, setting every variable to its lower bound
+    fzn_file = sys.argv[-1]
+    with open(fzn_file) as f:
+        fzn = f.read()
+    if "TEST_FZN_COPY" in os.environ:
+        Path(os.environ["TEST_FZN_COPY"]).write_text(fzn_file + "\n" + fzn)
+    values = {}
+    for lb, name in re.findall(r"^var (-?\d+)\.\.-?\d+: (\w+)", fzn, re.M):
+        values[name] = lb
+    for line in fzn.splitlines():
+        m = re.match(r"var .*: (\w+):: output_var", line)
+        if m:
+            print("{} = {};".format(m.group(1), values[m.group(1)]))
+        m = re.match(
+            r"array \[1\.\.\d+\] of var .*: (\w+):: output_array\(\[(.*)\]\) = \[(.*)\];", line
+        )
+        if m:
+            elems = ", ".join(values[e.strip()] for e in m.group(3).split(","))
+            print("{} = array1d({}, [{}]);".format(m.group(1), m.group(2), elems))
+    print("----------")
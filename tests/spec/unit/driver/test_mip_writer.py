@@ -0,0 +1,73 @@
+from pathlib import Path
+import subprocess
+import json
+import pytest
+from tempfile import TemporaryDirectory
+
+
+def write_model(model_file, out_file, *args):
+    from minizinc import default_driver
+
+    p = subprocess.run(
+        [
+            default_driver._executable,
+            model_file,
+            "--solver",
+            "writer",
+            "--writeModel",
+            out_file,
+            *args,
+        ],
+        stdin=None,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+    assert p.returncode == 0, p.stderr
+    assert "=====UNKNOWN=====" in p.stdout.decode()
+    return out_file.read_text().splitlines()
+
+
+def test_mip_writer():
+    from minizinc import default_driver, Driver
+
+    here = Path(__file__).resolve().parent
+    assert isinstance(default_driver, Driver)
+    solvers = subprocess.run(
+        [default_driver._executable, "--solvers-json"], stdout=subprocess.PIPE
+    )
+    if "writer" not in [t for s in json.loads(solvers.stdout) for t in s.get("tags", [])]:
+        pytest.skip("requires the MIP model writer")
+    model_file = here / "test_mip_writer.mzn"
+    with TemporaryDirectory() as tmp:
+        lp = write_model(model_file, Path(tmp) / "model.lp")
+        assert lp[1] == "Maximize"
+        assert " _c0: + 2 x + 3 y <= 12" in lp
+        assert " _c1: - 1 x + 1 y <= 2" in lp
+        assert " 0 <= x <= 10" in lp
+        assert " 0 <= y <= 10" in lp
+        assert lp.index("Generals") < len(lp) - 2
+        assert "x y" in lp[lp.index("Generals") + 1]
+        assert lp[-1] == "End"
+
+        mps = write_model(model_file, Path(tmp) / "model.mps")
+        assert mps[0].split() == ["NAME", "MiniZinc"]
+        assert mps[1:3] == ["OBJSENSE", "    MAX"]
+        assert " L  _c0" in mps and " L  _c1" in mps
+        for line in [
+            "    x  _c0  2",
+            "    x  _c1  -1",
+            "    y  _c0  3",
+            "    y  _c1  1",
+            "    RHS  _c0  12",
+            "    RHS  _c1  2",
+            " UP BND  x  10",
+            " UP BND  y  10",
+        ]:
+            assert line in mps
+        assert mps[-1] == "ENDATA"
+
+        # Transposing the matrix in small chunks gives the same file
+        chunked = write_model(
+            model_file, Path(tmp) / "chunked.mps", "--writer-chunk-size", "1"
+        )
+        assert chunked == mps
@@ -0,0 +1,123 @@
+from pathlib import Path
+import subprocess
+import json
+import os
+import stat
+import struct
+import sys
+import pytest
+from tempfile import TemporaryDirectory
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="uses a shell script as NL solver")
+def test_nl_binary():
+    from minizinc import default_driver, Driver
+
+    here = Path(__file__).resolve().parent
+    assert isinstance(default_driver, Driver)
+    model_file = here / "test_nl_binary.mzn"
+    with TemporaryDirectory() as tmp:
+        # The NL solver is called as <executable> <file>.nl -AMPL, so run this file through a script
+        solver = Path(tmp) / "solver.sh"
+        solver.write_text(
+            '#!/bin/sh\nexec "{}" "{}" "$@"\n'.format(
+                Path(sys.executable).resolve().as_posix(),
+                Path(__file__).resolve().as_posix(),
+            )
+        )
+        solver.chmod(solver.stat().st_mode | stat.S_IXUSR)
+        config = Path(tmp) / "solver.msc"
+        config.write_text(
+            json.dumps(
+                {
+                    "name": "Test NL solver",
+                    "version": "1.0",
+                    "id": "org.minizinc.test_nl_solver",
+                    "executable": solver.as_posix(),
+                    "supportsFzn": False,
+                    "supportsNL": True,
+                }
+            )
+        )
+        outputs = []
+        nl_copy = Path(tmp) / "copy.nl"
+        env = dict(os.environ, TEST_NL_COPY=nl_copy.as_posix())
+        for flags in [[], ["--nl-binary"]]:
+            p = subprocess.run(
+                [
+                    default_driver._executable,
+                    model_file,
+                    "--solver",
+                    config,
+                    "--output-mode",
+                    "json",
+                ]
+                + flags,
+                stdin=None,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+                env=env,
+            )
+            assert p.returncode == 0, p.stderr
+            outputs.append(p.stdout.decode())
+        # The binary file must match the reference, which was encoded from the text NL file
+        # following "Writing .nl files" (D. M. Gay), independently of the NL writer
+        assert nl_copy.read_bytes() == (here / "test_nl_binary.nl").read_bytes()
+        # Both formats must result in the solution at the lower bounds of the variables
+        assert outputs[0] == outputs[1]
+        lines = outputs[0].splitlines()
+        assert lines[-2:] == ["----------", "=========="]
+        solution = json.loads("\n".join(lines[:-2]))
+        assert solution == {"x": 3, "y": -4, "z": 1.5, "a": [[2, 2], [2, 2]]}
+
+
+def read_bounds(nl):
+    # Read the bounds of the variables from a text ('g') or binary ('b') NL file. The header is
+    # made of 10 text lines, followed by the 'k' segment (n-1 column counts) and the 'b' segment.
+    binary = nl[0:1] == b"b"
+    header = nl.split(b"\n", 10)
+    n_vars = int(header[1].split()[0])
+    values = []
+    if binary:
+        pos = len(nl) - len(header[10]) + 1 + 4 * n_vars
+        assert nl[pos : pos + 1] == b"b"
+        pos += 1
+        for _ in range(n_vars):
+            tag = nl[pos] - ord("0")
+            n = [2, 1, 1, 0, 1][tag]
+            bounds = struct.unpack_from("={}d".format(n), nl, pos + 1)
+            pos += 1 + 8 * n
+            values.append(bounds[0] if tag != 3 else 0.0)
+    else:
+        lines = header[10].split(b"\n")
+        assert lines[n_vars].startswith(b"b")
+        for line in lines[n_vars + 1 : 2 * n_vars + 1]:
+            items = line.split(b"#")[0].split()
+            tag = int(items[0])
+            values.append(float(items[1]) if tag != 3 else 0.0)
+    return binary, values
+
+
+def record(data):
+    return struct.pack("=i", len(data)) + data + struct.pack("=i", len(data))
+
+
+if __name__ == "__main__":
+    # Dummy NL solver, setting every variable to its lower bound
+    nl_file = Path(sys.argv[1])
+    if "TEST_NL_COPY" in os.environ:
+        Path(os.environ["TEST_NL_COPY"]).write_bytes(nl_file.read_bytes())
+    binary, values = read_bounds(nl_file.read_bytes())
+    sol_file = nl_file.with_suffix(".sol")
+    if binary:
+        sol = record(b"Test NL solver")
+        sol += record(b"Options") + record(struct.pack("=3i", 2, 1, 1))
+        sol += record(struct.pack("=4i", 0, 0, len(values), len(values)))
+        sol += record(struct.pack("={}d".format(len(values)), *values))
+        sol += record(struct.pack("=2i", 0, 0))
+        sol_file.write_bytes(sol)
+    else:
+        sol = "Test NL solver\n\nOptions\n3\n1\n1\n0\n0\n0\n{0}\n{0}\n".format(len(values))
+        sol += "".join("{}\n".format(repr(v)) for v in values)
+        sol += "objno 0 0\n"
+        sol_file.write_text(sol)
@@ -0,0 +1,50 @@
+from pathlib import Path
+import subprocess
+import json
+import pytest
+from tempfile import TemporaryDirectory
+
+
+def test_warm_start_cache():
+    from minizinc import default_driver, Driver
+
+    here = Path(__file__).resolve().parent
+    assert isinstance(default_driver, Driver)
+    solvers = subprocess.run(
+        [default_driver._executable, "--solvers-json"], stdout=subprocess.PIPE
+    )
+    if "cbc" not in [t for s in json.loads(solvers.stdout) for t in s.get("tags", [])]:
+        pytest.skip("requires the COIN-BC solver")
+    model_file = here / "test_warm_start_cache.mzn"
+    with TemporaryDirectory() as tmp:
+        cache = Path(tmp) / "cache.txt"
+        for run in range(2):
+            p = subprocess.run(
+                [
+                    default_driver._executable,
+                    model_file,
+                    "--solver",
+                    "cbc",
+                    "--warm-start-cache",
+                    cache,
+                    "-v",
+                ],
+                stdin=None,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+            )
+            assert p.returncode == 0, p.stderr
+            assert "x = [5, 2, 0];" in p.stdout.decode()
+            # The cache is replaced in one step, no temporary files are left behind
+            assert [f.name for f in Path(tmp).iterdir()] == ["cache.txt"]
+            values = {}
+            for line in cache.read_text().splitlines():
+                key, value = line.split("\t")
+                values[key] = float(value)
+            assert {k: values.get(k) for k in ["x[1]", "x[2]", "x[3]"]} == {
+                "x[1]": 5.0,
+                "x[2]": 2.0,
+                "x[3]": 0.0,
+            }
+            # The second run is warm started from the cache written by the first
+            assert ("from the warm start cache" in p.stderr.decode()) == (run == 1)